@@ -0,0 +1,137 @@
+/****************************************************************************
+
+ This file is part of the GLC-lib library.
+ Copyright (C) 2005-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ http://glc-lib.sourceforge.net
+
+ GLC-lib is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ GLC-lib is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with GLC-lib; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+
+
+//! Headless check of the software occlusion culler, no OpenGL context is needed
+/*! The view projection matrix is the identity, so world coordinates are the
+ *  normalized device coordinates and a smaller z is nearer. Return 0 on success.*/
+
+#include <QtDebug>
+
+#include <GLC_OcclusionCuller>
+#include <GLC_3DViewInstance>
+#include <GLC_Mesh>
+
+// Return a mesh of the given box
+static GLC_Mesh* boxMesh(const GLC_Point3d& lower, const GLC_Point3d& upper)
+{
+	GLfloatVector positions;
+	for (int i= 0; i < 8; ++i)
+	{
+		positions << static_cast<GLfloat>((i & 1) ? upper.x() : lower.x());
+		positions << static_cast<GLfloat>((i & 2) ? upper.y() : lower.y());
+		positions << static_cast<GLfloat>((i & 4) ? upper.z() : lower.z());
+	}
+	IndexList index;
+	index << 0 << 2 << 1 << 1 << 2 << 3 << 4 << 5 << 6 << 5 << 7 << 6
+		  << 0 << 1 << 4 << 1 << 5 << 4 << 2 << 6 << 3 << 3 << 6 << 7
+		  << 0 << 4 << 2 << 2 << 4 << 6 << 1 << 3 << 5 << 3 << 7 << 5;
+
+	GLC_Mesh* pMesh= new GLC_Mesh();
+	pMesh->addVertice(positions);
+	pMesh->addTriangles(NULL, index);
+	pMesh->finish();
+	return pMesh;
+}
+
+// Return a mesh of the square wall of the given depth, split along its diagonal
+static GLC_Mesh* wallMesh(float z)
+{
+	GLfloatVector positions;
+	positions << -1.0f << -1.0f << z << 1.0f << -1.0f << z << 1.0f << 1.0f << z << -1.0f << 1.0f << z;
+	IndexList index;
+	index << 0 << 1 << 2 << 0 << 2 << 3;
+
+	GLC_Mesh* pMesh= new GLC_Mesh();
+	pMesh->addVertice(positions);
+	pMesh->addTriangles(NULL, index);
+	pMesh->finish();
+	return pMesh;
+}
+
+static int failureCount= 0;
+
+static void check(bool condition, const char* pMessage)
+{
+	qDebug() << (condition ? "PASS" : "FAIL") << pMessage;
+	if (!condition) ++failureCount;
+}
+
+int main(int, char**)
+{
+	// Depth buffer filled directly
+	{
+		GLC_OcclusionCuller culler(64, 64);
+		culler.setViewProjectionMatrix(GLC_Matrix4x4());
+		const float wall[]= {-0.5f, -0.5f, 0.0f, 0.5f, -0.5f, 0.0f, 0.5f, 0.5f, 0.0f
+							, -0.5f, -0.5f, 0.0f, 0.5f, 0.5f, 0.0f, -0.5f, 0.5f, 0.0f};
+		culler.rasterizeTriangles(wall, 2);
+		culler.buildDepthPyramid();
+
+		check(culler.isOccluded(GLC_BoundingBox(GLC_Point3d(-0.2, -0.2, 0.5), GLC_Point3d(0.2, 0.2, 0.6))), "box behind the wall is occluded");
+		check(!culler.isOccluded(GLC_BoundingBox(GLC_Point3d(-0.2, -0.2, -0.6), GLC_Point3d(0.2, 0.2, -0.5))), "box in front of the wall is visible");
+		check(!culler.isOccluded(GLC_BoundingBox(GLC_Point3d(0.7, 0.7, 0.5), GLC_Point3d(0.9, 0.9, 0.6))), "box beside the wall is visible");
+		check(!culler.isOccluded(GLC_BoundingBox(GLC_Point3d(0.3, -0.2, 0.5), GLC_Point3d(0.7, 0.2, 0.6))), "box partly behind the wall is visible");
+	}
+
+	// Instances culled with a triangle budget cutting the wall
+	{
+		GLC_3DViewInstance wallInstance(wallMesh(0.0f));
+		// One box behind each triangle of the wall
+		GLC_3DViewInstance lowerBox(boxMesh(GLC_Point3d(0.5, -0.9, 0.5), GLC_Point3d(0.7, -0.7, 0.6)));
+		GLC_3DViewInstance upperBox(boxMesh(GLC_Point3d(-0.7, 0.7, 0.5), GLC_Point3d(-0.5, 0.9, 0.6)));
+		QList<GLC_3DViewInstance*> instances;
+		instances << &wallInstance << &lowerBox << &upperBox;
+
+		GLC_OcclusionCuller culler(64, 64);
+		culler.setMinimumOccluderSize(0.5);
+		check(culler.cull(instances, GLC_Matrix4x4()) == 2, "both boxes are occluded by the wall");
+		check(culler.occluderCount() == 1, "the wall is the only occluder");
+		check(lowerBox.viewableFlag() == GLC_3DViewInstance::NoViewable, "occluded box is not viewable");
+
+		// Only the first wall triangle, below the diagonal, fits in the budget
+		lowerBox.setViewable(GLC_3DViewInstance::FullViewable);
+		upperBox.setViewable(GLC_3DViewInstance::FullViewable);
+		culler.setOccluderTriangleBudget(1);
+		check(culler.cull(instances, GLC_Matrix4x4()) == 1, "the wall is cut at the triangle budget");
+		check(lowerBox.viewableFlag() == GLC_3DViewInstance::NoViewable, "box behind the rasterized triangle is occluded");
+		check(upperBox.viewableFlag() == GLC_3DViewInstance::FullViewable, "box behind the dropped triangle is visible");
+	}
+
+	// A wireframe wall doesn't hide the boxes behind it
+	{
+		GLC_3DViewInstance wallInstance(wallMesh(0.0f));
+		wallInstance.setPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+		GLC_3DViewInstance box(boxMesh(GLC_Point3d(-0.2, -0.2, 0.5), GLC_Point3d(0.2, 0.2, 0.6)));
+		QList<GLC_3DViewInstance*> instances;
+		instances << &wallInstance << &box;
+
+		GLC_OcclusionCuller culler(64, 64);
+		culler.setMinimumOccluderSize(0.5);
+		check(culler.cull(instances, GLC_Matrix4x4()) == 0, "wireframe wall occludes nothing");
+		check(culler.occluderCount() == 0, "wireframe wall is not an occluder");
+		check(box.viewableFlag() == GLC_3DViewInstance::FullViewable, "box behind the wireframe wall is visible");
+	}
+
+	qDebug() << failureCount << "failure(s)";
+	return (0 == failureCount) ? 0 : 1;
+}
@@ -0,0 +1,169 @@
+/****************************************************************************
+
+ This file is part of the GLC-lib library.
+ Copyright (C) 2005-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ http://glc-lib.sourceforge.net
+
+ GLC-lib is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ GLC-lib is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with GLC-lib; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+
+
+//! Offscreen comparison of instanced and regular rendering
+/*! A grid of boxes sharing one geometry, far from the origin, is rendered in a
+ *  frame buffer object with instancing on and off. The images must match.
+ *  Run it with "-platform offscreen" where no display is available.
+ *  Return 0 on success.*/
+
+#include <QGuiApplication>
+#include <QOffscreenSurface>
+#include <QOpenGLContext>
+#include <QOpenGLFramebufferObject>
+#include <QImage>
+#include <QtDebug>
+
+#include <GLC_Factory>
+#include <GLC_3DViewCollection>
+#include <GLC_3DViewInstance>
+#include <GLC_Viewport>
+#include <GLC_Light>
+#include <GLC_Context>
+#include <GLC_ContextManager>
+#include <GLC_State>
+
+// Size of the rendered image
+static const int imageSize= 256;
+
+// Grid of boxes along x and y
+static const int gridSize= 16;
+
+// Offset of the grid, large enough to lose float precision in world coordinates
+static const double gridOffset= 100000.0;
+
+// Render the given collection with the given instancing usage and return the image
+static QImage renderImage(GLC_3DViewCollection* pCollection, GLC_Viewport* pViewport, GLC_Light* pLight, bool useInstancing)
+{
+	GLC_State::setInstancingUsage(useInstancing);
+
+	QOpenGLFramebufferObject fbo(imageSize, imageSize, QOpenGLFramebufferObject::CombinedDepthStencil);
+	fbo.bind();
+
+	GLC_Context* pContext= GLC_ContextManager::instance()->currentContext();
+	pContext->useDefaultShader();
+
+	pViewport->setDistMinAndMax(pCollection->boundingBox());
+	pCollection->updateInstanceViewableState();
+	pViewport->clearBackground();
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+	pContext->glcLoadIdentity();
+	pLight->glExecute();
+	pViewport->glExecuteCam();
+
+	pCollection->render(0, glc::ShadingFlag);
+	glFinish();
+
+	pContext->unuseDefaultShader();
+	fbo.release();
+
+	return fbo.toImage();
+}
+
+// Return the number of pixels of the given images which differ by more than the given tolerance
+static int differentPixelCount(const QImage& image1, const QImage& image2, int tolerance)
+{
+	int count= 0;
+	for (int y= 0; y < image1.height(); ++y)
+	{
+		for (int x= 0; x < image1.width(); ++x)
+		{
+			const QRgb pixel1= image1.pixel(x, y);
+			const QRgb pixel2= image2.pixel(x, y);
+			if ((qAbs(qRed(pixel1) - qRed(pixel2)) > tolerance) || (qAbs(qGreen(pixel1) - qGreen(pixel2)) > tolerance)
+					|| (qAbs(qBlue(pixel1) - qBlue(pixel2)) > tolerance))
+			{
+				++count;
+			}
+		}
+	}
+	return count;
+}
+
+int main(int argc, char** argv)
+{
+	QGuiApplication app(argc, argv);
+
+	QSurfaceFormat format;
+	format.setDepthBufferSize(24);
+	QOffscreenSurface surface;
+	surface.setFormat(format);
+	surface.create();
+	QOpenGLContext context;
+	context.setFormat(format);
+	if (!context.create() || !context.makeCurrent(&surface))
+	{
+		qDebug() << "Unable to create an OpenGL context";
+		return 1;
+	}
+
+	// Initialize the GLC_lib state of the context
+	GLC_ContextManager::instance()->currentContext();
+	GLC_State::setVboUsage(true);
+
+	// Boxes sharing one geometry
+	const GLC_3DRep box(GLC_Factory::instance()->createBox(0.8, 0.8, 0.8));
+	GLC_3DViewCollection collection;
+	for (int i= 0; i < gridSize; ++i)
+	{
+		for (int j= 0; j < gridSize; ++j)
+		{
+			GLC_3DViewInstance instance(box);
+			instance.translate(gridOffset + i, gridOffset + j, 0.0);
+			collection.add(instance);
+		}
+	}
+
+	GLC_Viewport viewport;
+	viewport.initGl();
+	viewport.setWinGLSize(imageSize, imageSize);
+	viewport.setBackgroundColor(Qt::black);
+	viewport.cameraHandle()->setEyeCam(GLC_Point3d(gridOffset, gridOffset - gridSize, gridSize));
+	viewport.reframe(collection.boundingBox());
+
+	GLC_Light light(GLC_Light::LightPosition, GL_LIGHT0);
+
+	const QImage regularImage(renderImage(&collection, &viewport, &light, false));
+	const QImage instancedImage(renderImage(&collection, &viewport, &light, true));
+
+	if (!GLC_State::isInstancingActivated())
+	{
+		qDebug() << "Instancing is not supported, nothing to compare";
+		return 0;
+	}
+
+	// Instances are transformed in float by the shader, a few edge pixels may differ
+	const int pixelCount= imageSize * imageSize;
+	const int differentCount= differentPixelCount(regularImage, instancedImage, 8);
+	qDebug() << differentCount << "different pixel(s) on" << pixelCount;
+	if (differentCount > (pixelCount / 1000))
+	{
+		regularImage.save("example16_regular.png");
+		instancedImage.save("example16_instanced.png");
+		qDebug() << "FAIL images saved in example16_regular.png and example16_instanced.png";
+		return 1;
+	}
+
+	qDebug() << "PASS";
+	return 0;
+}
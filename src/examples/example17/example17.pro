@@ -0,0 +1,21 @@
+TARGET = example17
+TEMPLATE = app
+QT += opengl
+CONFIG += console warn_on
+CONFIG -= app_bundle
+
+OBJECTS_DIR = ./Build
+MOC_DIR = ./Build
+UI_DIR = ./Build
+RCC_DIR = ./Build
+
+include(../../../glc_lib.pri)
+
+
+# Input
+SOURCES += main.cpp
+
+include(../../../install.pri)
+
+target.path = $${GLC_LIB_DIR}/examples
+INSTALLS += target
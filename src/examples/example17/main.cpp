@@ -0,0 +1,154 @@
+/****************************************************************************
+
+ This file is part of the GLC-lib library.
+ Copyright (C) 2005-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ http://glc-lib.sourceforge.net
+
+ GLC-lib is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ GLC-lib is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with GLC-lib; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+
+
+//! Microbenchmark of the 3DXML number scanning
+/*! Compare the former QTextStream token reading with glcTextScanner on
+ *  generated vertex and index buffers. Check that both read the same values,
+ *  malformed numbers included. Return 0 on success.*/
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <QStringList>
+#include <QtDebug>
+
+#include <glcTextScanner>
+
+// Number of values of the generated buffers
+static const int valueCount= 3000000;
+
+// Number of runs of each reader, the best time is kept
+static const int runCount= 5;
+
+// Read the floats of the given text as the 3DXML loader used to
+static GLfloatVector streamFloats(const QString& data)
+{
+	QString text(data);
+	text.replace(',', ' ');
+	QTextStream stream(&text);
+	QList<GLfloat> values;
+	QString buff;
+	while ((!stream.atEnd()))
+	{
+		stream >> buff;
+		values.append(buff.toFloat());
+	}
+	return values.toVector();
+}
+
+// Read the indexes of the given text as the 3DXML loader used to
+static IndexList streamIndexes(const QString& data)
+{
+	QString text(data);
+	text.remove(',');
+	QTextStream stream(&text);
+	IndexList values;
+	QString buff;
+	while ((!stream.atEnd()))
+	{
+		stream >> buff;
+		values.append(buff.toUInt());
+	}
+	return values;
+}
+
+static GLfloatVector scanFloats(const QString& text)
+{
+	GLfloatVector values;
+	glcTextScanner::appendFloats(text, &values);
+	return values;
+}
+
+static IndexList scanIndexes(const QString& text)
+{
+	IndexList values;
+	glcTextScanner::appendIndexes(text, &values);
+	return values;
+}
+
+// Return the best time in ms of the given reader
+template <typename Container>
+static qint64 bestTime(Container (*pReader)(const QString&), const QString& text, Container* pResult)
+{
+	qint64 best= -1;
+	for (int i= 0; i < runCount; ++i)
+	{
+		QElapsedTimer timer;
+		timer.start();
+		*pResult= pReader(text);
+		const qint64 elapsed= timer.elapsed();
+		if ((best < 0) || (elapsed < best)) best= elapsed;
+	}
+	return best;
+}
+
+static int failureCount= 0;
+
+static void check(bool condition, const char* pMessage)
+{
+	qDebug() << (condition ? "PASS" : "FAIL") << pMessage;
+	if (!condition) ++failureCount;
+}
+
+int main(int argc, char** argv)
+{
+	QCoreApplication app(argc, argv);
+
+	// Generated buffers, formatted like 3DXML vertex buffers and faces
+	QString positions;
+	QString indexes;
+	positions.reserve(valueCount * 12);
+	indexes.reserve(valueCount * 8);
+	for (int i= 0; i < valueCount; ++i)
+	{
+		positions+= QString::number((i % 2000) * 0.125 - 100.0, 'g', 7);
+		positions+= ((i % 3) == 2) ? QLatin1Char(',') : QLatin1Char(' ');
+		indexes+= QString::number(i % 65536);
+		indexes+= QLatin1Char(' ');
+	}
+	// A trailing separator was read as an extra 0 by QTextStream
+	positions.chop(1);
+	indexes.chop(1);
+
+	GLfloatVector streamedFloats, scannedFloats;
+	IndexList streamedIndexes, scannedIndexes;
+	const qint64 streamFloatTime= bestTime(streamFloats, positions, &streamedFloats);
+	const qint64 scanFloatTime= bestTime(scanFloats, positions, &scannedFloats);
+	const qint64 streamIndexTime= bestTime(streamIndexes, indexes, &streamedIndexes);
+	const qint64 scanIndexTime= bestTime(scanIndexes, indexes, &scannedIndexes);
+
+	qDebug() << valueCount << "floats  : QTextStream" << streamFloatTime << "ms, glcTextScanner" << scanFloatTime << "ms";
+	qDebug() << valueCount << "indexes : QTextStream" << streamIndexTime << "ms, glcTextScanner" << scanIndexTime << "ms";
+
+	check(streamedFloats == scannedFloats, "floats are read as before");
+	check(streamedIndexes == scannedIndexes, "indexes are read as before");
+
+	// Malformed numbers are read as 0 as before
+	const QString malformedFloats("1.5 abc 2e 3.25 -0x1");
+	check(streamFloats(malformedFloats) == scanFloats(malformedFloats), "malformed floats are read as 0");
+	const QString malformedIndexes("1 -2 3x 4 99999999999");
+	check(streamIndexes(malformedIndexes) == scanIndexes(malformedIndexes), "malformed indexes are read as 0");
+
+	qDebug() << failureCount << "failure(s)";
+	return (0 == failureCount) ? 0 : 1;
+}
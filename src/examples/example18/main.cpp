@@ -0,0 +1,169 @@
+/****************************************************************************
+
+ This file is part of the GLC-lib library.
+ Copyright (C) 2005-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ http://glc-lib.sourceforge.net
+
+ GLC-lib is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ GLC-lib is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with GLC-lib; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+
+
+//! Benchmark of the BVH against the octree space partitioning
+/*! A scene of instances sharing one box geometry is partitioned by GLC_Octree
+ *  and GLC_Bvh. Build, box query and frustum update times are compared, and
+ *  BVH results are checked against a brute force search. No OpenGL context is
+ *  needed. Pass the instance count as argument, 100000 by default.
+ *  Return 0 on success.*/
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QSet>
+#include <QtDebug>
+
+#include <GLC_Factory>
+#include <GLC_3DViewCollection>
+#include <GLC_3DViewInstance>
+#include <GLC_Octree>
+#include <GLC_Bvh>
+#include <GLC_Frustum>
+
+// Size of the scene cube
+static const double sceneSize= 1000.0;
+
+// Number of box queries and frustum updates
+static const int queryCount= 200;
+
+// Deterministic pseudo random number in [0, 1)
+static double nextRandom(quint32* pSeed)
+{
+	*pSeed= (*pSeed * 1664525u) + 1013904223u;
+	return static_cast<double>(*pSeed >> 8) / static_cast<double>(1 << 24);
+}
+
+// Return the frustum of a camera at the given position looking at the scene center
+static GLC_Frustum cameraFrustum(const GLC_Point3d& eye)
+{
+	const GLC_Point3d target(sceneSize / 2.0, sceneSize / 2.0, sceneSize / 2.0);
+	const GLC_Vector3d forward((target - eye).normalize());
+	const GLC_Vector3d side((forward ^ GLC_Vector3d(0.0, 0.0, 1.0)).normalize());
+	const GLC_Vector3d up(side ^ forward);
+	double view[16]= {side.x(), up.x(), -forward.x(), 0.0
+					, side.y(), up.y(), -forward.y(), 0.0
+					, side.z(), up.z(), -forward.z(), 0.0
+					, 0.0, 0.0, 0.0, 1.0};
+	const GLC_Matrix4x4 viewMatrix(GLC_Matrix4x4(view) * GLC_Matrix4x4(-eye.x(), -eye.y(), -eye.z()));
+	const GLC_Matrix4x4 projectionMatrix(GLC_Matrix4x4::frustumMatrix(-0.3, 0.3, -0.3, 0.3, 1.0, 4.0 * sceneSize));
+
+	GLC_Frustum frustum;
+	frustum.update(projectionMatrix * viewMatrix);
+	return frustum;
+}
+
+static int failureCount= 0;
+
+static void check(bool condition, const char* pMessage)
+{
+	qDebug() << (condition ? "PASS" : "FAIL") << pMessage;
+	if (!condition) ++failureCount;
+}
+
+int main(int argc, char** argv)
+{
+	QCoreApplication app(argc, argv);
+	const int instanceCount= (argc > 1) ? qMax(1, QString(argv[1]).toInt()) : 100000;
+
+	// Randomly placed boxes sharing one geometry
+	quint32 seed= 12345;
+	const GLC_3DRep box(GLC_Factory::instance()->createBox(1.0, 1.0, 1.0));
+	GLC_3DViewCollection collection;
+	for (int i= 0; i < instanceCount; ++i)
+	{
+		GLC_3DViewInstance instance(box);
+		instance.translate(nextRandom(&seed) * sceneSize, nextRandom(&seed) * sceneSize, nextRandom(&seed) * sceneSize);
+		collection.add(instance);
+	}
+	const QList<GLC_3DViewInstance*> instances(collection.instancesHandle());
+
+	// Query boxes and frustums
+	QList<GLC_BoundingBox> queryBoxes;
+	QList<GLC_Frustum> frustums;
+	for (int i= 0; i < queryCount; ++i)
+	{
+		const GLC_Point3d lower(nextRandom(&seed) * sceneSize, nextRandom(&seed) * sceneSize, nextRandom(&seed) * sceneSize);
+		const double size= nextRandom(&seed) * sceneSize / 10.0;
+		queryBoxes.append(GLC_BoundingBox(lower, lower + GLC_Vector3d(size, size, size)));
+		const double angle= (2.0 * glc::PI * i) / queryCount;
+		frustums.append(cameraFrustum(GLC_Point3d(sceneSize / 2.0 + 1.5 * sceneSize * cos(angle), sceneSize / 2.0 + 1.5 * sceneSize * sin(angle), sceneSize)));
+	}
+
+	GLC_Octree octree(&collection);
+	GLC_Bvh bvh(&collection);
+	GLC_SpacePartitioning* partitionings[2]= {&octree, &bvh};
+	const char* names[2]= {"Octree", "BVH"};
+	QList<GLC_3DViewInstance*> lastQueryResults[2];
+	for (int p= 0; p < 2; ++p)
+	{
+		GLC_SpacePartitioning* pPartitioning= partitionings[p];
+		QElapsedTimer timer;
+		timer.start();
+		pPartitioning->updateSpacePartitioning();
+		const qint64 buildTime= timer.elapsed();
+
+		timer.restart();
+		int foundCount= 0;
+		for (int i= 0; i < queryCount; ++i)
+		{
+			lastQueryResults[p]= pPartitioning->listOfIntersectedInstances(queryBoxes.at(i));
+			foundCount+= lastQueryResults[p].size();
+		}
+		const qint64 queryTime= timer.elapsed();
+
+		timer.restart();
+		for (int i= 0; i < queryCount; ++i)
+		{
+			pPartitioning->updateViewableInstances(frustums.at(i));
+		}
+		const qint64 frustumTime= timer.elapsed();
+
+		qDebug() << names[p] << ":" << instanceCount << "instances, build" << buildTime << "ms,"
+				 << queryCount << "box queries" << queryTime << "ms (" << foundCount << "found),"
+				 << queryCount << "frustum updates" << frustumTime << "ms";
+	}
+
+	// The BVH finds exactly the intersected instances
+	QSet<GLC_3DViewInstance*> expected;
+	for (int i= 0; i < instanceCount; ++i)
+	{
+		if (instances.at(i)->boundingBox().intersect(queryBoxes.last())) expected.insert(instances.at(i));
+	}
+	check(QSet<GLC_3DViewInstance*>(lastQueryResults[1].begin(), lastQueryResults[1].end()) == expected, "BVH box query finds the intersected instances");
+
+	// The BVH doesn't cull instances of the last frustum
+	int wronglyCulledCount= 0;
+	for (int i= 0; i < instanceCount; ++i)
+	{
+		GLC_3DViewInstance* pInstance= instances.at(i);
+		if ((frustums.last().localizeBoundingBox(pInstance->boundingBox()) != GLC_Frustum::OutFrustum)
+				&& (pInstance->viewableFlag() == GLC_3DViewInstance::NoViewable))
+		{
+			++wronglyCulledCount;
+		}
+	}
+	check(0 == wronglyCulledCount, "BVH keeps the instances in the frustum viewable");
+
+	qDebug() << failureCount << "failure(s)";
+	return (0 == failureCount) ? 0 : 1;
+}
@@ -0,0 +1,152 @@
+/****************************************************************************
+
+ This file is part of the GLC-lib library.
+ Copyright (C) 2005-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ http://glc-lib.sourceforge.net
+
+ GLC-lib is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ GLC-lib is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with GLC-lib; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+
+
+//! Benchmark of the vertex cache optimization of mesh triangles
+/*! Grid meshes, in row order and with shuffled triangles, are reordered by
+ *  GLC_VertexCacheOptimizer. The average cache miss ratio (ACMR) before and
+ *  after, and the optimization time, are reported for several cache sizes.
+ *  Reordered triangles must be the same triangles with the same winding.
+ *  Return 0 on success.*/
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QtDebug>
+
+#include <algorithm>
+
+#include <GLC_VertexCacheOptimizer>
+
+// Deterministic pseudo random number in [0, max)
+static int nextRandom(quint32* pSeed, int max)
+{
+	*pSeed= (*pSeed * 1664525u) + 1013904223u;
+	return static_cast<int>((static_cast<quint64>(*pSeed >> 8) * max) >> 24);
+}
+
+// Fill the positions and the triangles in row order of a grid of the given size
+static void createGrid(int size, GLfloatVector* pPositions, IndexList* pTriangles)
+{
+	for (int y= 0; y <= size; ++y)
+	{
+		for (int x= 0; x <= size; ++x)
+		{
+			*pPositions << static_cast<GLfloat>(x) << static_cast<GLfloat>(y) << 0.0f;
+		}
+	}
+	for (int y= 0; y < size; ++y)
+	{
+		for (int x= 0; x < size; ++x)
+		{
+			const GLuint corner= y * (size + 1) + x;
+			*pTriangles << corner << corner + 1 << corner + size + 2;
+			*pTriangles << corner << corner + size + 2 << corner + size + 1;
+		}
+	}
+}
+
+// Return the given triangles in random order
+static IndexList shuffledTriangles(const IndexList& triangles)
+{
+	quint32 seed= 12345;
+	IndexList subject(triangles);
+	for (int i= subject.size() / 3 - 1; i > 0; --i)
+	{
+		const int j= nextRandom(&seed, i + 1);
+		for (int k= 0; k < 3; ++k)
+		{
+			subject.swapItemsAt(i * 3 + k, j * 3 + k);
+		}
+	}
+	return subject;
+}
+
+// Return the sorted triangles of the given index, each one starting with its smallest index
+static QList<QList<GLuint> > canonicalTriangles(const IndexList& triangles)
+{
+	QList<QList<GLuint> > subject;
+	for (int i= 0; i < triangles.size(); i+= 3)
+	{
+		QList<GLuint> triangle;
+		triangle << triangles.at(i) << triangles.at(i + 1) << triangles.at(i + 2);
+		while ((triangle.at(0) > triangle.at(1)) || (triangle.at(0) > triangle.at(2)))
+		{
+			triangle.append(triangle.takeFirst());
+		}
+		subject.append(triangle);
+	}
+	std::sort(subject.begin(), subject.end());
+	return subject;
+}
+
+static int failureCount= 0;
+
+static void check(bool condition, const QString& message)
+{
+	qDebug() << (condition ? "PASS" : "FAIL") << qPrintable(message);
+	if (!condition) ++failureCount;
+}
+
+int main(int argc, char** argv)
+{
+	QCoreApplication app(argc, argv);
+
+	const int gridSizes[]= {32, 256};
+	const int cacheSizes[]= {16, 32};
+	for (int g= 0; g < 2; ++g)
+	{
+		GLfloatVector positions;
+		IndexList rowTriangles;
+		createGrid(gridSizes[g], &positions, &rowTriangles);
+		const IndexList randomTriangles(shuffledTriangles(rowTriangles));
+		const int vertexCount= positions.size() / 3;
+
+		for (int c= 0; c < 2; ++c)
+		{
+			for (int order= 0; order < 2; ++order)
+			{
+				const IndexList& triangles= (0 == order) ? rowTriangles : randomTriangles;
+				const QString name(QString("grid %1x%1, %2 order, cache %3").arg(gridSizes[g]).arg((0 == order) ? "row" : "random").arg(cacheSizes[c]));
+
+				GLC_VertexCacheOptimizer optimizer(vertexCount, cacheSizes[c]);
+				QElapsedTimer timer;
+				timer.start();
+				const IndexList optimized(optimizer.optimize(triangles, positions));
+				const qint64 elapsed= timer.elapsed();
+
+				qDebug() << qPrintable(name) << ":" << triangles.size() / 3 << "triangles, ACMR"
+						 << optimizer.acmrBefore() << "->" << optimizer.acmrAfter() << "in" << elapsed << "ms";
+
+				check(canonicalTriangles(optimized) == canonicalTriangles(triangles), name + " keeps the triangles");
+				check(qAbs(GLC_VertexCacheOptimizer::acmr(optimized, cacheSizes[c]) - optimizer.acmrAfter()) < 1e-9, name + " reports the ACMR of its result");
+				check(optimizer.acmrAfter() <= optimizer.acmrBefore(), name + " doesn't increase the ACMR");
+				if (1 == order)
+				{
+					check(optimizer.acmrAfter() < optimizer.acmrBefore(), name + " decreases the ACMR");
+				}
+			}
+		}
+	}
+
+	qDebug() << failureCount << "failure(s)";
+	return (0 == failureCount) ? 0 : 1;
+}
@@ -13,5 +13,10 @@ SUBDIRS += \
     example11 \
     example12 \
     example13 \
-    example14
+    example14 \
+    example15 \
+    example16 \
+    example17 \
+    example18 \
+    example19
 
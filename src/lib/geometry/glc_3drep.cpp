@@ -463,18 +463,20 @@ void GLC_3DRep::clear3DRepGeom()
     *m_pIsLoaded= false;
 }
 
-// Non Member methods
-QDataStream &operator<<(QDataStream & stream, const GLC_3DRep & rep)
+//////////////////////////////////////////////////////////////////////
+// Binary serialisation Functions
+//////////////////////////////////////////////////////////////////////
+void GLC_3DRep::saveToDataStream(QDataStream& stream, bool withMeshData) const
 {
-	quint32 chunckId= GLC_3DRep::m_ChunkId;
+	quint32 chunckId= m_ChunkId;
 	stream << chunckId;
 
 	// The representation name
-	stream << rep.name();
+	stream << name();
 
 	// Save the list of 3DRep materials
 	QList<GLC_Material> materialsList;
-    QList<GLC_Material*> sourceMaterialsList= rep.materialSet().values();
+    QList<GLC_Material*> sourceMaterialsList= materialSet().values();
 	const int materialNumber= sourceMaterialsList.size();
 	for (int i= 0; i < materialNumber; ++i)
 	{
@@ -485,32 +487,30 @@ QDataStream &operator<<(QDataStream & stream, const GLC_3DRep & rep)
 	stream << materialsList;
 
 	// Save the list of mesh
-	const int meshNumber= rep.m_pGeomList->size();
+	const int meshNumber= m_pGeomList->size();
 	stream << meshNumber;
 	for (int i= 0; i < meshNumber; ++i)
 	{
-		GLC_Mesh* pMesh= dynamic_cast<GLC_Mesh*>(rep.m_pGeomList->at(i));
+		GLC_Mesh* pMesh= dynamic_cast<GLC_Mesh*>(m_pGeomList->at(i));
 		if (NULL != pMesh)
 		{
-			pMesh->saveToDataStream(stream);
+			pMesh->saveToDataStream(stream, withMeshData);
 		}
 	}
-
-	return stream;
 }
 
-QDataStream &operator>>(QDataStream & stream, GLC_3DRep & rep)
+void GLC_3DRep::loadFromDataStream(QDataStream& stream, bool withMeshData)
 {
-	Q_ASSERT(rep.isEmpty());
+	Q_ASSERT(isEmpty());
 
 	quint32 chunckId;
 	stream >> chunckId;
-	Q_ASSERT(chunckId == GLC_3DRep::m_ChunkId);
+	Q_ASSERT(chunckId == m_ChunkId);
 
 	// The rep name
-	QString name;
-	stream >> name;
-	rep.setName(name);
+	QString repName;
+	stream >> repName;
+	setName(repName);
 
 	// Retrieve the list of rep materials
 	QList<GLC_Material> materialsList;
@@ -532,10 +532,23 @@ QDataStream &operator>>(QDataStream & stream, GLC_3DRep & rep)
 	for (int i= 0; i < meshNumber; ++i)
 	{
 		GLC_Mesh* pMesh= new GLC_Mesh();
-		pMesh->loadFromDataStream(stream, materialHash, materialIdMap);
+		pMesh->loadFromDataStream(stream, materialHash, materialIdMap, withMeshData);
 
-		rep.addGeom(pMesh);
+		addGeom(pMesh);
 	}
+}
+
+// Non Member methods
+QDataStream &operator<<(QDataStream & stream, const GLC_3DRep & rep)
+{
+	rep.saveToDataStream(stream);
+
+	return stream;
+}
+
+QDataStream &operator>>(QDataStream & stream, GLC_3DRep & rep)
+{
+	rep.loadFromDataStream(stream);
 
 	return stream;
 }
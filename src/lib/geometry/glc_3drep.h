@@ -184,6 +184,21 @@ public:
 
 //@}
 
+//////////////////////////////////////////////////////////////////////
+/*! \name Binary serialisation Functions*/
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Save the representation to binary data stream
+	/*! If withMeshData is false, mesh vertex attributes and index are not saved*/
+	void saveToDataStream(QDataStream&, bool withMeshData= true) const;
+
+	//! Load the representation from binary data stream
+	/*! If withMeshData is false, only the LOD layout of the meshes is loaded*/
+	void loadFromDataStream(QDataStream&, bool withMeshData= true);
+
+//@}
+
 //////////////////////////////////////////////////////////////////////
 // private services functions
 //////////////////////////////////////////////////////////////////////
@@ -21,7 +21,15 @@
  *****************************************************************************/
 //! \file glc_bsrep.cpp implementation for the GLC_BSRep class.
 
+#include <QBuffer>
+#include <QSharedPointer>
+#include <QtEndian>
+
+#include <cstring>
+#include <limits>
+
 #include "glc_bsrep.h"
+#include "glc_mesh.h"
 #include "../glc_fileformatexception.h"
 #include "../glc_tracelog.h"
 
@@ -32,11 +40,354 @@ const QString GLC_BSRep::m_Suffix("BSRep");
 const QUuid GLC_BSRep::m_Uuid("{d6f97789-36a9-4c2e-b667-0e66c27f839f}");
 
 // The binary rep version
-const quint32 GLC_BSRep::m_Version= 103;
+const quint32 GLC_BSRep::m_Version= 105;
 
 // Mutex used by compression
 QMutex GLC_BSRep::m_CompressionMutex;
 
+// The first version of the sectioned binary rep
+static const quint32 sectionedVersion= 104;
+
+// The alignment of sections in the file
+static const qint64 sectionAlignment= 16;
+
+// Sections smaller than this size are not compressed
+static const int sectionCompressionThreshold= 4096;
+
+// The size of a section table entry
+static const qint64 sectionEntrySize= 4 * sizeof(quint32) + 3 * sizeof(qint64);
+
+//! Section types of the sectioned binary rep
+enum BSRepSectionType
+{
+	BSRepSkeletonSection= 1,
+	BSRepPositionSection,
+	BSRepNormalSection,
+	BSRepTexelSection,
+	BSRepColorSection,
+	BSRepIndexSection,
+	BSRepQuantizedPositionSection,
+	BSRepOctahedralNormal8Section,
+	BSRepOctahedralNormal16Section,
+	BSRepHalfFloatTexelSection,
+	BSRepShortIndexSection
+};
+
+// The size of the offset and scale header of a quantized position section
+static const int quantizedPositionHeaderSize= 6 * sizeof(quint32);
+
+//! A section of the sectioned binary rep
+class BSRepSection
+{
+public:
+	BSRepSection(quint32 type= 0, qint32 meshIndex= -1, qint32 lodIndex= -1)
+	: m_Type(type)
+	, m_MeshIndex(meshIndex)
+	, m_LodIndex(lodIndex)
+	, m_Offset(0)
+	, m_Size(0)
+	, m_RawSize(0)
+	, m_IsCompressed(false)
+	{}
+
+	//! The section type
+	quint32 m_Type;
+
+	//! The index of the mesh in the representation
+	qint32 m_MeshIndex;
+
+	//! The LOD index of index section
+	qint32 m_LodIndex;
+
+	//! The section offset in the file
+	qint64 m_Offset;
+
+	//! The section size in the file
+	qint64 m_Size;
+
+	//! The uncompressed section size
+	qint64 m_RawSize;
+
+	//! True if the section is compressed
+	bool m_IsCompressed;
+};
+
+static QDataStream &operator<<(QDataStream &stream, const BSRepSection &section)
+{
+	stream << section.m_Type << section.m_MeshIndex << section.m_LodIndex;
+	stream << section.m_Offset << section.m_Size << section.m_RawSize;
+	stream << static_cast<quint32>(section.m_IsCompressed);
+
+	return stream;
+}
+
+static QDataStream &operator>>(QDataStream &stream, BSRepSection &section)
+{
+	quint32 isCompressed;
+	stream >> section.m_Type >> section.m_MeshIndex >> section.m_LodIndex;
+	stream >> section.m_Offset >> section.m_Size >> section.m_RawSize;
+	stream >> isCompressed;
+	section.m_IsCompressed= (isCompressed != 0);
+
+	return stream;
+}
+
+// Copy 32 bits words from or to little endian byte order
+static void copyLittleEndianWords(void* pTarget, const void* pSource, int wordCount)
+{
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+	memcpy(pTarget, pSource, wordCount * sizeof(quint32));
+#else
+	const uchar* pSourceBytes= static_cast<const uchar*>(pSource);
+	quint32* pTargetWords= static_cast<quint32*>(pTarget);
+	for (int i= 0; i < wordCount; ++i)
+	{
+		pTargetWords[i]= qFromLittleEndian<quint32>(pSourceBytes + i * sizeof(quint32));
+	}
+#endif
+}
+
+// Copy 16 bits words from or to little endian byte order
+static void copyLittleEndianHalfWords(void* pTarget, const void* pSource, int halfWordCount)
+{
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+	memcpy(pTarget, pSource, halfWordCount * sizeof(quint16));
+#else
+	const uchar* pSourceBytes= static_cast<const uchar*>(pSource);
+	quint16* pTargetHalfWords= static_cast<quint16*>(pTarget);
+	for (int i= 0; i < halfWordCount; ++i)
+	{
+		pTargetHalfWords[i]= qFromLittleEndian<quint16>(pSourceBytes + i * sizeof(quint16));
+	}
+#endif
+}
+
+// Read the uncompressed content of the given section
+/*! If the file is mapped and the section is not compressed, the content refers to the mapped data*/
+static bool readSection(QFile* pFile, const uchar* pMap, const BSRepSection& section, QByteArray* pContent)
+{
+	if (NULL != pMap)
+	{
+		if (section.m_IsCompressed)
+		{
+			*pContent= qUncompress(pMap + section.m_Offset, static_cast<int>(section.m_Size));
+		}
+		else
+		{
+			*pContent= QByteArray::fromRawData(reinterpret_cast<const char*>(pMap + section.m_Offset), static_cast<int>(section.m_Size));
+		}
+	}
+	else if (pFile->seek(section.m_Offset))
+	{
+		*pContent= pFile->read(section.m_Size);
+		if (section.m_IsCompressed)
+		{
+			*pContent= qUncompress(*pContent);
+		}
+	}
+
+	return pContent->size() == section.m_RawSize;
+}
+
+// Read the given section into a vector of 32 bits words
+template <typename T>
+static bool readSectionWords(QFile* pFile, const uchar* pMap, const BSRepSection& section, QVector<T>* pVector)
+{
+	QByteArray content;
+	const bool readOk= readSection(pFile, pMap, section, &content) && ((content.size() % sizeof(T)) == 0);
+	if (readOk)
+	{
+		pVector->resize(content.size() / sizeof(T));
+		copyLittleEndianWords(pVector->data(), content.constData(), pVector->size());
+	}
+
+	return readOk;
+}
+
+// Read the given section into a vector of 16 bits words
+static bool readSectionHalfWords(QFile* pFile, const uchar* pMap, const BSRepSection& section, QVector<GLushort>* pVector)
+{
+	QByteArray content;
+	const bool readOk= readSection(pFile, pMap, section, &content) && ((content.size() % sizeof(GLushort)) == 0);
+	if (readOk)
+	{
+		pVector->resize(content.size() / sizeof(GLushort));
+		copyLittleEndianHalfWords(pVector->data(), content.constData(), pVector->size());
+	}
+
+	return readOk;
+}
+
+// Read the given index section, 16 bits index are converted to 32 bits
+static bool readIndexSection(QFile* pFile, const uchar* pMap, const BSRepSection& section, QVector<GLuint>* pIndexVector)
+{
+	bool readOk= false;
+	if (section.m_Type == BSRepShortIndexSection)
+	{
+		QVector<GLushort> shortIndex;
+		readOk= readSectionHalfWords(pFile, pMap, section, &shortIndex);
+		*pIndexVector= GLC_VertexCompression::longIndex(shortIndex);
+	}
+	else
+	{
+		readOk= readSectionWords(pFile, pMap, section, pIndexVector);
+	}
+
+	return readOk;
+}
+
+// Read the given vertex attribute section, compressed attributes are decoded
+static bool readAttributeSection(QFile* pFile, const uchar* pMap, const BSRepSection& section, GLfloatVector* pVector)
+{
+	bool readOk= false;
+	if (section.m_Type == BSRepQuantizedPositionSection)
+	{
+		QByteArray content;
+		readOk= readSection(pFile, pMap, section, &content) && (content.size() >= quantizedPositionHeaderSize)
+				&& (((content.size() - quantizedPositionHeaderSize) % (3 * sizeof(GLushort))) == 0);
+		if (readOk)
+		{
+			// The offset and the scale of the positions
+			GLfloat bounds[6];
+			copyLittleEndianWords(bounds, content.constData(), 6);
+
+			QVector<GLushort> quantized((content.size() - quantizedPositionHeaderSize) / sizeof(GLushort));
+			copyLittleEndianHalfWords(quantized.data(), content.constData() + quantizedPositionHeaderSize, quantized.size());
+			*pVector= GLC_VertexCompression::dequantizePositions(quantized, bounds, bounds + 3);
+		}
+	}
+	else if (section.m_Type == BSRepOctahedralNormal8Section)
+	{
+		QByteArray content;
+		readOk= readSection(pFile, pMap, section, &content) && ((content.size() % 2) == 0);
+		if (readOk)
+		{
+			QVector<GLubyte> encoded(content.size());
+			memcpy(encoded.data(), content.constData(), content.size());
+			*pVector= GLC_VertexCompression::decodeNormals8(encoded);
+		}
+	}
+	else if (section.m_Type == BSRepOctahedralNormal16Section)
+	{
+		QVector<GLushort> encoded;
+		readOk= readSectionHalfWords(pFile, pMap, section, &encoded) && ((encoded.size() % 2) == 0);
+		if (readOk)
+		{
+			*pVector= GLC_VertexCompression::decodeNormals16(encoded);
+		}
+	}
+	else if (section.m_Type == BSRepHalfFloatTexelSection)
+	{
+		QVector<GLushort> halfValues;
+		readOk= readSectionHalfWords(pFile, pMap, section, &halfValues);
+		if (readOk)
+		{
+			*pVector= GLC_VertexCompression::decodeHalfFloats(halfValues);
+		}
+	}
+	else
+	{
+		readOk= readSectionWords(pFile, pMap, section, pVector);
+	}
+
+	return readOk;
+}
+
+// Return the raw data of the given compressed mesh section
+static QByteArray compressedMeshSectionData(const GLC_MeshData& meshData, const BSRepSection& section)
+{
+	QByteArray rawData;
+	switch (section.m_Type)
+	{
+	case BSRepQuantizedPositionSection:
+	{
+		GLfloat bounds[6];
+		GLC_VertexCompression::positionBounds(meshData.positionVector(), bounds, bounds + 3);
+		const QVector<GLushort> quantized(GLC_VertexCompression::quantizePositions(meshData.positionVector(), bounds, bounds + 3));
+		rawData.resize(quantizedPositionHeaderSize + quantized.size() * static_cast<int>(sizeof(GLushort)));
+		copyLittleEndianWords(rawData.data(), bounds, 6);
+		copyLittleEndianHalfWords(rawData.data() + quantizedPositionHeaderSize, quantized.constData(), quantized.size());
+		break;
+	}
+	case BSRepOctahedralNormal8Section:
+	{
+		const QVector<GLubyte> encoded(GLC_VertexCompression::encodeNormals8(meshData.normalVector()));
+		rawData= QByteArray(reinterpret_cast<const char*>(encoded.constData()), encoded.size());
+		break;
+	}
+	case BSRepOctahedralNormal16Section:
+	case BSRepHalfFloatTexelSection:
+	case BSRepShortIndexSection:
+	{
+		QVector<GLushort> halfWords;
+		if (section.m_Type == BSRepOctahedralNormal16Section) halfWords= GLC_VertexCompression::encodeNormals16(meshData.normalVector());
+		else if (section.m_Type == BSRepHalfFloatTexelSection) halfWords= GLC_VertexCompression::encodeHalfFloats(meshData.texelVector());
+		else halfWords= GLC_VertexCompression::shortIndex(meshData.indexVector(section.m_LodIndex));
+
+		rawData.resize(halfWords.size() * static_cast<int>(sizeof(GLushort)));
+		copyLittleEndianHalfWords(rawData.data(), halfWords.constData(), halfWords.size());
+		break;
+	}
+	default:
+		Q_ASSERT(false);
+		break;
+	}
+
+	return rawData;
+}
+
+//! Source of a LOD index stored in a sectioned binary rep
+class BSRepIndexSource : public GLC_LodIndexSource
+{
+public:
+	BSRepIndexSource(const QString& fileName, qint64 fileSize, const BSRepSection& section, const QSharedPointer<GLC_BSRepPin>& pin)
+	: m_FileName(fileName)
+	, m_FileSize(fileSize)
+	, m_Section(section)
+	, m_pPin(pin)
+	{}
+
+	virtual QVector<GLuint> loadIndexVector() const
+	{
+		QVector<GLuint> indexVector;
+
+		// The file must not have been replaced since the rep was loaded
+		QFile file(m_FileName);
+		bool loadOk= file.open(QIODevice::ReadOnly) && (file.size() == m_FileSize);
+		if (loadOk)
+		{
+			uchar* pMap= file.map(0, m_FileSize);
+			loadOk= readIndexSection(&file, pMap, m_Section, &indexVector);
+			if (NULL != pMap)
+			{
+				file.unmap(pMap);
+			}
+		}
+
+		if (!loadOk)
+		{
+			QString message(QString("GLC_BSRep::loadIndexVector Unable to load LOD index from ") + m_FileName);
+			GLC_FileFormatException fileFormatException(message, m_FileName, GLC_FileFormatException::WrongFileFormat);
+			throw(fileFormatException);
+		}
+
+		return indexVector;
+	}
+
+private:
+	//! The binary rep file name
+	QString m_FileName;
+
+	//! The binary rep file size when the rep was loaded
+	qint64 m_FileSize;
+
+	//! The index section
+	BSRepSection m_Section;
+
+	//! The pin of the binary rep file until the index is loaded
+	QSharedPointer<GLC_BSRepPin> m_pPin;
+};
+
 // Default constructor
 GLC_BSRep::GLC_BSRep(const QString& fileName, bool useCompression)
 : m_FileInfo()
@@ -44,6 +395,10 @@ GLC_BSRep::GLC_BSRep(const QString& fileName, bool useCompression)
 , m_DataStream()
 , m_UseCompression(useCompression)
 , m_CompressionLevel(-1)
+, m_FileVersion(0)
+, m_LazyLodLoading(true)
+, m_VertexCompression(GLC_VertexCompression::NoCompression)
+, m_pPin()
 {
 	setAbsoluteFileName(fileName);
 	m_DataStream.setVersion(QDataStream::Qt_4_6);
@@ -57,6 +412,10 @@ GLC_BSRep::GLC_BSRep(const GLC_BSRep& binaryRep)
 , m_DataStream()
 , m_UseCompression(binaryRep.m_UseCompression)
 , m_CompressionLevel(binaryRep.m_CompressionLevel)
+, m_FileVersion(0)
+, m_LazyLodLoading(binaryRep.m_LazyLodLoading)
+, m_VertexCompression(binaryRep.m_VertexCompression)
+, m_pPin(binaryRep.m_pPin)
 {
 	m_DataStream.setVersion(QDataStream::Qt_4_6);
 	m_DataStream.setFloatingPointPrecision(binaryRep.m_DataStream.floatingPointPrecision());
@@ -111,22 +470,29 @@ GLC_3DRep GLC_BSRep::loadRep(QFile *pFile)
 			timeStampOk(QDateTime());
 			GLC_BoundingBox boundingBox;
 			m_DataStream >> boundingBox;
-			bool useCompression;
-			m_DataStream >> useCompression;
-			if (useCompression)
+			if (m_FileVersion >= sectionedVersion)
 			{
-				QByteArray CompresseBuffer;
-				m_DataStream >> CompresseBuffer;
-				QByteArray uncompressedBuffer= qUncompress(CompresseBuffer);
-				uncompressedBuffer.squeeze();
-				CompresseBuffer.clear();
-				CompresseBuffer.squeeze();
-				QDataStream bufferStream(uncompressedBuffer);
-				bufferStream >> loadedRep;
+				loadSectionedRep(&loadedRep);
 			}
 			else
 			{
-				m_DataStream >> loadedRep;
+				bool useCompression;
+				m_DataStream >> useCompression;
+				if (useCompression)
+				{
+					QByteArray CompresseBuffer;
+					m_DataStream >> CompresseBuffer;
+					QByteArray uncompressedBuffer= qUncompress(CompresseBuffer);
+					uncompressedBuffer.squeeze();
+					CompresseBuffer.clear();
+					CompresseBuffer.squeeze();
+					QDataStream bufferStream(uncompressedBuffer);
+					bufferStream >> loadedRep;
+				}
+				else
+				{
+					m_DataStream >> loadedRep;
+				}
 			}
 			loadedRep.setFileName(m_FileInfo.filePath());
 
@@ -153,6 +519,8 @@ GLC_3DRep GLC_BSRep::loadRep(QFile *pFile)
 		throw(fileFormatException);
 	}
 
+	// Deferred LOD index keep their own pin on the file
+	m_pPin.clear();
 
 	return loadedRep;
 }
@@ -213,26 +581,84 @@ bool GLC_BSRep::save(const GLC_3DRep& rep)
 		// Representation Bounding Box
 		m_DataStream << rep.boundingBox();
 
-		// Compression usage
+		// The representation without vertex attributes and index
+		QByteArray skeleton;
+		{
+			QBuffer buffer(&skeleton);
+			buffer.open(QIODevice::WriteOnly);
+			QDataStream bufferStream(&buffer);
+			bufferStream.setVersion(QDataStream::Qt_4_6);
+			rep.saveToDataStream(bufferStream, false);
+		}
 
-		if (m_UseCompression && (rep.faceCount() < 1000000))
+		// List the sections of the representation
+		QList<const GLC_Mesh*> meshList;
+		const int bodyCount= rep.numberOfBody();
+		for (int i= 0; i < bodyCount; ++i)
 		{
-			m_DataStream << true;
-			QByteArray uncompressedBuffer;
+			const GLC_Mesh* pMesh= dynamic_cast<const GLC_Mesh*>(rep.geomAt(i));
+			if (NULL != pMesh)
 			{
-				QBuffer buffer(&uncompressedBuffer);
-				buffer.open(QIODevice::WriteOnly);
-				QDataStream bufferStream(&buffer);
-				bufferStream << rep;
+				meshList.append(pMesh);
 			}
-			m_DataStream << qCompress(uncompressedBuffer, m_CompressionLevel);
 		}
-		else
+
+		QList<BSRepSection> sectionList;
+		sectionList.append(BSRepSection(BSRepSkeletonSection));
+		// The section types of the vertex attributes and index
+		const quint32 positionType= m_VertexCompression.testFlag(GLC_VertexCompression::QuantizedPosition) ? BSRepQuantizedPositionSection : BSRepPositionSection;
+		quint32 normalType= BSRepNormalSection;
+		if (m_VertexCompression.testFlag(GLC_VertexCompression::OctahedralNormal16)) normalType= BSRepOctahedralNormal16Section;
+		else if (m_VertexCompression.testFlag(GLC_VertexCompression::OctahedralNormal8)) normalType= BSRepOctahedralNormal8Section;
+		const quint32 texelType= m_VertexCompression.testFlag(GLC_VertexCompression::HalfFloatTexel) ? BSRepHalfFloatTexelSection : BSRepTexelSection;
+
+		const int meshCount= meshList.size();
+		for (int i= 0; i < meshCount; ++i)
+		{
+			const GLC_MeshData& meshData= meshList.at(i)->m_MeshData;
+			if (!meshData.positionVector().isEmpty()) sectionList.append(BSRepSection(positionType, i));
+			if (!meshData.normalVector().isEmpty()) sectionList.append(BSRepSection(normalType, i));
+			if (!meshData.texelVector().isEmpty()) sectionList.append(BSRepSection(texelType, i));
+			if (!meshData.colorVector().isEmpty()) sectionList.append(BSRepSection(BSRepColorSection, i));
+
+			const bool useShortIndex= m_VertexCompression.testFlag(GLC_VertexCompression::ShortIndex)
+					&& ((meshData.positionVector().size() / 3) <= GLC_VertexCompression::shortIndexMaxVertexCount());
+			const quint32 indexType= useShortIndex ? BSRepShortIndexSection : BSRepIndexSection;
+			const int lodCount= meshData.lodCount();
+			for (int lod= 0; lod < lodCount; ++lod)
+			{
+				sectionList.append(BSRepSection(indexType, i, lod));
+			}
+		}
+
+		// Reserve the section table
+		const int sectionCount= sectionList.size();
+		m_DataStream << static_cast<quint32>(sectionCount);
+		const qint64 sectionTableOffset= m_pFile->pos();
+		for (int i= 0; i < sectionCount; ++i)
+		{
+			m_DataStream << sectionList.at(i);
+		}
+
+		// Write the sections
+		for (int i= 0; i < sectionCount; ++i)
+		{
+			BSRepSection& section= sectionList[i];
+			if (section.m_Type == BSRepSkeletonSection)
+			{
+				writeSection(&section, skeleton);
+			}
+			else
+			{
+				writeSection(&section, meshSectionData(meshList.at(section.m_MeshIndex), section));
+			}
+		}
+
+		// Write the section table
+		m_pFile->seek(sectionTableOffset);
+		for (int i= 0; i < sectionCount; ++i)
 		{
-			m_DataStream << false;
-			// Binary representation geometry
-			// Add the rep
-			m_DataStream << rep;
+			m_DataStream << sectionList.at(i);
 		}
 
 		// Flag the file
@@ -334,11 +760,207 @@ bool GLC_BSRep::headerIsOk()
 	// Set the version of the data stream
 	m_DataStream.setVersion(QDataStream::Qt_4_6);
 
+	m_FileVersion= version;
+
 	bool headerOk= (uuid == m_Uuid) && (version <= m_Version) && (version > 101) && writeFinished;
 
 	return headerOk;
 }
 
+// Load the sections of a sectioned binary rep into the given 3DRep
+void GLC_BSRep::loadSectionedRep(GLC_3DRep* pRep)
+{
+	Q_ASSERT(pRep->isEmpty());
+	const qint64 fileSize= m_pFile->size();
+
+	// Read the section table
+	quint32 sectionCount;
+	m_DataStream >> sectionCount;
+	bool loadOk= (m_DataStream.status() == QDataStream::Ok) && (sectionCount > 0) && ((sectionCount * sectionEntrySize) < fileSize);
+
+	QList<BSRepSection> sectionList;
+	for (quint32 i= 0; loadOk && (i < sectionCount); ++i)
+	{
+		BSRepSection section;
+		m_DataStream >> section;
+		loadOk= (m_DataStream.status() == QDataStream::Ok) && (section.m_Offset >= 0) && (section.m_Size >= 0)
+				&& ((section.m_Offset + section.m_Size) <= fileSize)
+				&& (section.m_Size <= std::numeric_limits<int>::max())
+				&& (section.m_RawSize >= 0) && (section.m_RawSize <= std::numeric_limits<int>::max());
+		sectionList.append(section);
+	}
+	loadOk= loadOk && (sectionList.first().m_Type == BSRepSkeletonSection);
+
+	// Uncompressed sections are copied directly from the mapped file
+	uchar* pMap= NULL;
+	if (loadOk)
+	{
+		pMap= m_pFile->map(0, fileSize);
+	}
+
+	// Load the representation without vertex attributes and index
+	if (loadOk)
+	{
+		QByteArray skeleton;
+		loadOk= readSection(m_pFile, pMap, sectionList.first(), &skeleton);
+		if (loadOk)
+		{
+			QDataStream skeletonStream(skeleton);
+			skeletonStream.setVersion(QDataStream::Qt_4_6);
+			pRep->loadFromDataStream(skeletonStream, false);
+			loadOk= (skeletonStream.status() == QDataStream::Ok);
+		}
+	}
+
+	// Load vertex attributes and index
+	const QString fileName(m_pFile->fileName());
+	const int bodyCount= loadOk ? pRep->numberOfBody() : 0;
+	const int sectionListSize= sectionList.size();
+	for (int i= 1; loadOk && (i < sectionListSize); ++i)
+	{
+		const BSRepSection& section= sectionList.at(i);
+		GLC_Mesh* pMesh= NULL;
+		if ((section.m_MeshIndex >= 0) && (section.m_MeshIndex < bodyCount))
+		{
+			pMesh= dynamic_cast<GLC_Mesh*>(pRep->geomAt(section.m_MeshIndex));
+		}
+		loadOk= (NULL != pMesh);
+		if (!loadOk) break;
+
+		GLC_MeshData* pMeshData= &(pMesh->m_MeshData);
+		if ((section.m_Type == BSRepIndexSection) || (section.m_Type == BSRepShortIndexSection))
+		{
+			GLC_Lod* pLod= pMeshData->getLod(section.m_LodIndex);
+			loadOk= (NULL != pLod);
+			if (loadOk && m_LazyLodLoading && (section.m_LodIndex > 0))
+			{
+				pLod->setIndexSource(QSharedPointer<GLC_LodIndexSource>(new BSRepIndexSource(fileName, fileSize, section, m_pPin)));
+			}
+			else if (loadOk)
+			{
+				loadOk= readIndexSection(m_pFile, pMap, section, pLod->indexVectorHandle());
+			}
+		}
+		else
+		{
+			GLfloatVector* pVector= NULL;
+			switch (section.m_Type)
+			{
+			case BSRepPositionSection:
+			case BSRepQuantizedPositionSection:
+				pVector= pMeshData->positionVectorHandle();
+				break;
+			case BSRepNormalSection:
+			case BSRepOctahedralNormal8Section:
+			case BSRepOctahedralNormal16Section:
+				pVector= pMeshData->normalVectorHandle();
+				break;
+			case BSRepTexelSection:
+			case BSRepHalfFloatTexelSection:
+				pVector= pMeshData->texelVectorHandle();
+				break;
+			case BSRepColorSection:
+				pVector= pMeshData->colorVectorHandle();
+				break;
+			default:
+				break;
+			}
+
+			loadOk= (NULL != pVector) && readAttributeSection(m_pFile, pMap, section, pVector);
+		}
+	}
+
+	if (NULL != pMap)
+	{
+		m_pFile->unmap(pMap);
+	}
+
+	if (!loadOk)
+	{
+		QString message(QString("GLC_BSRep::loadRep Corrupted sections in file ") + m_FileInfo.fileName());
+		GLC_FileFormatException fileFormatException(message, m_FileInfo.fileName(), GLC_FileFormatException::WrongFileFormat);
+		close();
+		throw(fileFormatException);
+	}
+}
+
+// Write the given section data aligned and compressed if needed
+void GLC_BSRep::writeSection(BSRepSection* pSection, const QByteArray& rawData)
+{
+	Q_ASSERT(m_pFile != NULL);
+
+	// Align the section
+	const qint64 padding= (sectionAlignment - (m_pFile->pos() % sectionAlignment)) % sectionAlignment;
+	bool writeOk= (padding == 0) || (m_pFile->write(QByteArray(static_cast<int>(padding), '\0')) == padding);
+
+	pSection->m_Offset= m_pFile->pos();
+	pSection->m_RawSize= rawData.size();
+	pSection->m_IsCompressed= false;
+
+	QByteArray compressedData;
+	if (m_UseCompression && (rawData.size() > sectionCompressionThreshold))
+	{
+		compressedData= qCompress(rawData, m_CompressionLevel);
+		pSection->m_IsCompressed= (compressedData.size() < rawData.size());
+	}
+	const QByteArray& data= pSection->m_IsCompressed ? compressedData : rawData;
+	pSection->m_Size= data.size();
+	writeOk= writeOk && (m_pFile->write(data) == data.size());
+
+	if (!writeOk)
+	{
+		m_DataStream.setStatus(QDataStream::WriteFailed);
+	}
+}
+
+// Return the raw data of the given mesh section
+QByteArray GLC_BSRep::meshSectionData(const GLC_Mesh* pMesh, const BSRepSection& section)
+{
+	const GLC_MeshData& meshData= pMesh->m_MeshData;
+	if (section.m_Type >= BSRepQuantizedPositionSection)
+	{
+		return compressedMeshSectionData(meshData, section);
+	}
+
+	const void* pData= NULL;
+	int wordCount= 0;
+	QVector<GLuint> indexVector;
+	GLfloatVector colorVector;
+	switch (section.m_Type)
+	{
+	case BSRepPositionSection:
+		pData= meshData.positionVector().constData();
+		wordCount= meshData.positionVector().size();
+		break;
+	case BSRepNormalSection:
+		pData= meshData.normalVector().constData();
+		wordCount= meshData.normalVector().size();
+		break;
+	case BSRepTexelSection:
+		pData= meshData.texelVector().constData();
+		wordCount= meshData.texelVector().size();
+		break;
+	case BSRepColorSection:
+		colorVector= meshData.colorVector();
+		pData= colorVector.constData();
+		wordCount= colorVector.size();
+		break;
+	case BSRepIndexSection:
+		indexVector= meshData.indexVector(section.m_LodIndex);
+		pData= indexVector.constData();
+		wordCount= indexVector.size();
+		break;
+	default:
+		Q_ASSERT(false);
+		break;
+	}
+
+	QByteArray rawData(wordCount * static_cast<int>(sizeof(quint32)), Qt::Uninitialized);
+	copyLittleEndianWords(rawData.data(), pData, wordCount);
+
+	return rawData;
+}
+
 // Check the time Stamp
 bool GLC_BSRep::timeStampOk(const QDateTime& timeStamp)
 {
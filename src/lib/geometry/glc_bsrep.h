@@ -30,13 +30,42 @@
 #include <QUuid>
 #include <QDateTime>
 #include <QMutex>
+#include <QSharedPointer>
 
 #include "../glc_config.h"
 #include "glc_3drep.h"
+#include "glc_vertexcompression.h"
+
+class GLC_Mesh;
+class BSRepSection;
+
+//////////////////////////////////////////////////////////////////////
+//! \class GLC_BSRepPin
+/*! \brief GLC_BSRepPin : Keep the file of a binary rep until it is loaded*/
+
+/*! The owner of the file, a cache for instance, must not remove it while
+ *  a pin is alive*/
+//////////////////////////////////////////////////////////////////////
+class GLC_LIB_EXPORT GLC_BSRepPin
+{
+public:
+	virtual ~GLC_BSRepPin() {}
+};
 
 //////////////////////////////////////////////////////////////////////
 //! \class GLC_BSRep
 /*! \brief GLC_BSRep : The 3D Binary serialised representation*/
+
+/*! Since version 104, the representation is saved in aligned sections :
+ *  - The representation without vertex attributes and index
+ *  - One section by mesh vertex attribute
+ *  - One section by mesh LOD index
+ *  Each section can be compressed. On loading, the file is mapped and
+ *  LOD other than the master LOD are loaded on first use if lazy LOD loading
+ *  is activated.
+ *
+ *  Since version 105, vertex attributes and index sections can be saved with
+ *  the encodings of GLC_VertexCompression. They are decoded on loading.*/
 //////////////////////////////////////////////////////////////////////
 class GLC_LIB_EXPORT GLC_BSRep
 {
@@ -78,6 +107,14 @@ public:
 
 	//! Return bsrep version
 	static quint32 version();
+
+	//! Return true if LOD index are loaded on first use
+	inline bool lazyLodLoadingIsActivated() const
+	{return m_LazyLodLoading;}
+
+	//! Return the compression of saved vertex attributes and index
+	inline GLC_VertexCompression::Compression vertexCompression() const
+	{return m_VertexCompression;}
 //@}
 
 //////////////////////////////////////////////////////////////////////
@@ -99,6 +136,21 @@ public:
 	inline void setCompressionLevel(int level)
 	{m_CompressionLevel= level;}
 
+	//! Set lazy LOD loading
+	/*! If activated, the index of LOD other than the master LOD are loaded on first use*/
+	inline void setLazyLodLoading(bool lazy)
+	{m_LazyLodLoading= lazy;}
+
+	//! Set the compression of saved vertex attributes and index
+	/*! Quantized positions and encoded normals are lossy, 16 bits index are used
+	 *  only for meshes with no more than 65536 vertices*/
+	inline void setVertexCompression(GLC_VertexCompression::Compression compression)
+	{m_VertexCompression= compression;}
+
+	//! Set the pin of the file, released when the binary rep is loaded
+	inline void setPin(const QSharedPointer<GLC_BSRepPin>& pin)
+	{m_pPin= pin;}
+
 //@}
 
 private:
@@ -121,6 +173,15 @@ private:
 	//! Check the time Stamp
 	bool timeStampOk(const QDateTime&);
 
+	//! Load the sections of a sectioned binary rep into the given 3DRep
+	void loadSectionedRep(GLC_3DRep* pRep);
+
+	//! Write the given section data aligned and compressed if needed
+	void writeSection(BSRepSection* pSection, const QByteArray& rawData);
+
+	//! Return the raw data of the given mesh section
+	static QByteArray meshSectionData(const GLC_Mesh* pMesh, const BSRepSection& section);
+
 //////////////////////////////////////////////////////////////////////
 // Private members
 //////////////////////////////////////////////////////////////////////
@@ -149,6 +210,18 @@ private:
 	//! The compression level
 	int m_CompressionLevel;
 
+	//! The version of the opened file
+	quint32 m_FileVersion;
+
+	//! Load LOD index on first use
+	bool m_LazyLodLoading;
+
+	//! The compression of saved vertex attributes and index
+	GLC_VertexCompression::Compression m_VertexCompression;
+
+	//! The pin of the file until the binary rep is loaded
+	QSharedPointer<GLC_BSRepPin> m_pPin;
+
 	//! Compression Mutex
 	static QMutex m_CompressionMutex;
 
@@ -24,6 +24,7 @@
 
 #include "../glc_exception.h"
 #include "glc_lod.h"
+#include "glc_vertexcompression.h"
 
 // Class chunk id
 quint32 GLC_Lod::m_ChunkId= 0xA708;
@@ -33,8 +34,11 @@ GLC_Lod::GLC_Lod()
 : m_Accuracy(0.0)
 , m_IndexBuffer(QOpenGLBuffer::IndexBuffer)
 , m_IndexVector()
+, m_pIndexSource()
+, m_IndexMutex()
 , m_IndexSize(0)
 , m_TrianglesCount(0)
+, m_UseShortIndex(false)
 {
 
 }
@@ -44,8 +48,11 @@ GLC_Lod::GLC_Lod(double accuracy)
 : m_Accuracy(accuracy)
 , m_IndexBuffer(QOpenGLBuffer::IndexBuffer)
 , m_IndexVector()
+, m_pIndexSource()
+, m_IndexMutex()
 , m_IndexSize(0)
 , m_TrianglesCount(0)
+, m_UseShortIndex(false)
 {
 
 }
@@ -54,12 +61,16 @@ GLC_Lod::GLC_Lod(double accuracy)
 GLC_Lod::GLC_Lod(const GLC_Lod& lod)
 : m_Accuracy(lod.m_Accuracy)
 , m_IndexBuffer(QOpenGLBuffer::IndexBuffer)
-, m_IndexVector(lod.indexVector())
+, m_IndexVector()
+, m_pIndexSource()
+, m_IndexMutex()
 , m_IndexSize(lod.m_IndexSize)
 , m_TrianglesCount(lod.m_TrianglesCount)
+, m_UseShortIndex(false)
 {
-
-
+	QMutexLocker locker(&(lod.m_IndexMutex));
+	m_IndexVector= lod.m_IndexVector;
+	m_pIndexSource= lod.m_pIndexSource;
 }
 
 
@@ -69,9 +80,14 @@ GLC_Lod& GLC_Lod::operator=(const GLC_Lod& lod)
 	{
 		m_Accuracy= lod.m_Accuracy;
 		m_IndexBuffer.destroy();
-		m_IndexVector= lod.indexVector();
+		{
+			QMutexLocker locker(&(lod.m_IndexMutex));
+			m_IndexVector= lod.m_IndexVector;
+			m_pIndexSource= lod.m_pIndexSource;
+		}
 		m_IndexSize= lod.m_IndexSize;
 		m_TrianglesCount= lod.m_TrianglesCount;
+		m_UseShortIndex= false;
 	}
 
 	return *this;
@@ -111,12 +127,7 @@ void GLC_Lod::releaseIboClientSide(bool update)
 		if (update)
 		{
 			// Copy index from client side to serveur
-			m_IndexBuffer.bind();
-
-			const GLsizei indexNbr= static_cast<GLsizei>(m_IndexVector.size());
-			const GLsizeiptr indexSize = indexNbr * sizeof(GLuint);
-			m_IndexBuffer.allocate(m_IndexVector.data(), indexSize);
-			m_IndexBuffer.release();
+			allocateIbo();
 		}
 		m_IndexSize= m_IndexVector.size();
 	}
@@ -124,16 +135,12 @@ void GLC_Lod::releaseIboClientSide(bool update)
 
 void GLC_Lod::setIboUsage(bool usage)
 {
+	// The IBO of a LOD whose index is not loaded is created when the LOD is drawn
 	if (usage && !m_IndexVector.isEmpty())
 	{
 		createIBO();
 		// Copy index from client side to serveur
-		m_IndexBuffer.bind();
-
-		const GLsizei indexNbr= static_cast<GLsizei>(m_IndexVector.size());
-		const GLsizeiptr indexSize = indexNbr * sizeof(GLuint);
-		m_IndexBuffer.allocate(m_IndexVector.data(), indexSize);
-		m_IndexBuffer.release();
+		allocateIbo();
 
 		m_IndexSize= m_IndexVector.size();
 	}
@@ -144,16 +151,77 @@ void GLC_Lod::setIboUsage(bool usage)
 	}
 }
 
-void GLC_Lod::useIBO() const
+void GLC_Lod::setIndexSource(const QSharedPointer<GLC_LodIndexSource>& source)
 {
-	Q_ASSERT(m_IndexBuffer.isCreated());
-	if (!const_cast<QOpenGLBuffer&>(m_IndexBuffer).bind())
+	QMutexLocker locker(&m_IndexMutex);
+	m_IndexVector.clear();
+	m_pIndexSource= source;
+}
+
+void GLC_Lod::createIBO()
+{
+	if (!m_IndexBuffer.isCreated() && !m_IndexVector.isEmpty())
+	{
+		m_IndexBuffer.create();
+	}
+}
+
+bool GLC_Lod::useIBO()
+{
+	// The index of a deferred LOD is loaded the first time the LOD is drawn
+	if (!m_IndexBuffer.isCreated())
+	{
+		loadPendingIndex();
+		if (m_IndexVector.isEmpty()) return false;
+
+		m_IndexBuffer.create();
+		allocateIbo();
+		m_IndexSize= m_IndexVector.size();
+	}
+
+	if (!m_IndexBuffer.bind())
 	{
 		GLC_Exception exception("GLC_Lod::useIBO  Failed to bind index buffer");
 		throw(exception);
 	}
+	return true;
+}
+
+
+void GLC_Lod::loadIndexFromSource() const
+{
+	Q_ASSERT(!m_pIndexSource.isNull());
+	// The source is released before loading, so a failing source is not called again
+	QSharedPointer<GLC_LodIndexSource> pSource(m_pIndexSource);
+	m_pIndexSource.clear();
+	try
+	{
+		m_IndexVector= pSource->loadIndexVector();
+	}
+	catch (GLC_Exception&)
+	{
+		// The error is logged by the exception, the LOD is empty
+		m_IndexVector.clear();
+	}
 }
 
+void GLC_Lod::allocateIbo()
+{
+	m_IndexBuffer.bind();
+	if (m_UseShortIndex)
+	{
+		const QVector<GLushort> shortIndex(GLC_VertexCompression::shortIndex(m_IndexVector));
+		const GLsizeiptr indexSize= static_cast<GLsizeiptr>(shortIndex.size()) * sizeof(GLushort);
+		m_IndexBuffer.allocate(shortIndex.constData(), indexSize);
+	}
+	else
+	{
+		const GLsizei indexNbr= static_cast<GLsizei>(m_IndexVector.size());
+		const GLsizeiptr indexSize = indexNbr * sizeof(GLuint);
+		m_IndexBuffer.allocate(m_IndexVector.data(), indexSize);
+	}
+	m_IndexBuffer.release();
+}
 
 QDataStream &operator<<(QDataStream &stream, const GLC_Lod &lod)
 {
@@ -161,7 +229,7 @@ QDataStream &operator<<(QDataStream &stream, const GLC_Lod &lod)
 	stream << chunckId;
 
 	stream << lod.m_Accuracy;
-    stream << lod.m_IndexVector;
+    stream << lod.indexVector();
 	stream << lod.m_TrianglesCount;
 
 	return stream;
@@ -173,6 +241,7 @@ QDataStream &operator>>(QDataStream &stream, GLC_Lod &lod)
 	Q_ASSERT(chunckId == GLC_Lod::m_ChunkId);
 
 	stream >> lod.m_Accuracy;
+	lod.m_pIndexSource.clear();
 	stream >> lod.m_IndexVector;
 	stream >> lod.m_TrianglesCount;
 
@@ -27,11 +27,30 @@
 
 #include <QVector>
 #include <QOpenGLBuffer>
+#include <QSharedPointer>
+#include <QMutex>
 
 #include "../glc_ext.h"
 
 #include "../glc_config.h"
 
+//////////////////////////////////////////////////////////////////////
+//! \class GLC_LodIndexSource
+/*! \brief GLC_LodIndexSource : Deferred source of a LOD index vector*/
+
+/*! A GLC_Lod with an index source loads its index vector the first time
+ *  it is accessed or drawn. If the index vector can't be loaded, the error
+ *  is logged and the LOD is empty*/
+//////////////////////////////////////////////////////////////////////
+class GLC_LIB_EXPORT GLC_LodIndexSource
+{
+public:
+	virtual ~GLC_LodIndexSource() {}
+
+	//! Load and return the index vector of the LOD, throw a GLC_Exception on failure
+	virtual QVector<GLuint> loadIndexVector() const= 0;
+};
+
 //////////////////////////////////////////////////////////////////////
 //! \class GLC_Lod
 /*! \brief GLC_Lod is a Level of detail index and accuracy*/
@@ -82,7 +101,10 @@ public:
 	 * - Triangles Fans index
 	 */
     QVector<GLuint> indexVector() const
-    {return m_IndexVector;}
+    {
+        loadPendingIndex();
+        return m_IndexVector;
+    }
 
 	//! Return The unique index Vector handle which contains :
 	/*!
@@ -91,16 +113,33 @@ public:
 	 * - Triangles Fans index
 	 */
 	inline QVector<GLuint>* indexVectorHandle()
-	{return &m_IndexVector;}
+	{
+		loadPendingIndex();
+		return &m_IndexVector;
+	}
 
 	//! Return the size of the index Vector
 	inline int indexVectorSize() const
-	{return m_IndexVector.size();}
+	{
+		loadPendingIndex();
+		return m_IndexVector.size();
+	}
+
+	//! Return true if the index vector of this LOD is loaded
+	inline bool indexIsLoaded() const
+	{
+		QMutexLocker locker(&m_IndexMutex);
+		return m_pIndexSource.isNull();
+	}
 
 	//! Return this lod triangle count
 	inline unsigned int trianglesCount() const
 	{return m_TrianglesCount;}
 
+	//! Return true if the IBO is filled with 16 bits index
+	inline bool shortIndexIsUsed() const
+	{return m_UseShortIndex;}
+
 //@}
 
 //////////////////////////////////////////////////////////////////////
@@ -127,6 +166,14 @@ public:
 	//! Set IBO usage
 	void setIboUsage(bool usage);
 
+	//! Set 16 bits index usage in the IBO
+	/*! Take effect the next time the IBO is filled, the index must be lower than 65536*/
+	inline void setShortIndexUsage(bool usage)
+	{m_UseShortIndex= usage;}
+
+	//! Set the source used to load the index vector on first use
+	/*! The current index vector is discarded*/
+	void setIndexSource(const QSharedPointer<GLC_LodIndexSource>& source);
 
 //@}
 
@@ -136,16 +183,12 @@ public:
 //////////////////////////////////////////////////////////////////////
 public:
 	//! IBO creation
-	inline void createIBO()
-	{
-		if (!m_IndexBuffer.isCreated() && !m_IndexVector.isEmpty())
-		{
-			m_IndexBuffer.create();
-		}
-	}
+	/*! The IBO of a LOD whose index vector is not loaded is not created*/
+	void createIBO();
 
-	//! Ibo Usage
-	void useIBO() const;
+	//! Ibo Usage, return false if the LOD is empty
+	/*! The index vector of a deferred LOD is loaded and its IBO created and filled*/
+	bool useIBO();
 
 	//! Fill IBO
 	inline void fillIbo()
@@ -153,6 +196,23 @@ public:
 
 //@}
 
+//////////////////////////////////////////////////////////////////////
+// Private services Functions
+//////////////////////////////////////////////////////////////////////
+private:
+	//! Load the index vector from the index source if needed
+	inline void loadPendingIndex() const
+	{
+		QMutexLocker locker(&m_IndexMutex);
+		if (!m_pIndexSource.isNull()) loadIndexFromSource();
+	}
+
+	//! Load the index vector from the index source, the index mutex must be locked
+	void loadIndexFromSource() const;
+
+	//! Copy the index vector to the IBO
+	void allocateIbo();
+
 //////////////////////////////////////////////////////////////////////
 // Private members
 //////////////////////////////////////////////////////////////////////
@@ -165,7 +225,13 @@ private:
 	QOpenGLBuffer m_IndexBuffer;
 
 	//! The Index Vector
-	QVector<GLuint> m_IndexVector;
+	mutable QVector<GLuint> m_IndexVector;
+
+	//! The source of the index vector if it is not loaded
+	mutable QSharedPointer<GLC_LodIndexSource> m_pIndexSource;
+
+	//! Guard the index vector loading of const accessors
+	mutable QMutex m_IndexMutex;
 
 	//! The Index vector size
 	int m_IndexSize;
@@ -173,6 +239,9 @@ private:
 	//! Lod number of faces
 	unsigned int m_TrianglesCount;
 
+	//! Fill the IBO with 16 bits index
+	bool m_UseShortIndex;
+
 	//! Class chunk id
 	static quint32 m_ChunkId;
 
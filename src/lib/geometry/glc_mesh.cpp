@@ -22,35 +22,18 @@
 
 //! \file glc_mesh.cpp Implementation for the GLC_Mesh class.
 
-#include <QtConcurrent>
-
 #include "glc_mesh.h"
+#include "glc_sharpedgeextractor.h"
+#include "glc_vertexcacheoptimizer.h"
 #include "../glc_renderstatistics.h"
 #include "../glc_context.h"
 #include "../glc_contextmanager.h"
 
 #include "../maths/glc_geomtools.h"
-#include "../maths/glc_triangle.h"
 
 // Class chunk id
 quint32 GLC_Mesh::m_ChunkId= 0xA701;
 
-class SharpEdgeContainer
-{
-public:
-    SharpEdgeContainer(GLC_Triangle* pTriangle, QList<GLC_Triangle>* pTriangleList, double angleThresold, int index)
-        : m_pTriangle(pTriangle)
-        , m_pTriangleList(pTriangleList)
-        , m_AngleThresold(angleThresold)
-        , m_Index(index)
-    {}
-
-    GLC_Triangle* m_pTriangle;
-    QList<GLC_Triangle>* m_pTriangleList;
-    double m_AngleThresold;
-    int m_Index;
-};
-
 GLC_Mesh::GLC_Mesh()
     :GLC_Geometry("Mesh", false)
     , m_NextPrimitiveLocalId(1)
@@ -410,6 +393,66 @@ QList<QVector<GLuint> > GLC_Mesh::getFansIndex(int lod, GLC_uint materialId) con
     return result;
 }
 
+QVector<GLC_uint> GLC_Mesh::getTrianglesPrimitiveId(int lod, GLC_uint materialId) const
+{
+    Q_ASSERT(containsTriangles(lod, materialId));
+
+    GLC_PrimitiveGroup* pPrimitiveGroup= m_PrimitiveGroups.value(lod)->value(materialId);
+    QVector<GLC_uint> result;
+    result.reserve(pPrimitiveGroup->trianglesIndexSize() / 3);
+
+    const IndexSizes& sizes= pPrimitiveGroup->trianglesIndexSizes();
+    const int groupCount= sizes.size();
+    for (int i= 0; i < groupCount; ++i)
+    {
+        GLC_uint id= 0;
+        if (pPrimitiveGroup->containsTrianglesGroupId()) id= pPrimitiveGroup->triangleGroupId(i);
+        const int triangleCount= sizes.at(i) / 3;
+        for (int j= 0; j < triangleCount; ++j)
+        {
+            result.append(id);
+        }
+    }
+
+    return result;
+}
+
+QVector<GLC_uint> GLC_Mesh::getStripsPrimitiveId(int lod, GLC_uint materialId) const
+{
+    Q_ASSERT(containsStrips(lod, materialId));
+
+    GLC_PrimitiveGroup* pPrimitiveGroup= m_PrimitiveGroups.value(lod)->value(materialId);
+    const int stripCount= pPrimitiveGroup->stripsSizes().size();
+    QVector<GLC_uint> result(stripCount, 0);
+    if (pPrimitiveGroup->containsStripGroupId())
+    {
+        for (int i= 0; i < stripCount; ++i)
+        {
+            result[i]= pPrimitiveGroup->stripGroupId(i);
+        }
+    }
+
+    return result;
+}
+
+QVector<GLC_uint> GLC_Mesh::getFansPrimitiveId(int lod, GLC_uint materialId) const
+{
+    Q_ASSERT(containsFans(lod, materialId));
+
+    GLC_PrimitiveGroup* pPrimitiveGroup= m_PrimitiveGroups.value(lod)->value(materialId);
+    const int fanCount= pPrimitiveGroup->fansSizes().size();
+    QVector<GLC_uint> result(fanCount, 0);
+    if (pPrimitiveGroup->containsFanGroupId())
+    {
+        for (int i= 0; i < fanCount; ++i)
+        {
+            result[i]= pPrimitiveGroup->fanGroupId(i);
+        }
+    }
+
+    return result;
+}
+
 QSet<GLC_uint> GLC_Mesh::setOfPrimitiveId() const
 {
     QList<GLC_uint> subject;
@@ -684,6 +727,42 @@ GLC_uint GLC_Mesh::addTrianglesFan(GLC_Material* pMaterial, const IndexList& ind
     return id;
 }
 
+int GLC_Mesh::appendLod(const QHash<GLC_uint, IndexList>& trianglesIndex, double accuracy)
+{
+    // The new LOD index must be moved to the mesh data LOD as done by finish()
+    const bool isFinished= m_PrimitiveGroups.contains(0) && !m_PrimitiveGroups.value(0)->isEmpty()
+            && m_PrimitiveGroups.value(0)->constBegin().value()->isFinished();
+    if (!isFinished || m_MeshData.positionSizeIsSet()) return -1;
+
+    const int lod= m_MeshData.lodCount();
+    LodPrimitiveGroups* pGroups= new LodPrimitiveGroups();
+    m_PrimitiveGroups.insert(lod, pGroups);
+    m_MeshData.appendLod(accuracy);
+
+    QHash<GLC_uint, IndexList>::const_iterator iIndex= trianglesIndex.constBegin();
+    while (iIndex != trianglesIndex.constEnd())
+    {
+        const GLC_uint materialId= iIndex.key();
+        Q_ASSERT(containsMaterial(materialId));
+        if (!iIndex.value().isEmpty())
+        {
+            GLC_PrimitiveGroup* pGroup= new GLC_PrimitiveGroup(materialId);
+            pGroup->addTriangles(iIndex.value());
+            // LOD list is in LOD order once finished
+            m_MeshData.getLod(lod)->trianglesAdded(iIndex.value().size() / 3);
+
+            pGroup->setTrianglesOffseti(m_MeshData.indexVectorSize(lod));
+            (*m_MeshData.indexVectorHandle(lod))+= pGroup->trianglesIndex().toVector();
+            pGroup->computeVboOffset();
+            pGroup->finish();
+            pGroups->insert(materialId, pGroup);
+        }
+        ++iIndex;
+    }
+
+    return lod;
+}
+
 // Reverse mesh normal
 void GLC_Mesh::reverseNormals()
 {
@@ -713,6 +792,11 @@ void GLC_Mesh::finish()
 
         m_MeshData.finishLod();
 
+        if (GLC_State::isMeshOptimizationActivated())
+        {
+            optimizeVertexCache();
+        }
+
         moveIndexToMeshDataLod();
     }
     else
@@ -815,13 +899,7 @@ void GLC_Mesh::setVboUsage(bool usage)
 
 void GLC_Mesh::createSharpEdges(double precision, double angleThreshold)
 {
-    angleThreshold= glc::toRadian(angleThreshold);
-    const double savedPrecision= glc::comparedPrecision;
-    glc::comparedPrecision= precision;
-
     m_WireData.clear();
-    const GLfloatVector& positionVector= *(m_MeshData.positionVectorHandle());
-    const GLfloatVector& normalVector= *(m_MeshData.normalVectorHandle());
 
     QList<GLC_uint> materialIdList= this->materialIds();
     const int materialCount= materialIdList.count();
@@ -832,62 +910,13 @@ void GLC_Mesh::createSharpEdges(double precision, double angleThreshold)
         indexList.append(this->getEquivalentTrianglesStripsFansIndex(0, materialId));
     }
 
-    const int indexCount= indexList.count();
-
-    QList<GLC_Triangle> triangles;
-    QList<SharpEdgeContainer*> sharpEdgeContainerList;
-
-    for (int tri1Index= 0; tri1Index < indexCount; tri1Index+=3)
-    {
-        int index= indexList.at(tri1Index);
-        const GLC_Point3d p1(positionVector.at(index * 3), positionVector.at((index * 3) + 1), positionVector.at((index * 3) + 2));
-        const GLC_Vector3d n1(normalVector.at(index * 3), normalVector.at((index * 3) + 1), normalVector.at((index * 3) + 2));
-        index= indexList.at(tri1Index + 1);
-        const GLC_Point3d p2(positionVector.at(index * 3), positionVector.at((index * 3) + 1), positionVector.at((index * 3) + 2));
-        const GLC_Vector3d n2(normalVector.at(index * 3), normalVector.at((index * 3) + 1), normalVector.at((index * 3) + 2));
-        index= indexList.at(tri1Index + 2);
-        const GLC_Point3d p3(positionVector.at(index * 3), positionVector.at((index * 3) + 1), positionVector.at((index * 3) + 2));
-        const GLC_Vector3d n3(normalVector.at(index * 3), normalVector.at((index * 3) + 1), normalVector.at((index * 3) + 2));
-
-        GLC_Triangle triangle(p1, p2, p3, n1, n2, n3);
-        triangles.append(triangle);
-
-        SharpEdgeContainer* pSharpEdgeContainer= new SharpEdgeContainer(&(triangles.last()), &triangles, angleThreshold, triangles.count() - 1);
-        sharpEdgeContainerList.append(pSharpEdgeContainer);
-    }
-
-    // Multi thread edge computing
-    QtConcurrent::blockingMapped(sharpEdgeContainerList, computeSharEdgeMappedFunction);
-    qDeleteAll(sharpEdgeContainerList);
-
-    const int count= triangles.count();
-    for (int i= 0; i < count; ++i)
-    {
-        GLC_Triangle& triangle= triangles[i];
-        if (triangle.hasSharpEdge())
-        {
-            QList<GLC_Point3d> edge= triangle.sharpEdges();
-            Q_ASSERT(!edge.isEmpty());
-            const int edgeCount= edge.count();
-            GLfloatVector edgeVector(edgeCount * 3);
-            for (int i= 0; i < edgeCount; ++i)
-            {
-                const GLC_Point3d& point= edge.at(i);
-                const int index= i * 3;
-                edgeVector[index]= static_cast<float>(point.x());
-                edgeVector[index + 1]= static_cast<float>(point.y());
-                edgeVector[index + 2]= static_cast<float>(point.z());
-            }
-
-            m_WireData.addVerticeGroup(edgeVector);
-        }
-    }
-
-    glc::comparedPrecision= savedPrecision;
+    GLC_SharpEdgeExtractor extractor(precision, angleThreshold);
+    extractor.extract(*(m_MeshData.positionVectorHandle()), indexList);
+    extractor.addPolylinesTo(&m_WireData);
 }
 
 // Load the mesh from binary data stream
-void GLC_Mesh::loadFromDataStream(QDataStream& stream, const MaterialHash& materialHash, const QHash<GLC_uint, GLC_uint>& materialIdMap)
+void GLC_Mesh::loadFromDataStream(QDataStream& stream, const MaterialHash& materialHash, const QHash<GLC_uint, GLC_uint>& materialIdMap, bool withMeshData)
 {
     quint32 chunckId;
     stream >> chunckId;
@@ -907,7 +936,14 @@ void GLC_Mesh::loadFromDataStream(QDataStream& stream, const MaterialHash& mater
     setNextPrimitiveLocalId(localId);
 
     // Retrieve geom mesh data
-    stream >> m_MeshData;
+    if (withMeshData)
+    {
+        stream >> m_MeshData;
+    }
+    else
+    {
+        m_MeshData.loadLodLayoutFromDataStream(stream);
+    }
 
     // Retrieve primitiveGroupLodList
     QList<int> primitiveGroupLodList;
@@ -946,7 +982,7 @@ void GLC_Mesh::loadFromDataStream(QDataStream& stream, const MaterialHash& mater
 }
 
 // Save the mesh to binary data stream
-void GLC_Mesh::saveToDataStream(QDataStream& stream) const
+void GLC_Mesh::saveToDataStream(QDataStream& stream, bool withMeshData) const
 {
     quint32 chunckId= m_ChunkId;
     stream << chunckId;
@@ -961,7 +997,14 @@ void GLC_Mesh::saveToDataStream(QDataStream& stream) const
     stream << nextPrimitiveLocalId();
 
     // Mesh data serialisation
-    stream << m_MeshData;
+    if (withMeshData)
+    {
+        stream << m_MeshData;
+    }
+    else
+    {
+        m_MeshData.saveLodLayoutToDataStream(stream);
+    }
 
     // Primitive groups serialisation
     QList<int> primitiveGroupLodList;
@@ -1007,7 +1050,12 @@ void GLC_Mesh::glDraw(const GLC_RenderProperties& renderProperties)
         m_CurrentLod= 0;
     }
 
-    setClientState();
+    if (!setClientState())
+    {
+        // A LOD whose index can't be loaded is empty
+        restoreClientState(pContext);
+        return;
+    }
 
     if (renderProperties.renderingFlag() == glc::OutlineSilhouetteRenderFlag) {
         pContext->glcEnableLighting(false);
@@ -1089,13 +1137,15 @@ void GLC_Mesh::glDraw(const GLC_RenderProperties& renderProperties)
         drawMeshWire(renderProperties, pContext);
     }
 
-    // Update statistics
-    GLC_RenderStatistics::addBodies(1);
-    GLC_RenderStatistics::addTriangles(m_MeshData.trianglesCount(m_CurrentLod));
+    // Update statistics, an instanced draw renders the mesh once by instance
+    const unsigned int drawCount= static_cast<unsigned int>(qMax(1, GLC_State::drawInstanceCount()));
+    GLC_RenderStatistics::addBodies(drawCount);
+    GLC_RenderStatistics::addTriangles(m_MeshData.trianglesCount(m_CurrentLod) * drawCount);
 }
 
-void GLC_Mesh::setClientState()
+bool GLC_Mesh::setClientState()
 {
+    bool subject;
     if (GLC_Geometry::vboIsUsed())
     {
         m_MeshData.createVBOs();
@@ -1105,9 +1155,13 @@ void GLC_Mesh::setClientState()
         {
             fillVbosAndIbos();
         }
+        else if (!vertexDecodingIsAvailable())
+        {
+            useFloatVbos();
+        }
 
         // Activate mesh VBOs and IBO of the current LOD
-        activateVboAndIbo();
+        subject= activateVboAndIbo();
     }
     else
     {
@@ -1116,7 +1170,9 @@ void GLC_Mesh::setClientState()
             m_MeshData.initPositionSize();
         }
         activateVertexArray();
+        subject= !m_MeshData.indexVectorHandle(m_CurrentLod)->isEmpty();
     }
+    return subject;
 }
 
 void GLC_Mesh::restoreClientState(GLC_Context *pContext)
@@ -1133,6 +1189,10 @@ void GLC_Mesh::restoreClientState(GLC_Context *pContext)
 
     if (GLC_Geometry::vboIsUsed())
     {
+        if (m_MeshData.vboCompression() != GLC_VertexCompression::NoCompression)
+        {
+            pContext->glcSetVertexDecoding(false, m_MeshData.positionOffset(), m_MeshData.positionScale(), false);
+        }
         QOpenGLBuffer::release(QOpenGLBuffer::IndexBuffer);
         QOpenGLBuffer::release(QOpenGLBuffer::VertexBuffer);
     }
@@ -1233,6 +1293,16 @@ GLC_uint GLC_Mesh::setCurrentMaterial(GLC_Material* pMaterial, int lod, double a
 // Fill VBOs and IBOs
 void GLC_Mesh::fillVbosAndIbos()
 {
+    // Compressed vertex attributes are decoded by the shader, 16 bits index need no decoding
+    if (GLC_State::glslUsed() && vertexDecodingIsAvailable())
+    {
+        m_MeshData.setVboCompression(GLC_State::vertexCompression());
+    }
+    else
+    {
+        m_MeshData.setVboCompression(GLC_State::vertexCompression() & GLC_VertexCompression::ShortIndex);
+    }
+
     // Fill VBO of vertices
     m_MeshData.fillVbo(GLC_MeshData::GLC_Vertex);
 
@@ -1248,7 +1318,37 @@ void GLC_Mesh::fillVbosAndIbos()
     // Fill a lod IBO
     m_MeshData.fillLodIbo();
 
+    // The offsets of the primitive groups depend on the IBO index size
+    finishSerialized();
+}
+// Return true if the active shader decodes compressed vertex attributes
+bool GLC_Mesh::vertexDecodingIsAvailable()
+{
+    bool subject= GLC_Shader::hasActiveShader();
+    if (subject)
+    {
+        const GLC_Shader* pShader= GLC_Shader::currentShaderHandle();
+        subject= (pShader->decodePositionId() != -1) && (pShader->decodeNormalId() != -1);
+    }
+    return subject;
+}
+
+// Fill VBOs with float vertex attributes if they are compressed
+void GLC_Mesh::useFloatVbos()
+{
+    // The index size is kept, so the IBOs and the primitive group offsets remain valid
+    const GLC_VertexCompression::Compression indexCompression= m_MeshData.vboCompression() & GLC_VertexCompression::ShortIndex;
+    if ((m_MeshData.vboCompression() != indexCompression) && !m_MeshData.positionVectorHandle()->isEmpty())
+    {
+        m_MeshData.setVboCompression(indexCompression);
+        m_MeshData.fillVbo(GLC_MeshData::GLC_Vertex);
+        m_MeshData.fillVbo(GLC_MeshData::GLC_Normal);
+        m_MeshData.fillVbo(GLC_MeshData::GLC_Texel);
+        m_MeshData.fillVbo(GLC_MeshData::GLC_Color);
+        QOpenGLBuffer::release(QOpenGLBuffer::VertexBuffer);
+    }
 }
+
 // set primitive group offset
 void GLC_Mesh::finishSerialized()
 {
@@ -1258,7 +1358,7 @@ void GLC_Mesh::finishSerialized()
         LodPrimitiveGroups::iterator iGroup= iGroups.value()->begin();
         while (iGroup != iGroups.value()->constEnd())
         {
-            iGroup.value()->computeVboOffset();
+            iGroup.value()->computeVboOffset(m_MeshData.vboIndexSize());
             ++iGroup;
         }
         ++iGroups;
@@ -1345,6 +1445,96 @@ void GLC_Mesh::moveIndexToMeshDataLod()
     }
 }
 
+void GLC_Mesh::optimizeVertexCache()
+{
+    const GLfloatVector& positions= m_MeshData.positionVector();
+    const int vertexCount= positions.size() / 3;
+    if (0 == vertexCount) return;
+
+    GLC_VertexCacheOptimizer optimizer(vertexCount);
+
+    // Reorder triangles of each primitive group
+    PrimitiveGroupsHash::iterator iGroups= m_PrimitiveGroups.begin();
+    while (iGroups != m_PrimitiveGroups.constEnd())
+    {
+        LodPrimitiveGroups::iterator iGroup= iGroups.value()->begin();
+        while (iGroup != iGroups.value()->constEnd())
+        {
+            GLC_PrimitiveGroup* pGroup= iGroup.value();
+            if (pGroup->containsTriangles())
+            {
+                if (pGroup->containsTrianglesGroupId())
+                {
+                    // Each primitive id range is optimized on its own to keep selection
+                    const IndexList& trianglesIndex= pGroup->trianglesIndex();
+                    const IndexSizes& sizes= pGroup->trianglesIndexSizes();
+                    IndexList optimizedIndex;
+                    optimizedIndex.reserve(trianglesIndex.size());
+                    int offset= 0;
+                    for (int i= 0; i < sizes.size(); ++i)
+                    {
+                        optimizedIndex.append(optimizer.optimize(trianglesIndex.mid(offset, sizes.at(i)), positions));
+                        offset+= sizes.at(i);
+                    }
+                    pGroup->setTrianglesIndex(optimizedIndex);
+                }
+                else
+                {
+                    pGroup->setTrianglesIndex(optimizer.optimize(pGroup->trianglesIndex(), positions));
+                }
+            }
+            ++iGroup;
+        }
+        ++iGroups;
+    }
+
+    // Reorder vertices by first use
+    const GLuint unused= static_cast<GLuint>(vertexCount);
+    QVector<GLuint> remap(vertexCount, unused);
+    GLuint nextIndex= 0;
+    const int lodCount= m_MeshData.lodCount();
+    for (int lod= 0; lod < lodCount; ++lod)
+    {
+        if (!m_PrimitiveGroups.contains(lod)) continue;
+        LodPrimitiveGroups::const_iterator iGroup= m_PrimitiveGroups.value(lod)->constBegin();
+        while (iGroup != m_PrimitiveGroups.value(lod)->constEnd())
+        {
+            const IndexList* indexLists[3]= {&(iGroup.value()->trianglesIndex()), &(iGroup.value()->stripsIndex()), &(iGroup.value()->fansIndex())};
+            for (int i= 0; i < 3; ++i)
+            {
+                const int indexCount= indexLists[i]->size();
+                for (int j= 0; j < indexCount; ++j)
+                {
+                    const GLuint vertex= indexLists[i]->at(j);
+                    if (unused == remap.at(vertex)) remap[vertex]= nextIndex++;
+                }
+            }
+            ++iGroup;
+        }
+    }
+
+    bool isIdentity= true;
+    for (int i= 0; i < vertexCount; ++i)
+    {
+        if (unused == remap.at(i)) remap[i]= nextIndex++;
+        isIdentity= isIdentity && (remap.at(i) == static_cast<GLuint>(i));
+    }
+    if (isIdentity) return;
+
+    m_MeshData.reorderVertices(remap);
+    iGroups= m_PrimitiveGroups.begin();
+    while (iGroups != m_PrimitiveGroups.constEnd())
+    {
+        LodPrimitiveGroups::iterator iGroup= iGroups.value()->begin();
+        while (iGroup != iGroups.value()->constEnd())
+        {
+            iGroup.value()->remapIndex(remap);
+            ++iGroup;
+        }
+        ++iGroups;
+    }
+}
+
 // The normal display loop
 void GLC_Mesh::normalRenderLoop(const GLC_RenderProperties& renderProperties, bool vboIsUsed)
 {
@@ -1891,19 +2081,6 @@ IndexList GLC_Mesh::equivalentTrianglesIndexOfFansIndex(int lodIndex, GLC_uint m
     return trianglesIndex;
 }
 
-SharpEdgeContainer* GLC_Mesh::computeSharEdgeMappedFunction(SharpEdgeContainer* pContainer)
-{
-    const int count= pContainer->m_pTriangleList->count();
-    const int startIndex= pContainer->m_Index + 1;
-    for (int i= startIndex; i < count; ++i)
-    {
-        GLC_Triangle& triangle2= pContainer->m_pTriangleList->operator [](i);
-        pContainer->m_pTriangle->setSharpEdge(&triangle2, pContainer->m_AngleThresold);
-    }
-
-    return pContainer;
-}
-
 void GLC_Mesh::innerCopy(const GLC_Mesh& other)
 {
     // Copy of geometry preserve material id.
@@ -38,12 +38,10 @@
 #include "../shading/glc_selectionmaterial.h"
 #include "../glc_context.h"
 #include "../glc_contextmanager.h"
+#include "../glc_ext.h"
 
 #include "../glc_config.h"
 
-class GLC_Triangle;
-class SharpEdgeContainer;
-
 //////////////////////////////////////////////////////////////////////
 //! \class GLC_Mesh
 /*! \brief GLC_Mesh : OpenGL 3D Mesh*/
@@ -55,6 +53,7 @@ class GLC_LIB_EXPORT GLC_Mesh : public GLC_Geometry
 {
 	friend QDataStream &operator<<(QDataStream &, const GLC_Mesh &);
 	friend QDataStream &operator>>(QDataStream &, GLC_Mesh &);
+	friend class GLC_BSRep;
 
 public:
 	typedef QHash<GLC_uint, GLC_PrimitiveGroup*> LodPrimitiveGroups;
@@ -157,6 +156,18 @@ public:
 	//! Return the number of fans in the specified LOD with the specified material id
 	int numberOfFans(int lod, GLC_uint materialId) const;
 
+	//! Return the primitive id of each triangle in the specified LOD with the specified material id
+	/*! Ids are in the order of getTrianglesIndex(), they are 0 if the mesh has no primitive id*/
+	QVector<GLC_uint> getTrianglesPrimitiveId(int lod, GLC_uint materialId) const;
+
+	//! Return the primitive id of each strip in the specified LOD with the specified material id
+	/*! Ids are in the order of getStripsIndex(), they are 0 if the mesh has no primitive id*/
+	QVector<GLC_uint> getStripsPrimitiveId(int lod, GLC_uint materialId) const;
+
+	//! Return the primitive id of each fan in the specified LOD with the specified material id
+	/*! Ids are in the order of getFansIndex(), they are 0 if the mesh has no primitive id*/
+	QVector<GLC_uint> getFansPrimitiveId(int lod, GLC_uint materialId) const;
+
 	//! Return true if the mesh contains the specified LOD
 	inline bool containsLod(int lod) const
 	{return (NULL != m_MeshData.getLod(lod));}
@@ -254,6 +265,11 @@ public:
 	//! Add triangles Fan and return his id
 	GLC_uint addTrianglesFan(GLC_Material*, const IndexList&, const int lod= 0, double accuracy= 0.0);
 
+	//! Append a LOD made of the given triangles index of each material id to this finished mesh
+	/*! The LOD uses the vertices of the mesh and the materials of the master LOD.
+	 *  Return the index of the new LOD, or -1 if the mesh is not finished or its data has been sent to the GPU*/
+	int appendLod(const QHash<GLC_uint, IndexList>& trianglesIndex, double accuracy);
+
 	//! Reverse mesh normal
     void reverseNormals() override;
 
@@ -287,6 +303,7 @@ public:
 	//! Set VBO usage
     void setVboUsage(bool usage) override;
 
+	//! Create the sharp edges wire data of this mesh with the given weld precision and angle threshold in degrees
     void createSharpEdges(double precision, double angleThreshold);
 
 //@}
@@ -300,11 +317,13 @@ public:
 	/*! The MaterialHash contains a hash table of GLC_Material that the mesh can use
 	 *  The QHash<GLC_uint, GLC_uint> is used to map serialised material ID to the new
 	 *  constructed materials
+	 *  If withMeshData is false, only the LOD layout of the mesh data is loaded
 	 */
-	void loadFromDataStream(QDataStream&, const MaterialHash&, const QHash<GLC_uint, GLC_uint>&);
+	void loadFromDataStream(QDataStream&, const MaterialHash&, const QHash<GLC_uint, GLC_uint>&, bool withMeshData= true);
 
 	//! Save the mesh to binary data stream
-	void saveToDataStream(QDataStream&) const;
+	/*! If withMeshData is false, vertex attributes and index are not saved*/
+	void saveToDataStream(QDataStream&, bool withMeshData= true) const;
 
 //@}
 //////////////////////////////////////////////////////////////////////
@@ -317,7 +336,8 @@ protected:
 	/*! This Virtual function is implemented here.*/
     void glDraw(const GLC_RenderProperties&) override;
 
-    void setClientState();
+    //! Set the client state of the current LOD, return false if the current LOD is empty
+    bool setClientState();
     void restoreClientState(GLC_Context *pContext);
     void drawMeshWire(const GLC_RenderProperties &renderProperties, GLC_Context *pContext);
 
@@ -344,6 +364,13 @@ private:
 	//! Fill VBOs and IBOs
 	void fillVbosAndIbos();
 
+	//! Return true if the active shader has the uniforms decoding compressed vertex attributes
+	static bool vertexDecodingIsAvailable();
+
+	//! Fill VBOs with float vertex attributes if they are compressed
+	/*! Used to draw with a shader which doesn't decode compressed vertex attributes*/
+	void useFloatVbos();
+
 	//! Set primitive group offset after loading mesh from binary
 	void finishSerialized();
 
@@ -353,6 +380,13 @@ private:
 	//! Move Indexs from the primitive groups to the mesh Data LOD and Set Index offsets
 	void moveIndexToMeshDataLod();
 
+	//! Reorder triangles of each primitive group and vertices for the post transform vertex cache
+	/*! Triangles of a primitive id are kept together, the vertices are reordered by first use*/
+	void optimizeVertexCache();
+
+	//! Draw the given elements of the IBO, once by instance if instances are drawn
+	inline static void vboDrawElements(GLenum mode, GLsizei count, GLenum type, const GLvoid* indices);
+
 	//! Use VBO to Draw primitives from the specified GLC_PrimitiveGroup
 	inline void vboDrawPrimitivesOf(GLC_PrimitiveGroup*);
 
@@ -377,8 +411,8 @@ private:
 	//! Use Vertex Array to Draw primitives with selection materials from the specified GLC_PrimitiveGroup
 	inline void vertexArrayDrawSelectedPrimitivesGroupOf(GLC_PrimitiveGroup*, GLC_Material*, bool, bool, const GLC_RenderProperties&);
 
-	//! Activate mesh VBOs and IBO of the current LOD
-	inline void activateVboAndIbo();
+	//! Activate mesh VBOs and IBO of the current LOD, return false if the current LOD is empty
+	inline bool activateVboAndIbo();
 
 	//! Activate vertex Array
 	inline void activateVertexArray();
@@ -422,8 +456,6 @@ private:
 	//! Return the equivalent triangles index of the fan index of given LOD and material ID
     IndexList equivalentTrianglesIndexOfFansIndex(int lodIndex, GLC_uint materialId) const;
 
-    static SharpEdgeContainer* computeSharEdgeMappedFunction(SharpEdgeContainer* pContainer);
-
     void innerCopy(const GLC_Mesh& other);
 
 //@}
@@ -466,13 +498,27 @@ private:
 
 // Inline functions
 
+// Draw the given elements of the IBO, once by instance if instances are drawn
+void GLC_Mesh::vboDrawElements(GLenum mode, GLsizei count, GLenum type, const GLvoid* indices)
+{
+	const int instanceCount= GLC_State::drawInstanceCount();
+	if (instanceCount > 0)
+	{
+		glDrawElementsInstancedARB(mode, count, type, indices, instanceCount);
+	}
+	else
+	{
+		glDrawElements(mode, count, type, indices);
+	}
+}
+
 // Use VBO to Draw triangles from the specified GLC_PrimitiveGroup
 void GLC_Mesh::vboDrawPrimitivesOf(GLC_PrimitiveGroup* pCurrentGroup)
 {
 	// Draw triangles
 	if (pCurrentGroup->containsTriangles())
 	{
-		glDrawElements(GL_TRIANGLES, pCurrentGroup->trianglesIndexSize(), GL_UNSIGNED_INT, pCurrentGroup->trianglesIndexOffset());
+		vboDrawElements(GL_TRIANGLES, pCurrentGroup->trianglesIndexSize(), m_MeshData.vboIndexType(), pCurrentGroup->trianglesIndexOffset());
 	}
 
 	// Draw Triangles strip
@@ -481,7 +527,7 @@ void GLC_Mesh::vboDrawPrimitivesOf(GLC_PrimitiveGroup* pCurrentGroup)
 		const GLsizei stripsCount= static_cast<GLsizei>(pCurrentGroup->stripsOffset().size());
 		for (GLint i= 0; i < stripsCount; ++i)
 		{
-			glDrawElements(GL_TRIANGLE_STRIP, pCurrentGroup->stripsSizes().at(i), GL_UNSIGNED_INT, pCurrentGroup->stripsOffset().at(i));
+			vboDrawElements(GL_TRIANGLE_STRIP, pCurrentGroup->stripsSizes().at(i), m_MeshData.vboIndexType(), pCurrentGroup->stripsOffset().at(i));
 		}
 	}
 
@@ -491,7 +537,7 @@ void GLC_Mesh::vboDrawPrimitivesOf(GLC_PrimitiveGroup* pCurrentGroup)
 		const GLsizei fansCount= static_cast<GLsizei>(pCurrentGroup->fansOffset().size());
 		for (GLint i= 0; i < fansCount; ++i)
 		{
-			glDrawElements(GL_TRIANGLE_FAN, pCurrentGroup->fansSizes().at(i), GL_UNSIGNED_INT, pCurrentGroup->fansOffset().at(i));
+			vboDrawElements(GL_TRIANGLE_FAN, pCurrentGroup->fansSizes().at(i), m_MeshData.vboIndexType(), pCurrentGroup->fansOffset().at(i));
 		}
 	}
 }
@@ -540,7 +586,7 @@ void GLC_Mesh::vboDrawInSelectionModePrimitivesOf(GLC_PrimitiveGroup* pCurrentGr
 		{
 			glc::encodeRgbId(pCurrentGroup->triangleGroupId(i), colorId);
 			glColor3ubv(colorId);
-			glDrawElements(GL_TRIANGLES, pCurrentGroup->trianglesIndexSizes().at(i), GL_UNSIGNED_INT, pCurrentGroup->trianglesGroupOffset().at(i));
+			vboDrawElements(GL_TRIANGLES, pCurrentGroup->trianglesIndexSizes().at(i), m_MeshData.vboIndexType(), pCurrentGroup->trianglesGroupOffset().at(i));
 		}
 	}
 
@@ -552,7 +598,7 @@ void GLC_Mesh::vboDrawInSelectionModePrimitivesOf(GLC_PrimitiveGroup* pCurrentGr
 		{
 			glc::encodeRgbId(pCurrentGroup->stripGroupId(i), colorId);
 			glColor3ubv(colorId);
-			glDrawElements(GL_TRIANGLE_STRIP, pCurrentGroup->stripsSizes().at(i), GL_UNSIGNED_INT, pCurrentGroup->stripsOffset().at(i));
+			vboDrawElements(GL_TRIANGLE_STRIP, pCurrentGroup->stripsSizes().at(i), m_MeshData.vboIndexType(), pCurrentGroup->stripsOffset().at(i));
 		}
 	}
 
@@ -565,7 +611,7 @@ void GLC_Mesh::vboDrawInSelectionModePrimitivesOf(GLC_PrimitiveGroup* pCurrentGr
 			glc::encodeRgbId(pCurrentGroup->fanGroupId(i), colorId);
 			glColor3ubv(colorId);
 
-			glDrawElements(GL_TRIANGLE_FAN, pCurrentGroup->fansSizes().at(i), GL_UNSIGNED_INT, pCurrentGroup->fansOffset().at(i));
+			vboDrawElements(GL_TRIANGLE_FAN, pCurrentGroup->fansSizes().at(i), m_MeshData.vboIndexType(), pCurrentGroup->fansOffset().at(i));
 		}
 	}
 
@@ -649,7 +695,7 @@ void GLC_Mesh::vboDrawPrimitivesGroupOf(GLC_PrimitiveGroup* pCurrentGroup, GLC_M
 			}
 			if (pCurrentLocalMaterial->isTransparent() == isTransparent)
 			{
-				glDrawElements(GL_TRIANGLES, pCurrentGroup->trianglesIndexSizes().at(i), GL_UNSIGNED_INT, pCurrentGroup->trianglesGroupOffset().at(i));
+				vboDrawElements(GL_TRIANGLES, pCurrentGroup->trianglesIndexSizes().at(i), m_MeshData.vboIndexType(), pCurrentGroup->trianglesGroupOffset().at(i));
 			}
 		}
 	}
@@ -677,7 +723,7 @@ void GLC_Mesh::vboDrawPrimitivesGroupOf(GLC_PrimitiveGroup* pCurrentGroup, GLC_M
 			}
 			if (pCurrentLocalMaterial->isTransparent() == isTransparent)
 			{
-				glDrawElements(GL_TRIANGLE_STRIP, pCurrentGroup->stripsSizes().at(i), GL_UNSIGNED_INT, pCurrentGroup->stripsOffset().at(i));
+				vboDrawElements(GL_TRIANGLE_STRIP, pCurrentGroup->stripsSizes().at(i), m_MeshData.vboIndexType(), pCurrentGroup->stripsOffset().at(i));
 			}
 		}
 	}
@@ -705,7 +751,7 @@ void GLC_Mesh::vboDrawPrimitivesGroupOf(GLC_PrimitiveGroup* pCurrentGroup, GLC_M
 			}
 			if (pCurrentLocalMaterial->isTransparent() == isTransparent)
 			{
-				glDrawElements(GL_TRIANGLE_FAN, pCurrentGroup->fansSizes().at(i), GL_UNSIGNED_INT, pCurrentGroup->fansOffset().at(i));
+				vboDrawElements(GL_TRIANGLE_FAN, pCurrentGroup->fansSizes().at(i), m_MeshData.vboIndexType(), pCurrentGroup->fansOffset().at(i));
 			}
 		}
 	}
@@ -834,7 +880,7 @@ void GLC_Mesh::vboDrawSelectedPrimitivesGroupOf(GLC_PrimitiveGroup* pCurrentGrou
 				{
 					GLC_SelectionMaterial::glExecute();
 					pCurrentLocalMaterial= NULL;
-					glDrawElements(GL_TRIANGLES, pCurrentGroup->trianglesIndexSizes().at(i), GL_UNSIGNED_INT, pCurrentGroup->trianglesGroupOffset().at(i));
+					vboDrawElements(GL_TRIANGLES, pCurrentGroup->trianglesIndexSizes().at(i), m_MeshData.vboIndexType(), pCurrentGroup->trianglesGroupOffset().at(i));
 				}
 			}
 			else if ((NULL != pMaterialHash) && pMaterialHash->contains(currentPrimitiveId))
@@ -847,7 +893,7 @@ void GLC_Mesh::vboDrawSelectedPrimitivesGroupOf(GLC_PrimitiveGroup* pCurrentGrou
 						pCurrentLocalMaterial= pMat;
 						pCurrentLocalMaterial->glExecute();
 					}
-					glDrawElements(GL_TRIANGLES, pCurrentGroup->trianglesIndexSizes().at(i), GL_UNSIGNED_INT, pCurrentGroup->trianglesGroupOffset().at(i));
+					vboDrawElements(GL_TRIANGLES, pCurrentGroup->trianglesIndexSizes().at(i), m_MeshData.vboIndexType(), pCurrentGroup->trianglesGroupOffset().at(i));
 				}
 
 			}
@@ -858,7 +904,7 @@ void GLC_Mesh::vboDrawSelectedPrimitivesGroupOf(GLC_PrimitiveGroup* pCurrentGrou
 					pCurrentLocalMaterial= pCurrentMaterial;
 					pCurrentLocalMaterial->glExecute();
 				}
-				glDrawElements(GL_TRIANGLES, pCurrentGroup->trianglesIndexSizes().at(i), GL_UNSIGNED_INT, pCurrentGroup->trianglesGroupOffset().at(i));
+				vboDrawElements(GL_TRIANGLES, pCurrentGroup->trianglesIndexSizes().at(i), m_MeshData.vboIndexType(), pCurrentGroup->trianglesGroupOffset().at(i));
 			}
 		}
 	}
@@ -877,7 +923,7 @@ void GLC_Mesh::vboDrawSelectedPrimitivesGroupOf(GLC_PrimitiveGroup* pCurrentGrou
 				{
 					GLC_SelectionMaterial::glExecute();
 					pCurrentLocalMaterial= NULL;
-					glDrawElements(GL_TRIANGLE_STRIP, pCurrentGroup->stripsSizes().at(i), GL_UNSIGNED_INT, pCurrentGroup->stripsOffset().at(i));
+					vboDrawElements(GL_TRIANGLE_STRIP, pCurrentGroup->stripsSizes().at(i), m_MeshData.vboIndexType(), pCurrentGroup->stripsOffset().at(i));
 				}
 			}
 			else if ((NULL != pMaterialHash) && pMaterialHash->contains(currentPrimitiveId))
@@ -890,7 +936,7 @@ void GLC_Mesh::vboDrawSelectedPrimitivesGroupOf(GLC_PrimitiveGroup* pCurrentGrou
 						pCurrentLocalMaterial= pMat;
 						pCurrentLocalMaterial->glExecute();
 					}
-					glDrawElements(GL_TRIANGLE_STRIP, pCurrentGroup->stripsSizes().at(i), GL_UNSIGNED_INT, pCurrentGroup->stripsOffset().at(i));
+					vboDrawElements(GL_TRIANGLE_STRIP, pCurrentGroup->stripsSizes().at(i), m_MeshData.vboIndexType(), pCurrentGroup->stripsOffset().at(i));
 				}
 
 			}
@@ -901,7 +947,7 @@ void GLC_Mesh::vboDrawSelectedPrimitivesGroupOf(GLC_PrimitiveGroup* pCurrentGrou
 					pCurrentLocalMaterial= pCurrentMaterial;
 					pCurrentLocalMaterial->glExecute();
 				}
-				glDrawElements(GL_TRIANGLE_STRIP, pCurrentGroup->stripsSizes().at(i), GL_UNSIGNED_INT, pCurrentGroup->stripsOffset().at(i));
+				vboDrawElements(GL_TRIANGLE_STRIP, pCurrentGroup->stripsSizes().at(i), m_MeshData.vboIndexType(), pCurrentGroup->stripsOffset().at(i));
 			}
 		}
 	}
@@ -920,7 +966,7 @@ void GLC_Mesh::vboDrawSelectedPrimitivesGroupOf(GLC_PrimitiveGroup* pCurrentGrou
 				{
 					GLC_SelectionMaterial::glExecute();
 					pCurrentLocalMaterial= NULL;
-					glDrawElements(GL_TRIANGLE_FAN, pCurrentGroup->fansSizes().at(i), GL_UNSIGNED_INT, pCurrentGroup->fansOffset().at(i));
+					vboDrawElements(GL_TRIANGLE_FAN, pCurrentGroup->fansSizes().at(i), m_MeshData.vboIndexType(), pCurrentGroup->fansOffset().at(i));
 				}
 			}
 			else if ((NULL != pMaterialHash) && pMaterialHash->contains(currentPrimitiveId))
@@ -933,7 +979,7 @@ void GLC_Mesh::vboDrawSelectedPrimitivesGroupOf(GLC_PrimitiveGroup* pCurrentGrou
 						pCurrentLocalMaterial= pMat;
 						pCurrentLocalMaterial->glExecute();
 					}
-					glDrawElements(GL_TRIANGLE_FAN, pCurrentGroup->fansSizes().at(i), GL_UNSIGNED_INT, pCurrentGroup->fansOffset().at(i));
+					vboDrawElements(GL_TRIANGLE_FAN, pCurrentGroup->fansSizes().at(i), m_MeshData.vboIndexType(), pCurrentGroup->fansOffset().at(i));
 				}
 
 			}
@@ -944,7 +990,7 @@ void GLC_Mesh::vboDrawSelectedPrimitivesGroupOf(GLC_PrimitiveGroup* pCurrentGrou
 					pCurrentLocalMaterial= pCurrentMaterial;
 					pCurrentLocalMaterial->glExecute();
 				}
-				glDrawElements(GL_TRIANGLE_FAN, pCurrentGroup->fansSizes().at(i), GL_UNSIGNED_INT, pCurrentGroup->fansOffset().at(i));
+				vboDrawElements(GL_TRIANGLE_FAN, pCurrentGroup->fansSizes().at(i), m_MeshData.vboIndexType(), pCurrentGroup->fansOffset().at(i));
 			}
 		}
 	}
@@ -1106,24 +1152,50 @@ void GLC_Mesh::vertexArrayDrawSelectedPrimitivesGroupOf(GLC_PrimitiveGroup* pCur
 }
 
 // Activate mesh VBOs and IBO of the current LOD
-void GLC_Mesh::activateVboAndIbo()
+bool GLC_Mesh::activateVboAndIbo()
 {
     GLC_Context* pContext= GLC_ContextManager::instance()->currentContext();
+    const GLC_VertexCompression::Compression compression= m_MeshData.vboCompression();
 
 	// Activate Vertices VBO
     m_MeshData.useVBO(GLC_MeshData::GLC_Vertex);
-    pContext->glcUseVertexPointer(0);
+    if (compression.testFlag(GLC_VertexCompression::QuantizedPosition))
+    {
+        pContext->glcUseVertexPointer(0, 3, GL_UNSIGNED_SHORT, GL_TRUE);
+    }
+    else
+    {
+        pContext->glcUseVertexPointer(0);
+    }
 
 	// Activate Normals VBO
     m_MeshData.useVBO(GLC_MeshData::GLC_Normal);
-    pContext->glcUseNormalPointer(0);
+    if (compression.testFlag(GLC_VertexCompression::OctahedralNormal16))
+    {
+        pContext->glcUseNormalPointer(0, 2, GL_UNSIGNED_SHORT, GL_TRUE);
+    }
+    else if (compression.testFlag(GLC_VertexCompression::OctahedralNormal8))
+    {
+        pContext->glcUseNormalPointer(0, 2, GL_UNSIGNED_BYTE, GL_TRUE);
+    }
+    else
+    {
+        pContext->glcUseNormalPointer(0);
+    }
 
 	// Activate texel VBO if needed
     if (m_MeshData.useVBO(GLC_MeshData::GLC_Texel))
 	{
-        pContext->glcUseTexturePointer(0);
+        pContext->glcUseTexturePointer(0, compression.testFlag(GLC_VertexCompression::HalfFloatTexel) ? GL_HALF_FLOAT : GL_FLOAT);
 	}
 
+	// Decode compressed vertex attributes in the shader
+    if (compression != GLC_VertexCompression::NoCompression)
+    {
+        const bool decodeNormal= compression.testFlag(GLC_VertexCompression::OctahedralNormal8) || compression.testFlag(GLC_VertexCompression::OctahedralNormal16);
+        pContext->glcSetVertexDecoding(compression.testFlag(GLC_VertexCompression::QuantizedPosition), m_MeshData.positionOffset(), m_MeshData.positionScale(), decodeNormal);
+    }
+
 	// Activate Color VBO if needed
     if ((m_ColorPearVertex && !m_IsSelected && !GLC_State::isInSelectionMode()) && m_MeshData.useVBO(GLC_MeshData::GLC_Color))
 	{
@@ -1132,7 +1204,7 @@ void GLC_Mesh::activateVboAndIbo()
         pContext->glcUseColorPointer(0);
 	}
 
-	m_MeshData.useIBO(true, m_CurrentLod);
+	return m_MeshData.useIBO(true, m_CurrentLod);
 }
 
 // Activate vertex Array
@@ -45,8 +45,13 @@ GLC_MeshData::GLC_MeshData()
     , m_TexelsSize(-1)
     , m_ColorSize(-1)
     , m_UseVbo(false)
+    , m_VboCompression(GLC_VertexCompression::NoCompression)
 {
-
+	for (int i= 0; i < 3; ++i)
+	{
+		m_PositionOffset[i]= 0.0f;
+		m_PositionScale[i]= 1.0f;
+	}
 }
 
 // Copy constructor
@@ -64,7 +69,14 @@ GLC_MeshData::GLC_MeshData(const GLC_MeshData& meshData)
     , m_TexelsSize(-1)
     , m_ColorSize(-1)
     , m_UseVbo(meshData.m_UseVbo)
+    , m_VboCompression(GLC_VertexCompression::NoCompression)
 {
+	for (int i= 0; i < 3; ++i)
+	{
+		m_PositionOffset[i]= 0.0f;
+		m_PositionScale[i]= 1.0f;
+	}
+
 	// Copy meshData LOD list
 	const int size= meshData.m_LodList.size();
 	for (int i= 0; i < size; ++i)
@@ -131,6 +143,34 @@ void GLC_MeshData::finishLod()
 	}
 }
 
+// Reorder the given vector of the given number of components by vertex
+static void reorderVertexVector(GLfloatVector* pVector, const QVector<GLuint>& remap, int componentCount)
+{
+	const int vertexCount= remap.size();
+	if (pVector->size() != (vertexCount * componentCount)) return;
+
+	GLfloatVector reordered(pVector->size());
+	for (int i= 0; i < vertexCount; ++i)
+	{
+		const int source= i * componentCount;
+		const int target= static_cast<int>(remap.at(i)) * componentCount;
+		for (int j= 0; j < componentCount; ++j)
+		{
+			reordered[target + j]= pVector->at(source + j);
+		}
+	}
+	pVector->swap(reordered);
+}
+
+void GLC_MeshData::reorderVertices(const QVector<GLuint>& remap)
+{
+	Q_ASSERT(remap.size() == (m_Positions.size() / 3));
+	reorderVertexVector(&m_Positions, remap, 3);
+	reorderVertexVector(&m_Normals, remap, 3);
+	reorderVertexVector(&m_Texels, remap, 2);
+	reorderVertexVector(&m_Colors, remap, 4);
+}
+
 // Clear the content of the meshData and makes it empty
 void GLC_MeshData::clear()
 {
@@ -141,6 +181,7 @@ void GLC_MeshData::clear()
 	m_PositionSize= -1;
 	m_TexelsSize= -1;
 	m_ColorSize= -1;
+	m_VboCompression= GLC_VertexCompression::NoCompression;
 
 	// Delete Main Vbo ID
 	if (m_VertexBuffer.isCreated())
@@ -241,6 +282,31 @@ void GLC_MeshData::setVboUsage(bool usage)
 	m_UseVbo= usage;
 }
 
+void GLC_MeshData::setVboCompression(GLC_VertexCompression::Compression compression)
+{
+	// 16 bits normals are used if both normal encodings are set
+	if (compression.testFlag(GLC_VertexCompression::OctahedralNormal16))
+	{
+		compression&= ~GLC_VertexCompression::OctahedralNormal8;
+	}
+	if ((m_Positions.size() / 3) > GLC_VertexCompression::shortIndexMaxVertexCount())
+	{
+		compression&= ~GLC_VertexCompression::ShortIndex;
+	}
+#ifdef GLC_OPENGL_ES_2
+	// Half float vertex attributes are not in OpenGL ES 2.0
+	compression&= ~GLC_VertexCompression::HalfFloatTexel;
+#endif
+	m_VboCompression= compression;
+
+	const bool useShortIndex= m_VboCompression.testFlag(GLC_VertexCompression::ShortIndex);
+	const int lodCount= m_LodList.count();
+	for (int i= 0; i < lodCount; ++i)
+	{
+		m_LodList.at(i)->setShortIndexUsage(useShortIndex);
+	}
+}
+
 //////////////////////////////////////////////////////////////////////
 // OpenGL Functions
 //////////////////////////////////////////////////////////////////////
@@ -324,31 +390,65 @@ bool GLC_MeshData::useVBO(GLC_MeshData::VboType vboType)
     return result;
 }
 
+// Allocate the given buffer with the given compressed data
+template <typename T>
+static void allocateCompressedBuffer(QOpenGLBuffer* pBuffer, const QVector<T>& data)
+{
+	const GLsizeiptr dataSize= static_cast<GLsizeiptr>(data.size()) * sizeof(T);
+	pBuffer->allocate(data.constData(), dataSize);
+}
+
 void GLC_MeshData::fillVbo(GLC_MeshData::VboType type)
 {
 	// Chose the right VBO
 	if (type == GLC_MeshData::GLC_Vertex)
 	{
         useVBO(type);
-		const GLsizei dataNbr= static_cast<GLsizei>(m_Positions.size());
-		const GLsizeiptr dataSize= dataNbr * sizeof(GLfloat);
-		m_VertexBuffer.allocate(m_Positions.data(), dataSize);
+		if (m_VboCompression.testFlag(GLC_VertexCompression::QuantizedPosition))
+		{
+			GLC_VertexCompression::positionBounds(m_Positions, m_PositionOffset, m_PositionScale);
+			allocateCompressedBuffer(&m_VertexBuffer, GLC_VertexCompression::quantizePositions(m_Positions, m_PositionOffset, m_PositionScale));
+		}
+		else
+		{
+			const GLsizei dataNbr= static_cast<GLsizei>(m_Positions.size());
+			const GLsizeiptr dataSize= dataNbr * sizeof(GLfloat);
+			m_VertexBuffer.allocate(m_Positions.data(), dataSize);
+		}
 
 		m_PositionSize= m_Positions.size();
 	}
 	else if (type == GLC_MeshData::GLC_Normal)
 	{
         useVBO(type);
-		const GLsizei dataNbr= static_cast<GLsizei>(m_Normals.size());
-		const GLsizeiptr dataSize= dataNbr * sizeof(GLfloat);
-		m_NormalBuffer.allocate(m_Normals.data(), dataSize);
+		if (m_VboCompression.testFlag(GLC_VertexCompression::OctahedralNormal16))
+		{
+			allocateCompressedBuffer(&m_NormalBuffer, GLC_VertexCompression::encodeNormals16(m_Normals));
+		}
+		else if (m_VboCompression.testFlag(GLC_VertexCompression::OctahedralNormal8))
+		{
+			allocateCompressedBuffer(&m_NormalBuffer, GLC_VertexCompression::encodeNormals8(m_Normals));
+		}
+		else
+		{
+			const GLsizei dataNbr= static_cast<GLsizei>(m_Normals.size());
+			const GLsizeiptr dataSize= dataNbr * sizeof(GLfloat);
+			m_NormalBuffer.allocate(m_Normals.data(), dataSize);
+		}
 	}
 	else if ((type == GLC_MeshData::GLC_Texel) && m_TexelBuffer.isCreated())
 	{
         useVBO(type);
-		const GLsizei dataNbr= static_cast<GLsizei>(m_Texels.size());
-		const GLsizeiptr dataSize= dataNbr * sizeof(GLfloat);
-		m_TexelBuffer.allocate(m_Texels.data(), dataSize);
+		if (m_VboCompression.testFlag(GLC_VertexCompression::HalfFloatTexel))
+		{
+			allocateCompressedBuffer(&m_TexelBuffer, GLC_VertexCompression::encodeHalfFloats(m_Texels));
+		}
+		else
+		{
+			const GLsizei dataNbr= static_cast<GLsizei>(m_Texels.size());
+			const GLsizeiptr dataSize= dataNbr * sizeof(GLfloat);
+			m_TexelBuffer.allocate(m_Texels.data(), dataSize);
+		}
 
 		m_TexelsSize= m_Texels.size();
 	}
@@ -371,6 +471,46 @@ void GLC_MeshData::fillLodIbo()
 		m_LodList.at(i)->fillIbo();
 	}
 }
+//////////////////////////////////////////////////////////////////////
+// Binary serialisation Functions
+//////////////////////////////////////////////////////////////////////
+void GLC_MeshData::saveLodLayoutToDataStream(QDataStream& stream) const
+{
+	quint32 chunckId= m_ChunkId;
+	stream << chunckId;
+
+	const int lodCount= m_LodList.size();
+	stream << lodCount;
+	for (int i= 0; i < lodCount; ++i)
+	{
+		stream << m_LodList.at(i)->accuracy();
+		stream << m_LodList.at(i)->trianglesCount();
+	}
+}
+
+void GLC_MeshData::loadLodLayoutFromDataStream(QDataStream& stream)
+{
+	quint32 chunckId;
+	stream >> chunckId;
+	Q_ASSERT(chunckId == m_ChunkId);
+
+	clear();
+
+	int lodCount;
+	stream >> lodCount;
+	for (int i= 0; i < lodCount; ++i)
+	{
+		double accuracy;
+		unsigned int trianglesCount;
+		stream >> accuracy;
+		stream >> trianglesCount;
+
+		GLC_Lod* pLod= new GLC_Lod(accuracy);
+		pLod->trianglesAdded(trianglesCount);
+		m_LodList.append(pLod);
+	}
+}
+
 // Non Member methods
 // Non-member stream operator
 QDataStream &operator<<(QDataStream &stream, const GLC_MeshData &meshData)
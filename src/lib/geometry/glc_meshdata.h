@@ -29,6 +29,7 @@
 #include <QOpenGLBuffer>
 
 #include "glc_lod.h"
+#include "glc_vertexcompression.h"
 #include "../glc_global.h"
 
 #include "../glc_config.h"
@@ -163,6 +164,26 @@ public:
 	inline bool positionSizeIsSet() const
 	{return m_PositionSize != -1;}
 
+	//! Return the compression of the VBOs and IBOs
+	inline GLC_VertexCompression::Compression vboCompression() const
+	{return m_VboCompression;}
+
+	//! Return the type of the IBO index
+	inline GLenum vboIndexType() const
+	{return m_VboCompression.testFlag(GLC_VertexCompression::ShortIndex) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;}
+
+	//! Return the size in bytes of the IBO index
+	inline GLsizei vboIndexSize() const
+	{return m_VboCompression.testFlag(GLC_VertexCompression::ShortIndex) ? sizeof(GLushort) : sizeof(GLuint);}
+
+	//! Return the offset of quantized positions, an array of 3 floats
+	inline const GLfloat* positionOffset() const
+	{return m_PositionOffset;}
+
+	//! Return the scale of quantized positions, an array of 3 floats
+	inline const GLfloat* positionScale() const
+	{return m_PositionScale;}
+
 //@}
 
 //////////////////////////////////////////////////////////////////////
@@ -180,6 +201,10 @@ public:
 	//! Clear the content of the meshData and makes it empty
 	void clear();
 
+	//! Move each vertex to its index in the given remap
+	/*! Positions, normals, texels and colors are reordered, the index of the LODs are unchanged*/
+	void reorderVertices(const QVector<GLuint>& remap);
+
 	//! Release client VBO
 	void releaseVboClientSide(bool update= false);
 
@@ -194,12 +219,32 @@ public:
 	//! Set VBO usage
 	void setVboUsage(bool usage);
 
+	//! Set the compression of the VBOs and IBOs
+	/*! Take effect the next time the VBOs are filled. 16 bits index are used only if
+	 *  the mesh has no more than 65536 vertices*/
+	void setVboCompression(GLC_VertexCompression::Compression compression);
+
 	//! Init the position size
 	inline void initPositionSize()
 	{m_PositionSize= m_Positions.size();}
 
 //@}
 
+//////////////////////////////////////////////////////////////////////
+/*! \name Binary serialisation Functions*/
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Save the LOD layout (accuracy and triangle count) to binary data stream
+	/*! Vertex attributes and index vectors are not saved*/
+	void saveLodLayoutToDataStream(QDataStream&) const;
+
+	//! Load the LOD layout from binary data stream
+	/*! The mesh data is cleared, vertex attributes and index must be set afterwards*/
+	void loadLodLayoutFromDataStream(QDataStream&);
+
+//@}
+
 //////////////////////////////////////////////////////////////////////
 /*! \name OpenGL Functions*/
 //@{
@@ -211,11 +256,12 @@ public:
 	//! Ibo Usage
     bool useVBO(GLC_MeshData::VboType vboType);
 
-	//! Ibo Usage
-	inline void useIBO(bool use, const int currentLod= 0)
+	//! Ibo Usage, return false if the given LOD is empty
+	inline bool useIBO(bool use, const int currentLod= 0)
 	{
-		if (use) m_LodList.at(currentLod)->useIBO();
-        else QOpenGLBuffer::release(QOpenGLBuffer::IndexBuffer);
+		if (use) return m_LodList.at(currentLod)->useIBO();
+        QOpenGLBuffer::release(QOpenGLBuffer::IndexBuffer);
+        return true;
 	}
 
 	//! Fill all LOD IBO
@@ -270,6 +316,15 @@ private:
 	//! Use VBO
 	bool m_UseVbo;
 
+	//! The compression of the VBOs and IBOs
+	GLC_VertexCompression::Compression m_VboCompression;
+
+	//! The offset of quantized positions
+	GLfloat m_PositionOffset[3];
+
+	//! The scale of quantized positions
+	GLfloat m_PositionScale[3];
+
 	//! Class chunk id
 	static quint32 m_ChunkId;
 };
@@ -0,0 +1,481 @@
+/****************************************************************************
+
+ This file is part of the GLC-lib library.
+ Copyright (C) 2005-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ http://glc-lib.sourceforge.net
+
+ GLC-lib is free software; you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation; either version 3 of the License, or
+ (at your option) any later version.
+
+ GLC-lib is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with GLC-lib; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+
+//! \file glc_meshsimplifier.cpp implementation for the GLC_MeshSimplifier class.
+
+#include <QtConcurrent>
+#include <QHash>
+#include <algorithm>
+#include <cmath>
+
+#include "glc_meshsimplifier.h"
+#include "glc_mesh.h"
+#include "glc_sharpedgeextractor.h"
+#include "../maths/glc_vector3d.h"
+
+// Symmetric 4x4 matrix of the sum of squared distances to planes
+class MeshSimplifierQuadric
+{
+public:
+	MeshSimplifierQuadric()
+	{
+		for (int i= 0; i < 10; ++i) m_Values[i]= 0.0;
+	}
+
+	//! Add the plane of the given unit normal and offset
+	inline void addPlane(double a, double b, double c, double d)
+	{
+		m_Values[0]+= a * a; m_Values[1]+= a * b; m_Values[2]+= a * c; m_Values[3]+= a * d;
+		m_Values[4]+= b * b; m_Values[5]+= b * c; m_Values[6]+= b * d;
+		m_Values[7]+= c * c; m_Values[8]+= c * d;
+		m_Values[9]+= d * d;
+	}
+
+	inline void add(const MeshSimplifierQuadric& other)
+	{
+		for (int i= 0; i < 10; ++i) m_Values[i]+= other.m_Values[i];
+	}
+
+	//! Return the error of the given position for the sum of this quadric and the other one
+	inline double error(const MeshSimplifierQuadric& other, double x, double y, double z) const
+	{
+		double q[10];
+		for (int i= 0; i < 10; ++i) q[i]= m_Values[i] + other.m_Values[i];
+		const double subject= q[0] * x * x + 2.0 * q[1] * x * y + 2.0 * q[2] * x * z + 2.0 * q[3] * x
+				+ q[4] * y * y + 2.0 * q[5] * y * z + 2.0 * q[6] * y
+				+ q[7] * z * z + 2.0 * q[8] * z
+				+ q[9];
+		return qMax(0.0, subject);
+	}
+
+	double m_Values[10];
+};
+
+// The collapse of a vertex onto one of its neighbours
+class MeshSimplifierCollapse
+{
+public:
+	inline bool operator<(const MeshSimplifierCollapse& other) const
+	{return m_Cost < other.m_Cost;}
+
+	double m_Cost;
+	int m_From;
+	int m_To;
+};
+
+// The working data of the simplification of a mesh
+class MeshSimplifierState
+{
+public:
+	MeshSimplifierState(const GLfloatVector& positions)
+		: m_Positions(positions)
+		, m_pPositions(m_Positions.constData())
+		, m_VertexCount(positions.size() / 3)
+		, m_Faces()
+		, m_FaceMaterials()
+		, m_Quadrics(m_VertexCount)
+		, m_Locked(m_VertexCount, false)
+		, m_Error(0.0)
+	{}
+
+	inline int faceCount() const
+	{return m_Faces.size() / 3;}
+
+	inline GLC_Vector3d position(int vertex) const
+	{return GLC_Vector3d(m_pPositions[3 * vertex], m_pPositions[3 * vertex + 1], m_pPositions[3 * vertex + 2]);}
+
+	//! Return the non normalized normal of the given triangle
+	inline GLC_Vector3d normal(int v0, int v1, int v2) const
+	{return (position(v1) - position(v0)) ^ (position(v2) - position(v0));}
+
+	//! Add the faces of the master LOD and compute the quadrics
+	void setFaces(const QList<IndexList>& materialsIndex);
+
+	//! Lock the vertices which must not be removed
+	void lockVertices(double weldPrecision, double sharpEdgeAngle);
+
+	//! Collapse vertices until the given face count is reached, return false if no collapse is possible
+	bool collapsePass(int targetFaceCount);
+
+	//! Return the triangles index of each of the given materials
+	QHash<GLC_uint, IndexList> trianglesIndex(const QList<GLC_uint>& materialIds) const;
+
+private:
+	//! Return true if the collapse does not change the topology and does not flip triangles
+	bool canCollapse(int from, int to, const QVector<int>& offsets, const QVector<int>& vertexFaces) const;
+
+public:
+	GLfloatVector m_Positions;
+	const float* m_pPositions;
+	int m_VertexCount;
+	QVector<int> m_Faces;
+	QVector<int> m_FaceMaterials;
+	QVector<MeshSimplifierQuadric> m_Quadrics;
+	QVector<bool> m_Locked;
+	double m_Error;
+};
+
+void MeshSimplifierState::setFaces(const QList<IndexList>& materialsIndex)
+{
+	const int materialCount= materialsIndex.count();
+	for (int material= 0; material < materialCount; ++material)
+	{
+		const IndexList& indexList= materialsIndex.at(material);
+		const int count= indexList.count() / 3;
+		for (int i= 0; i < count; ++i)
+		{
+			const int v0= indexList.at(3 * i);
+			const int v1= indexList.at(3 * i + 1);
+			const int v2= indexList.at(3 * i + 2);
+			if ((v0 == v1) || (v1 == v2) || (v2 == v0)) continue;
+
+			m_Faces << v0 << v1 << v2;
+			m_FaceMaterials << material;
+
+			GLC_Vector3d faceNormal(normal(v0, v1, v2));
+			const double length= faceNormal.length();
+			if (length > glc::EPSILON)
+			{
+				faceNormal= faceNormal * (1.0 / length);
+				const double d= -(faceNormal * position(v0));
+				for (int j= 0; j < 3; ++j)
+				{
+					m_Quadrics[m_Faces.at(m_Faces.size() - 3 + j)].addPlane(faceNormal.x(), faceNormal.y(), faceNormal.z(), d);
+				}
+			}
+		}
+	}
+}
+
+void MeshSimplifierState::lockVertices(double weldPrecision, double sharpEdgeAngle)
+{
+	// Seam, sharp, boundary and non manifold vertices
+	IndexList allIndex;
+	const int indexCount= m_Faces.size();
+	for (int i= 0; i < indexCount; ++i)
+	{
+		allIndex.append(m_Faces.at(i));
+	}
+
+	GLC_SharpEdgeExtractor extractor(weldPrecision, sharpEdgeAngle);
+	extractor.extract(m_Positions, allIndex);
+	const QVector<int>& weldedIndexes= extractor.weldedIndexes();
+
+	QVector<bool> weldedLocked(extractor.weldedVertexCount(), false);
+	const int edgeCount= extractor.edgeCount();
+	for (int edge= 0; edge < edgeCount; ++edge)
+	{
+		if (GLC_SharpEdgeExtractor::SmoothEdge != extractor.edgeType(edge))
+		{
+			const QPair<int, int> vertices(extractor.edgeVertices(edge));
+			weldedLocked[vertices.first]= true;
+			weldedLocked[vertices.second]= true;
+		}
+	}
+
+	// A welded vertex used by more than one vertex is on a seam, a vertex used by more than one material is on a material boundary
+	QVector<int> weldedUsers(extractor.weldedVertexCount(), -1);
+	QVector<int> vertexMaterials(m_VertexCount, -1);
+	const int faceCount= this->faceCount();
+	for (int face= 0; face < faceCount; ++face)
+	{
+		for (int i= 0; i < 3; ++i)
+		{
+			const int vertex= m_Faces.at(3 * face + i);
+			const int welded= weldedIndexes.at(vertex);
+			if (-1 == weldedUsers.at(welded)) weldedUsers[welded]= vertex;
+			else if (weldedUsers.at(welded) != vertex) weldedLocked[welded]= true;
+
+			if (-1 == vertexMaterials.at(vertex)) vertexMaterials[vertex]= m_FaceMaterials.at(face);
+			else if (vertexMaterials.at(vertex) != m_FaceMaterials.at(face)) m_Locked[vertex]= true;
+		}
+	}
+
+	for (int vertex= 0; vertex < m_VertexCount; ++vertex)
+	{
+		if (weldedLocked.at(weldedIndexes.at(vertex))) m_Locked[vertex]= true;
+	}
+}
+
+bool MeshSimplifierState::collapsePass(int targetFaceCount)
+{
+	const int faceCount= this->faceCount();
+
+	// Faces of each vertex
+	QVector<int> offsets(m_VertexCount + 1, 0);
+	for (int i= 0; i < m_Faces.size(); ++i)
+	{
+		++offsets[m_Faces.at(i) + 1];
+	}
+	for (int i= 0; i < m_VertexCount; ++i)
+	{
+		offsets[i + 1]+= offsets.at(i);
+	}
+	QVector<int> vertexFaces(offsets.last());
+	QVector<int> fill(offsets);
+	for (int face= 0; face < faceCount; ++face)
+	{
+		for (int i= 0; i < 3; ++i)
+		{
+			vertexFaces[fill[m_Faces.at(3 * face + i)]++]= face;
+		}
+	}
+
+	// Candidate collapses sorted by error
+	QVector<MeshSimplifierCollapse> collapses;
+	collapses.reserve(3 * faceCount);
+	for (int face= 0; face < faceCount; ++face)
+	{
+		for (int i= 0; i < 3; ++i)
+		{
+			const int v1= m_Faces.at(3 * face + i);
+			const int v2= m_Faces.at(3 * face + (i + 1) % 3);
+			for (int j= 0; j < 2; ++j)
+			{
+				const int from= (0 == j) ? v1 : v2;
+				const int to= (0 == j) ? v2 : v1;
+				if (m_Locked.at(from)) continue;
+
+				MeshSimplifierCollapse collapse;
+				collapse.m_From= from;
+				collapse.m_To= to;
+				collapse.m_Cost= m_Quadrics.at(from).error(m_Quadrics.at(to), m_pPositions[3 * to], m_pPositions[3 * to + 1], m_pPositions[3 * to + 2]);
+				collapses.append(collapse);
+			}
+		}
+	}
+	std::sort(collapses.begin(), collapses.end());
+
+	// Collapse vertices whose neighbourhood is unchanged in this pass
+	QVector<bool> touched(m_VertexCount, false);
+	QVector<int> remap(m_VertexCount);
+	for (int i= 0; i < m_VertexCount; ++i) remap[i]= i;
+
+	int currentFaceCount= faceCount;
+	bool collapsed= false;
+	const int collapseCount= collapses.size();
+	for (int i= 0; (i < collapseCount) && (currentFaceCount > targetFaceCount); ++i)
+	{
+		const MeshSimplifierCollapse& collapse= collapses.at(i);
+		const int from= collapse.m_From;
+		const int to= collapse.m_To;
+		if (touched.at(from) || touched.at(to)) continue;
+		if (!canCollapse(from, to, offsets, vertexFaces)) continue;
+
+		for (int j= offsets.at(from); j < offsets.at(from + 1); ++j)
+		{
+			const int face= vertexFaces.at(j);
+			bool containsTo= false;
+			for (int k= 0; k < 3; ++k)
+			{
+				touched[m_Faces.at(3 * face + k)]= true;
+				containsTo= containsTo || (m_Faces.at(3 * face + k) == to);
+			}
+			if (containsTo) --currentFaceCount;
+		}
+		remap[from]= to;
+		m_Quadrics[to].add(m_Quadrics.at(from));
+		m_Error= qMax(m_Error, collapse.m_Cost);
+		collapsed= true;
+	}
+
+	if (collapsed)
+	{
+		QVector<int> faces;
+		QVector<int> faceMaterials;
+		faces.reserve(3 * currentFaceCount);
+		faceMaterials.reserve(currentFaceCount);
+		for (int face= 0; face < faceCount; ++face)
+		{
+			const int v0= remap.at(m_Faces.at(3 * face));
+			const int v1= remap.at(m_Faces.at(3 * face + 1));
+			const int v2= remap.at(m_Faces.at(3 * face + 2));
+			if ((v0 != v1) && (v1 != v2) && (v2 != v0))
+			{
+				faces << v0 << v1 << v2;
+				faceMaterials << m_FaceMaterials.at(face);
+			}
+		}
+		m_Faces.swap(faces);
+		m_FaceMaterials.swap(faceMaterials);
+	}
+
+	return collapsed;
+}
+
+bool MeshSimplifierState::canCollapse(int from, int to, const QVector<int>& offsets, const QVector<int>& vertexFaces) const
+{
+	// The edge must be shared by exactly two faces and the vertices must have exactly two common neighbours
+	QVector<int> fromNeighbours;
+	for (int i= offsets.at(from); i < offsets.at(from + 1); ++i)
+	{
+		const int face= vertexFaces.at(i);
+		for (int k= 0; k < 3; ++k)
+		{
+			const int vertex= m_Faces.at(3 * face + k);
+			if ((vertex != from) && !fromNeighbours.contains(vertex)) fromNeighbours.append(vertex);
+		}
+	}
+
+	QVector<int> commonNeighbours;
+	for (int i= offsets.at(to); i < offsets.at(to + 1); ++i)
+	{
+		const int face= vertexFaces.at(i);
+		for (int k= 0; k < 3; ++k)
+		{
+			const int vertex= m_Faces.at(3 * face + k);
+			if ((vertex != to) && (vertex != from) && fromNeighbours.contains(vertex) && !commonNeighbours.contains(vertex))
+			{
+				commonNeighbours.append(vertex);
+			}
+		}
+	}
+	if (2 != commonNeighbours.size()) return false;
+
+	// The faces which remain must not flip
+	for (int i= offsets.at(from); i < offsets.at(from + 1); ++i)
+	{
+		const int face= vertexFaces.at(i);
+		int vertices[3];
+		bool containsTo= false;
+		for (int k= 0; k < 3; ++k)
+		{
+			vertices[k]= m_Faces.at(3 * face + k);
+			containsTo= containsTo || (vertices[k] == to);
+		}
+		if (containsTo) continue;
+
+		const GLC_Vector3d before(normal(vertices[0], vertices[1], vertices[2]));
+		for (int k= 0; k < 3; ++k)
+		{
+			if (vertices[k] == from) vertices[k]= to;
+		}
+		const GLC_Vector3d after(normal(vertices[0], vertices[1], vertices[2]));
+		if ((before * after) <= 0.0) return false;
+	}
+
+	return true;
+}
+
+QHash<GLC_uint, IndexList> MeshSimplifierState::trianglesIndex(const QList<GLC_uint>& materialIds) const
+{
+	QHash<GLC_uint, IndexList> subject;
+	const int faceCount= this->faceCount();
+	for (int face= 0; face < faceCount; ++face)
+	{
+		IndexList& indexList= subject[materialIds.at(m_FaceMaterials.at(face))];
+		indexList.append(m_Faces.at(3 * face));
+		indexList.append(m_Faces.at(3 * face + 1));
+		indexList.append(m_Faces.at(3 * face + 2));
+	}
+	return subject;
+}
+
+// The simplification of a mesh of a list
+class MeshSimplifierJob
+{
+public:
+	const GLC_MeshSimplifier* m_pSimplifier;
+	GLC_Mesh* m_pMesh;
+	int m_LodCount;
+};
+
+static void simplifyJob(MeshSimplifierJob& job)
+{
+	job.m_LodCount= job.m_pSimplifier->simplify(job.m_pMesh);
+}
+
+GLC_MeshSimplifier::GLC_MeshSimplifier()
+	: m_LodCount(3)
+	, m_ReductionRatio(0.5)
+	, m_MinimumTriangleCount(64)
+	, m_SharpEdgeAngle(60.0)
+	, m_WeldPrecision(0.0)
+{
+
+}
+
+int GLC_MeshSimplifier::simplify(GLC_Mesh* pMesh) const
+{
+	Q_ASSERT(NULL != pMesh);
+	if ((1 != pMesh->lodCount()) || (0 == m_LodCount) || pMesh->positionVector().isEmpty()) return 0;
+
+	// Triangles of the master LOD by material
+	QList<GLC_uint> materialIds;
+	QList<IndexList> materialsIndex;
+	const QList<GLC_uint> meshMaterialIds(pMesh->materialIds());
+	const int materialCount= meshMaterialIds.count();
+	for (int i= 0; i < materialCount; ++i)
+	{
+		const GLC_uint materialId= meshMaterialIds.at(i);
+		if (pMesh->lodContainsMaterial(0, materialId))
+		{
+			materialIds.append(materialId);
+			materialsIndex.append(pMesh->getEquivalentTrianglesStripsFansIndex(0, materialId));
+		}
+	}
+
+	MeshSimplifierState state(pMesh->positionVector());
+	state.setFaces(materialsIndex);
+	if (state.faceCount() < (2 * m_MinimumTriangleCount)) return 0;
+	state.lockVertices(m_WeldPrecision, m_SharpEdgeAngle);
+
+	int lodCreated= 0;
+	bool canContinue= true;
+	while (canContinue && (lodCreated < m_LodCount))
+	{
+		const int previousFaceCount= state.faceCount();
+		const int targetFaceCount= qMax(m_MinimumTriangleCount, static_cast<int>(previousFaceCount * m_ReductionRatio));
+		while ((state.faceCount() > targetFaceCount) && state.collapsePass(targetFaceCount)) {}
+
+		// A LOD must remove at least a tenth of the triangles of the previous one
+		canContinue= state.faceCount() < (previousFaceCount - previousFaceCount / 10);
+		if (canContinue)
+		{
+			canContinue= (-1 != pMesh->appendLod(state.trianglesIndex(materialIds), sqrt(state.m_Error)));
+			if (canContinue) ++lodCreated;
+			canContinue= canContinue && (state.faceCount() > m_MinimumTriangleCount);
+		}
+	}
+
+	return lodCreated;
+}
+
+int GLC_MeshSimplifier::simplify(const QList<GLC_Mesh*>& meshes) const
+{
+	const int count= meshes.count();
+	QVector<MeshSimplifierJob> jobs(count);
+	for (int i= 0; i < count; ++i)
+	{
+		jobs[i].m_pSimplifier= this;
+		jobs[i].m_pMesh= meshes.at(i);
+		jobs[i].m_LodCount= 0;
+	}
+	QtConcurrent::blockingMap(jobs, simplifyJob);
+
+	int subject= 0;
+	for (int i= 0; i < count; ++i)
+	{
+		subject+= jobs.at(i).m_LodCount;
+	}
+	return subject;
+}
@@ -0,0 +1,139 @@
+/****************************************************************************
+
+ This file is part of the GLC-lib library.
+ Copyright (C) 2005-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ http://glc-lib.sourceforge.net
+
+ GLC-lib is free software; you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation; either version 3 of the License, or
+ (at your option) any later version.
+
+ GLC-lib is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with GLC-lib; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+
+//! \file glc_meshsimplifier.h interface for the GLC_MeshSimplifier class.
+
+#ifndef GLC_MESHSIMPLIFIER_H_
+#define GLC_MESHSIMPLIFIER_H_
+
+#include <QList>
+
+#include "../glc_config.h"
+
+class GLC_Mesh;
+
+//////////////////////////////////////////////////////////////////////
+//! \class GLC_MeshSimplifier
+/*! \brief GLC_MeshSimplifier : Generate the LOD chain of meshes with quadric error metrics */
+
+/*! Each LOD is obtained from the previous one by collapsing vertices onto one of their
+ *  neighbours in increasing order of quadric error, so LODs reference the vertices of
+ *  the master LOD and no vertex data is added to the mesh.
+ *
+ *  Vertices on a material boundary, on a texture or normal seam, on a sharp edge,
+ *  on a boundary edge or on a non manifold edge are never removed.
+ *
+ *  The accuracy of a LOD is the square root of the largest quadric error of its collapses,
+ *  an estimation of its distance to the master LOD in mesh units.*/
+//////////////////////////////////////////////////////////////////////
+class GLC_LIB_EXPORT GLC_MeshSimplifier
+{
+//////////////////////////////////////////////////////////////////////
+/*! @name Constructor / Destructor */
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Construct a simplifier generating 3 LOD, each with half the triangles of the previous one
+	GLC_MeshSimplifier();
+//@}
+
+//////////////////////////////////////////////////////////////////////
+/*! \name Get Functions*/
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Return the maximum number of LOD generated in addition to the master LOD
+	inline int lodCount() const
+	{return m_LodCount;}
+
+	//! Return the ratio of triangles kept from a LOD to the next one
+	inline double reductionRatio() const
+	{return m_ReductionRatio;}
+
+	//! Return the minimum number of triangles of a LOD
+	inline int minimumTriangleCount() const
+	{return m_MinimumTriangleCount;}
+
+	//! Return the angle in degrees above which an edge is sharp
+	inline double sharpEdgeAngle() const
+	{return m_SharpEdgeAngle;}
+
+	//! Return the precision used to find vertices of the same position
+	inline double weldPrecision() const
+	{return m_WeldPrecision;}
+//@}
+
+//////////////////////////////////////////////////////////////////////
+/*! \name Set Functions*/
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Set the maximum number of LOD generated in addition to the master LOD
+	inline void setLodCount(int count)
+	{m_LodCount= qMax(0, count);}
+
+	//! Set the ratio of triangles kept from a LOD to the next one
+	inline void setReductionRatio(double ratio)
+	{m_ReductionRatio= qBound(0.01, ratio, 0.95);}
+
+	//! Set the minimum number of triangles of a LOD
+	inline void setMinimumTriangleCount(int count)
+	{m_MinimumTriangleCount= qMax(1, count);}
+
+	//! Set the angle in degrees above which an edge is sharp
+	inline void setSharpEdgeAngle(double angle)
+	{m_SharpEdgeAngle= angle;}
+
+	//! Set the precision used to find vertices of the same position
+	inline void setWeldPrecision(double precision)
+	{m_WeldPrecision= precision;}
+
+	//! Generate the LOD chain of the given finished mesh and return the number of LOD created
+	/*! Meshes which already have LODs, or whose data has been sent to the GPU, are left unchanged*/
+	int simplify(GLC_Mesh* pMesh) const;
+
+	//! Generate the LOD chain of the given meshes in parallel and return the number of LOD created
+	/*! A mesh must appear only once in the list*/
+	int simplify(const QList<GLC_Mesh*>& meshes) const;
+//@}
+
+//////////////////////////////////////////////////////////////////////
+// Private members
+//////////////////////////////////////////////////////////////////////
+private:
+	//! The maximum number of LOD generated
+	int m_LodCount;
+
+	//! The ratio of triangles kept from a LOD to the next one
+	double m_ReductionRatio;
+
+	//! The minimum number of triangles of a LOD
+	int m_MinimumTriangleCount;
+
+	//! The sharp edge angle in degrees
+	double m_SharpEdgeAngle;
+
+	//! The weld precision
+	double m_WeldPrecision;
+};
+
+#endif /* GLC_MESHSIMPLIFIER_H_ */
@@ -167,6 +167,28 @@ void GLC_PrimitiveGroup::addTriangles(const IndexList& input, GLC_uint id)
 	else Q_ASSERT(m_TrianglesId.isEmpty());
 }
 
+void GLC_PrimitiveGroup::setTrianglesIndex(const IndexList& input)
+{
+	Q_ASSERT(!m_IsFinished);
+	Q_ASSERT(input.size() == m_TrianglesIndex.size());
+	m_TrianglesIndex= input;
+}
+
+void GLC_PrimitiveGroup::remapIndex(const QVector<GLuint>& remap)
+{
+	Q_ASSERT(!m_IsFinished);
+	IndexList* indexLists[3]= {&m_TrianglesIndex, &m_StripsIndex, &m_FansIndex};
+	for (int i= 0; i < 3; ++i)
+	{
+		IndexList& indexList= *(indexLists[i]);
+		const int size= indexList.size();
+		for (int j= 0; j < size; ++j)
+		{
+			indexList[j]= remap.at(indexList.at(j));
+		}
+	}
+}
+
 // Add triangle strip to the group
 void GLC_PrimitiveGroup::addTrianglesStrip(const IndexList& input, GLC_uint id)
 {
@@ -275,27 +297,27 @@ void GLC_PrimitiveGroup::setBaseTrianglesFanOffseti(int offset)
 }
 
 // Change index to VBO mode
-void GLC_PrimitiveGroup::computeVboOffset()
+void GLC_PrimitiveGroup::computeVboOffset(GLsizei indexSize)
 {
 	m_TrianglesGroupOffset.clear();
 	const int triangleOffsetSize= m_TrianglesGroupOffseti.size();
 	for (int i= 0; i < triangleOffsetSize; ++i)
 	{
-		m_TrianglesGroupOffset.append(BUFFER_OFFSET(static_cast<GLsizei>(m_TrianglesGroupOffseti.at(i)) * sizeof(GLuint)));
+		m_TrianglesGroupOffset.append(BUFFER_OFFSET(static_cast<GLsizei>(m_TrianglesGroupOffseti.at(i)) * indexSize));
 	}
 
 	m_StripIndexOffset.clear();
 	const int stripOffsetSize= m_StripIndexOffseti.size();
 	for (int i= 0; i < stripOffsetSize; ++i)
 	{
-		m_StripIndexOffset.append(BUFFER_OFFSET(static_cast<GLsizei>(m_StripIndexOffseti.at(i)) * sizeof(GLuint)));
+		m_StripIndexOffset.append(BUFFER_OFFSET(static_cast<GLsizei>(m_StripIndexOffseti.at(i)) * indexSize));
 	}
 
 	m_FanIndexOffset.clear();
 	const int fanOffsetSize= m_FanIndexOffseti.size();
 	for (int i= 0; i < fanOffsetSize; ++i)
 	{
-		m_FanIndexOffset.append(BUFFER_OFFSET(static_cast<GLsizei>(m_FanIndexOffseti.at(i)) * sizeof(GLuint)));
+		m_FanIndexOffset.append(BUFFER_OFFSET(static_cast<GLsizei>(m_FanIndexOffseti.at(i)) * indexSize));
 	}
 }
 
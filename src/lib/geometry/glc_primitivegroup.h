@@ -219,6 +219,14 @@ public:
 	//! Add triangles to the group
 	void addTriangles(const IndexList& input, GLC_uint id= 0);
 
+	//! Replace the triangles index of the group by the given index of the same size
+	/*! Used to reorder triangles before the group is finished*/
+	void setTrianglesIndex(const IndexList& input);
+
+	//! Replace each vertex index of the group by its value in the given remap
+	/*! The group must not be finished*/
+	void remapIndex(const QVector<GLuint>& remap);
+
 	//! Set the triangle index offset
 	void setTrianglesOffset(GLvoid* pOffset);
 
@@ -244,7 +252,8 @@ public:
 	void setBaseTrianglesFanOffseti(int);
 
 	//! Compute VBO offset
-	void computeVboOffset();
+	/*! The given index size is the size in bytes of the IBO index*/
+	void computeVboOffset(GLsizei indexSize= sizeof(GLuint));
 
 	//! The mesh wich use this group is finished
 	inline void finish()
@@ -0,0 +1,408 @@
+/****************************************************************************
+
+ This file is part of the GLC-lib library.
+ Copyright (C) 2005-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ http://glc-lib.sourceforge.net
+
+ GLC-lib is free software; you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation; either version 3 of the License, or
+ (at your option) any later version.
+
+ GLC-lib is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with GLC-lib; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+
+//! \file glc_sharpedgeextractor.cpp implementation for the GLC_SharpEdgeExtractor class.
+
+#include <QtConcurrent>
+#include <QHash>
+#include <cmath>
+
+#include "glc_sharpedgeextractor.h"
+#include "glc_wiredata.h"
+#include "../maths/glc_vector3d.h"
+#include "../maths/glc_utils_maths.h"
+
+// Number of faces or edges of a job
+static const int sharpEdgeChunkSize= 4096;
+
+// A cell of the weld spatial hash
+class SharpEdgeCell
+{
+public:
+	SharpEdgeCell(qint64 x, qint64 y, qint64 z)
+		: m_X(x)
+		, m_Y(y)
+		, m_Z(z)
+	{}
+
+	inline bool operator==(const SharpEdgeCell& other) const
+	{return (m_X == other.m_X) && (m_Y == other.m_Y) && (m_Z == other.m_Z);}
+
+	qint64 m_X;
+	qint64 m_Y;
+	qint64 m_Z;
+};
+
+inline uint qHash(const SharpEdgeCell& cell)
+{
+	return qHash(cell.m_X) ^ (qHash(cell.m_Y) * 73856093u) ^ (qHash(cell.m_Z) * 19349663u);
+}
+
+// The arrays shared by the jobs of an extraction
+class SharpEdgeContext
+{
+public:
+	const float* m_pPositions;
+	const int* m_pFaceVertices;
+	GLC_Vector3d* m_pFaceNormals;
+	const int* m_pEdgeFaces;
+	const char* m_pEdgeForwards;
+	const int* m_pEdgeFaceCounts;
+	int* m_pEdgeClasses;
+	double m_CosThreshold;
+};
+
+// A range of faces or edges
+class SharpEdgeJob
+{
+public:
+	const SharpEdgeContext* m_pContext;
+	int m_Begin;
+	int m_End;
+};
+
+// Compute the normal of the faces of the given job, null for degenerated faces
+static void computeFaceNormals(SharpEdgeJob& job)
+{
+	const SharpEdgeContext* pContext= job.m_pContext;
+	const float* pPositions= pContext->m_pPositions;
+	for (int face= job.m_Begin; face < job.m_End; ++face)
+	{
+		const float* p0= pPositions + 3 * pContext->m_pFaceVertices[3 * face];
+		const float* p1= pPositions + 3 * pContext->m_pFaceVertices[3 * face + 1];
+		const float* p2= pPositions + 3 * pContext->m_pFaceVertices[3 * face + 2];
+		const GLC_Vector3d v1(p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]);
+		const GLC_Vector3d v2(p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]);
+		GLC_Vector3d normal(v1 ^ v2);
+		const double length= normal.length();
+		if (length > glc::EPSILON)
+		{
+			normal= normal * (1.0 / length);
+		}
+		else
+		{
+			normal.setVect(0.0, 0.0, 0.0);
+		}
+		pContext->m_pFaceNormals[face]= normal;
+	}
+}
+
+// Classify the edges of the given job, each edge is written by one job only
+static void classifyEdges(SharpEdgeJob& job)
+{
+	const SharpEdgeContext* pContext= job.m_pContext;
+	for (int edge= job.m_Begin; edge < job.m_End; ++edge)
+	{
+		const int faceCount= pContext->m_pEdgeFaceCounts[edge];
+		int edgeClass= GLC_SharpEdgeExtractor::SmoothEdge;
+		if (1 == faceCount)
+		{
+			edgeClass= GLC_SharpEdgeExtractor::BoundaryEdge;
+		}
+		else if (faceCount > 2)
+		{
+			edgeClass= GLC_SharpEdgeExtractor::NonManifoldEdge;
+		}
+		else
+		{
+			const GLC_Vector3d& normal1= pContext->m_pFaceNormals[pContext->m_pEdgeFaces[2 * edge]];
+			const GLC_Vector3d& normal2= pContext->m_pFaceNormals[pContext->m_pEdgeFaces[2 * edge + 1]];
+			if (!normal1.isNull() && !normal2.isNull())
+			{
+				// Faces of consistent orientation run through their common edge in opposite directions
+				double cosAngle= normal1 * normal2;
+				if (pContext->m_pEdgeForwards[2 * edge] == pContext->m_pEdgeForwards[2 * edge + 1])
+				{
+					cosAngle= -cosAngle;
+				}
+				if (cosAngle <= pContext->m_CosThreshold)
+				{
+					edgeClass= GLC_SharpEdgeExtractor::SharpEdge;
+				}
+			}
+		}
+		pContext->m_pEdgeClasses[edge]= edgeClass;
+	}
+}
+
+// Run the given function on count items, in parallel if there are enough items
+static void runSharpEdgeJobs(int count, const SharpEdgeContext* pContext, void (*pFunction)(SharpEdgeJob&))
+{
+	if (0 == count) return;
+
+	const int jobCount= (count + sharpEdgeChunkSize - 1) / sharpEdgeChunkSize;
+	QVector<SharpEdgeJob> jobs(jobCount);
+	for (int i= 0; i < jobCount; ++i)
+	{
+		jobs[i].m_pContext= pContext;
+		jobs[i].m_Begin= i * sharpEdgeChunkSize;
+		jobs[i].m_End= qMin(count, (i + 1) * sharpEdgeChunkSize);
+	}
+
+	if (1 == jobCount)
+	{
+		pFunction(jobs[0]);
+	}
+	else
+	{
+		QtConcurrent::blockingMap(jobs, pFunction);
+	}
+}
+
+GLC_SharpEdgeExtractor::GLC_SharpEdgeExtractor(double precision, double angleThreshold)
+	: m_Precision(precision)
+	, m_AngleThreshold(angleThreshold)
+	, m_EdgeTypes(SharpEdge)
+	, m_Positions()
+	, m_WeldedIndexes()
+	, m_EdgeVertices()
+	, m_EdgeClasses()
+	, m_Polylines()
+{
+
+}
+
+int GLC_SharpEdgeExtractor::edgeCount(EdgeType type) const
+{
+	return m_EdgeClasses.count(static_cast<int>(type));
+}
+
+void GLC_SharpEdgeExtractor::extract(const GLfloatVector& positions, const IndexList& trianglesIndex)
+{
+	m_Positions.clear();
+	m_WeldedIndexes.clear();
+	m_EdgeVertices.clear();
+	m_EdgeClasses.clear();
+	m_Polylines.clear();
+
+	weld(positions);
+
+	// The faces on welded vertices, degenerated faces are skipped
+	const int triangleCount= trianglesIndex.size() / 3;
+	QVector<int> faceVertices;
+	faceVertices.reserve(trianglesIndex.size());
+	for (int i= 0; i < triangleCount; ++i)
+	{
+		const int v0= m_WeldedIndexes.at(trianglesIndex.at(3 * i));
+		const int v1= m_WeldedIndexes.at(trianglesIndex.at(3 * i + 1));
+		const int v2= m_WeldedIndexes.at(trianglesIndex.at(3 * i + 2));
+		if ((v0 != v1) && (v1 != v2) && (v2 != v0))
+		{
+			faceVertices << v0 << v1 << v2;
+		}
+	}
+	const int faceCount= faceVertices.size() / 3;
+
+	// The edge to faces map, the first two faces of each edge are kept
+	QHash<quint64, int> edgeIndexes;
+	edgeIndexes.reserve(faceCount * 3 / 2);
+	QVector<int> edgeFaces;
+	QVector<char> edgeForwards;
+	QVector<int> edgeFaceCounts;
+	for (int face= 0; face < faceCount; ++face)
+	{
+		for (int i= 0; i < 3; ++i)
+		{
+			const int v1= faceVertices.at(3 * face + i);
+			const int v2= faceVertices.at(3 * face + (i + 1) % 3);
+			const quint64 key= (static_cast<quint64>(qMin(v1, v2)) << 32) | static_cast<quint32>(qMax(v1, v2));
+			QHash<quint64, int>::iterator iEdge= edgeIndexes.find(key);
+			if (iEdge == edgeIndexes.end())
+			{
+				const int edge= edgeFaceCounts.size();
+				edgeIndexes.insert(key, edge);
+				m_EdgeVertices << qMin(v1, v2) << qMax(v1, v2);
+				edgeFaces << face << -1;
+				edgeForwards << static_cast<char>(v1 < v2) << 0;
+				edgeFaceCounts << 1;
+			}
+			else
+			{
+				const int edge= iEdge.value();
+				if (1 == edgeFaceCounts.at(edge))
+				{
+					edgeFaces[2 * edge + 1]= face;
+					edgeForwards[2 * edge + 1]= static_cast<char>(v1 < v2);
+				}
+				++edgeFaceCounts[edge];
+			}
+		}
+	}
+	const int edgeCount= edgeFaceCounts.size();
+
+	// Face normals and edge classification
+	QVector<GLC_Vector3d> faceNormals(faceCount);
+	m_EdgeClasses.resize(edgeCount);
+
+	SharpEdgeContext context;
+	context.m_pPositions= m_Positions.constData();
+	context.m_pFaceVertices= faceVertices.constData();
+	context.m_pFaceNormals= faceNormals.data();
+	context.m_pEdgeFaces= edgeFaces.constData();
+	context.m_pEdgeForwards= edgeForwards.constData();
+	context.m_pEdgeFaceCounts= edgeFaceCounts.constData();
+	context.m_pEdgeClasses= m_EdgeClasses.data();
+	context.m_CosThreshold= cos(glc::toRadian(m_AngleThreshold));
+
+	runSharpEdgeJobs(faceCount, &context, computeFaceNormals);
+	runSharpEdgeJobs(edgeCount, &context, classifyEdges);
+
+	chainEdges();
+}
+
+void GLC_SharpEdgeExtractor::addPolylinesTo(GLC_WireData* pWireData) const
+{
+	Q_ASSERT(NULL != pWireData);
+	const int count= m_Polylines.count();
+	for (int i= 0; i < count; ++i)
+	{
+		pWireData->addVerticeGroup(m_Polylines.at(i));
+	}
+}
+
+void GLC_SharpEdgeExtractor::weld(const GLfloatVector& positions)
+{
+	const int vertexCount= positions.size() / 3;
+	m_WeldedIndexes.resize(vertexCount);
+
+	// Points closer than the precision are in the same or in adjacent cells
+	const double cellSize= qMax(m_Precision, glc::EPSILON);
+	const double squaredPrecision= m_Precision * m_Precision;
+	QHash<SharpEdgeCell, int> cellHeads;
+	cellHeads.reserve(vertexCount);
+	QVector<int> nextInCell;
+	nextInCell.reserve(vertexCount);
+	m_Positions.reserve(positions.size());
+
+	for (int i= 0; i < vertexCount; ++i)
+	{
+		const float x= positions.at(3 * i);
+		const float y= positions.at(3 * i + 1);
+		const float z= positions.at(3 * i + 2);
+		const qint64 cellX= static_cast<qint64>(floor(x / cellSize));
+		const qint64 cellY= static_cast<qint64>(floor(y / cellSize));
+		const qint64 cellZ= static_cast<qint64>(floor(z / cellSize));
+
+		int weldedIndex= -1;
+		for (int dx= -1; (dx < 2) && (weldedIndex < 0); ++dx)
+		{
+			for (int dy= -1; (dy < 2) && (weldedIndex < 0); ++dy)
+			{
+				for (int dz= -1; (dz < 2) && (weldedIndex < 0); ++dz)
+				{
+					int candidate= cellHeads.value(SharpEdgeCell(cellX + dx, cellY + dy, cellZ + dz), -1);
+					while ((candidate >= 0) && (weldedIndex < 0))
+					{
+						const double deltaX= m_Positions.at(3 * candidate) - x;
+						const double deltaY= m_Positions.at(3 * candidate + 1) - y;
+						const double deltaZ= m_Positions.at(3 * candidate + 2) - z;
+						if ((deltaX * deltaX + deltaY * deltaY + deltaZ * deltaZ) <= squaredPrecision)
+						{
+							weldedIndex= candidate;
+						}
+						candidate= nextInCell.at(candidate);
+					}
+				}
+			}
+		}
+
+		if (weldedIndex < 0)
+		{
+			weldedIndex= nextInCell.size();
+			m_Positions << x << y << z;
+			const SharpEdgeCell cell(cellX, cellY, cellZ);
+			nextInCell.append(cellHeads.value(cell, -1));
+			cellHeads.insert(cell, weldedIndex);
+		}
+		m_WeldedIndexes[i]= weldedIndex;
+	}
+}
+
+void GLC_SharpEdgeExtractor::chainEdges()
+{
+	const int vertexCount= weldedVertexCount();
+	const int edgeCount= m_EdgeClasses.size();
+	const int selectedTypes= m_EdgeTypes;
+
+	// Incident selected edges of each vertex
+	QVector<int> offsets(vertexCount + 1, 0);
+	for (int edge= 0; edge < edgeCount; ++edge)
+	{
+		if (0 != (m_EdgeClasses.at(edge) & selectedTypes))
+		{
+			++offsets[m_EdgeVertices.at(2 * edge) + 1];
+			++offsets[m_EdgeVertices.at(2 * edge + 1) + 1];
+		}
+	}
+	for (int i= 0; i < vertexCount; ++i)
+	{
+		offsets[i + 1]+= offsets.at(i);
+	}
+	QVector<int> incidentEdges(offsets.last());
+	QVector<int> fill(offsets);
+	for (int edge= 0; edge < edgeCount; ++edge)
+	{
+		if (0 != (m_EdgeClasses.at(edge) & selectedTypes))
+		{
+			incidentEdges[fill[m_EdgeVertices.at(2 * edge)]++]= edge;
+			incidentEdges[fill[m_EdgeVertices.at(2 * edge + 1)]++]= edge;
+		}
+	}
+
+	// Polylines start at vertices which are not inside a chain, then the remaining edges are closed loops
+	QVector<bool> visited(edgeCount, false);
+	for (int pass= 0; pass < 2; ++pass)
+	{
+		for (int start= 0; start < vertexCount; ++start)
+		{
+			const int valence= offsets.at(start + 1) - offsets.at(start);
+			if ((0 == valence) || ((0 == pass) && (2 == valence))) continue;
+
+			for (int i= offsets.at(start); i < offsets.at(start + 1); ++i)
+			{
+				int edge= incidentEdges.at(i);
+				if (visited.at(edge)) continue;
+
+				GLfloatVector polyline;
+				polyline << m_Positions.at(3 * start) << m_Positions.at(3 * start + 1) << m_Positions.at(3 * start + 2);
+				int current= start;
+				while (edge >= 0)
+				{
+					visited[edge]= true;
+					current= (m_EdgeVertices.at(2 * edge) == current) ? m_EdgeVertices.at(2 * edge + 1) : m_EdgeVertices.at(2 * edge);
+					polyline << m_Positions.at(3 * current) << m_Positions.at(3 * current + 1) << m_Positions.at(3 * current + 2);
+
+					// Continue through vertices of valence 2 only
+					edge= -1;
+					if (2 == (offsets.at(current + 1) - offsets.at(current)))
+					{
+						for (int j= offsets.at(current); (j < offsets.at(current + 1)) && (edge < 0); ++j)
+						{
+							if (!visited.at(incidentEdges.at(j))) edge= incidentEdges.at(j);
+						}
+					}
+				}
+				m_Polylines.append(polyline);
+			}
+		}
+	}
+}
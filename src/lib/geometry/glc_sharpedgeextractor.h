@@ -0,0 +1,182 @@
+/****************************************************************************
+
+ This file is part of the GLC-lib library.
+ Copyright (C) 2005-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ http://glc-lib.sourceforge.net
+
+ GLC-lib is free software; you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation; either version 3 of the License, or
+ (at your option) any later version.
+
+ GLC-lib is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with GLC-lib; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+
+//! \file glc_sharpedgeextractor.h interface for the GLC_SharpEdgeExtractor class.
+
+#ifndef GLC_SHARPEDGEEXTRACTOR_H_
+#define GLC_SHARPEDGEEXTRACTOR_H_
+
+#include <QFlags>
+#include <QList>
+#include <QPair>
+#include <QVector>
+
+#include "../glc_global.h"
+
+#include "../glc_config.h"
+
+class GLC_WireData;
+
+//////////////////////////////////////////////////////////////////////
+//! \class GLC_SharpEdgeExtractor
+/*! \brief GLC_SharpEdgeExtractor : Extract feature lines of a triangle list */
+
+/*! Positions closer than the precision are welded with a spatial hash,
+ *  then an edge to faces map is built in one pass over the triangles.
+ *  Edges are classified in parallel :
+ *  - sharp edge if the dihedral angle of its two faces is not less than the angle threshold
+ *  - boundary edge if it has only one face
+ *  - non manifold edge if it has more than two faces
+ *
+ *  Edges of the selected types are chained into polylines which can be added to a GLC_WireData.*/
+//////////////////////////////////////////////////////////////////////
+class GLC_LIB_EXPORT GLC_SharpEdgeExtractor
+{
+public:
+	//! The type of an edge
+	enum EdgeType
+	{
+		SmoothEdge= 0x0,
+		SharpEdge= 0x1,
+		BoundaryEdge= 0x2,
+		NonManifoldEdge= 0x4
+	};
+	Q_DECLARE_FLAGS(EdgeTypes, EdgeType)
+
+//////////////////////////////////////////////////////////////////////
+/*! @name Constructor / Destructor */
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Construct an extractor with the given weld precision and angle threshold in degrees
+	/*! By default only sharp edges are chained into polylines*/
+	GLC_SharpEdgeExtractor(double precision, double angleThreshold);
+//@}
+
+//////////////////////////////////////////////////////////////////////
+/*! \name Get Functions*/
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Return the weld precision
+	inline double precision() const
+	{return m_Precision;}
+
+	//! Return the angle threshold in degrees
+	inline double angleThreshold() const
+	{return m_AngleThreshold;}
+
+	//! Return the types of edges chained into polylines
+	inline EdgeTypes edgeTypes() const
+	{return m_EdgeTypes;}
+
+	//! Return the number of welded vertices of the last extraction
+	inline int weldedVertexCount() const
+	{return m_Positions.size() / 3;}
+
+	//! Return the number of edges of the last extraction
+	inline int edgeCount() const
+	{return m_EdgeClasses.size();}
+
+	//! Return the number of edges of the given type of the last extraction
+	int edgeCount(EdgeType type) const;
+
+	//! Return the type of the edge of the given index
+	inline EdgeType edgeType(int index) const
+	{return static_cast<EdgeType>(m_EdgeClasses.at(index));}
+
+	//! Return the welded vertices index of the edge of the given index
+	inline QPair<int, int> edgeVertices(int index) const
+	{return qMakePair(m_EdgeVertices.at(2 * index), m_EdgeVertices.at(2 * index + 1));}
+
+	//! Return the welded vertex index of each position of the last extraction
+	inline const QVector<int>& weldedIndexes() const
+	{return m_WeldedIndexes;}
+
+	//! Return the welded positions of the last extraction
+	inline const GLfloatVector& weldedPositions() const
+	{return m_Positions;}
+
+	//! Return the polylines of the last extraction
+	inline const QList<GLfloatVector>& polylines() const
+	{return m_Polylines;}
+//@}
+
+//////////////////////////////////////////////////////////////////////
+/*! \name Set Functions*/
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Set the types of edges chained into polylines
+	inline void setEdgeTypes(EdgeTypes types)
+	{m_EdgeTypes= types;}
+
+	//! Extract the edges of the given triangles
+	/*! The triangles index refer to the given positions (3 floats per vertex)*/
+	void extract(const GLfloatVector& positions, const IndexList& trianglesIndex);
+
+	//! Add the polylines of the last extraction to the given wire data
+	void addPolylinesTo(GLC_WireData* pWireData) const;
+//@}
+
+//////////////////////////////////////////////////////////////////////
+// Private services function
+//////////////////////////////////////////////////////////////////////
+private:
+	//! Weld the given positions and set the welded index of each position
+	void weld(const GLfloatVector& positions);
+
+	//! Chain the edges of the selected types into polylines
+	void chainEdges();
+
+//////////////////////////////////////////////////////////////////////
+// Private members
+//////////////////////////////////////////////////////////////////////
+private:
+	//! The weld precision
+	double m_Precision;
+
+	//! The angle threshold in degrees
+	double m_AngleThreshold;
+
+	//! The types of edges chained into polylines
+	EdgeTypes m_EdgeTypes;
+
+	//! The welded positions
+	GLfloatVector m_Positions;
+
+	//! The welded vertex index of each position
+	QVector<int> m_WeldedIndexes;
+
+	//! The two welded vertices of each edge
+	QVector<int> m_EdgeVertices;
+
+	//! The type of each edge
+	QVector<int> m_EdgeClasses;
+
+	//! The polylines of the selected edges
+	QList<GLfloatVector> m_Polylines;
+};
+
+Q_DECLARE_OPERATORS_FOR_FLAGS(GLC_SharpEdgeExtractor::EdgeTypes)
+
+#endif /* GLC_SHARPEDGEEXTRACTOR_H_ */
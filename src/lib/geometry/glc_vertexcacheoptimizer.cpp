@@ -0,0 +1,335 @@
+/****************************************************************************
+
+ This file is part of the GLC-lib library.
+ Copyright (C) 2005-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ http://glc-lib.sourceforge.net
+
+ GLC-lib is free software; you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation; either version 3 of the License, or
+ (at your option) any later version.
+
+ GLC-lib is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with GLC-lib; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+
+//! \file glc_vertexcacheoptimizer.cpp implementation for the GLC_VertexCacheOptimizer class.
+
+#include <algorithm>
+
+#include "glc_vertexcacheoptimizer.h"
+#include "../maths/glc_vector3d.h"
+
+// A cluster of triangles of the optimized order
+class VertexCacheCluster
+{
+public:
+	//! The most outward facing cluster first
+	inline bool operator<(const VertexCacheCluster& other) const
+	{return m_Key > other.m_Key;}
+
+	double m_Key;
+	int m_Begin;
+	int m_End;
+};
+
+GLC_VertexCacheOptimizer::GLC_VertexCacheOptimizer(int vertexCount, int cacheSize)
+	: m_CacheSize(qMax(3, cacheSize))
+	, m_OverdrawOptimization(true)
+	, m_LocalIndexes(vertexCount, -1)
+	, m_TriangleCount(0)
+	, m_MissesBefore(0)
+	, m_MissesAfter(0)
+{
+
+}
+
+double GLC_VertexCacheOptimizer::acmr(const IndexList& trianglesIndex, int cacheSize)
+{
+	const int indexCount= trianglesIndex.size();
+	if (indexCount < 3) return 0.0;
+
+	QVector<int> index(indexCount);
+	int vertexCount= 0;
+	for (int i= 0; i < indexCount; ++i)
+	{
+		index[i]= static_cast<int>(trianglesIndex.at(i));
+		vertexCount= qMax(vertexCount, index.at(i) + 1);
+	}
+	return static_cast<double>(cacheMisses(index, vertexCount, cacheSize)) / (indexCount / 3);
+}
+
+IndexList GLC_VertexCacheOptimizer::optimize(const IndexList& trianglesIndex, const GLfloatVector& positions)
+{
+	const int indexCount= trianglesIndex.size();
+	const int triangleCount= indexCount / 3;
+	if (0 == triangleCount) return trianglesIndex;
+
+	// Triangles on local vertex index
+	QVector<int> localToGlobal;
+	QVector<int> triangles(indexCount);
+	for (int i= 0; i < indexCount; ++i)
+	{
+		const int vertex= static_cast<int>(trianglesIndex.at(i));
+		Q_ASSERT(vertex < m_LocalIndexes.size());
+		if (m_LocalIndexes.at(vertex) < 0)
+		{
+			m_LocalIndexes[vertex]= localToGlobal.size();
+			localToGlobal.append(vertex);
+		}
+		triangles[i]= m_LocalIndexes.at(vertex);
+	}
+	const int vertexCount= localToGlobal.size();
+	for (int i= 0; i < vertexCount; ++i)
+	{
+		m_LocalIndexes[localToGlobal.at(i)]= -1;
+	}
+
+	const int missesBefore= cacheMisses(triangles, vertexCount, m_CacheSize);
+	m_TriangleCount+= triangleCount;
+	m_MissesBefore+= missesBefore;
+	if (triangleCount < 2)
+	{
+		m_MissesAfter+= missesBefore;
+		return trianglesIndex;
+	}
+
+	QVector<int> clusters;
+	QVector<int> order(tipsify(triangles, vertexCount, &clusters));
+	if (m_OverdrawOptimization && (clusters.size() > 1))
+	{
+		order= sortClusters(order, clusters, trianglesIndex, positions);
+	}
+
+	QVector<int> reordered(indexCount);
+	IndexList subject;
+	subject.reserve(indexCount);
+	for (int i= 0; i < triangleCount; ++i)
+	{
+		const int triangle= order.at(i);
+		for (int j= 0; j < 3; ++j)
+		{
+			reordered[3 * i + j]= triangles.at(3 * triangle + j);
+			subject.append(trianglesIndex.at(3 * triangle + j));
+		}
+	}
+
+	// Keep the original order if it is better
+	const int missesAfter= cacheMisses(reordered, vertexCount, m_CacheSize);
+	if (missesAfter > missesBefore)
+	{
+		m_MissesAfter+= missesBefore;
+		return trianglesIndex;
+	}
+	m_MissesAfter+= missesAfter;
+
+	return subject;
+}
+
+QVector<int> GLC_VertexCacheOptimizer::tipsify(const QVector<int>& triangles, int vertexCount, QVector<int>* pClusters) const
+{
+	const int triangleCount= triangles.size() / 3;
+
+	// Triangles of each vertex, the live count is the number of triangles not emitted
+	QVector<int> offsets(vertexCount + 1, 0);
+	for (int i= 0; i < triangles.size(); ++i)
+	{
+		++offsets[triangles.at(i) + 1];
+	}
+	QVector<int> liveCounts(vertexCount);
+	for (int i= 0; i < vertexCount; ++i)
+	{
+		liveCounts[i]= offsets.at(i + 1);
+		offsets[i + 1]+= offsets.at(i);
+	}
+	QVector<int> vertexTriangles(offsets.last());
+	QVector<int> fill(offsets);
+	for (int triangle= 0; triangle < triangleCount; ++triangle)
+	{
+		for (int j= 0; j < 3; ++j)
+		{
+			vertexTriangles[fill[triangles.at(3 * triangle + j)]++]= triangle;
+		}
+	}
+
+	QVector<int> subject;
+	subject.reserve(triangleCount);
+	QVector<int> cacheTimes(vertexCount, 0);
+	QVector<bool> emitted(triangleCount, false);
+	QVector<int> deadEnds;
+	QVector<int> candidates;
+	int time= m_CacheSize + 1;
+	int cursor= 0;
+	int fanning= triangles.at(0);
+	pClusters->append(0);
+
+	while (fanning >= 0)
+	{
+		// Emit the triangles around the fanning vertex
+		candidates.clear();
+		for (int i= offsets.at(fanning); i < offsets.at(fanning + 1); ++i)
+		{
+			const int triangle= vertexTriangles.at(i);
+			if (emitted.at(triangle)) continue;
+
+			emitted[triangle]= true;
+			subject.append(triangle);
+			for (int j= 0; j < 3; ++j)
+			{
+				const int vertex= triangles.at(3 * triangle + j);
+				deadEnds.append(vertex);
+				candidates.append(vertex);
+				--liveCounts[vertex];
+				if ((time - cacheTimes.at(vertex)) > m_CacheSize)
+				{
+					cacheTimes[vertex]= time;
+					++time;
+				}
+			}
+		}
+
+		// The next fanning vertex is the one which stays in the cache the longest after its fan
+		int next= -1;
+		int bestPriority= -1;
+		const int candidateCount= candidates.size();
+		for (int i= 0; i < candidateCount; ++i)
+		{
+			const int vertex= candidates.at(i);
+			if (liveCounts.at(vertex) > 0)
+			{
+				int priority= 0;
+				if ((time - cacheTimes.at(vertex) + 2 * liveCounts.at(vertex)) <= m_CacheSize)
+				{
+					priority= time - cacheTimes.at(vertex);
+				}
+				if (priority > bestPriority)
+				{
+					bestPriority= priority;
+					next= vertex;
+				}
+			}
+		}
+
+		// The cache locality is lost when the next fan does not fit in the cache
+		// or at a dead end, a new cluster begins
+		if ((0 == bestPriority) && (subject.size() < triangleCount))
+		{
+			pClusters->append(subject.size());
+		}
+		else if (next < 0)
+		{
+			while (!deadEnds.isEmpty() && (next < 0))
+			{
+				const int vertex= deadEnds.takeLast();
+				if (liveCounts.at(vertex) > 0) next= vertex;
+			}
+			while ((next < 0) && (cursor < vertexCount))
+			{
+				if (liveCounts.at(cursor) > 0) next= cursor;
+				else ++cursor;
+			}
+			if ((next >= 0) && (subject.size() < triangleCount))
+			{
+				pClusters->append(subject.size());
+			}
+		}
+		fanning= next;
+	}
+	Q_ASSERT(subject.size() == triangleCount);
+
+	return subject;
+}
+
+QVector<int> GLC_VertexCacheOptimizer::sortClusters(const QVector<int>& order, const QVector<int>& clusters, const IndexList& trianglesIndex, const GLfloatVector& positions) const
+{
+	const int clusterCount= clusters.size();
+	QVector<VertexCacheCluster> sortedClusters(clusterCount);
+	QVector<GLC_Vector3d> centroids(clusterCount);
+	QVector<GLC_Vector3d> normals(clusterCount);
+	GLC_Vector3d meshCentroid;
+	double meshArea= 0.0;
+
+	for (int i= 0; i < clusterCount; ++i)
+	{
+		VertexCacheCluster& cluster= sortedClusters[i];
+		cluster.m_Begin= clusters.at(i);
+		cluster.m_End= (i + 1 < clusterCount) ? clusters.at(i + 1) : order.size();
+
+		// Area weighted centroid and normal of the cluster
+		GLC_Vector3d centroid;
+		GLC_Vector3d normal;
+		double area= 0.0;
+		for (int j= cluster.m_Begin; j < cluster.m_End; ++j)
+		{
+			GLC_Vector3d points[3];
+			for (int k= 0; k < 3; ++k)
+			{
+				const int vertex= static_cast<int>(trianglesIndex.at(3 * order.at(j) + k));
+				points[k].setVect(positions.at(3 * vertex), positions.at(3 * vertex + 1), positions.at(3 * vertex + 2));
+			}
+			const GLC_Vector3d triangleNormal((points[1] - points[0]) ^ (points[2] - points[0]));
+			const double triangleArea= triangleNormal.length();
+			normal+= triangleNormal;
+			centroid+= (points[0] + points[1] + points[2]) * (triangleArea / 3.0);
+			area+= triangleArea;
+		}
+		if (area > 0.0)
+		{
+			meshCentroid+= centroid;
+			meshArea+= area;
+			centroid= centroid * (1.0 / area);
+		}
+		centroids[i]= centroid;
+		normals[i]= normal;
+	}
+	if (meshArea > 0.0)
+	{
+		meshCentroid= meshCentroid * (1.0 / meshArea);
+	}
+
+	for (int i= 0; i < clusterCount; ++i)
+	{
+		GLC_Vector3d normal(normals.at(i));
+		const double length= normal.length();
+		sortedClusters[i].m_Key= (length > 0.0) ? ((centroids.at(i) - meshCentroid) * normal) / length : 0.0;
+	}
+	std::stable_sort(sortedClusters.begin(), sortedClusters.end());
+
+	QVector<int> subject;
+	subject.reserve(order.size());
+	for (int i= 0; i < clusterCount; ++i)
+	{
+		for (int j= sortedClusters.at(i).m_Begin; j < sortedClusters.at(i).m_End; ++j)
+		{
+			subject.append(order.at(j));
+		}
+	}
+	return subject;
+}
+
+int GLC_VertexCacheOptimizer::cacheMisses(const QVector<int>& index, int vertexCount, int cacheSize)
+{
+	// FIFO cache, a vertex is in the cache if less than cacheSize vertices entered it since
+	QVector<int> cacheTimes(vertexCount, 0);
+	int time= cacheSize + 1;
+	int subject= 0;
+	const int indexCount= index.size();
+	for (int i= 0; i < indexCount; ++i)
+	{
+		const int vertex= index.at(i);
+		if ((time - cacheTimes.at(vertex)) > cacheSize)
+		{
+			cacheTimes[vertex]= time;
+			++time;
+			++subject;
+		}
+	}
+	return subject;
+}
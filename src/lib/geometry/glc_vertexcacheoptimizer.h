@@ -0,0 +1,135 @@
+/****************************************************************************
+
+ This file is part of the GLC-lib library.
+ Copyright (C) 2005-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ http://glc-lib.sourceforge.net
+
+ GLC-lib is free software; you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation; either version 3 of the License, or
+ (at your option) any later version.
+
+ GLC-lib is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with GLC-lib; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+
+//! \file glc_vertexcacheoptimizer.h interface for the GLC_VertexCacheOptimizer class.
+
+#ifndef GLC_VERTEXCACHEOPTIMIZER_H_
+#define GLC_VERTEXCACHEOPTIMIZER_H_
+
+#include <QVector>
+
+#include "../glc_global.h"
+
+#include "../glc_config.h"
+
+//////////////////////////////////////////////////////////////////////
+//! \class GLC_VertexCacheOptimizer
+/*! \brief GLC_VertexCacheOptimizer : Reorder triangles for the post transform vertex cache and overdraw */
+
+/*! Triangles are reordered with the Tipsify algorithm (Sander, Nehab and Barczak 2007),
+ *  which fans around vertices likely to be in a FIFO cache of the given size.
+ *  The sequence is cut into clusters where the cache locality is lost, then
+ *  clusters are sorted from the most outward facing one to reduce overdraw.
+ *
+ *  The optimizer accumulates the average cache miss ratio (ACMR), the number of
+ *  cache misses per triangle, before and after the optimization of each triangle list.*/
+//////////////////////////////////////////////////////////////////////
+class GLC_LIB_EXPORT GLC_VertexCacheOptimizer
+{
+//////////////////////////////////////////////////////////////////////
+/*! @name Constructor / Destructor */
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Construct an optimizer for triangles of the given number of vertices
+	explicit GLC_VertexCacheOptimizer(int vertexCount, int cacheSize= 16);
+//@}
+
+//////////////////////////////////////////////////////////////////////
+/*! \name Get Functions*/
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Return the simulated cache size
+	inline int cacheSize() const
+	{return m_CacheSize;}
+
+	//! Return true if clusters are sorted to reduce overdraw
+	inline bool overdrawOptimizationIsUsed() const
+	{return m_OverdrawOptimization;}
+
+	//! Return the number of optimized triangles
+	inline int triangleCount() const
+	{return m_TriangleCount;}
+
+	//! Return the ACMR of the triangles before optimization
+	inline double acmrBefore() const
+	{return (m_TriangleCount > 0) ? static_cast<double>(m_MissesBefore) / m_TriangleCount : 0.0;}
+
+	//! Return the ACMR of the triangles after optimization
+	inline double acmrAfter() const
+	{return (m_TriangleCount > 0) ? static_cast<double>(m_MissesAfter) / m_TriangleCount : 0.0;}
+
+	//! Return the ACMR of the given triangles index for a FIFO cache of the given size
+	static double acmr(const IndexList& trianglesIndex, int cacheSize= 16);
+//@}
+
+//////////////////////////////////////////////////////////////////////
+/*! \name Set Functions*/
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Set the overdraw optimization usage
+	inline void setOverdrawOptimizationUsage(bool usage)
+	{m_OverdrawOptimization= usage;}
+
+	//! Return the given triangles index reordered, the given positions are used to reduce overdraw
+	IndexList optimize(const IndexList& trianglesIndex, const GLfloatVector& positions);
+//@}
+
+//////////////////////////////////////////////////////////////////////
+// Private services function
+//////////////////////////////////////////////////////////////////////
+private:
+	//! Return the triangle order of the given local triangles and set the first triangle of each cluster
+	QVector<int> tipsify(const QVector<int>& triangles, int vertexCount, QVector<int>* pClusters) const;
+
+	//! Sort the clusters of the given triangle order from the most outward facing one
+	QVector<int> sortClusters(const QVector<int>& order, const QVector<int>& clusters, const IndexList& trianglesIndex, const GLfloatVector& positions) const;
+
+	//! Return the number of cache misses of the given local triangles index
+	static int cacheMisses(const QVector<int>& index, int vertexCount, int cacheSize);
+
+//////////////////////////////////////////////////////////////////////
+// Private members
+//////////////////////////////////////////////////////////////////////
+private:
+	//! The simulated cache size
+	int m_CacheSize;
+
+	//! Overdraw optimization usage
+	bool m_OverdrawOptimization;
+
+	//! The local index of each vertex, -1 outside of optimize()
+	QVector<int> m_LocalIndexes;
+
+	//! The number of optimized triangles
+	int m_TriangleCount;
+
+	//! The cache misses before optimization
+	qint64 m_MissesBefore;
+
+	//! The cache misses after optimization
+	qint64 m_MissesAfter;
+};
+
+#endif /* GLC_VERTEXCACHEOPTIMIZER_H_ */
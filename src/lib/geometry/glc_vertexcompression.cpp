@@ -0,0 +1,281 @@
+/****************************************************************************
+
+ This file is part of the GLC-lib library.
+ Copyright (C) 2005-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ http://glc-lib.sourceforge.net
+
+ GLC-lib is free software; you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation; either version 3 of the License, or
+ (at your option) any later version.
+
+ GLC-lib is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with GLC-lib; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+
+//! \file glc_vertexcompression.cpp implementation for the GLC_VertexCompression class.
+
+#include <cmath>
+#include <cstring>
+
+#include "glc_vertexcompression.h"
+
+// The maximum value of 16 bits unsigned integers
+static const double maxUnsignedShort= 65535.0;
+
+// The maximum value of 8 bits unsigned integers
+static const double maxUnsignedByte= 255.0;
+
+// Return the sign of the given value, the sign of 0 is 1
+static inline double signNotZero(double value)
+{
+	return (value >= 0.0) ? 1.0 : -1.0;
+}
+
+// Return the given value in the [-1, 1] range mapped to an unsigned integer of the given maximum value
+static inline int toUnsignedNormalized(double value, double maxValue)
+{
+	return qBound(0, qRound((value * 0.5 + 0.5) * maxValue), static_cast<int>(maxValue));
+}
+
+// Octahedral encode the given normals
+template <typename T>
+static QVector<T> encodeOctahedral(const GLfloatVector& normals, double maxValue)
+{
+	const int normalCount= normals.size() / 3;
+	QVector<T> subject(normalCount * 2);
+	for (int i= 0; i < normalCount; ++i)
+	{
+		double x= normals.at(3 * i);
+		double y= normals.at(3 * i + 1);
+		double z= normals.at(3 * i + 2);
+
+		// Project the normal on the octahedron and fold the lower hemisphere
+		const double norm= qAbs(x) + qAbs(y) + qAbs(z);
+		if (norm > 0.0)
+		{
+			x/= norm;
+			y/= norm;
+			z/= norm;
+		}
+		if (z < 0.0)
+		{
+			const double foldedX= (1.0 - qAbs(y)) * signNotZero(x);
+			const double foldedY= (1.0 - qAbs(x)) * signNotZero(y);
+			x= foldedX;
+			y= foldedY;
+		}
+		subject[2 * i]= static_cast<T>(toUnsignedNormalized(x, maxValue));
+		subject[2 * i + 1]= static_cast<T>(toUnsignedNormalized(y, maxValue));
+	}
+	return subject;
+}
+
+// Decode the given octahedral encoded normals
+template <typename T>
+static GLfloatVector decodeOctahedral(const QVector<T>& encoded, double maxValue)
+{
+	const int normalCount= encoded.size() / 2;
+	GLfloatVector subject(normalCount * 3);
+	for (int i= 0; i < normalCount; ++i)
+	{
+		const double encodedX= 2.0 * (encoded.at(2 * i) / maxValue) - 1.0;
+		const double encodedY= 2.0 * (encoded.at(2 * i + 1) / maxValue) - 1.0;
+		double x= encodedX;
+		double y= encodedY;
+		const double z= 1.0 - qAbs(encodedX) - qAbs(encodedY);
+		if (z < 0.0)
+		{
+			x= (1.0 - qAbs(encodedY)) * signNotZero(encodedX);
+			y= (1.0 - qAbs(encodedX)) * signNotZero(encodedY);
+		}
+		const double length= sqrt(x * x + y * y + z * z);
+		subject[3 * i]= static_cast<GLfloat>(x / length);
+		subject[3 * i + 1]= static_cast<GLfloat>(y / length);
+		subject[3 * i + 2]= static_cast<GLfloat>(z / length);
+	}
+	return subject;
+}
+
+// Return the given float as an half float rounded to the nearest
+static GLushort floatToHalf(GLfloat value)
+{
+	quint32 bits;
+	memcpy(&bits, &value, sizeof(bits));
+	const quint32 sign= (bits >> 16) & 0x8000;
+	const quint32 absBits= bits & 0x7FFFFFFF;
+
+	quint32 subject;
+	if (absBits >= 0x7F800000)
+	{
+		// Infinity or NaN
+		subject= sign | 0x7C00 | ((absBits > 0x7F800000) ? 0x0200 : 0);
+	}
+	else if (absBits >= 0x477FF000)
+	{
+		// Overflow
+		subject= sign | 0x7C00;
+	}
+	else if (absBits < 0x38800000)
+	{
+		// Subnormal half float, the unit is 2^-24
+		subject= sign | static_cast<quint32>(qRound(qAbs(value) * 16777216.0f));
+	}
+	else
+	{
+		// Rebias the exponent and round the mantissa to the nearest even
+		const quint32 rounded= absBits + 0x0FFF + ((absBits >> 13) & 1);
+		subject= sign | ((rounded - 0x38000000) >> 13);
+	}
+	return static_cast<GLushort>(subject);
+}
+
+// Return the float of the given half float
+static GLfloat halfToFloat(GLushort value)
+{
+	const quint32 sign= static_cast<quint32>(value & 0x8000) << 16;
+	const quint32 exponent= (value >> 10) & 0x1F;
+	const quint32 mantissa= value & 0x03FF;
+
+	quint32 bits;
+	if (0 == exponent)
+	{
+		// Zero or subnormal
+		const GLfloat magnitude= static_cast<GLfloat>(mantissa) / 16777216.0f;
+		return (0 != sign) ? -magnitude : magnitude;
+	}
+	else if (0x1F == exponent)
+	{
+		bits= sign | 0x7F800000 | (mantissa << 13);
+	}
+	else
+	{
+		bits= sign | ((exponent + 112) << 23) | (mantissa << 13);
+	}
+	GLfloat subject;
+	memcpy(&subject, &bits, sizeof(subject));
+	return subject;
+}
+
+//////////////////////////////////////////////////////////////////////
+// Get Functions
+//////////////////////////////////////////////////////////////////////
+
+void GLC_VertexCompression::positionBounds(const GLfloatVector& positions, GLfloat* pOffset, GLfloat* pScale)
+{
+	const int vertexCount= positions.size() / 3;
+	for (int j= 0; j < 3; ++j)
+	{
+		GLfloat minValue= (vertexCount > 0) ? positions.at(j) : 0.0f;
+		GLfloat maxValue= minValue;
+		for (int i= 1; i < vertexCount; ++i)
+		{
+			const GLfloat value= positions.at(3 * i + j);
+			minValue= qMin(minValue, value);
+			maxValue= qMax(maxValue, value);
+		}
+		pOffset[j]= minValue;
+		pScale[j]= maxValue - minValue;
+	}
+}
+
+QVector<GLushort> GLC_VertexCompression::quantizePositions(const GLfloatVector& positions, const GLfloat* pOffset, const GLfloat* pScale)
+{
+	const int size= positions.size();
+	QVector<GLushort> subject(size);
+	for (int i= 0; i < size; ++i)
+	{
+		const int j= i % 3;
+		int quantized= 0;
+		if (pScale[j] > 0.0f)
+		{
+			quantized= qRound((static_cast<double>(positions.at(i)) - pOffset[j]) / pScale[j] * maxUnsignedShort);
+		}
+		subject[i]= static_cast<GLushort>(qBound(0, quantized, static_cast<int>(maxUnsignedShort)));
+	}
+	return subject;
+}
+
+GLfloatVector GLC_VertexCompression::dequantizePositions(const QVector<GLushort>& quantized, const GLfloat* pOffset, const GLfloat* pScale)
+{
+	const int size= quantized.size();
+	GLfloatVector subject(size);
+	for (int i= 0; i < size; ++i)
+	{
+		const int j= i % 3;
+		subject[i]= static_cast<GLfloat>(pOffset[j] + pScale[j] * (quantized.at(i) / maxUnsignedShort));
+	}
+	return subject;
+}
+
+QVector<GLubyte> GLC_VertexCompression::encodeNormals8(const GLfloatVector& normals)
+{
+	return encodeOctahedral<GLubyte>(normals, maxUnsignedByte);
+}
+
+QVector<GLushort> GLC_VertexCompression::encodeNormals16(const GLfloatVector& normals)
+{
+	return encodeOctahedral<GLushort>(normals, maxUnsignedShort);
+}
+
+GLfloatVector GLC_VertexCompression::decodeNormals8(const QVector<GLubyte>& encoded)
+{
+	return decodeOctahedral(encoded, maxUnsignedByte);
+}
+
+GLfloatVector GLC_VertexCompression::decodeNormals16(const QVector<GLushort>& encoded)
+{
+	return decodeOctahedral(encoded, maxUnsignedShort);
+}
+
+QVector<GLushort> GLC_VertexCompression::encodeHalfFloats(const GLfloatVector& values)
+{
+	const int size= values.size();
+	QVector<GLushort> subject(size);
+	for (int i= 0; i < size; ++i)
+	{
+		subject[i]= floatToHalf(values.at(i));
+	}
+	return subject;
+}
+
+GLfloatVector GLC_VertexCompression::decodeHalfFloats(const QVector<GLushort>& halfValues)
+{
+	const int size= halfValues.size();
+	GLfloatVector subject(size);
+	for (int i= 0; i < size; ++i)
+	{
+		subject[i]= halfToFloat(halfValues.at(i));
+	}
+	return subject;
+}
+
+QVector<GLushort> GLC_VertexCompression::shortIndex(const QVector<GLuint>& index)
+{
+	const int size= index.size();
+	QVector<GLushort> subject(size);
+	for (int i= 0; i < size; ++i)
+	{
+		Q_ASSERT(index.at(i) < static_cast<GLuint>(shortIndexMaxVertexCount()));
+		subject[i]= static_cast<GLushort>(index.at(i));
+	}
+	return subject;
+}
+
+QVector<GLuint> GLC_VertexCompression::longIndex(const QVector<GLushort>& index)
+{
+	const int size= index.size();
+	QVector<GLuint> subject(size);
+	for (int i= 0; i < size; ++i)
+	{
+		subject[i]= index.at(i);
+	}
+	return subject;
+}
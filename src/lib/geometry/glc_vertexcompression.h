@@ -0,0 +1,120 @@
+/****************************************************************************
+
+ This file is part of the GLC-lib library.
+ Copyright (C) 2005-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ http://glc-lib.sourceforge.net
+
+ GLC-lib is free software; you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation; either version 3 of the License, or
+ (at your option) any later version.
+
+ GLC-lib is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with GLC-lib; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+
+//! \file glc_vertexcompression.h interface for the GLC_VertexCompression class.
+
+#ifndef GLC_VERTEXCOMPRESSION_H_
+#define GLC_VERTEXCOMPRESSION_H_
+
+#include <QFlags>
+#include <QVector>
+
+#include "../glc_global.h"
+
+#include "../glc_config.h"
+
+// Half float vertex attribute type of OpenGL 3.0
+#ifndef GL_HALF_FLOAT
+#define GL_HALF_FLOAT 0x140B
+#endif
+
+//////////////////////////////////////////////////////////////////////
+//! \class GLC_VertexCompression
+/*! \brief GLC_VertexCompression : Compact encodings of mesh vertex attributes and index */
+
+/*! The encodings are :
+ *  - Positions quantized to 16 bits unsigned integers in the bounding box of the mesh,
+ *    decoded with position= offset + scale * (quantized / 65535)
+ *  - Normals octahedral encoded in 2x8 or 2x16 bits unsigned integers,
+ *    each component e is mapped to the [-1, 1] range with 2 * (e / max) - 1
+ *  - Texels stored as half floats
+ *  - Index stored as 16 bits unsigned integers if the mesh has no more than 65536 vertices
+ *
+ *  Unsigned integers are used so that normalized vertex attributes decode the same way
+ *  on every OpenGL version.*/
+//////////////////////////////////////////////////////////////////////
+class GLC_LIB_EXPORT GLC_VertexCompression
+{
+public:
+	//! The compressed vertex attributes and index
+	enum CompressionFlag
+	{
+		NoCompression= 0x00,
+		QuantizedPosition= 0x01,
+		OctahedralNormal8= 0x02,
+		OctahedralNormal16= 0x04,
+		HalfFloatTexel= 0x08,
+		ShortIndex= 0x10
+	};
+	Q_DECLARE_FLAGS(Compression, CompressionFlag)
+
+private:
+	GLC_VertexCompression();
+
+//////////////////////////////////////////////////////////////////////
+/*! \name Get Functions*/
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Return the maximum number of vertices of a mesh with 16 bits index
+	inline static int shortIndexMaxVertexCount()
+	{return 65536;}
+
+	//! Set the given offset and scale, arrays of 3 floats, to the bounding box of the given positions
+	static void positionBounds(const GLfloatVector& positions, GLfloat* pOffset, GLfloat* pScale);
+
+	//! Return the given positions quantized in the box of the given offset and scale
+	static QVector<GLushort> quantizePositions(const GLfloatVector& positions, const GLfloat* pOffset, const GLfloat* pScale);
+
+	//! Return the positions of the given quantized positions in the box of the given offset and scale
+	static GLfloatVector dequantizePositions(const QVector<GLushort>& quantized, const GLfloat* pOffset, const GLfloat* pScale);
+
+	//! Return the given normals octahedral encoded in 2x8 bits
+	static QVector<GLubyte> encodeNormals8(const GLfloatVector& normals);
+
+	//! Return the given normals octahedral encoded in 2x16 bits
+	static QVector<GLushort> encodeNormals16(const GLfloatVector& normals);
+
+	//! Return the normals of the given 2x8 bits octahedral encoded normals
+	static GLfloatVector decodeNormals8(const QVector<GLubyte>& encoded);
+
+	//! Return the normals of the given 2x16 bits octahedral encoded normals
+	static GLfloatVector decodeNormals16(const QVector<GLushort>& encoded);
+
+	//! Return the given floats as half floats
+	static QVector<GLushort> encodeHalfFloats(const GLfloatVector& values);
+
+	//! Return the floats of the given half floats
+	static GLfloatVector decodeHalfFloats(const QVector<GLushort>& halfValues);
+
+	//! Return the given index as 16 bits index
+	/*! The given index must be lower than shortIndexMaxVertexCount()*/
+	static QVector<GLushort> shortIndex(const QVector<GLuint>& index);
+
+	//! Return the given 16 bits index as 32 bits index
+	static QVector<GLuint> longIndex(const QVector<GLushort>& index);
+//@}
+};
+
+Q_DECLARE_OPERATORS_FOR_FLAGS(GLC_VertexCompression::Compression)
+
+#endif /* GLC_VERTEXCOMPRESSION_H_ */
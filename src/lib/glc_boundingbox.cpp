@@ -26,6 +26,8 @@
 #include "maths/glc_matrix4x4.h"
 #include "maths/glc_plane.h"
 
+#include <limits>
+
 quint32 GLC_BoundingBox::m_ChunkId= 0xA707;
 
 //////////////////////////////////////////////////////////////////////
@@ -124,6 +126,43 @@ bool GLC_BoundingBox::intersect(const GLC_Plane& plane) const
     return subject;
 }
 
+bool GLC_BoundingBox::intersectRay(const GLC_Line3d& ray, double* pDistance) const
+{
+    if (m_IsEmpty) return false;
+
+    const GLC_Point3d origin(ray.startingPoint());
+    const GLC_Vector3d direction(ray.direction());
+    const double* pOrigin= origin.data();
+    const double* pDirection= direction.data();
+    const double* pLower= m_Lower.data();
+    const double* pUpper= m_Upper.data();
+
+    // Slab test
+    double nearDistance= 0.0;
+    double farDistance= std::numeric_limits<double>::max();
+    for (int i= 0; i < 3; ++i)
+    {
+        if (pDirection[i] == 0.0)
+        {
+            if ((pOrigin[i] < pLower[i]) || (pOrigin[i] > pUpper[i])) return false;
+        }
+        else
+        {
+            const double inverse= 1.0 / pDirection[i];
+            double t1= (pLower[i] - pOrigin[i]) * inverse;
+            double t2= (pUpper[i] - pOrigin[i]) * inverse;
+            if (t1 > t2) qSwap(t1, t2);
+            nearDistance= qMax(nearDistance, t1);
+            farDistance= qMin(farDistance, t2);
+            if (nearDistance > farDistance) return false;
+        }
+    }
+
+    if (nullptr != pDistance) *pDistance= nearDistance;
+
+    return true;
+}
+
 
 
 GLC_Vector3d GLC_BoundingBox::size() const
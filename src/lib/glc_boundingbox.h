@@ -171,6 +171,12 @@ public:
     //! Return true if the given bounding box intersect this bounding box
     inline bool intersect(const GLC_BoundingBox& boundingBox, double epsilon= glc::EPSILON) const;
 
+    //! Return true if the given ray intersect this bounding box
+    /*! The ray starts at the starting point of the given line and follows its direction.
+     *  If pDistance is not null, it is set to the line parameter of the entry point,
+     *  0 if the starting point is inside this bounding box*/
+    bool intersectRay(const GLC_Line3d& ray, double* pDistance= nullptr) const;
+
     inline bool intersectObb(const GLC_BoundingBox& other) const;
 
     inline bool fuzzyIntersect(const GLC_BoundingBox& boundingBox) const;
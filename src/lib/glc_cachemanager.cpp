@@ -22,13 +22,383 @@
 //! \file glc_cachemanager.cpp implementation of the GLC_CacheManager class.
 
 #include "glc_cachemanager.h"
+#include "glc_errorlog.h"
+
+#include <QAtomicInt>
+#include <QCryptographicHash>
+#include <QDirIterator>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QRunnable>
+#include <QSet>
+#include <QThreadPool>
+#include <QWeakPointer>
 #include <QtDebug>
 
+#include <algorithm>
+
+// The cache index file name
+static const QString cacheIndexFileName("GLC_CacheIndex");
+
+// The cache index file version
+static const quint32 cacheIndexVersion= 1;
+
+// The context of content addressed binary rep
+static const QString cacheContentContext("Content");
+
+// The size of data read at once to compute a content key
+static const qint64 contentKeyChunkSize= 1 << 20;
+
+// Return the index key of the given cached file
+static QString cacheEntryKey(const QString& context, const QString& fileName)
+{
+	return context + '/' + fileName + '.' + GLC_BSRep::suffix();
+}
+
+//! An entry of the cache index
+class CacheEntry
+{
+public:
+	CacheEntry(qint64 size= 0, qint64 lastAccess= 0)
+	: m_Size(size)
+	, m_LastAccess(lastAccess)
+	{}
+
+	//! The size of the cached file
+	qint64 m_Size;
+
+	//! The last access time in ms since epoch
+	qint64 m_LastAccess;
+};
+
+//! State shared by copies of a cache manager
+class CacheState
+{
+public:
+	CacheState(const QString& path);
+	~CacheState();
+
+	//! Load the index if needed, the mutex must be locked
+	void loadIndex();
+
+	//! Save the index if it has been modified, the mutex must be locked
+	void saveIndex();
+
+	//! Update the last access of the given entry
+	void entryUsed(const QString& key);
+
+	//! Update the given entry after writing and apply the disk budget
+	void entryWritten(const QString& key);
+
+	//! Remove least recently used entries until the cache fits the budget, the mutex must be locked
+	void evict(const QString& keptKey);
+
+	//! Return a new pin of the given entry, the mutex must be locked
+	static QSharedPointer<GLC_BSRepPin> pin(const QSharedPointer<CacheState>& pState, const QString& key);
+
+	//! The cache absolute path
+	const QString m_Path;
+
+	//! Protect the index and the set of pending writes
+	QMutex m_Mutex;
+
+	//! The cache index
+	QHash<QString, CacheEntry> m_Index;
+
+	//! True if the index has been loaded
+	bool m_IndexIsLoaded;
+
+	//! True if the index must be saved
+	bool m_IndexIsDirty;
+
+	//! The sum of the size of indexed entries
+	qint64 m_DiskUsage;
+
+	//! The disk budget, 0 if the cache is unbounded
+	qint64 m_DiskBudget;
+
+	//! Keys of binary rep waiting to be written
+	QSet<QString> m_PendingWrites;
+
+	//! Pin count of entries which must not be evicted
+	QHash<QString, int> m_PinCount;
+
+	//! Pins of usable entries, taken by binary3DRep()
+	QMultiHash<QString, QSharedPointer<GLC_BSRepPin> > m_UsablePins;
+
+	//! Write binary rep in the background
+	bool m_UseWriteBehind;
+
+	//! The pool of the write queue
+	QThreadPool m_WritePool;
+
+	//! Cache statistics
+	QAtomicInt m_HitCount;
+	QAtomicInt m_MissCount;
+	QAtomicInt m_EvictionCount;
+};
+
+CacheState::CacheState(const QString& path)
+: m_Path(path)
+, m_Mutex()
+, m_Index()
+, m_IndexIsLoaded(false)
+, m_IndexIsDirty(false)
+, m_DiskUsage(0)
+, m_DiskBudget(0)
+, m_PendingWrites()
+, m_PinCount()
+, m_UsablePins()
+, m_UseWriteBehind(true)
+, m_WritePool()
+, m_HitCount(0)
+, m_MissCount(0)
+, m_EvictionCount(0)
+{
+	// Binary rep are written one after the other
+	m_WritePool.setMaxThreadCount(1);
+}
+
+CacheState::~CacheState()
+{
+	m_WritePool.waitForDone();
+	QMutexLocker locker(&m_Mutex);
+	saveIndex();
+}
+
+void CacheState::loadIndex()
+{
+	if (m_IndexIsLoaded) return;
+	m_IndexIsLoaded= true;
+
+	QFile indexFile(m_Path + '/' + cacheIndexFileName);
+	if (indexFile.open(QIODevice::ReadOnly))
+	{
+		QDataStream stream(&indexFile);
+		stream.setVersion(QDataStream::Qt_4_6);
+		quint32 version;
+		int entryCount;
+		stream >> version >> entryCount;
+		for (int i= 0; (version == cacheIndexVersion) && (stream.status() == QDataStream::Ok) && (i < entryCount); ++i)
+		{
+			QString key;
+			qint64 size, lastAccess;
+			stream >> key >> size >> lastAccess;
+			m_Index.insert(key, CacheEntry(size, lastAccess));
+		}
+		if ((version != cacheIndexVersion) || (stream.status() != QDataStream::Ok))
+		{
+			m_Index.clear();
+		}
+	}
+
+	if (m_Index.isEmpty())
+	{
+		// Build the index from the content of the cache directory
+		const QStringList nameFilters(QString("*.") + GLC_BSRep::suffix());
+		QDirIterator iFile(m_Path, nameFilters, QDir::Files, QDirIterator::Subdirectories);
+		while (iFile.hasNext())
+		{
+			iFile.next();
+			const QFileInfo fileInfo(iFile.fileInfo());
+			const QString key(fileInfo.dir().dirName() + '/' + fileInfo.fileName());
+			m_Index.insert(key, CacheEntry(fileInfo.size(), fileInfo.lastModified().toMSecsSinceEpoch()));
+		}
+		m_IndexIsDirty= !m_Index.isEmpty();
+	}
+
+	m_DiskUsage= 0;
+	QHash<QString, CacheEntry>::const_iterator iEntry= m_Index.constBegin();
+	while (m_Index.constEnd() != iEntry)
+	{
+		m_DiskUsage+= iEntry.value().m_Size;
+		++iEntry;
+	}
+}
+
+void CacheState::saveIndex()
+{
+	if (!m_IndexIsDirty) return;
+
+	QFile indexFile(m_Path + '/' + cacheIndexFileName);
+	if (indexFile.open(QIODevice::WriteOnly))
+	{
+		QDataStream stream(&indexFile);
+		stream.setVersion(QDataStream::Qt_4_6);
+		stream << cacheIndexVersion << m_Index.size();
+		QHash<QString, CacheEntry>::const_iterator iEntry= m_Index.constBegin();
+		while (m_Index.constEnd() != iEntry)
+		{
+			stream << iEntry.key() << iEntry.value().m_Size << iEntry.value().m_LastAccess;
+			++iEntry;
+		}
+		m_IndexIsDirty= (stream.status() != QDataStream::Ok);
+	}
+}
+
+void CacheState::entryUsed(const QString& key)
+{
+	QMutexLocker locker(&m_Mutex);
+	loadIndex();
+
+	QHash<QString, CacheEntry>::iterator iEntry= m_Index.find(key);
+	if (m_Index.end() == iEntry)
+	{
+		// Entry added by another cache manager
+		const qint64 size= QFileInfo(m_Path + '/' + key).size();
+		iEntry= m_Index.insert(key, CacheEntry(size));
+		m_DiskUsage+= size;
+	}
+	iEntry.value().m_LastAccess= QDateTime::currentMSecsSinceEpoch();
+	m_IndexIsDirty= true;
+}
+
+void CacheState::entryWritten(const QString& key)
+{
+	QMutexLocker locker(&m_Mutex);
+	loadIndex();
+
+	const qint64 size= QFileInfo(m_Path + '/' + key).size();
+	m_DiskUsage-= m_Index.value(key).m_Size;
+	m_DiskUsage+= size;
+	m_Index.insert(key, CacheEntry(size, QDateTime::currentMSecsSinceEpoch()));
+	m_PendingWrites.remove(key);
+	m_IndexIsDirty= true;
+
+	evict(key);
+	saveIndex();
+}
+
+void CacheState::evict(const QString& keptKey)
+{
+	if ((m_DiskBudget <= 0) || (m_DiskUsage <= m_DiskBudget)) return;
+
+	// Sort entries from the least recently used
+	QList<QPair<qint64, QString> > lruList;
+	QHash<QString, CacheEntry>::const_iterator iEntry= m_Index.constBegin();
+	while (m_Index.constEnd() != iEntry)
+	{
+		if ((iEntry.key() != keptKey) && !m_PendingWrites.contains(iEntry.key()) && !m_PinCount.contains(iEntry.key()))
+		{
+			lruList.append(qMakePair(iEntry.value().m_LastAccess, iEntry.key()));
+		}
+		++iEntry;
+	}
+	std::sort(lruList.begin(), lruList.end());
+
+	const int size= lruList.size();
+	for (int i= 0; (i < size) && (m_DiskUsage > m_DiskBudget); ++i)
+	{
+		const QString& key= lruList.at(i).second;
+		const QString fileName(m_Path + '/' + key);
+		// A file in use can't be removed on some platforms
+		if (QFile::remove(fileName) || !QFile::exists(fileName))
+		{
+			m_DiskUsage-= m_Index.value(key).m_Size;
+			m_Index.remove(key);
+			m_EvictionCount.ref();
+			m_IndexIsDirty= true;
+		}
+	}
+}
+
+//! Pin of a cache entry, the entry is not evicted while it is alive
+class CacheEntryPin : public GLC_BSRepPin
+{
+public:
+	CacheEntryPin(const QSharedPointer<CacheState>& pState, const QString& key)
+	: m_pState(pState)
+	, m_Key(key)
+	{}
+
+	virtual ~CacheEntryPin()
+	{
+		QSharedPointer<CacheState> pState(m_pState.toStrongRef());
+		if (!pState.isNull())
+		{
+			QMutexLocker locker(&(pState->m_Mutex));
+			QHash<QString, int>::iterator iPin= pState->m_PinCount.find(m_Key);
+			if (0 == --iPin.value())
+			{
+				pState->m_PinCount.erase(iPin);
+			}
+		}
+	}
+
+private:
+	QWeakPointer<CacheState> m_pState;
+	QString m_Key;
+};
+
+QSharedPointer<GLC_BSRepPin> CacheState::pin(const QSharedPointer<CacheState>& pState, const QString& key)
+{
+	++(pState->m_PinCount[key]);
+	return QSharedPointer<GLC_BSRepPin>(new CacheEntryPin(pState, key));
+}
+
+// Save the given binary rep in the cache
+static bool saveToCache(CacheState* pState, const QString& key, const QString& fileName, const GLC_3DRep& rep, bool useCompression, int compressionLevel)
+{
+	GLC_BSRep binariRep(fileName, useCompression);
+	binariRep.setCompressionLevel(compressionLevel);
+	const bool saveOk= binariRep.save(rep);
+	if (saveOk)
+	{
+		pState->entryWritten(key);
+	}
+	else
+	{
+		QMutexLocker locker(&(pState->m_Mutex));
+		pState->m_PendingWrites.remove(key);
+	}
+
+	return saveOk;
+}
+
+//! Background writing of a binary rep
+class CacheWriteTask : public QRunnable
+{
+public:
+	CacheWriteTask(CacheState* pState, const QString& key, const QString& fileName, GLC_3DRep* pRep, bool useCompression, int compressionLevel)
+	: m_pState(pState)
+	, m_Key(key)
+	, m_FileName(fileName)
+	, m_pRep(pRep)
+	, m_UseCompression(useCompression)
+	, m_CompressionLevel(compressionLevel)
+	{}
+
+	virtual ~CacheWriteTask()
+	{
+		delete m_pRep;
+	}
+
+	virtual void run()
+	{
+		if (!saveToCache(m_pState, m_Key, m_FileName, *m_pRep, m_UseCompression, m_CompressionLevel))
+		{
+			QStringList stringList("GLC_CacheManager::addToCache");
+			stringList.append("File " + m_pRep->fileName() + " Not Added to cache");
+			GLC_ErrorLog::addError(stringList);
+		}
+	}
+
+private:
+	CacheState* m_pState;
+	QString m_Key;
+	QString m_FileName;
+	GLC_3DRep* m_pRep;
+	bool m_UseCompression;
+	int m_CompressionLevel;
+};
 
 GLC_CacheManager::GLC_CacheManager(const QString& path)
 : m_Dir()
 , m_UseCompression(true)
 , m_CompressionLevel(-1)
+, m_UseContentAddressing(false)
+, m_pState()
 {
 	if (! path.isEmpty())
 	{
@@ -38,6 +408,7 @@ GLC_CacheManager::GLC_CacheManager(const QString& path)
 			m_Dir.setPath(path);
 		}
 	}
+	m_pState= QSharedPointer<CacheState>(new CacheState(m_Dir.absolutePath()));
 }
 
 // Copy constructor
@@ -45,6 +416,8 @@ GLC_CacheManager::GLC_CacheManager(const GLC_CacheManager& cacheManager)
 :m_Dir(cacheManager.m_Dir)
 , m_UseCompression(cacheManager.m_UseCompression)
 , m_CompressionLevel(cacheManager.m_CompressionLevel)
+, m_UseContentAddressing(cacheManager.m_UseContentAddressing)
+, m_pState(cacheManager.m_pState)
 {
 
 }
@@ -55,6 +428,8 @@ GLC_CacheManager& GLC_CacheManager::operator=(const GLC_CacheManager& cacheManag
 	m_Dir= cacheManager.m_Dir;
 	m_UseCompression= cacheManager.m_UseCompression;
 	m_CompressionLevel= cacheManager.m_CompressionLevel;
+	m_UseContentAddressing= cacheManager.m_UseContentAddressing;
+	m_pState= cacheManager.m_pState;
 
 	return *this;
 }
@@ -91,6 +466,90 @@ bool GLC_CacheManager::isWritable() const
 	return isWritable;
 }
 
+// Return the context of content addressed binary rep
+QString GLC_CacheManager::contentContext()
+{
+	return cacheContentContext;
+}
+
+// Return the content key of the given data
+QString GLC_CacheManager::contentKey(const QList<QByteArray>& data)
+{
+	QCryptographicHash hash(QCryptographicHash::Md5);
+	qint64 size= 0;
+	const int count= data.size();
+	for (int i= 0; i < count; ++i)
+	{
+		hash.addData(data.at(i));
+		size+= data.at(i).size();
+	}
+
+	return QString::fromLatin1(hash.result().toHex()) + '_' + QString::number(size, 16);
+}
+
+// Return the content key of the remaining data of the given device
+QString GLC_CacheManager::contentKey(QIODevice* pDevice)
+{
+	QCryptographicHash hash(QCryptographicHash::Md5);
+	qint64 size= 0;
+	QByteArray buffer;
+	do
+	{
+		buffer= pDevice->read(contentKeyChunkSize);
+		hash.addData(buffer);
+		size+= buffer.size();
+	} while (!buffer.isEmpty());
+
+	return QString::fromLatin1(hash.result().toHex()) + '_' + QString::number(size, 16);
+}
+
+// Return true if binary rep are written in the background
+bool GLC_CacheManager::writeBehindIsUsed() const
+{
+	QMutexLocker locker(&(m_pState->m_Mutex));
+	return m_pState->m_UseWriteBehind;
+}
+
+// Return the disk budget of the cache in bytes
+qint64 GLC_CacheManager::diskBudget() const
+{
+	QMutexLocker locker(&(m_pState->m_Mutex));
+	return m_pState->m_DiskBudget;
+}
+
+// Return the disk usage of the cache in bytes
+qint64 GLC_CacheManager::diskUsage() const
+{
+	QMutexLocker locker(&(m_pState->m_Mutex));
+	m_pState->loadIndex();
+	return m_pState->m_DiskUsage;
+}
+
+// Return the number of binary rep waiting to be written
+int GLC_CacheManager::pendingWriteCount() const
+{
+	QMutexLocker locker(&(m_pState->m_Mutex));
+	return m_pState->m_PendingWrites.size();
+}
+
+// Return the number of cache hits
+int GLC_CacheManager::hitCount() const
+{
+	return m_pState->m_HitCount.load();
+}
+
+// Return the number of cache misses
+int GLC_CacheManager::missCount() const
+{
+	return m_pState->m_MissCount.load();
+}
+
+// Return the number of binary rep removed from the cache
+int GLC_CacheManager::evictionCount() const
+{
+	return m_pState->m_EvictionCount.load();
+}
+
 // Return True if the specified file is cashed in the specified context
 bool GLC_CacheManager::isCashed(const QString& context, const QString& fileName) const
 {
@@ -103,7 +562,20 @@ bool GLC_CacheManager::isCashed(const QString& context, const QString& fileName)
 // Return True if the cached file is usable
 bool GLC_CacheManager::isUsable(const QDateTime& timeStamp, const QString& context, const QString& fileName) const
 {
-	bool result= isCashed(context, fileName);
+	const QString key(cacheEntryKey(context, fileName));
+
+	// The entry is pinned before it is checked, so it is not evicted until it is loaded
+	QSharedPointer<GLC_BSRepPin> pPin;
+	{
+		QMutexLocker locker(&(m_pState->m_Mutex));
+		// The file is being rewritten
+		if (!m_pState->m_PendingWrites.contains(key))
+		{
+			pPin= CacheState::pin(m_pState, key);
+		}
+	}
+
+	bool result= !pPin.isNull() && isCashed(context, fileName);
 
 	if (result)
 	{
@@ -118,6 +590,18 @@ bool GLC_CacheManager::isUsable(const QDateTime& timeStamp, const QString& conte
 		}
 	}
 
+	if (result)
+	{
+		m_pState->entryUsed(key);
+		m_pState->m_HitCount.ref();
+		QMutexLocker locker(&(m_pState->m_Mutex));
+		m_pState->m_UsablePins.insert(key, pPin);
+	}
+	else
+	{
+		m_pState->m_MissCount.ref();
+	}
+
 	return result;
 }
 
@@ -127,6 +611,17 @@ GLC_BSRep GLC_CacheManager::binary3DRep(const QString& context, const QString& f
 	const QString absoluteFileName(m_Dir.absolutePath() + QDir::separator() + context + QDir::separator() + fileName + '.' + GLC_BSRep::suffix());
 	GLC_BSRep binaryRep(absoluteFileName);
 
+	// Take the pin of the usable entry or pin it now
+	const QString key(cacheEntryKey(context, fileName));
+	QMutexLocker locker(&(m_pState->m_Mutex));
+	QSharedPointer<GLC_BSRepPin> pPin(m_pState->m_UsablePins.take(key));
+	if (pPin.isNull())
+	{
+		pPin= CacheState::pin(m_pState, key);
+	}
+	locker.unlock();
+	binaryRep.setPin(pPin);
+
 	return binaryRep;
 }
 
@@ -134,6 +629,22 @@ GLC_BSRep GLC_CacheManager::binary3DRep(const QString& context, const QString& f
 bool GLC_CacheManager::addToCache(const QString& context, const GLC_3DRep& rep)
 {
 	Q_ASSERT(!rep.fileName().isEmpty());
+	QString repFileName= rep.fileName();
+	if (glc::isArchiveString(repFileName))
+	{
+		repFileName= glc::archiveEntryFileName(repFileName);
+	}
+	else
+	{
+		repFileName= QFileInfo(repFileName).fileName();
+	}
+
+	return addToCache(context, repFileName, rep);
+}
+
+// Add the given rep in the cache with the specified context and file name
+bool GLC_CacheManager::addToCache(const QString& context, const QString& repFileName, const GLC_3DRep& rep)
+{
 	bool addedToCache= isWritable();
 	if (addedToCache)
 	{
@@ -144,19 +655,26 @@ bool GLC_CacheManager::addToCache(const QString& context, const GLC_3DRep& rep)
 		}
 		if (addedToCache)
 		{
-			QString repFileName= rep.fileName();
-			if (glc::isArchiveString(repFileName))
-			{
-				repFileName= glc::archiveEntryFileName(repFileName);
-			}
-			else
+			const QString binaryFileName= contextCacheInfo.filePath() + QDir::separator() + repFileName;
+			const QString key(cacheEntryKey(context, repFileName));
+
+			QMutexLocker locker(&(m_pState->m_Mutex));
+			if (!m_pState->m_PendingWrites.contains(key))
 			{
-				repFileName= QFileInfo(repFileName).fileName();
+				m_pState->m_PendingWrites.insert(key);
+				if (m_pState->m_UseWriteBehind)
+				{
+					// The copy shares vertex data with the given rep until one of them is modified
+					GLC_3DRep* pRep= dynamic_cast<GLC_3DRep*>(rep.deepCopy());
+					pRep->setLastModified(rep.lastModified());
+					m_pState->m_WritePool.start(new CacheWriteTask(m_pState.data(), key, binaryFileName, pRep, m_UseCompression, m_CompressionLevel));
+				}
+				else
+				{
+					locker.unlock();
+					addedToCache= saveToCache(m_pState.data(), key, binaryFileName, rep, m_UseCompression, m_CompressionLevel);
+				}
 			}
-			const QString binaryFileName= contextCacheInfo.filePath() + QDir::separator() + repFileName;
-			GLC_BSRep binariRep(binaryFileName, m_UseCompression);
-			binariRep.setCompressionLevel(m_CompressionLevel);
-			addedToCache= binariRep.save(rep);
 		}
 	}
 
@@ -177,7 +695,48 @@ bool GLC_CacheManager::setCachePath(const QString& path)
 	if (result)
 	{
 		m_Dir.setPath(path);
+
+		QSharedPointer<CacheState> pState(new CacheState(m_Dir.absolutePath()));
+		pState->m_UseWriteBehind= m_pState->m_UseWriteBehind;
+		pState->m_DiskBudget= m_pState->m_DiskBudget;
+		m_pState= pState;
 	}
 	return result;
 }
 
+// Set background writing of binary rep usage
+void GLC_CacheManager::setWriteBehindUsage(bool use)
+{
+	QMutexLocker locker(&(m_pState->m_Mutex));
+	m_pState->m_UseWriteBehind= use;
+}
+
+// Set the disk budget of the cache in bytes
+void GLC_CacheManager::setDiskBudget(qint64 budget)
+{
+	QMutexLocker locker(&(m_pState->m_Mutex));
+	m_pState->m_DiskBudget= qMax(Q_INT64_C(0), budget);
+	if (m_pState->m_DiskBudget > 0)
+	{
+		m_pState->loadIndex();
+		m_pState->evict(QString());
+		m_pState->saveIndex();
+	}
+}
+
+// Wait until all pending binary rep are written
+void GLC_CacheManager::waitForPendingWrites()
+{
+	m_pState->m_WritePool.waitForDone();
+	QMutexLocker locker(&(m_pState->m_Mutex));
+	m_pState->saveIndex();
+}
+
+// Reset hit, miss and eviction counters
+void GLC_CacheManager::resetStatistics()
+{
+	m_pState->m_HitCount.store(0);
+	m_pState->m_MissCount.store(0);
+	m_pState->m_EvictionCount.store(0);
+}
+
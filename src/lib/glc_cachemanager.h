@@ -27,16 +27,31 @@
 #include <QDir>
 #include <QString>
 #include <QDateTime>
+#include <QSharedPointer>
+#include <QIODevice>
 #include "geometry/glc_bsrep.h"
 
 #include "glc_config.h"
 
+class CacheState;
+
 //////////////////////////////////////////////////////////////////////
 //! \class GLC_CacheManager
 /*! \brief GLC_CacheManager : The 3D Rep Binary cache manager*/
 
 /*! By default the binary rep are compressed with a default
  * compression level
+ *
+ * Binary rep are written in the background by default, so addToCache returns
+ * immediately. The disk usage of the cache can be bounded, the least recently
+ * used binary rep are then removed. Entries size and last access are kept in
+ * an index file at the root of the cache directory.
+ *
+ * Copies of a cache manager share the same write queue, index and statistics.
+ *
+ * If content addressing is used, loaders store binary rep in the contentContext()
+ * with the contentKey() of the source representation data as file name. Identical
+ * representations are then shared and a time stamp change doesn't invalidate them.
  */
 //////////////////////////////////////////////////////////////////////
 class GLC_LIB_EXPORT GLC_CacheManager
@@ -82,14 +97,19 @@ public:
 	bool isCashed(const QString&, const QString&) const;
 
 	//! Return True if the cached file is usable
+	/*! A usable file is not evicted until the binary rep returned by binary3DRep() is loaded*/
 	bool isUsable(const QDateTime&, const QString&, const QString&) const;
 
 	//! Return the binary serialized representation of the specified file
+	/*! The file is not evicted until the returned binary rep is loaded or destroyed*/
 	GLC_BSRep binary3DRep(const QString&, const QString&) const;
 
 	//! Add the specified file in the cache
 	bool addToCache(const QString&, const GLC_3DRep&);
 
+	//! Add the given rep in the cache with the specified context and file name
+	bool addToCache(const QString& context, const QString& fileName, const GLC_3DRep& rep);
+
 	//! Return true if the compression is used
 	inline bool compressionIsUsed() const
 	{return m_UseCompression;}
@@ -98,6 +118,40 @@ public:
 	inline int compressionLevel() const
 	{return m_CompressionLevel;}
 
+	//! Return true if content addressing is used
+	inline bool contentAddressingIsUsed() const
+	{return m_UseContentAddressing;}
+
+	//! Return the context of content addressed binary rep
+	static QString contentContext();
+
+	//! Return the content key of the given data
+	static QString contentKey(const QList<QByteArray>& data);
+
+	//! Return the content key of the remaining data of the given device
+	static QString contentKey(QIODevice* pDevice);
+
+	//! Return true if binary rep are written in the background
+	bool writeBehindIsUsed() const;
+
+	//! Return the disk budget of the cache in bytes, 0 if the cache is unbounded
+	qint64 diskBudget() const;
+
+	//! Return the disk usage of the cache in bytes
+	qint64 diskUsage() const;
+
+	//! Return the number of binary rep waiting to be written
+	int pendingWriteCount() const;
+
+	//! Return the number of cache hits
+	int hitCount() const;
+
+	//! Return the number of cache misses
+	int missCount() const;
+
+	//! Return the number of binary rep removed from the cache to respect the disk budget
+	int evictionCount() const;
+
 //@}
 
 //////////////////////////////////////////////////////////////////////
@@ -116,6 +170,23 @@ public:
 	//! Set the cache compression level
 	inline void setCompressionLevel(int level)
 	{m_CompressionLevel= level;}
+
+	//! Set content addressing usage
+	inline void setContentAddressingUsage(bool use)
+	{m_UseContentAddressing= use;}
+
+	//! Set background writing of binary rep usage
+	void setWriteBehindUsage(bool use);
+
+	//! Set the disk budget of the cache in bytes, 0 for an unbounded cache
+	/*! Least recently used binary rep are removed until the cache fits the budget*/
+	void setDiskBudget(qint64 budget);
+
+	//! Wait until all pending binary rep are written and save the cache index
+	void waitForPendingWrites();
+
+	//! Reset hit, miss and eviction counters
+	void resetStatistics();
 //@}
 
 //////////////////////////////////////////////////////////////////////
@@ -131,6 +202,12 @@ private:
 
 	//! The compression level
 	int m_CompressionLevel;
+
+	//! Use content addressing
+	bool m_UseContentAddressing;
+
+	//! The state shared by copies of this cache manager
+	QSharedPointer<CacheState> m_pState;
 };
 
 #endif /* GLC_CACHEMANAGER_H_ */
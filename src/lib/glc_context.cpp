@@ -28,6 +28,7 @@
 #include "shading/glc_shader.h"
 
 #include "glc_state.h"
+#include "glc_ext.h"
 
 GLC_Context::GLC_Context(QOpenGLContext *pOpenGLContext, QSurface *pSurface)
     : QObject()
@@ -53,7 +54,7 @@ GLC_Context *GLC_Context::current()
 // Get Functions
 //////////////////////////////////////////////////////////////////////
 
-void GLC_Context::glcUseVertexPointer(const GLvoid *pointer)
+void GLC_Context::glcUseVertexPointer(const GLvoid *pointer, GLint size, GLenum type, GLboolean normalized)
 {
     Q_ASSERT(m_pOpenGLContext);
     QOpenGLFunctions* pGlFunctions= m_pOpenGLContext->functions();
@@ -62,18 +63,18 @@ void GLC_Context::glcUseVertexPointer(const GLvoid *pointer)
 #ifdef GLC_OPENGL_ES_2
     Q_ASSERT(NULL != pShader);
     const GLuint location= pShader->positionAttributeId();
-    pGlFunctions->glVertexAttribPointer(location, 3, GL_FLOAT, GL_FALSE, 0, pointer);
+    pGlFunctions->glVertexAttribPointer(location, size, type, normalized, 0, pointer);
     pGlFunctions->glEnableVertexAttribArray(location);
 #else
     if ((NULL != pShader) && (pShader->positionAttributeId() != -1))
     {
         const GLuint location= pShader->positionAttributeId();
-        pGlFunctions->glVertexAttribPointer(location, 3, GL_FLOAT, GL_FALSE, 0, pointer);
+        pGlFunctions->glVertexAttribPointer(location, size, type, normalized, 0, pointer);
         pGlFunctions->glEnableVertexAttribArray(location);
     }
     else
     {
-        glVertexPointer(3, GL_FLOAT, 0, pointer);
+        glVertexPointer(size, type, 0, pointer);
         glEnableClientState(GL_VERTEX_ARRAY);
     }
 #endif
@@ -100,7 +101,7 @@ void GLC_Context::glcDisableVertexClientState()
 #endif
 }
 
-void GLC_Context::glcUseNormalPointer(const GLvoid *pointer)
+void GLC_Context::glcUseNormalPointer(const GLvoid *pointer, GLint size, GLenum type, GLboolean normalized)
 {
     Q_ASSERT(m_pOpenGLContext);
     QOpenGLFunctions* pGlFunctions= m_pOpenGLContext->functions();
@@ -109,18 +110,18 @@ void GLC_Context::glcUseNormalPointer(const GLvoid *pointer)
 #ifdef GLC_OPENGL_ES_2
     Q_ASSERT(NULL != pShader);
     const GLuint location= pShader->normalAttributeId();
-    pGlFunctions->glVertexAttribPointer(location, 3, GL_FLOAT, GL_FALSE, 0, pointer);
+    pGlFunctions->glVertexAttribPointer(location, size, type, normalized, 0, pointer);
     pGlFunctions->glEnableVertexAttribArray(location);
 #else
     if ((NULL != pShader) && (pShader->positionAttributeId() != -1))
     {
         const GLuint location= pShader->normalAttributeId();
-        pGlFunctions->glVertexAttribPointer(location, 3, GL_FLOAT, GL_FALSE, 0, pointer);
+        pGlFunctions->glVertexAttribPointer(location, size, type, normalized, 0, pointer);
         pGlFunctions->glEnableVertexAttribArray(location);
     }
     else
     {
-        glNormalPointer(GL_FLOAT, 0, pointer);
+        glNormalPointer(type, 0, pointer);
         glEnableClientState(GL_NORMAL_ARRAY);
     }
 #endif
@@ -147,7 +148,7 @@ void GLC_Context::glcDisableNormalClientState()
 #endif
 }
 
-void GLC_Context::glcUseTexturePointer(const GLvoid *pointer)
+void GLC_Context::glcUseTexturePointer(const GLvoid *pointer, GLenum type)
 {
     Q_ASSERT(m_pOpenGLContext);
     QOpenGLFunctions* pGlFunctions= m_pOpenGLContext->functions();
@@ -156,18 +157,18 @@ void GLC_Context::glcUseTexturePointer(const GLvoid *pointer)
 #ifdef GLC_OPENGL_ES_2
     Q_ASSERT(NULL != pShader);
     const GLuint location= pShader->textureAttributeId();
-    pGlFunctions->glVertexAttribPointer(location, 2, GL_FLOAT, GL_FALSE, 0, pointer);
+    pGlFunctions->glVertexAttribPointer(location, 2, type, GL_FALSE, 0, pointer);
     pGlFunctions->glEnableVertexAttribArray(location);
 #else
     if ((NULL != pShader) && (pShader->textureAttributeId() != -1))
     {
         const GLuint location= pShader->textureAttributeId();
-        pGlFunctions->glVertexAttribPointer(location, 2, GL_FLOAT, GL_FALSE, 0, pointer);
+        pGlFunctions->glVertexAttribPointer(location, 2, type, GL_FALSE, 0, pointer);
         pGlFunctions->glEnableVertexAttribArray(location);
     }
     else
     {
-        glTexCoordPointer(2, GL_FLOAT, 0, pointer);
+        glTexCoordPointer(2, type, 0, pointer);
         glEnableClientState(GL_TEXTURE_COORD_ARRAY);
     }
 #endif
@@ -242,6 +243,43 @@ void GLC_Context::glcDisableColorClientState()
 
 }
 
+void GLC_Context::glcUseInstanceMatrixPointer(const GLvoid *pointer)
+{
+    Q_ASSERT(m_pOpenGLContext);
+    Q_ASSERT(GLC_State::instancingSupported());
+    QOpenGLFunctions* pGlFunctions= m_pOpenGLContext->functions();
+
+    GLC_Shader* pShader= GLC_Shader::currentShaderHandle();
+    Q_ASSERT((NULL != pShader) && (pShader->instanceMatrixAttributeId() != -1));
+
+    // A matrix attribute uses one location by column
+    const GLsizei stride= 16 * sizeof(GLfloat);
+    for (GLuint i= 0; i < 4; ++i)
+    {
+        const GLuint location= pShader->instanceMatrixAttributeId() + i;
+        const GLvoid* pColumn= static_cast<const char*>(pointer) + i * 4 * sizeof(GLfloat);
+        pGlFunctions->glVertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE, stride, pColumn);
+        pGlFunctions->glEnableVertexAttribArray(location);
+        glVertexAttribDivisorARB(location, 1);
+    }
+}
+
+void GLC_Context::glcDisableInstanceMatrixClientState()
+{
+    Q_ASSERT(m_pOpenGLContext);
+    QOpenGLFunctions* pGlFunctions= m_pOpenGLContext->functions();
+
+    GLC_Shader* pShader= GLC_Shader::currentShaderHandle();
+    Q_ASSERT((NULL != pShader) && (pShader->instanceMatrixAttributeId() != -1));
+
+    for (GLuint i= 0; i < 4; ++i)
+    {
+        const GLuint location= pShader->instanceMatrixAttributeId() + i;
+        glVertexAttribDivisorARB(location, 0);
+        pGlFunctions->glDisableVertexAttribArray(location);
+    }
+}
+
 bool GLC_Context::makeCurrent()
 {
     Q_ASSERT(m_pOpenGLContext && m_pSurface);
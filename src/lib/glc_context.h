@@ -175,20 +175,30 @@ public:
     inline void glcSetTwoSidedLight(GLint twoSided)
     {m_ContextSharedData->glcSetTwoSidedLight(twoSided);}
 
+    //! Set the decoding of compressed vertex attributes
+    inline void glcSetVertexDecoding(bool decodePosition, const GLfloat* pOffset, const GLfloat* pScale, bool decodeNormal)
+    {m_ContextSharedData->glcSetVertexDecoding(decodePosition, pOffset, pScale, decodeNormal);}
+
+    //! Set the instanced rendering state
+    inline void glcEnableInstancing(bool enable)
+    {m_ContextSharedData->glcEnableInstancing(enable);}
+
     //! Use vertex array pointer and enable it
-    void glcUseVertexPointer(const GLvoid* pointer);
+    /*! Compressed positions of the given size, type and normalization need a shader*/
+    void glcUseVertexPointer(const GLvoid* pointer, GLint size= 3, GLenum type= GL_FLOAT, GLboolean normalized= GL_FALSE);
 
     //! Disable the vertex client state
     void glcDisableVertexClientState();
 
     //! Use Normal array pointer and enable it
-    void glcUseNormalPointer(const GLvoid* pointer);
+    /*! Compressed normals of the given size, type and normalization need a shader*/
+    void glcUseNormalPointer(const GLvoid* pointer, GLint size= 3, GLenum type= GL_FLOAT, GLboolean normalized= GL_FALSE);
 
     //! Disable the normal client state
     void glcDisableNormalClientState();
 
     //! Use Texture array pointer and enable it
-    void glcUseTexturePointer(const GLvoid* pointer);
+    void glcUseTexturePointer(const GLvoid* pointer, GLenum type= GL_FLOAT);
 
     //! Disable the normal client state
     void glcDisableTextureClientState();
@@ -199,6 +209,14 @@ public:
     //! Disable the color client state
     void glcDisableColorClientState();
 
+    //! Use instance matrices pointer, advanced once by instance, and enable it
+    /*! The matrices are column major arrays of 16 floats. Need a shader
+     *  with an instance matrix attribute and instancing support*/
+    void glcUseInstanceMatrixPointer(const GLvoid* pointer);
+
+    //! Disable the instance matrices client state
+    void glcDisableInstanceMatrixClientState();
+
 //@}
 //////////////////////////////////////////////////////////////////////
 /*! \name Set Functions*/
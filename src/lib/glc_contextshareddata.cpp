@@ -298,6 +298,22 @@ void GLC_ContextSharedData::glcDisableLight(GLenum lightId)
    }
 }
 
+void GLC_ContextSharedData::glcSetVertexDecoding(bool decodePosition, const GLfloat* pOffset, const GLfloat* pScale, bool decodeNormal)
+{
+    if (GLC_Shader::hasActiveShader())
+    {
+        m_UniformShaderData.setVertexDecoding(decodePosition, pOffset, pScale, decodeNormal);
+    }
+}
+
+void GLC_ContextSharedData::glcEnableInstancing(bool enable)
+{
+    if (GLC_Shader::hasActiveShader())
+    {
+        m_UniformShaderData.setInstancingState(enable);
+    }
+}
+
 void GLC_ContextSharedData::initDefaultShader()
 {
     QFile vertexShader(":/GLC_lib_Shaders/default_vert");
@@ -139,6 +139,12 @@ public:
     //! Disable the given light id
     void glcDisableLight(GLenum lightId);
 
+    //! Set the decoding of compressed vertex attributes if there is an active shader
+    void glcSetVertexDecoding(bool decodePosition, const GLfloat* pOffset, const GLfloat* pScale, bool decodeNormal);
+
+    //! Set the instanced rendering state if there is an active shader
+    void glcEnableInstancing(bool enable);
+
 //@}
 
 private:
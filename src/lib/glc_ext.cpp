@@ -34,6 +34,10 @@
 PFNGLPOINTPARAMETERFARBPROC			glPointParameterf		= NULL;
 PFNGLPOINTPARAMETERFVARBPROC		glPointParameterfv		= NULL;
 
+// GL_ARB_draw_instanced and GL_ARB_instanced_arrays Instanced rendering
+PFNGLDRAWELEMENTSINSTANCEDARBPROC	glDrawElementsInstancedARB	= NULL;
+PFNGLVERTEXATTRIBDIVISORPROC		glVertexAttribDivisorARB	= NULL;
+
 #endif
 
 
@@ -76,3 +80,28 @@ bool glc::loadPointSpriteExtension()
     return result;
 }
 
+// Load instanced rendering extensions
+bool glc::loadInstancingExtension()
+{
+	bool result= false;
+#if !defined(Q_OS_MAC) && !defined(GLC_OPENGL_ES_2)
+	const QOpenGLContext* pContext= QOpenGLContext::currentContext();
+	// Core since OpenGL 3.3, the ARB entry points are used otherwise
+	glDrawElementsInstancedARB		= (PFNGLDRAWELEMENTSINSTANCEDARBPROC)pContext->getProcAddress("glDrawElementsInstanced");
+	if (!glDrawElementsInstancedARB)
+	{
+		glDrawElementsInstancedARB	= (PFNGLDRAWELEMENTSINSTANCEDARBPROC)pContext->getProcAddress("glDrawElementsInstancedARB");
+	}
+	if (!glDrawElementsInstancedARB) qDebug() << "not glDrawElementsInstanced";
+	glVertexAttribDivisorARB		= (PFNGLVERTEXATTRIBDIVISORPROC)pContext->getProcAddress("glVertexAttribDivisor");
+	if (!glVertexAttribDivisorARB)
+	{
+		glVertexAttribDivisorARB	= (PFNGLVERTEXATTRIBDIVISORPROC)pContext->getProcAddress("glVertexAttribDivisorARB");
+	}
+	if (!glVertexAttribDivisorARB) qDebug() << "not glVertexAttribDivisor";
+
+	result= glDrawElementsInstancedARB && glVertexAttribDivisorARB;
+
+#endif
+	return result;
+}
@@ -27,6 +27,10 @@
 bool GLC_RenderStatistics::m_IsActivated= false;
 unsigned int GLC_RenderStatistics::m_LastRenderGeometryCount= 0;
 unsigned long GLC_RenderStatistics::m_LastRenderPolygonCount= 0;
+unsigned long GLC_RenderStatistics::m_LastTriangleBudget= 0;
+unsigned long GLC_RenderStatistics::m_LastScheduledTriangleCount= 0;
+double GLC_RenderStatistics::m_LastScreenSpaceErrorThreshold= 0.0;
+QVector<unsigned int> GLC_RenderStatistics::m_LastScheduledLodCount;
 
 GLC_RenderStatistics::GLC_RenderStatistics()
 {
@@ -57,6 +61,36 @@ unsigned long GLC_RenderStatistics::triangleCount()
 	return m_LastRenderPolygonCount;
 }
 
+unsigned long GLC_RenderStatistics::triangleBudget()
+{
+	return m_LastTriangleBudget;
+}
+
+unsigned long GLC_RenderStatistics::scheduledTriangleCount()
+{
+	return m_LastScheduledTriangleCount;
+}
+
+double GLC_RenderStatistics::triangleBudgetUsage()
+{
+	double subject= 0.0;
+	if (m_LastTriangleBudget > 0)
+	{
+		subject= static_cast<double>(m_LastScheduledTriangleCount) / static_cast<double>(m_LastTriangleBudget);
+	}
+	return subject;
+}
+
+double GLC_RenderStatistics::screenSpaceErrorThreshold()
+{
+	return m_LastScreenSpaceErrorThreshold;
+}
+
+QVector<unsigned int> GLC_RenderStatistics::scheduledLodCount()
+{
+	return m_LastScheduledLodCount;
+}
+
 //////////////////////////////////////////////////////////////////////
 // Set methods
 //////////////////////////////////////////////////////////////////////
@@ -69,6 +103,10 @@ void GLC_RenderStatistics::reset()
 {
 	m_LastRenderGeometryCount= 0;
 	m_LastRenderPolygonCount= 0;
+	m_LastTriangleBudget= 0;
+	m_LastScheduledTriangleCount= 0;
+	m_LastScreenSpaceErrorThreshold= 0.0;
+	m_LastScheduledLodCount.clear();
 }
 
 void GLC_RenderStatistics::addBodies(unsigned int bodies)
@@ -86,3 +124,14 @@ void GLC_RenderStatistics::addTriangles(unsigned int triangles)
 		m_LastRenderPolygonCount+= triangles;
 	}
 }
+
+void GLC_RenderStatistics::setLodSchedule(unsigned long budget, unsigned long triangles, double threshold, const QVector<unsigned int>& lodCount)
+{
+	if (m_IsActivated)
+	{
+		m_LastTriangleBudget= budget;
+		m_LastScheduledTriangleCount= triangles;
+		m_LastScreenSpaceErrorThreshold= threshold;
+		m_LastScheduledLodCount= lodCount;
+	}
+}
@@ -24,6 +24,8 @@
 #ifndef GLC_RENDERSTATISTICS_H_
 #define GLC_RENDERSTATISTICS_H_
 
+#include <QVector>
+
 #include "glc_config.h"
 
 //////////////////////////////////////////////////////////////////////
@@ -55,6 +57,21 @@ public:
 
 	//! Return current triangles count
 	static unsigned long triangleCount();
+
+	//! Return the triangle budget of the last LOD schedule, 0 if LOD are not scheduled
+	static unsigned long triangleBudget();
+
+	//! Return the triangle count of the last LOD schedule
+	static unsigned long scheduledTriangleCount();
+
+	//! Return the part of the triangle budget used by the last LOD schedule
+	static double triangleBudgetUsage();
+
+	//! Return the screen space error threshold in pixels of the last LOD schedule
+	static double screenSpaceErrorThreshold();
+
+	//! Return the number of bodies scheduled at each LOD index by the last LOD schedule
+	static QVector<unsigned int> scheduledLodCount();
 //@}
 
 //////////////////////////////////////////////////////////////////////
@@ -74,6 +91,9 @@ public:
 	//! Add Triangles to the current tringle count
 	static void addTriangles(unsigned int triangles);
 
+	//! Set the result of a LOD schedule
+	static void setLodSchedule(unsigned long budget, unsigned long triangles, double threshold, const QVector<unsigned int>& lodCount);
+
 //@}
 
 //////////////////////////////////////////////////////////////////////
@@ -89,6 +109,18 @@ private:
 
 	//! Last render polygon count
 	static unsigned long m_LastRenderPolygonCount;
+
+	//! Last LOD schedule triangle budget
+	static unsigned long m_LastTriangleBudget;
+
+	//! Last LOD schedule triangle count
+	static unsigned long m_LastScheduledTriangleCount;
+
+	//! Last LOD schedule screen space error threshold
+	static double m_LastScreenSpaceErrorThreshold;
+
+	//! Last LOD schedule number of bodies by LOD index
+	static QVector<unsigned int> m_LastScheduledLodCount;
 };
 
 #endif /* GLC_RENDERSTATISTICS_H_ */
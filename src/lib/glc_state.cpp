@@ -33,6 +33,7 @@
 
 bool GLC_State::m_UseVbo= true;
 bool GLC_State::m_PointSpriteSupported= true;
+bool GLC_State::m_IsInstancingSupported= false;
 bool GLC_State::m_UseShader= true;
 bool GLC_State::m_UseSelectionShader= false;
 bool GLC_State::m_IsInSelectionMode= false;
@@ -50,6 +51,10 @@ GLC_CacheManager GLC_State::m_CacheManager;
 
 bool GLC_State::m_IsSpacePartitionningActivated= false;
 bool GLC_State::m_IsFrustumCullingActivated= false;
+bool GLC_State::m_IsMeshOptimizationActivated= false;
+GLC_VertexCompression::Compression GLC_State::m_VertexCompression= GLC_VertexCompression::NoCompression;
+bool GLC_State::m_IsInstancingActivated= false;
+int GLC_State::m_DrawInstanceCount= 0;
 bool GLC_State::m_IsValid= false;
 
 GLC_State::~GLC_State()
@@ -84,6 +89,11 @@ bool GLC_State::pointSpriteSupported()
     return m_PointSpriteSupported;
 }
 
+bool GLC_State::instancingSupported()
+{
+    return m_IsInstancingSupported;
+}
+
 bool GLC_State::selectionShaderUsed()
 {
     Q_ASSERT(m_IsValid);
@@ -145,12 +155,33 @@ bool GLC_State::isFrustumCullingActivated()
     return m_IsFrustumCullingActivated;
 }
 
+bool GLC_State::isMeshOptimizationActivated()
+{
+    return m_IsMeshOptimizationActivated;
+}
+
+GLC_VertexCompression::Compression GLC_State::vertexCompression()
+{
+    return m_VertexCompression;
+}
+
+bool GLC_State::isInstancingActivated()
+{
+    return m_IsInstancingActivated && m_IsInstancingSupported;
+}
+
+int GLC_State::drawInstanceCount()
+{
+    return m_DrawInstanceCount;
+}
+
 void GLC_State::init()
 {
     if (!m_IsValid)
     {
         Q_ASSERT((NULL != QOpenGLContext::currentContext()) &&  QOpenGLContext::currentContext()->isValid());
         setPointSpriteSupport();
+        setInstancingSupport();
         setFrameBufferSupport();
         setFrameBufferBlitSupport();
         m_Version= (char *) glGetString(GL_VERSION);
@@ -177,6 +208,11 @@ void GLC_State::setPointSpriteSupport()
     Q_ASSERT(m_PointSpriteSupported);
 }
 
+void GLC_State::setInstancingSupport()
+{
+    m_IsInstancingSupported= glc::loadInstancingExtension();
+}
+
 void GLC_State::setFrameBufferSupport()
 {
     m_IsFrameBufferSupported= QOpenGLFramebufferObject::hasOpenGLFramebufferObjects();
@@ -231,3 +267,23 @@ void GLC_State::setFrustumCullingUsage(bool usage)
 {
     m_IsFrustumCullingActivated= usage;
 }
+
+void GLC_State::setMeshOptimizationUsage(bool usage)
+{
+    m_IsMeshOptimizationActivated= usage;
+}
+
+void GLC_State::setVertexCompression(GLC_VertexCompression::Compression compression)
+{
+    m_VertexCompression= compression;
+}
+
+void GLC_State::setInstancingUsage(bool usage)
+{
+    m_IsInstancingActivated= usage;
+}
+
+void GLC_State::setDrawInstanceCount(int count)
+{
+    m_DrawInstanceCount= count;
+}
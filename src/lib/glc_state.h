@@ -28,6 +28,7 @@
 #include <QString>
 
 #include "glc_cachemanager.h"
+#include "geometry/glc_vertexcompression.h"
 
 #include "glc_config.h"
 
@@ -65,6 +66,9 @@ public:
 	//! Return true if Point Sprite is supported
 	static bool pointSpriteSupported();
 
+	//! Return true if instanced rendering is supported
+	static bool instancingSupported();
+
 	//! Return true if selection shader is used
 	static bool selectionShaderUsed();
 
@@ -98,6 +102,18 @@ public:
 	//! Return true if frustum culling is activated
 	static bool isFrustumCullingActivated();
 
+	//! Return true if mesh vertex cache optimization is activated
+	static bool isMeshOptimizationActivated();
+
+	//! Return the compression of mesh VBOs and IBOs
+	static GLC_VertexCompression::Compression vertexCompression();
+
+	//! Return true if instanced rendering of instances sharing their geometries is activated
+	static bool isInstancingActivated();
+
+	//! Return the number of instances drawn by each mesh draw call, 0 if not instanced
+	static int drawInstanceCount();
+
 	//! Return true valid
 	static bool isValid();
 //@}
@@ -116,6 +132,9 @@ public:
 	//! Set Point Sprite support
 	static void setPointSpriteSupport();
 
+	//! Set instanced rendering support
+	static void setInstancingSupport();
+
 	//! Set the frame buffer support
 	static void setFrameBufferSupport();
 
@@ -149,6 +168,29 @@ public:
 	//! Set the frustum culling usage
 	static void setFrustumCullingUsage(bool);
 
+	//! Set the mesh vertex cache optimization usage
+	/*! Take effect on meshes finished after the call*/
+	static void setMeshOptimizationUsage(bool);
+
+	//! Set the compression of mesh VBOs and IBOs
+	/*! Take effect on meshes whose VBOs are filled after the call.
+	 *  Compressed vertex attributes are decoded by the shader, so they are used only
+	 *  if GLSL is used and the active shader has the decoding uniforms of the default
+	 *  shader. A mesh drawn with a shader without these uniforms falls back to float
+	 *  vertex attributes.
+	 *  Only the VBOs, the IBOs and the binary cache are compressed, the client side
+	 *  data of meshes stays in float and 32 bits index, so RAM usage is unchanged*/
+	static void setVertexCompression(GLC_VertexCompression::Compression compression);
+
+	//! Set the usage of instanced rendering
+	/*! Instances sharing their geometries are drawn with one draw call by
+	 *  mesh primitive group. Used only if instancing is supported and the
+	 *  active shader has an instance matrix attribute*/
+	static void setInstancingUsage(bool);
+
+	//! Set the number of instances drawn by each mesh draw call, 0 if not instanced
+	static void setDrawInstanceCount(int count);
+
 //@}
 
 //////////////////////////////////////////////////////////////////////
@@ -161,6 +203,9 @@ private:
 	//! Point Sprite supported flag
 	static bool m_PointSpriteSupported;
 
+	//! Instanced rendering supported flag
+	static bool m_IsInstancingSupported;
+
 	//! Use shader
 	static bool m_UseShader;
 
@@ -194,6 +239,18 @@ private:
 	//! Frustum culling activated
 	static bool m_IsFrustumCullingActivated;
 
+	//! Mesh vertex cache optimization activated
+	static bool m_IsMeshOptimizationActivated;
+
+	//! Compression of mesh VBOs and IBOs
+	static GLC_VertexCompression::Compression m_VertexCompression;
+
+	//! Instanced rendering activation
+	static bool m_IsInstancingActivated;
+
+	//! The number of instances drawn by each mesh draw call
+	static int m_DrawInstanceCount;
+
 	//! Frame buffer supported
 	static bool m_IsFrameBufferSupported;
 
@@ -119,6 +119,27 @@ void GLC_UniformShaderData::setModelViewProjectionMatrix(const GLC_Matrix4x4& mo
 	pCurrentShader->programShaderHandle()->setUniformValue(pCurrentShader->invModelViewLocationId(), invTmdv);
 }
 
+void GLC_UniformShaderData::setVertexDecoding(bool decodePosition, const GLfloat* pOffset, const GLfloat* pScale, bool decodeNormal)
+{
+	GLC_Shader* pCurrentShader= GLC_Shader::currentShaderHandle();
+	Q_ASSERT(NULL != pCurrentShader);
+	QOpenGLShaderProgram* pProgram= pCurrentShader->programShaderHandle();
+	pProgram->setUniformValue(pCurrentShader->decodePositionId(), decodePosition);
+	if (decodePosition)
+	{
+		pProgram->setUniformValue(pCurrentShader->positionOffsetId(), pOffset[0], pOffset[1], pOffset[2]);
+		pProgram->setUniformValue(pCurrentShader->positionScaleId(), pScale[0], pScale[1], pScale[2]);
+	}
+	pProgram->setUniformValue(pCurrentShader->decodeNormalId(), decodeNormal);
+}
+
+void GLC_UniformShaderData::setInstancingState(bool enable)
+{
+	GLC_Shader* pCurrentShader= GLC_Shader::currentShaderHandle();
+	Q_ASSERT(NULL != pCurrentShader);
+	pCurrentShader->programShaderHandle()->setUniformValue(pCurrentShader->enableInstancingId(), enable);
+}
+
 void GLC_UniformShaderData::updateAll(const GLC_Context* pContext)
 {
 	setModelViewProjectionMatrix(pContext->modelViewMatrix(), pContext->projectionMatrix());
@@ -59,6 +59,13 @@ public:
 	//! Set the model view matrix
 	void setModelViewProjectionMatrix(const GLC_Matrix4x4& modelView, const GLC_Matrix4x4& projection);
 
+	//! Set the decoding of compressed vertex attributes
+	/*! The given offset and scale, arrays of 3 floats, are used to decode quantized positions*/
+	void setVertexDecoding(bool decodePosition, const GLfloat* pOffset, const GLfloat* pScale, bool decodeNormal);
+
+	//! Set the instanced rendering state
+	void setInstancingState(bool enable);
+
 	//! Update all uniform variables
 	void updateAll(const GLC_Context* pContext);
 
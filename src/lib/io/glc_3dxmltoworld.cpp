@@ -28,15 +28,21 @@
 #include "../geometry/glc_mesh.h"
 #include "../geometry/glc_3drep.h"
 #include "glc_xmlutil.h"
+#include "glc_textscanner.h"
 
 // Quazip library
 #include "../3rdparty/quazip/quazip.h"
 #include "../3rdparty/quazip/quazipfile.h"
+#include "../3rdparty/quazip/quazipfileinfo.h"
 
 #include <QString>
 #include <QFileInfo>
 #include <QSet>
 #include <QMutexLocker>
+#include <QtConcurrent>
+#include <QThread>
+#include <QCryptographicHash>
+#include <QDataStream>
 
 //using namespace glcXmlUtil;
 
@@ -44,6 +50,120 @@ QMutex GLC_3dxmlToWorld::m_ZipMutex;
 
 static qint64 chunckSize= 10000000;
 
+class ExternRepBatch
+{
+public:
+	ExternRepBatch(const GLC_3dxmlToWorld* pParent)
+		: m_pParent(pParent)
+		, m_RepIdList()
+		, m_RepFileNameList()
+		, m_RepHash()
+		, m_SetOfAttachedFileName()
+		, m_SharedMaterialHash()
+		, m_pException(NULL)
+	{}
+
+	~ExternRepBatch()
+	{delete m_pException;}
+
+	const GLC_3dxmlToWorld* m_pParent;
+	QList<unsigned int> m_RepIdList;
+	QStringList m_RepFileNameList;
+	QHash<const unsigned int, GLC_3DRep> m_RepHash;
+	QSet<QString> m_SetOfAttachedFileName;
+	//! Worker copies of the owner loader materials mapped to the owner materials
+	QHash<GLC_Material*, GLC_Material*> m_SharedMaterialHash;
+	GLC_FileFormatException* m_pException;
+};
+
+// Replace the worker copies of the given representation by the owner loader materials
+static void replaceByOwnerMaterials(const GLC_3DRep& representation, const QHash<GLC_Material*, GLC_Material*>& sharedMaterialHash)
+{
+	if (sharedMaterialHash.isEmpty()) return;
+	const int bodyCount= representation.numberOfBody();
+	for (int i= 0; i < bodyCount; ++i)
+	{
+		GLC_Geometry* pGeom= representation.geomAt(i);
+		const MaterialHash materialHash(pGeom->materialHash());
+		MaterialHash::const_iterator iMaterial= materialHash.constBegin();
+		while (materialHash.constEnd() != iMaterial)
+		{
+			GLC_Material* pSharedMaterial= sharedMaterialHash.value(iMaterial.value());
+			if (NULL != pSharedMaterial)
+			{
+				pGeom->replaceMaterial(iMaterial.key(), pSharedMaterial);
+			}
+			++iMaterial;
+		}
+	}
+}
+
+// Return the uncompressed size of the entries of the given archive by lower case entry name
+static QHash<QString, qint64> archiveEntrySizes(const QString& archiveFileName)
+{
+	QHash<QString, qint64> subject;
+	QuaZip archive(archiveFileName);
+	archive.setFileNameCodec("UTF-8");
+	if (archive.open(QuaZip::mdUnzip))
+	{
+		QuaZipFileInfo64 fileInfo;
+		for (bool more= archive.goToFirstFile(); more; more= archive.goToNextFile())
+		{
+			if (archive.getCurrentFileInfo(&fileInfo))
+			{
+				subject.insert(fileInfo.name.toLower(), static_cast<qint64>(fileInfo.uncompressedSize));
+			}
+		}
+		archive.close();
+	}
+	return subject;
+}
+
+// Collect the CATMaterialRef ids referenced by representation data read by chunks
+class MaterialIdScanner
+{
+public:
+	MaterialIdScanner()
+		: m_Buffer()
+		, m_MaterialIds()
+	{}
+
+	//! Scan the given chunk of data, which follows the previous scanned chunk
+	void scan(const QByteArray& chunk)
+	{
+		static const QByteArray prefix("urn:3DXML:CATMaterialRef.3dxml#");
+		m_Buffer.append(chunk);
+		int keptFrom= qMax(0, m_Buffer.size() - prefix.size() + 1);
+		int index= m_Buffer.indexOf(prefix);
+		while (-1 != index)
+		{
+			const int idStart= index + prefix.size();
+			int idEnd= idStart;
+			while ((idEnd < m_Buffer.size()) && !isIdEnd(m_Buffer.at(idEnd))) ++idEnd;
+			if (idEnd == m_Buffer.size())
+			{
+				// The id continues in the next chunk
+				keptFrom= index;
+				break;
+			}
+			m_MaterialIds.insert(QString::fromUtf8(m_Buffer.constData() + idStart, idEnd - idStart));
+			index= m_Buffer.indexOf(prefix, idEnd);
+		}
+		m_Buffer.remove(0, keptFrom);
+	}
+
+	//! Return the set of scanned material ids
+	inline const QSet<QString>& materialIds() const
+	{return m_MaterialIds;}
+
+private:
+	static inline bool isIdEnd(char character)
+	{return (character == '"') || (character == '\'') || (character == '<') || (character == '>') || QChar::isSpace(static_cast<uint>(static_cast<uchar>(character)));}
+
+	QByteArray m_Buffer;
+	QSet<QString> m_MaterialIds;
+};
+
 GLC_3dxmlToWorld::GLC_3dxmlToWorld()
     : QObject()
     , m_pStreamReader(NULL)
@@ -70,6 +190,7 @@ GLC_3dxmlToWorld::GLC_3dxmlToWorld()
     , m_SetOfAttachedFileName()
     , m_CurrentFileName()
     , m_CurrentDateTime()
+    , m_CurrentContentKey()
     , m_V3OccurrenceAttribHash()
     , m_V4OccurrenceAttribList()
     , m_GetExternalRef3DName(false)
@@ -78,6 +199,8 @@ GLC_3dxmlToWorld::GLC_3dxmlToWorld()
     , m_UseZipMutex(true)
     , m_productGroupRootId(1)
     , m_UseNative(false)
+    , m_ParallelExternRepLoading(false)
+    , m_pSharedMaterialHash(NULL)
 {
 
 }
@@ -264,18 +387,20 @@ GLC_3DRep GLC_3dxmlToWorld::create3DrepFrom3dxmlRep(const QString& fileName, boo
 
 	setRepresentationFileName(&resultRep);
 
+	// With content addressing, the file must be read to find the cached representation
+	const bool useContentKey= contentAddressedCacheIsUsed();
+	const bool streamIsSet= useContentKey && setStreamReaderToFile(m_CurrentFileName, true, true);
+
 	if (QFileInfo(m_CurrentFileName).suffix().toLower() == "3dxml")
 	{
-		if (GLC_State::cacheIsUsed() && GLC_State::currentCacheManager().isUsable(m_CurrentDateTime, QFileInfo(m_FileName).baseName(), QFileInfo(m_CurrentFileName).fileName()))
+		if ((!useContentKey || streamIsSet) && repIsCached(QFileInfo(m_CurrentFileName).fileName()))
 		{
-			GLC_CacheManager cacheManager = GLC_State::currentCacheManager();
-
-			GLC_BSRep binaryRep = cacheManager.binary3DRep(QFileInfo(m_FileName).baseName(), QFileInfo(m_CurrentFileName).fileName());
+			GLC_BSRep binaryRep = cachedBinaryRep(QFileInfo(m_CurrentFileName).fileName());
 			resultRep = binaryRep.loadRep();
 		}
 		else
 		{
-			if (setStreamReaderToFile(m_CurrentFileName, true))
+			if (streamIsSet || (!useContentKey && setStreamReaderToFile(m_CurrentFileName, true)))
 			{
 				GLC_StructReference* pStructRef = createReferenceRep(QString(), NULL);
 				if ((NULL != pStructRef) && pStructRef->hasRepresentation())
@@ -293,15 +418,14 @@ GLC_3DRep GLC_3dxmlToWorld::create3DrepFrom3dxmlRep(const QString& fileName, boo
 	}
 	else if ((QFileInfo(m_CurrentFileName).suffix().toLower() == "3drep") || (QFileInfo(m_CurrentFileName).suffix().toLower() == "xml"))
 	{
-        if (GLC_State::cacheIsUsed() && GLC_State::currentCacheManager().isUsable(m_CurrentDateTime, QFileInfo(m_FileName).baseName(), QFileInfo(m_CurrentFileName).fileName()))
+        if ((!useContentKey || streamIsSet) && repIsCached(QFileInfo(m_CurrentFileName).fileName()))
 		{
-			GLC_CacheManager cacheManager = GLC_State::currentCacheManager();
-			GLC_BSRep binaryRep = cacheManager.binary3DRep(QFileInfo(m_FileName).baseName(), QFileInfo(m_CurrentFileName).fileName());
+			GLC_BSRep binaryRep = cachedBinaryRep(QFileInfo(m_CurrentFileName).fileName());
 			resultRep = binaryRep.loadRep();
 		}
 		else
 		{
-			if (setStreamReaderToFile(m_CurrentFileName, true))
+			if (streamIsSet || (!useContentKey && setStreamReaderToFile(m_CurrentFileName, true)))
 			{
 				resultRep = loadCurrentExtRep();
 			}
@@ -312,6 +436,69 @@ GLC_3DRep GLC_3dxmlToWorld::create3DrepFrom3dxmlRep(const QString& fileName, boo
 	return resultRep;
 }
 
+// Return the bounding box of the given 3DXML rep from the cache
+GLC_BoundingBox GLC_3dxmlToWorld::cachedBoundingBoxOf3dxmlRep(const QString& fileName)
+{
+	GLC_BoundingBox subject;
+
+	// With content addressing, the rep must be read to find the cached representation
+	if (!GLC_State::cacheIsUsed() || contentAddressedCacheIsUsed()) return subject;
+
+	m_FileName= glc::archiveFileName(fileName);
+	m_CurrentFileName= glc::archiveEntryFileName(fileName);
+	m_CurrentContentKey.clear();
+	if (glc::isArchiveString(fileName))
+	{
+		m_CurrentDateTime= QFileInfo(m_FileName).lastModified();
+	}
+	else if (glc::isFileString(fileName))
+	{
+		m_CurrentDateTime= QFileInfo(m_CurrentFileName).lastModified();
+	}
+	else
+	{
+		return subject;
+	}
+
+	const QString repFileName(QFileInfo(m_CurrentFileName).fileName());
+	if (repIsCached(repFileName))
+	{
+		GLC_BSRep binaryRep= cachedBinaryRep(repFileName);
+		subject= binaryRep.boundingBox();
+	}
+
+	return subject;
+}
+
+// Return the data size of each of the given 3DXML reps
+QList<qint64> GLC_3dxmlToWorld::repDataSizes(const QStringList& fileNameList)
+{
+	QMutexLocker zipLocker(&m_ZipMutex);
+
+	QHash<QString, QHash<QString, qint64> > entrySizesHash;
+	QList<qint64> subject;
+	for (const QString& fileName : fileNameList)
+	{
+		qint64 size= 0;
+		if (glc::isArchiveString(fileName))
+		{
+			const QString archiveFileName(glc::archiveFileName(fileName));
+			if (!entrySizesHash.contains(archiveFileName))
+			{
+				entrySizesHash.insert(archiveFileName, archiveEntrySizes(archiveFileName));
+			}
+			size= entrySizesHash.value(archiveFileName).value(glc::archiveEntryFileName(fileName).toLower());
+		}
+		else if (glc::isFileString(fileName))
+		{
+			size= QFileInfo(glc::archiveEntryFileName(fileName)).size();
+		}
+		subject.append(size);
+	}
+
+	return subject;
+}
+
 //////////////////////////////////////////////////////////////////////
 // Private services functions
 //////////////////////////////////////////////////////////////////////
@@ -879,11 +1066,13 @@ void GLC_3dxmlToWorld::loadExternalRef3D()
 			m_CurrentDateTime= QFileInfo(QFileInfo(m_FileName).absolutePath() + QDir::separator() + QFileInfo(m_CurrentFileName).fileName()).lastModified();
 		}
 
-		if (!m_LoadStructureOnly && GLC_State::cacheIsUsed() && GLC_State::currentCacheManager().isUsable(m_CurrentDateTime, QFileInfo(m_FileName).baseName(), m_CurrentFileName))
-		{
-			GLC_CacheManager cacheManager= GLC_State::currentCacheManager();
+		// With content addressing, the file must be read to find the cached representation
+		const bool useContentKey= !m_LoadStructureOnly && contentAddressedCacheIsUsed();
+		const bool streamIsSet= useContentKey && setStreamReaderToFile(m_CurrentFileName, false, true);
 
-			GLC_BSRep binaryRep= cacheManager.binary3DRep(QFileInfo(m_FileName).baseName(), m_CurrentFileName);
+		if (!m_LoadStructureOnly && (!useContentKey || streamIsSet) && repIsCached(m_CurrentFileName))
+		{
+			GLC_BSRep binaryRep= cachedBinaryRep(m_CurrentFileName);
 			GLC_3DRep* pRep= new GLC_3DRep(binaryRep.loadRep());
 
 			setRepresentationFileName(pRep);
@@ -893,7 +1082,7 @@ void GLC_3dxmlToWorld::loadExternalRef3D()
 			m_ExternalReferenceHash.insert(m_CurrentFileName, pCurrentRef);
 
 		}
-		else if (!m_LoadStructureOnly && setStreamReaderToFile(m_CurrentFileName))
+		else if (!m_LoadStructureOnly && (streamIsSet || (!useContentKey && setStreamReaderToFile(m_CurrentFileName))))
 		{
 
 			// Avoid recursive call off createReferenceRep
@@ -1067,8 +1256,7 @@ GLC_StructReference* GLC_3dxmlToWorld::createReferenceRep(QString repId, GLC_3DR
 				{
 					if (GLC_State::cacheIsUsed())
 					{
-						GLC_CacheManager currentManager= GLC_State::currentCacheManager();
-						if (!currentManager.addToCache(QFileInfo(m_FileName).baseName(), currentMesh3DRep))
+						if (!addRepToCache(currentMesh3DRep))
 						{
 							QStringList stringList("GLC_3dxmlToWorld::createReferenceRep");
 							stringList.append(m_FileName);
@@ -1105,8 +1293,7 @@ GLC_StructReference* GLC_3dxmlToWorld::createReferenceRep(QString repId, GLC_3DR
 	{
 		if (GLC_State::cacheIsUsed())
 		{
-			GLC_CacheManager currentManager= GLC_State::currentCacheManager();
-			currentManager.addToCache(QFileInfo(m_FileName).baseName(), currentMesh3DRep);
+			addRepToCache(currentMesh3DRep);
 		}
 
 		return new GLC_StructReference(new GLC_3DRep(currentMesh3DRep));
@@ -1319,57 +1506,40 @@ void GLC_3dxmlToWorld::loadFace(GLC_Mesh* pMesh, const int lod, double accuracy)
 	// Trying to find triangles
 	if (!triangles.isEmpty())
 	{
-		// For 3dvia mesh
-		if (triangles.contains(','))
-		{
-			triangles.remove(',');
-		}
-		QTextStream trianglesStream(&triangles);
+		// Commas are separators for 3dvia mesh
 		IndexList trianglesIndex;
-		QString buff;
-		while ((!trianglesStream.atEnd()))
-		{
-			trianglesStream >> buff;
-			trianglesIndex.append(buff.toUInt());
-		}
+		glcTextScanner::appendIndexes(triangles, &trianglesIndex);
 		pMesh->addTriangles(pCurrentMaterial, trianglesIndex, lod, accuracy);
 	}
 	// Trying to find trips
 	if (!strips.isEmpty())
 	{
 
-		QStringList stripsList(strips.split(","));
-		const int size= stripsList.size();
-		for (int i= 0; i < size; ++i)
+		const QStringView stripsView(strips);
+		int stripStart= 0;
+		while (stripStart < stripsView.size())
 		{
-			//qDebug() << "Strip " << stripsList.at(i);
-			QTextStream stripsStream(&stripsList[i]);
+			int stripEnd= strips.indexOf(QLatin1Char(','), stripStart);
+			if (-1 == stripEnd) stripEnd= stripsView.size();
 			IndexList stripsIndex;
-			QString buff;
-			while ((!stripsStream.atEnd()))
-			{
-				stripsStream >> buff;
-				stripsIndex.append(buff.toUInt());
-			}
+			glcTextScanner::appendIndexes(stripsView.mid(stripStart, stripEnd - stripStart), &stripsIndex);
 			pMesh->addTrianglesStrip(pCurrentMaterial, stripsIndex, lod, accuracy);
+			stripStart= stripEnd + 1;
 		}
 	}
 	// Trying to find fans
 	if (!fans.isEmpty())
 	{
-		QStringList fansList(fans.split(","));
-		const int size= fansList.size();
-		for (int i= 0; i < size; ++i)
+		const QStringView fansView(fans);
+		int fanStart= 0;
+		while (fanStart < fansView.size())
 		{
-			QTextStream fansStream(&fansList[i]);
+			int fanEnd= fans.indexOf(QLatin1Char(','), fanStart);
+			if (-1 == fanEnd) fanEnd= fansView.size();
 			IndexList fansIndex;
-			QString buff;
-			while ((!fansStream.atEnd()))
-			{
-				fansStream >> buff;
-				fansIndex.append(buff.toUInt());
-			}
+			glcTextScanner::appendIndexes(fansView.mid(fanStart, fanEnd - fanStart), &fansIndex);
 			pMesh->addTrianglesFan(pCurrentMaterial, fansIndex, lod, accuracy);
+			fanStart= fanEnd + 1;
 		}
 	}
 
@@ -1380,18 +1550,11 @@ void GLC_3dxmlToWorld::loadPolyline(GLC_Mesh* pMesh)
 {
 	QString data= readAttribute("vertices", true);
 
-	data.replace(',', ' ');
-	QTextStream dataStream(&data);
-	QList<GLfloat> values;
-	QString buff;
-	while ((!dataStream.atEnd()))
-	{
-		dataStream >> buff;
-		values.append(buff.toFloat());
-	}
+	GLfloatVector values;
+	glcTextScanner::appendFloats(data, &values);
 	if ((values.size() % 3) == 0)
 	{
-		pMesh->addVerticeGroup(values.toVector());
+		pMesh->addVerticeGroup(values);
 	}
 	else
 	{
@@ -1443,6 +1606,13 @@ GLC_Material* GLC_3dxmlToWorld::loadSurfaceAttributes()
 					checkForXmlError("Material ID not found");
 					QString materialId= readAttribute("id", true).remove("urn:3DXML:CATMaterialRef.3dxml#");
 					pMaterial= m_MaterialHash.value(materialId);
+					if ((NULL == pMaterial) && (NULL != m_pSharedMaterialHash) && m_pSharedMaterialHash->contains(materialId))
+					{
+						// Materials of the owner loader are copied to not be shared between threads
+						// the copies are replaced by the owner materials when the batch is merged
+						pMaterial= new GLC_Material(*(m_pSharedMaterialHash->value(materialId)));
+						m_MaterialHash.insert(materialId, pMaterial);
+					}
 				}
 			}
 
@@ -1489,9 +1659,10 @@ GLC_Material* GLC_3dxmlToWorld::getMaterial()
 }
 
 // Set the stream reader to the specified file
-bool GLC_3dxmlToWorld::setStreamReaderToFile(QString fileName, bool test)
+bool GLC_3dxmlToWorld::setStreamReaderToFile(QString fileName, bool test, bool computeContentKey)
 {
 	m_CurrentFileName= fileName;
+	m_CurrentContentKey.clear();
 	if (m_IsInArchive)
 	{
         if (m_UseZipMutex) m_ZipMutex.lock();
@@ -1545,6 +1716,16 @@ bool GLC_3dxmlToWorld::setStreamReaderToFile(QString fileName, bool test)
 			currentByteArray= p3dxmlFile->read(chunckSize);
 			m_ByteArrayList.append(currentByteArray);
 		}
+		if (computeContentKey)
+		{
+			MaterialIdScanner scanner;
+			const int chunkCount= m_ByteArrayList.count();
+			for (int i= 0; i < chunkCount; ++i)
+			{
+				scanner.scan(m_ByteArrayList.at(i));
+			}
+			m_CurrentContentKey= GLC_CacheManager::contentKey(m_ByteArrayList) + materialContentKey(scanner.materialIds());
+		}
 		m_pStreamReader= new QXmlStreamReader(m_ByteArrayList.takeFirst());
 		delete p3dxmlFile;
         if (m_UseZipMutex) m_ZipMutex.unlock();
@@ -1576,6 +1757,19 @@ bool GLC_3dxmlToWorld::setStreamReaderToFile(QString fileName, bool test)
 		// Test if the file is a binary
 		checkFileValidity(m_pCurrentFile);
 
+		if (computeContentKey)
+		{
+			m_CurrentContentKey= GLC_CacheManager::contentKey(m_pCurrentFile);
+			m_pCurrentFile->seek(0);
+			MaterialIdScanner scanner;
+			while (!m_pCurrentFile->atEnd())
+			{
+				scanner.scan(m_pCurrentFile->read(chunckSize));
+			}
+			m_CurrentContentKey+= materialContentKey(scanner.materialIds());
+			m_pCurrentFile->seek(0);
+		}
+
 		// Set the stream reader
 		delete m_pStreamReader;
 		m_pStreamReader= new QXmlStreamReader(m_pCurrentFile);
@@ -1583,6 +1777,60 @@ bool GLC_3dxmlToWorld::setStreamReaderToFile(QString fileName, bool test)
 	return true;
 }
 
+// Return true if the cache is used with content addressing
+bool GLC_3dxmlToWorld::contentAddressedCacheIsUsed()
+{
+	return GLC_State::cacheIsUsed() && GLC_State::currentCacheManager().contentAddressingIsUsed();
+}
+
+// Return true if the representation of the given file is usable in the cache
+bool GLC_3dxmlToWorld::repIsCached(const QString& fileName) const
+{
+	bool isCached= false;
+	if (GLC_State::cacheIsUsed())
+	{
+		const GLC_CacheManager& cacheManager= GLC_State::currentCacheManager();
+		if (!m_CurrentContentKey.isEmpty())
+		{
+			// The time stamp of a content addressed representation is not checked
+			isCached= cacheManager.isUsable(QDateTime(), GLC_CacheManager::contentContext(), m_CurrentContentKey);
+		}
+		else
+		{
+			isCached= cacheManager.isUsable(m_CurrentDateTime, QFileInfo(m_FileName).baseName(), fileName);
+		}
+	}
+	return isCached;
+}
+
+// Return the binary representation of the given file from the cache
+GLC_BSRep GLC_3dxmlToWorld::cachedBinaryRep(const QString& fileName) const
+{
+	const GLC_CacheManager& cacheManager= GLC_State::currentCacheManager();
+	if (!m_CurrentContentKey.isEmpty())
+	{
+		return cacheManager.binary3DRep(GLC_CacheManager::contentContext(), m_CurrentContentKey);
+	}
+	else
+	{
+		return cacheManager.binary3DRep(QFileInfo(m_FileName).baseName(), fileName);
+	}
+}
+
+// Add the given representation of the current file to the cache
+bool GLC_3dxmlToWorld::addRepToCache(const GLC_3DRep& rep) const
+{
+	GLC_CacheManager cacheManager= GLC_State::currentCacheManager();
+	if (!m_CurrentContentKey.isEmpty())
+	{
+		return cacheManager.addToCache(GLC_CacheManager::contentContext(), m_CurrentContentKey, rep);
+	}
+	else
+	{
+		return cacheManager.addToCache(QFileInfo(m_FileName).baseName(), rep);
+	}
+}
+
 // Load the local representation
 void GLC_3dxmlToWorld::loadLocalRepresentations()
 {
@@ -1867,96 +2115,91 @@ void GLC_3dxmlToWorld::loadExternRepresentations()
 	int currentFileIndex= 0;
 	emit currentQuantum(currentQuantumValue);
 
-	// Load all external rep
-    ReferenceRepHash::const_iterator iRefRep= m_ReferenceRepHash.constBegin();
-	while (iRefRep != m_ReferenceRepHash.constEnd())
+	if (m_ParallelExternRepLoading && !m_UseNative && !m_LoadStructureOnly && !m_FileName.isEmpty())
 	{
-		m_CurrentFileName= iRefRep.value();
-		const unsigned int id= iRefRep.key();
-
-		if (!m_IsInArchive)
+		loadExternRepresentationsInParallel(&repHash);
+	}
+	else
+	{
+		// Load all external rep
+	    ReferenceRepHash::const_iterator iRefRep= m_ReferenceRepHash.constBegin();
+		while (iRefRep != m_ReferenceRepHash.constEnd())
 		{
-			// Get the 3DXML time stamp
-			m_CurrentDateTime= QFileInfo(QFileInfo(m_FileName).absolutePath() + QDir::separator() + QFileInfo(m_CurrentFileName).fileName()).lastModified();
-		}
-
-        if (m_UseNative)
-        {
-            GLC_3DRep representation;
-            QuaZipFile* p3dxmlFile= new QuaZipFile(m_p3dxmlArchive);
-            // Get the file of the 3dxml
-            if (m_p3dxmlArchive->setCurrentFile(m_CurrentFileName, QuaZip::csInsensitive))
-            {
-                if(p3dxmlFile->open(QIODevice::ReadOnly))
-                {
-                    QDataStream dataStream(p3dxmlFile);
-                    dataStream >> representation;
-                    setRepresentationFileName(&representation);
-                }
-                else
-                {
-                    QString message(QString("GLC_3dxmlToWorld::setStreamReaderToFile Unable to Open ") + m_CurrentFileName);
-                    GLC_FileFormatException fileFormatException(message, m_CurrentFileName, GLC_FileFormatException::FileNotSupported);
-                    clear();
-                    delete p3dxmlFile;
-                    throw(fileFormatException);
-                }
-
-                if (!representation.isEmpty())
-                {
-                    repHash.insert(id, representation);
-                }
+			m_CurrentFileName= iRefRep.value();
+			const unsigned int id= iRefRep.key();
 
-            }
-            delete p3dxmlFile;
-        }
-        else if (!m_LoadStructureOnly && setStreamReaderToFile(m_CurrentFileName))
-		{
-			GLC_3DRep representation;
-            if (GLC_State::cacheIsUsed() && GLC_State::currentCacheManager().isUsable(m_CurrentDateTime, QFileInfo(m_FileName).baseName(), QFileInfo(m_CurrentFileName).fileName()))
+			if (!m_IsInArchive)
 			{
-				GLC_CacheManager cacheManager= GLC_State::currentCacheManager();
-                GLC_BSRep binaryRep= cacheManager.binary3DRep(QFileInfo(m_FileName).baseName(), QFileInfo(m_CurrentFileName).fileName());
-				representation= binaryRep.loadRep();
-				setRepresentationFileName(&representation);
+				// Get the 3DXML time stamp
+				m_CurrentDateTime= QFileInfo(QFileInfo(m_FileName).absolutePath() + QDir::separator() + QFileInfo(m_CurrentFileName).fileName()).lastModified();
 			}
-			else
+
+	        if (m_UseNative)
+	        {
+	            GLC_3DRep representation;
+	            QuaZipFile* p3dxmlFile= new QuaZipFile(m_p3dxmlArchive);
+	            // Get the file of the 3dxml
+	            if (m_p3dxmlArchive->setCurrentFile(m_CurrentFileName, QuaZip::csInsensitive))
+	            {
+	                if(p3dxmlFile->open(QIODevice::ReadOnly))
+	                {
+	                    QDataStream dataStream(p3dxmlFile);
+	                    dataStream >> representation;
+	                    setRepresentationFileName(&representation);
+	                }
+	                else
+	                {
+	                    QString message(QString("GLC_3dxmlToWorld::setStreamReaderToFile Unable to Open ") + m_CurrentFileName);
+	                    GLC_FileFormatException fileFormatException(message, m_CurrentFileName, GLC_FileFormatException::FileNotSupported);
+	                    clear();
+	                    delete p3dxmlFile;
+	                    throw(fileFormatException);
+	                }
+
+	                if (!representation.isEmpty())
+	                {
+	                    repHash.insert(id, representation);
+	                }
+
+	            }
+	            delete p3dxmlFile;
+	        }
+	        else if (!m_LoadStructureOnly)
 			{
-				representation= loadCurrentExtRep();
-				representation.clean();
+				GLC_3DRep representation= loadExternRep(m_CurrentFileName);
+				if (!representation.isEmpty())
+				{
+					repHash.insert(id, representation);
+				}
 			}
-			if (!representation.isEmpty())
+			else if (m_LoadStructureOnly)
 			{
+				GLC_3DRep representation;
+				if (m_IsInArchive)
+				{
+					representation.setFileName(glc::builtArchiveString(m_FileName, m_CurrentFileName));
+				}
+				else
+				{
+					const QString repFileName= glc::builtFileString(m_FileName, m_CurrentFileName);
+					representation.setFileName(repFileName);
+					m_SetOfAttachedFileName << glc::archiveEntryFileName(repFileName);
+				}
+
 				repHash.insert(id, representation);
 			}
-		}
-		else if (m_LoadStructureOnly)
-		{
-			GLC_3DRep representation;
-			if (m_IsInArchive)
-			{
-				representation.setFileName(glc::builtArchiveString(m_FileName, m_CurrentFileName));
-			}
-			else
+
+	        // Progrees bar indicator
+			++currentFileIndex;
+			currentQuantumValue = static_cast<int>((static_cast<double>(currentFileIndex) / size) * 100);
+			if (currentQuantumValue > previousQuantumValue)
 			{
-				const QString repFileName= glc::builtFileString(m_FileName, m_CurrentFileName);
-				representation.setFileName(repFileName);
-				m_SetOfAttachedFileName << glc::archiveEntryFileName(repFileName);
+				emit currentQuantum(currentQuantumValue);
 			}
+			previousQuantumValue= currentQuantumValue;
 
-			repHash.insert(id, representation);
+			++iRefRep;
 		}
-
-        // Progrees bar indicator
-		++currentFileIndex;
-		currentQuantumValue = static_cast<int>((static_cast<double>(currentFileIndex) / size) * 100);
-		if (currentQuantumValue > previousQuantumValue)
-		{
-			emit currentQuantum(currentQuantumValue);
-		}
-		previousQuantumValue= currentQuantumValue;
-
-		++iRefRep;
 	}
 
 	// Attach the ref to the structure reference
@@ -1991,6 +2234,168 @@ void GLC_3dxmlToWorld::loadExternRepresentations()
 
 }
 
+// Load the extern representation on the thread pool into the given hash table
+void GLC_3dxmlToWorld::loadExternRepresentationsInParallel(QHash<const unsigned int, GLC_3DRep>* pRepHash)
+{
+	// Representations are sorted by id in order to get a deterministic result
+	QList<unsigned int> repIdList;
+	ReferenceRepHash::const_iterator iRefRep= m_ReferenceRepHash.constBegin();
+	while (iRefRep != m_ReferenceRepHash.constEnd())
+	{
+		repIdList.append(iRefRep.key());
+		++iRefRep;
+	}
+	std::sort(repIdList.begin(), repIdList.end());
+
+	// Split representations in contiguous batches, a worker loader is used by batch
+	const int repCount= repIdList.count();
+	const int batchCount= qMin(repCount, qMax(1, QThread::idealThreadCount()) * 16);
+	QList<ExternRepBatch*> batchList;
+	for (int i= 0; i < batchCount; ++i)
+	{
+		batchList.append(new ExternRepBatch(this));
+	}
+	for (int i= 0; i < repCount; ++i)
+	{
+		const unsigned int id= repIdList.at(i);
+		ExternRepBatch* pBatch= batchList.at(static_cast<int>((static_cast<qint64>(i) * batchCount) / repCount));
+		pBatch->m_RepIdList.append(id);
+		pBatch->m_RepFileNameList.append(m_ReferenceRepHash.value(id));
+	}
+
+	// Merge batches in order as soon as they are loaded
+	QFuture<ExternRepBatch*> future= QtConcurrent::mapped(batchList, loadExternRepBatch);
+	int previousQuantumValue= 0;
+	int loadedRepCount= 0;
+	ExternRepBatch* pFailedBatch= NULL;
+	for (int i= 0; i < batchCount; ++i)
+	{
+		ExternRepBatch* pBatch= future.resultAt(i);
+		if (NULL != pBatch->m_pException)
+		{
+			if (NULL == pFailedBatch) pFailedBatch= pBatch;
+		}
+		else
+		{
+			QHash<const unsigned int, GLC_3DRep>::const_iterator iRep= pBatch->m_RepHash.constBegin();
+			while (iRep != pBatch->m_RepHash.constEnd())
+			{
+				replaceByOwnerMaterials(iRep.value(), pBatch->m_SharedMaterialHash);
+				pRepHash->insert(iRep.key(), iRep.value());
+				++iRep;
+			}
+			m_SetOfAttachedFileName.unite(pBatch->m_SetOfAttachedFileName);
+			pBatch->m_RepHash.clear();
+		}
+
+		// Progrees bar indicator
+		loadedRepCount+= pBatch->m_RepIdList.count();
+		const int currentQuantumValue = static_cast<int>((static_cast<double>(loadedRepCount) / repCount) * 100);
+		if (currentQuantumValue > previousQuantumValue)
+		{
+			emit currentQuantum(currentQuantumValue);
+		}
+		previousQuantumValue= currentQuantumValue;
+	}
+
+	if (NULL != pFailedBatch)
+	{
+		GLC_FileFormatException fileFormatException(*(pFailedBatch->m_pException));
+		qDeleteAll(batchList);
+		clear();
+		throw(fileFormatException);
+	}
+	qDeleteAll(batchList);
+}
+
+// Load the extern representation of the given file
+GLC_3DRep GLC_3dxmlToWorld::loadExternRep(const QString& fileName)
+{
+	GLC_3DRep representation;
+	m_CurrentFileName= fileName;
+	if (setStreamReaderToFile(m_CurrentFileName, false, contentAddressedCacheIsUsed()))
+	{
+		if (repIsCached(QFileInfo(m_CurrentFileName).fileName()))
+		{
+			GLC_BSRep binaryRep= cachedBinaryRep(QFileInfo(m_CurrentFileName).fileName());
+			representation= binaryRep.loadRep();
+			setRepresentationFileName(&representation);
+		}
+		else
+		{
+			representation= loadCurrentExtRep();
+			representation.clean();
+		}
+	}
+	return representation;
+}
+
+// Load the extern representations of the given batch
+ExternRepBatch* GLC_3dxmlToWorld::loadExternRepBatch(ExternRepBatch* pBatch)
+{
+	const GLC_3dxmlToWorld* pParent= pBatch->m_pParent;
+
+	// The worker loader has its own archive handle and XML reader
+	GLC_3dxmlToWorld worker;
+	worker.m_FileName= pParent->m_FileName;
+	worker.m_IsInArchive= pParent->m_IsInArchive;
+	worker.m_CurrentDateTime= pParent->m_CurrentDateTime;
+	worker.m_TextureImagesHash= pParent->m_TextureImagesHash;
+	worker.m_pSharedMaterialHash= &(pParent->m_MaterialHash);
+	worker.m_UseZipMutex= false;
+
+	try
+	{
+		if (worker.m_IsInArchive)
+		{
+			worker.m_p3dxmlArchive= new QuaZip(worker.m_FileName);
+			worker.m_p3dxmlArchive->setFileNameCodec("UTF-8");
+			if (!worker.m_p3dxmlArchive->open(QuaZip::mdUnzip))
+			{
+				QString message(QString("GLC_3dxmlToWorld::loadExternRepBatch Unable to open ") + worker.m_FileName);
+				GLC_FileFormatException fileFormatException(message, worker.m_FileName, GLC_FileFormatException::FileNotSupported);
+				throw(fileFormatException);
+			}
+		}
+
+		const int repCount= pBatch->m_RepIdList.count();
+		for (int i= 0; i < repCount; ++i)
+		{
+			const QString fileName(pBatch->m_RepFileNameList.at(i));
+			if (!worker.m_IsInArchive)
+			{
+				// Get the 3DXML time stamp
+				worker.m_CurrentDateTime= QFileInfo(QFileInfo(worker.m_FileName).absolutePath() + QDir::separator() + QFileInfo(fileName).fileName()).lastModified();
+			}
+			GLC_3DRep representation= worker.loadExternRep(fileName);
+			if (!representation.isEmpty())
+			{
+				pBatch->m_RepHash.insert(pBatch->m_RepIdList.at(i), representation);
+			}
+		}
+		pBatch->m_SetOfAttachedFileName= worker.m_SetOfAttachedFileName;
+
+		// Used copies are replaced by the owner materials when the batch is merged
+		MaterialHash::const_iterator iMaterial= worker.m_MaterialHash.constBegin();
+		while (worker.m_MaterialHash.constEnd() != iMaterial)
+		{
+			GLC_Material* pSharedMaterial= pParent->m_MaterialHash.value(iMaterial.key());
+			if ((NULL != pSharedMaterial) && !iMaterial.value()->isUnused())
+			{
+				pBatch->m_SharedMaterialHash.insert(iMaterial.value(), pSharedMaterial);
+			}
+			++iMaterial;
+		}
+	}
+	catch (GLC_FileFormatException& e)
+	{
+		pBatch->m_pException= new GLC_FileFormatException(e);
+		pBatch->m_RepHash.clear();
+	}
+
+	return pBatch;
+}
+
 // Return the instance of the current extern representation
 GLC_3DRep GLC_3dxmlToWorld::loadCurrentExtRep()
 {
@@ -2023,8 +2428,7 @@ GLC_3DRep GLC_3dxmlToWorld::loadCurrentExtRep()
 
 				if (GLC_State::cacheIsUsed())
 				{
-					GLC_CacheManager currentManager= GLC_State::currentCacheManager();
-					currentManager.addToCache(QFileInfo(m_FileName).baseName(), currentMeshRep);
+					addRepToCache(currentMeshRep);
 				}
 
 				return currentMeshRep;
@@ -2047,8 +2451,7 @@ GLC_3DRep GLC_3dxmlToWorld::loadCurrentExtRep()
 
 	if (GLC_State::cacheIsUsed())
 	{
-		GLC_CacheManager currentManager= GLC_State::currentCacheManager();
-		currentManager.addToCache(QFileInfo(m_FileName).baseName(), currentMeshRep);
+		addRepToCache(currentMeshRep);
 	}
 
 	return currentMeshRep;
@@ -2098,6 +2501,39 @@ void GLC_3dxmlToWorld::loadCatMaterialRef()
 	}
 }
 
+// Return the content key of the given CATMaterialRef materials, empty if none of them is known
+QString GLC_3dxmlToWorld::materialContentKey(const QSet<QString>& materialIds) const
+{
+	// Representations refer to materials by id, so their resolved materials are part of the cached content
+	QStringList materialIdList(materialIds.values());
+	std::sort(materialIdList.begin(), materialIdList.end());
+	QByteArray data;
+	QDataStream stream(&data, QIODevice::WriteOnly);
+	const int count= materialIdList.count();
+	for (int i= 0; i < count; ++i)
+	{
+		const QString& materialId= materialIdList.at(i);
+		const GLC_Material* pMaterial= m_MaterialHash.value(materialId);
+		if ((NULL == pMaterial) && (NULL != m_pSharedMaterialHash))
+		{
+			pMaterial= m_pSharedMaterialHash->value(materialId);
+		}
+		if (NULL == pMaterial) continue;
+
+		stream << materialId << pMaterial->name();
+		stream << pMaterial->ambientColor() << pMaterial->diffuseColor() << pMaterial->specularColor() << pMaterial->emissiveColor();
+		stream << pMaterial->shininess() << pMaterial->opacity();
+		stream << (pMaterial->hasTexture() ? pMaterial->textureHandle()->fileName() : QString());
+	}
+
+	QString subject;
+	if (!data.isEmpty())
+	{
+		subject= '_' + QString::fromLatin1(QCryptographicHash::hash(data, QCryptographicHash::Md5).toHex());
+	}
+	return subject;
+}
+
 // Create material from material def file
 void GLC_3dxmlToWorld::loadMaterialDef(const MaterialRef& materialRef)
 {
@@ -2448,21 +2884,15 @@ void GLC_3dxmlToWorld::loadRep(GLC_Mesh* pMesh)
 void GLC_3dxmlToWorld::loadVertexBuffer(GLC_Mesh* pMesh)
 {
 	{
-		QString verticePosition= getContent(m_pStreamReader, "Positions").replace(',', ' ');
+		const QString verticePosition= getContent(m_pStreamReader, "Positions");
 		//qDebug() << "Position " << verticePosition;
 		checkForXmlError("Error while retrieving Position ContentVertexBuffer");
 		// Load Vertice position
-		QTextStream verticeStream(&verticePosition);
-		QList<GLfloat> verticeValues;
-		QString buff;
-		while ((!verticeStream.atEnd()))
-		{
-			verticeStream >> buff;
-			verticeValues.append(buff.toFloat());
-		}
+		GLfloatVector verticeValues;
+		glcTextScanner::appendFloats(verticePosition, &verticeValues);
 		if ((verticeValues.size() % 3) == 0)
 		{
-			pMesh->addVertice(verticeValues.toVector());
+			pMesh->addVertice(verticeValues);
 		}
 		else
 		{
@@ -2478,21 +2908,15 @@ void GLC_3dxmlToWorld::loadVertexBuffer(GLC_Mesh* pMesh)
 	}
 
 	{
-		QString normals= getContent(m_pStreamReader, "Normals").replace(',', ' ');
+		const QString normals= getContent(m_pStreamReader, "Normals");
 		//qDebug() << "Normals " << normals;
 		checkForXmlError("Error while retrieving Normals values");
 		// Load Vertice Normals
-		QTextStream normalsStream(&normals);
-		QList<GLfloat> normalValues;
-		QString buff;
-		while ((!normalsStream.atEnd()))
-		{
-			normalsStream >> buff;
-			normalValues.append(buff.toFloat());
-		}
+		GLfloatVector normalValues;
+		glcTextScanner::appendFloats(normals, &normalValues);
 		if ((normalValues.size() % 3) == 0)
 		{
-			pMesh->addNormals(normalValues.toVector());
+			pMesh->addNormals(normalValues);
 		}
 		else
 		{
@@ -2512,20 +2936,14 @@ void GLC_3dxmlToWorld::loadVertexBuffer(GLC_Mesh* pMesh)
 	{
 		if ((QXmlStreamReader::StartElement == m_pStreamReader->tokenType()) && (m_pStreamReader->name() == "TextureCoordinates"))
 		{
-			QString texels= getContent(m_pStreamReader, "TextureCoordinates").replace(',', ' ');
+			const QString texels= getContent(m_pStreamReader, "TextureCoordinates");
 			checkForXmlError("Error while retrieving Texture coordinates");
-			QTextStream texelStream(&texels);
-			QList<GLfloat> texelValues;
-			QString buff;
-			while ((!texelStream.atEnd()))
-			{
-				texelStream >> buff;
-				texelValues.append(buff.toFloat());
-			}
+			GLfloatVector texelValues;
+			glcTextScanner::appendFloats(texels, &texelValues);
 
 			if ((texelValues.size() % 2) == 0)
 			{
-				pMesh->addTexels(texelValues.toVector());
+				pMesh->addTexels(texelValues);
 			}
 			else
 			{
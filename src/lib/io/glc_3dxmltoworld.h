@@ -43,6 +43,8 @@ class GLC_StructReference;
 class GLC_StructInstance;
 class GLC_StructOccurrence;
 class GLC_Mesh;
+class ExternRepBatch;
+class GLC_BSRep;
 
 //////////////////////////////////////////////////////////////////////
 //! \class GLC_3dxmlToWorld
@@ -155,10 +157,29 @@ public:
 	//! Create 3DRep from an 3DXML rep
     GLC_3DRep create3DrepFrom3dxmlRep(const QString&, bool useZipMutex= true);
 
+	//! Return the bounding box of the given 3DXML rep from the cache
+	/*! Return an empty bounding box if the rep is not cached or if the cache use content addressing*/
+	GLC_BoundingBox cachedBoundingBoxOf3dxmlRep(const QString& fileName);
+
+	//! Return the data size of each of the given 3DXML reps, 0 if it is not known
+	/*! The size of a rep in an archive is the uncompressed size of its entry,
+	 *  each archive is opened once*/
+	static QList<qint64> repDataSizes(const QStringList& fileNameList);
+
 	//! Get the list of attached files
 	inline QStringList listOfAttachedFileName() const
     {return m_SetOfAttachedFileName.values();}
 
+	//! Set parallel loading of external representations
+	/*! If activated, external representations are decompressed and parsed on the
+	 *  global thread pool, each worker using its own archive handle and XML reader*/
+	inline void setParallelExternRepLoading(bool parallel)
+	{m_ParallelExternRepLoading= parallel;}
+
+	//! Return true if external representations are loaded in parallel
+	inline bool parallelExternRepLoadingIsActivated() const
+	{return m_ParallelExternRepLoading;}
+
 
 //@}
 
@@ -238,7 +259,20 @@ private:
 	GLC_Material* getMaterial();
 
 	//! Set the stream reader to the specified file
-	bool setStreamReaderToFile(QString, bool test= false);
+	/*! If computeContentKey is true, the content key of the file is computed for the cache*/
+	bool setStreamReaderToFile(QString, bool test= false, bool computeContentKey= false);
+
+	//! Return true if the cache is used with content addressing
+	static bool contentAddressedCacheIsUsed();
+
+	//! Return true if the representation of the given file is usable in the cache
+	bool repIsCached(const QString& fileName) const;
+
+	//! Return the binary representation of the given file from the cache
+	GLC_BSRep cachedBinaryRep(const QString& fileName) const;
+
+	//! Add the given representation of the current file to the cache
+	bool addRepToCache(const GLC_3DRep& rep) const;
 
 	//! Load default view element
 	void loadDefaultView();
@@ -261,6 +295,15 @@ private:
 	//! Load the extern representation
 	void loadExternRepresentations();
 
+	//! Load the extern representation on the thread pool into the given hash table
+	void loadExternRepresentationsInParallel(QHash<const unsigned int, GLC_3DRep>* pRepHash);
+
+	//! Load the extern representation of the given file
+	GLC_3DRep loadExternRep(const QString& fileName);
+
+	//! Load the extern representations of the given batch
+	static ExternRepBatch* loadExternRepBatch(ExternRepBatch* pBatch);
+
 	//! Return the instance of the current extern representation
 	GLC_3DRep loadCurrentExtRep();
 
@@ -270,6 +313,11 @@ private:
 	//! Create material from material def file
 	void loadMaterialDef(const MaterialRef&);
 
+	//! Return the content key of the given CATMaterialRef materials, appended to representation content keys
+	/*! Only the materials referenced by a representation are part of its key, so identical
+	 *  representations share their cache entry whatever the other materials of the archive*/
+	QString materialContentKey(const QSet<QString>& materialIds) const;
+
 	//! Load CATRepIage if present
 	void loadCatRepImage();
 
@@ -390,6 +438,9 @@ private:
 	//! The current file time and date
 	QDateTime m_CurrentDateTime;
 
+	//! The cache content key of the current file
+	QString m_CurrentContentKey;
+
 	//! Hash table of occurrence specific attributes for 3DXML V3
 	QHash<unsigned int, V3OccurrenceAttrib*> m_V3OccurrenceAttribHash;
 
@@ -413,6 +464,12 @@ private:
 
     bool m_UseNative;
 
+	//! Flag to know if extern representations are loaded in parallel
+	bool m_ParallelExternRepLoading;
+
+	//! Material hash table of the loader which owns this one (parallel loading)
+	const MaterialHash* m_pSharedMaterialHash;
+
 };
 
 QXmlStreamReader::TokenType GLC_3dxmlToWorld::readNext()
@@ -33,21 +33,50 @@
 #include "glc_3dxmltoworld.h"
 #include "glc_colladatoworld.h"
 #include "glc_bsreptoworld.h"
+#include "glc_gltftoworld.h"
 
 #include "../sceneGraph/glc_world.h"
+#include "../sceneGraph/glc_structreference.h"
+#include "../sceneGraph/glc_structoccurrence.h"
+#include "../viewport/glc_viewport.h"
 #include "../glc_fileformatexception.h"
+#include "../glc_errorlog.h"
 #include "../glc_factory.h"
 #include "glc_worldreaderplugin.h"
 
+#include <QtConcurrent>
+#include <QThread>
+
+#include <algorithm>
+
+// Return true if the priority of the first reference is greater than the second one
+static bool priorityGreaterThan(const QPair<double, GLC_StructReference*>& first, const QPair<double, GLC_StructReference*>& second)
+{
+	return first.first > second.first;
+}
+
 //////////////////////////////////////////////////////////////////////
 // Constructor
 //////////////////////////////////////////////////////////////////////
 GLC_FileLoader::GLC_FileLoader()
+: QObject()
+, m_ProgressiveWorld()
+, m_PendingReferenceList()
+, m_CurrentBatch()
+, m_ReferenceBoundingBoxHash()
+, m_ReferenceDataSizeHash()
+, m_pPriorityViewport(NULL)
+, m_ProgressiveBatchSize(qMax(1, QThread::idealThreadCount()) * 4)
+, m_ProgressiveReferenceCount(0)
+, m_LoadedReferenceCount(0)
+, m_BatchWatcher()
 {
+	connect(&m_BatchWatcher, SIGNAL(finished()), this, SLOT(setLoadedBatch()));
 }
 
 GLC_FileLoader::~GLC_FileLoader()
 {
+	cancelProgressiveLoading();
 }
 
 /////////////////////////////////////////////////////////////////////
@@ -138,6 +167,16 @@ GLC_World GLC_FileLoader::createWorldFromFile(QFile &file, QStringList* pAttache
 			(*pAttachedFileName)= colladaToWorld.listOfAttachedFileName();
 		}
 	}
+	else if (QFileInfo(file).suffix().toLower() == "glb")
+	{
+		GLC_GltfToWorld gltfToWorld;
+		connect(&gltfToWorld, SIGNAL(currentQuantum(int)), this, SIGNAL(currentQuantum(int)));
+		pWorld= gltfToWorld.CreateWorldFromGltf(file);
+        if (nullptr != pAttachedFileName)
+		{
+			(*pAttachedFileName)= gltfToWorld.listOfAttachedFileName();
+		}
+	}
 	else if (QFileInfo(file).suffix().toLower() == "bsrep")
 	{
 		GLC_BSRepToWorld bsRepToWorld;
@@ -194,3 +233,242 @@ GLC_World GLC_FileLoader::createWorldFromIoDevice(QIODevice* pDevice, const QStr
 
     return subject;
 }
+
+// Create a GLC_World with its product structure and start loading its representations
+GLC_World GLC_FileLoader::createWorldProgressivelyFromFile(QFile &file, QStringList* pAttachedFileName)
+{
+	cancelProgressiveLoading();
+
+	GLC_World world;
+	if (QFileInfo(file).suffix().toLower() == "3dxml")
+	{
+		GLC_3dxmlToWorld d3dxmlToWorld;
+		connect(&d3dxmlToWorld, SIGNAL(currentQuantum(int)), this, SIGNAL(currentQuantum(int)));
+		GLC_World* pWorld= d3dxmlToWorld.createWorldFrom3dxml(file, true);
+		if (nullptr != pAttachedFileName)
+		{
+			(*pAttachedFileName)= d3dxmlToWorld.listOfAttachedFileName();
+		}
+		world= *pWorld;
+		delete pWorld;
+	}
+	else
+	{
+		world= createWorldFromFile(file, pAttachedFileName);
+	}
+
+	// References with a representation to load
+	QStringList fileNameList;
+	const QList<GLC_StructReference*> referenceList(world.references());
+	for (GLC_StructReference* pRef : referenceList)
+	{
+		if (pRef->hasRepresentation() && !pRef->representationIsLoaded() && !pRef->representationFileName().isEmpty())
+		{
+			m_PendingReferenceList.append(pRef);
+			fileNameList.append(pRef->representationFileName());
+		}
+	}
+	m_ProgressiveReferenceCount= m_PendingReferenceList.size();
+	m_LoadedReferenceCount= 0;
+
+	if (!m_PendingReferenceList.isEmpty())
+	{
+		m_ProgressiveWorld= world;
+
+		// Bounding boxes of the representations found in the cache
+		const QList<GLC_BoundingBox> boundingBoxList(QtConcurrent::blockingMapped<QList<GLC_BoundingBox> >(fileNameList, cachedBoundingBox));
+		const int count= boundingBoxList.size();
+		for (int i= 0; i < count; ++i)
+		{
+			if (!boundingBoxList.at(i).isEmpty())
+			{
+				m_ReferenceBoundingBoxHash.insert(m_PendingReferenceList.at(i), boundingBoxList.at(i));
+			}
+		}
+
+		// Data sizes order the representations not found in the cache
+		const QList<qint64> dataSizeList(GLC_3dxmlToWorld::repDataSizes(fileNameList));
+		for (int i= 0; i < count; ++i)
+		{
+			m_ReferenceDataSizeHash.insert(m_PendingReferenceList.at(i), dataSizeList.at(i));
+		}
+
+		loadNextBatch();
+	}
+
+	return world;
+}
+
+// Cancel the progressive loading
+void GLC_FileLoader::cancelProgressiveLoading()
+{
+	m_PendingReferenceList.clear();
+	if (m_BatchWatcher.isRunning())
+	{
+		m_BatchWatcher.cancel();
+		m_BatchWatcher.waitForFinished();
+	}
+	m_CurrentBatch.clear();
+	m_ReferenceBoundingBoxHash.clear();
+	m_ReferenceDataSizeHash.clear();
+	m_ProgressiveReferenceCount= 0;
+	m_LoadedReferenceCount= 0;
+	m_ProgressiveWorld= GLC_World();
+}
+
+// Return the bounding box of the progressively loaded world
+GLC_BoundingBox GLC_FileLoader::progressiveWorldBoundingBox() const
+{
+	GLC_BoundingBox subject;
+	QHash<const GLC_StructReference*, GLC_BoundingBox>::const_iterator iBox= m_ReferenceBoundingBoxHash.constBegin();
+	while (m_ReferenceBoundingBoxHash.constEnd() != iBox)
+	{
+		const QList<GLC_StructOccurrence*> occurrenceList(iBox.key()->listOfStructOccurrence());
+		for (const GLC_StructOccurrence* pOcc : occurrenceList)
+		{
+			GLC_BoundingBox occurrenceBox(iBox.value());
+			subject.combine(occurrenceBox.transform(pOcc->absoluteMatrix()));
+		}
+		++iBox;
+	}
+
+	return subject;
+}
+
+// Load the next batch of representations by screen size priority
+void GLC_FileLoader::loadNextBatch()
+{
+	if (m_PendingReferenceList.isEmpty())
+	{
+		m_ReferenceBoundingBoxHash.clear();
+		m_ReferenceDataSizeHash.clear();
+		m_ProgressiveWorld= GLC_World();
+		emit progressiveLoadingFinished();
+		return;
+	}
+
+	// Priorities are computed for each batch in order to follow the camera
+	QList<QPair<double, GLC_StructReference*> > priorityList;
+	for (GLC_StructReference* pRef : m_PendingReferenceList)
+	{
+		priorityList.append(qMakePair(referencePriority(pRef), pRef));
+	}
+	std::stable_sort(priorityList.begin(), priorityList.end(), priorityGreaterThan);
+
+	const int count= priorityList.size();
+	const int batchSize= qMin(m_ProgressiveBatchSize, count);
+	QStringList fileNameList;
+	m_PendingReferenceList.clear();
+	for (int i= 0; i < count; ++i)
+	{
+		GLC_StructReference* pRef= priorityList.at(i).second;
+		if (i < batchSize)
+		{
+			m_CurrentBatch.append(pRef);
+			fileNameList.append(pRef->representationFileName());
+		}
+		else
+		{
+			m_PendingReferenceList.append(pRef);
+		}
+	}
+
+	m_BatchWatcher.setFuture(QtConcurrent::mapped(fileNameList, loadRepresentation));
+}
+
+// Return the loading priority of the given reference
+double GLC_FileLoader::referencePriority(const GLC_StructReference* pRef) const
+{
+	const QList<GLC_StructOccurrence*> occurrenceList(pRef->listOfStructOccurrence());
+
+	// Without bounding box, the heaviest references are loaded first, after the ones on the screen
+	if (!m_ReferenceBoundingBoxHash.contains(pRef))
+	{
+		const double weight= static_cast<double>(m_ReferenceDataSizeHash.value(pRef)) * occurrenceList.count();
+		return -1.0 / (2.0 + weight);
+	}
+
+	const GLC_BoundingBox boundingBox(m_ReferenceBoundingBoxHash.value(pRef));
+	double subject= -1.0;
+	for (const GLC_StructOccurrence* pOcc : occurrenceList)
+	{
+		GLC_BoundingBox occurrenceBox(boundingBox);
+		occurrenceBox.transform(pOcc->absoluteMatrix());
+		const double diameter= occurrenceBox.boundingSphereRadius() * 2.0;
+		if (NULL == m_pPriorityViewport)
+		{
+			// Without viewport, the largest occurrences are loaded first
+			subject= qMax(subject, diameter);
+		}
+		else if (m_pPriorityViewport->frustum().localizeBoundingBox(occurrenceBox) != GLC_Frustum::OutFrustum)
+		{
+			// Same camera cover ratio than the one used to select the LOD
+			const GLC_Camera* pCamera= m_pPriorityViewport->cameraHandle();
+			double dist= pCamera->distEyeTarget();
+			if (!m_pPriorityViewport->useOrtho())
+			{
+				dist= qMax((occurrenceBox.center() - pCamera->eye()).length(), m_pPriorityViewport->nearClippingPlaneDist());
+			}
+			const double cameraCover= dist * m_pPriorityViewport->viewTangent();
+			subject= qMax(subject, (cameraCover > 0.0) ? (diameter / cameraCover) : 0.0);
+		}
+	}
+
+	return subject;
+}
+
+// Set the loaded representations of the current batch
+void GLC_FileLoader::setLoadedBatch()
+{
+	// The batch has been canceled
+	if (m_CurrentBatch.isEmpty()) return;
+
+	const QFuture<GLC_3DRep> future(m_BatchWatcher.future());
+	const int count= m_CurrentBatch.size();
+	for (int i= 0; i < count; ++i)
+	{
+		GLC_StructReference* pRef= m_CurrentBatch.at(i);
+		GLC_3DRep representation(future.resultAt(i));
+		if (!representation.isEmpty())
+		{
+			representation.setName(pRef->representationName());
+			// The bounding box is known as soon as the representation is loaded
+			m_ReferenceBoundingBoxHash.insert(pRef, representation.boundingBox());
+			m_ReferenceDataSizeHash.remove(pRef);
+			pRef->setRepresentation(representation);
+		}
+	}
+	m_LoadedReferenceCount+= count;
+	m_CurrentBatch.clear();
+
+	emit representationBatchLoaded(m_LoadedReferenceCount, m_ProgressiveReferenceCount);
+
+	loadNextBatch();
+}
+
+// Load the representation of the given file name
+GLC_3DRep GLC_FileLoader::loadRepresentation(const QString& fileName)
+{
+	GLC_3DRep subject;
+	try
+	{
+		GLC_3dxmlToWorld d3dxmlToWorld;
+		subject= d3dxmlToWorld.create3DrepFrom3dxmlRep(fileName, true);
+	}
+	catch (GLC_FileFormatException& e)
+	{
+		QStringList stringList("GLC_FileLoader::loadRepresentation");
+		stringList.append(e.what());
+		GLC_ErrorLog::addError(stringList);
+		subject= GLC_3DRep();
+	}
+
+	return subject;
+}
+
+// Return the cached bounding box of the representation of the given file name
+GLC_BoundingBox GLC_FileLoader::cachedBoundingBox(const QString& fileName)
+{
+	GLC_3dxmlToWorld d3dxmlToWorld;
+	return d3dxmlToWorld.cachedBoundingBoxOf3dxmlRep(fileName);
+}
@@ -32,10 +32,17 @@
 #include <QTextStream>
 #include <QColor>
 #include <QList>
+#include <QHash>
+#include <QFutureWatcher>
+
+#include "../sceneGraph/glc_world.h"
+#include "../geometry/glc_3drep.h"
+#include "../glc_boundingbox.h"
 
 #include "../glc_config.h"
 
-class GLC_World;
+class GLC_StructReference;
+class GLC_Viewport;
 
 //////////////////////////////////////////////////////////////////////
 //! \class GLC_FileLoader
@@ -43,6 +50,16 @@ class GLC_World;
 
 /*! GLC_FileLoader loads a 3D model from a file.
  * 	A suitable parser is selected based on the file name extension.
+ *
+ * 	With createWorldProgressivelyFromFile() the product structure is returned
+ * 	first, with the bounding boxes of the representations found in the cache.
+ * 	The representations are then loaded by batches on the global thread pool,
+ * 	the largest on the screen of the priority viewport first. Representations
+ * 	whose bounding box is not known follow, the ones with the largest data
+ * 	size times occurrence count first, then the ones out of the viewport.
+ * 	Each batch is set to its references in the thread of the loader as soon as
+ * 	it is loaded, its bounding boxes are recorded and representationBatchLoaded()
+ * 	is emitted. Priorities are computed again before each batch.
  */
 //////////////////////////////////////////////////////////////////////
 
@@ -67,19 +84,119 @@ public:
 	GLC_World createWorldFromFile(QFile &file, QStringList* pAttachedFileName= NULL);
 
     GLC_World createWorldFromIoDevice(QIODevice* pDevice, const QString suffix);
+
+	//! Create a GLC_World with its product structure and start loading its representations
+	/*! Formats without product structure only loading are fully loaded.
+	 *  The loading of the representations can be followed with representationBatchLoaded()*/
+	GLC_World createWorldProgressivelyFromFile(QFile &file, QStringList* pAttachedFileName= NULL);
+
+	//! Set the viewport used to sort the representations to load
+	/*! The viewport must outlive the progressive loading or be unset*/
+	inline void setPriorityViewport(GLC_Viewport* pViewport)
+	{m_pPriorityViewport= pViewport;}
+
+	//! Set the number of representations loaded by batch
+	inline void setProgressiveBatchSize(int size)
+	{m_ProgressiveBatchSize= qMax(1, size);}
+
+	//! Cancel the progressive loading, the current batch is discarded
+	void cancelProgressiveLoading();
+//@}
+
+//////////////////////////////////////////////////////////////////////
+/*! \name Get Functions*/
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Return true if representations are being loaded progressively
+	inline bool progressiveLoadingIsRunning() const
+	{return !m_PendingReferenceList.isEmpty() || !m_CurrentBatch.isEmpty();}
+
+	//! Return the bounding box of the representation of the given reference
+	/*! Return an empty bounding box if it is not known, the bounding box of a
+	 *  representation is known if it is cached or once it is loaded*/
+	inline GLC_BoundingBox referenceBoundingBox(const GLC_StructReference* pRef) const
+	{return m_ReferenceBoundingBoxHash.value(pRef);}
+
+	//! Return the bounding box of the progressively loaded world
+	/*! This bounding box contains the cached representations before they are loaded
+	 *  and grows as representations are loaded*/
+	GLC_BoundingBox progressiveWorldBoundingBox() const;
+//@}
+
+//////////////////////////////////////////////////////////////////////
+/*! @name Private services functions */
+//@{
+//////////////////////////////////////////////////////////////////////
+private:
+	//! Load the next batch of representations by screen size priority
+	void loadNextBatch();
+
+	//! Return the loading priority of the given reference
+	/*! The priority of a reference with a known bounding box is its screen size, or -1 out of
+	 *  the viewport. Otherwise, it grows with its data size times its occurrence count in ]-1, 0[*/
+	double referencePriority(const GLC_StructReference* pRef) const;
+
+	//! Load the representation of the given file name
+	static GLC_3DRep loadRepresentation(const QString& fileName);
+
+	//! Return the cached bounding box of the representation of the given file name
+	static GLC_BoundingBox cachedBoundingBox(const QString& fileName);
 //@}
 
 
+//////////////////////////////////////////////////////////////////////
+// Private slots
+//////////////////////////////////////////////////////////////////////
+private slots:
+	//! Set the loaded representations of the current batch
+	void setLoadedBatch();
+
 //////////////////////////////////////////////////////////////////////
 // Qt Signals
 //////////////////////////////////////////////////////////////////////
 	signals:
 	void currentQuantum(int);
 
+	//! Emitted after a batch of representations has been set to its references
+	void representationBatchLoaded(int loadedCount, int referenceCount);
+
+	//! Emitted when all representations have been progressively loaded
+	void progressiveLoadingFinished();
+
 //////////////////////////////////////////////////////////////////////
 // Private members
 //////////////////////////////////////////////////////////////////////
 private:
+	//! The progressively loaded world
+	GLC_World m_ProgressiveWorld;
+
+	//! The references with a representation to load
+	QList<GLC_StructReference*> m_PendingReferenceList;
+
+	//! The references of the batch being loaded
+	QList<GLC_StructReference*> m_CurrentBatch;
+
+	//! Hash table of reference to the bounding box of its representation
+	QHash<const GLC_StructReference*, GLC_BoundingBox> m_ReferenceBoundingBoxHash;
+
+	//! Hash table of reference to the data size of its representation
+	QHash<const GLC_StructReference*, qint64> m_ReferenceDataSizeHash;
+
+	//! The viewport used to sort the representations to load
+	GLC_Viewport* m_pPriorityViewport;
+
+	//! The number of representations loaded by batch
+	int m_ProgressiveBatchSize;
+
+	//! The number of references with a representation to load
+	int m_ProgressiveReferenceCount;
+
+	//! The number of loaded representations
+	int m_LoadedReferenceCount;
+
+	//! Watcher of the batch being loaded
+	QFutureWatcher<GLC_3DRep> m_BatchWatcher;
 };
 
 #endif /*GLC_FILELOADER_H_*/
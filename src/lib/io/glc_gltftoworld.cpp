@@ -0,0 +1,969 @@
+/****************************************************************************
+
+ This file is part of the GLC-lib library.
+ Copyright (C) 2005-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ http://glc-lib.sourceforge.net
+
+ GLC-lib is free software; you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation; either version 3 of the License, or
+ (at your option) any later version.
+
+ GLC-lib is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with GLC-lib; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+
+//! \file glc_gltftoworld.cpp implementation of the GLC_GltfToWorld class.
+
+#include "glc_gltftoworld.h"
+#include "../sceneGraph/glc_world.h"
+#include "../sceneGraph/glc_structreference.h"
+#include "../sceneGraph/glc_structinstance.h"
+#include "../sceneGraph/glc_structoccurrence.h"
+#include "../geometry/glc_3drep.h"
+#include "../shading/glc_material.h"
+#include "../shading/glc_texture.h"
+#include "../glc_errorlog.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QtEndian>
+
+#include <cstring>
+#include <limits>
+
+// Binary glTF magic ("glTF"), version and chunk types
+static const quint32 glbMagic= 0x46546C67;
+static const quint32 glbVersion= 2;
+static const quint32 glbJsonChunk= 0x4E4F534A;
+static const quint32 glbBinaryChunk= 0x004E4942;
+
+// glTF accessor component types and primitive modes
+static const int gltfUnsignedByte= 5121;
+static const int gltfUnsignedShort= 5123;
+static const int gltfUnsignedInt= 5125;
+static const int gltfFloat= 5126;
+static const int gltfTriangles= 4;
+static const int gltfTriangleStrip= 5;
+static const int gltfTriangleFan= 6;
+
+// Return the size of the given accessor component type, 0 if it is not known
+static int gltfComponentSize(int componentType)
+{
+	switch (componentType)
+	{
+	case 5120:
+	case gltfUnsignedByte:
+		return 1;
+	case 5122:
+	case gltfUnsignedShort:
+		return 2;
+	case gltfUnsignedInt:
+	case gltfFloat:
+		return 4;
+	default:
+		return 0;
+	}
+}
+
+// Return the number of components of the given accessor type, 0 if it is not known
+static int gltfComponentCount(const QString& type)
+{
+	if (type == "SCALAR") return 1;
+	else if (type == "VEC2") return 2;
+	else if (type == "VEC3") return 3;
+	else if (type == "VEC4") return 4;
+	else if (type == "MAT2") return 4;
+	else if (type == "MAT3") return 9;
+	else if (type == "MAT4") return 16;
+	else return 0;
+}
+
+// Return the little endian float stored at the given address
+static inline GLfloat gltfFloatValue(const uchar* pData)
+{
+	const quint32 value= qFromLittleEndian<quint32>(pData);
+	GLfloat subject;
+	memcpy(&subject, &value, sizeof(GLfloat));
+	return subject;
+}
+
+// Return the given JSON value as a 64 bits integer
+static inline qint64 gltfInteger(const QJsonValue& value, qint64 defaultValue= 0)
+{
+	return value.isDouble() ? static_cast<qint64>(value.toDouble()) : defaultValue;
+}
+
+//////////////////////////////////////////////////////////////////////
+// Constructor
+//////////////////////////////////////////////////////////////////////
+GLC_GltfToWorld::GLC_GltfToWorld()
+: m_pWorld(NULL)
+, m_FileName()
+, m_ListOfAttachedFileName()
+, m_Accessors()
+, m_BufferViews()
+, m_Meshes()
+, m_Nodes()
+, m_Materials()
+, m_Textures()
+, m_Images()
+, m_pBinaryChunk(NULL)
+, m_BinaryChunkSize(0)
+, m_MeshReferenceHash()
+, m_MaterialHash()
+, m_ImageHash()
+, m_ReferenceOccurrenceHash()
+, m_NodePath()
+{
+}
+
+GLC_GltfToWorld::~GLC_GltfToWorld()
+{
+	clear();
+}
+
+/////////////////////////////////////////////////////////////////////
+// Set Functions
+//////////////////////////////////////////////////////////////////////
+
+// Create an GLC_World from an input binary glTF file
+GLC_World* GLC_GltfToWorld::CreateWorldFromGltf(QFile &file)
+{
+	m_ListOfAttachedFileName.clear();
+	m_FileName= file.fileName();
+	//////////////////////////////////////////////////////////////////
+	// Test if the file exist and can be opened
+	//////////////////////////////////////////////////////////////////
+	if (!file.open(QIODevice::ReadOnly))
+	{
+		QString message(QString("GLC_GltfToWorld::CreateWorldFromGltf File ") + m_FileName + QString(" doesn't exist"));
+		GLC_FileFormatException fileFormatException(message, m_FileName, GLC_FileFormatException::FileNotFound);
+		throw(fileFormatException);
+	}
+
+	m_pWorld= new GLC_World;
+	emit currentQuantum(0);
+
+	// Map the file, read it if mapping is not possible
+	QByteArray fileContent;
+	const qint64 fileSize= file.size();
+	uchar* pMappedData= file.map(0, fileSize);
+	const uchar* pData= pMappedData;
+	if (NULL == pData)
+	{
+		fileContent= file.readAll();
+		pData= reinterpret_cast<const uchar*>(fileContent.constData());
+	}
+
+	try
+	{
+		const QJsonObject root= readChunks(pData, fileSize);
+
+		// The nodes of the default scene, all root nodes if there is no scene
+		QJsonArray rootNodes;
+		const QJsonArray scenes= root.value("scenes").toArray();
+		if (scenes.isEmpty())
+		{
+			QSet<int> childNodes;
+			const int nodeCount= m_Nodes.size();
+			for (int i= 0; i < nodeCount; ++i)
+			{
+				const QJsonArray children= m_Nodes.at(i).toObject().value("children").toArray();
+				for (const QJsonValue& child : children)
+				{
+					childNodes.insert(child.toInt(-1));
+				}
+			}
+			for (int i= 0; i < nodeCount; ++i)
+			{
+				if (!childNodes.contains(i)) rootNodes.append(i);
+			}
+		}
+		else
+		{
+			const int sceneIndex= root.value("scene").toInt(0);
+			if ((sceneIndex < 0) || (sceneIndex >= scenes.size()))
+			{
+				throwException("GLC_GltfToWorld::CreateWorldFromGltf : Wrong scene index", GLC_FileFormatException::WrongFileFormat);
+			}
+			const QJsonObject scene= scenes.at(sceneIndex).toObject();
+			rootNodes= scene.value("nodes").toArray();
+			const QString sceneName= scene.value("name").toString();
+			if (!sceneName.isEmpty())
+			{
+				m_pWorld->rootOccurrence()->structReference()->setName(sceneName);
+			}
+		}
+
+		int previousQuantumValue= 0;
+		const int rootNodeCount= rootNodes.size();
+		for (int i= 0; i < rootNodeCount; ++i)
+		{
+			addNode(rootNodes.at(i).toInt(-1), m_pWorld->rootOccurrence());
+
+			const int currentQuantumValue = static_cast<int>((static_cast<double>(i + 1) / rootNodeCount) * 100);
+			if (currentQuantumValue > previousQuantumValue)
+			{
+				emit currentQuantum(currentQuantumValue);
+			}
+			previousQuantumValue= currentQuantumValue;
+		}
+	}
+	catch (GLC_FileFormatException&)
+	{
+		if (NULL != pMappedData) file.unmap(pMappedData);
+		file.close();
+		throw;
+	}
+
+	if (NULL != pMappedData)
+	{
+		file.unmap(pMappedData);
+	}
+	file.close();
+
+	//! Test if there is meshes in the world
+	if (m_pWorld->rootOccurrence()->childCount() == 0)
+	{
+		QString message= "GLC_GltfToWorld::CreateWorldFromGltf " + m_FileName + " No mesh found!";
+		throwException(message, GLC_FileFormatException::NoMeshFound);
+	}
+
+	GLC_World* pWorld= m_pWorld;
+	m_pWorld= NULL;
+	clear();
+
+	return pWorld;
+}
+
+//////////////////////////////////////////////////////////////////////
+// Private services functions
+//////////////////////////////////////////////////////////////////////
+
+// clear gltfToWorld allocate memmory
+void GLC_GltfToWorld::clear()
+{
+	// Delete mesh references which are not used
+	QHash<int, GLC_StructReference*>::const_iterator iRef= m_MeshReferenceHash.constBegin();
+	while (m_MeshReferenceHash.constEnd() != iRef)
+	{
+		if (!iRef.value()->hasStructInstance())
+		{
+			delete iRef.value();
+		}
+		++iRef;
+	}
+	m_MeshReferenceHash.clear();
+	m_MaterialHash.clear();
+	m_ImageHash.clear();
+	m_ReferenceOccurrenceHash.clear();
+	m_NodePath.clear();
+
+	m_Accessors= QJsonArray();
+	m_BufferViews= QJsonArray();
+	m_Meshes= QJsonArray();
+	m_Nodes= QJsonArray();
+	m_Materials= QJsonArray();
+	m_Textures= QJsonArray();
+	m_Images= QJsonArray();
+	m_pBinaryChunk= NULL;
+	m_BinaryChunkSize= 0;
+}
+
+// Clear and throw a file format exception with the given message and type
+void GLC_GltfToWorld::throwException(const QString& message, GLC_FileFormatException::ExceptionType type)
+{
+	GLC_FileFormatException fileFormatException(message, m_FileName, type);
+	// Unused references are deleted before the world which deletes the others
+	clear();
+	delete m_pWorld;
+	m_pWorld= NULL;
+	throw(fileFormatException);
+}
+
+// Read the header and the chunks of the given mapped binary glTF
+QJsonObject GLC_GltfToWorld::readChunks(const uchar* pData, qint64 size)
+{
+	// Header
+	if ((size < 20) || (qFromLittleEndian<quint32>(pData) != glbMagic))
+	{
+		throwException("GLC_GltfToWorld::readChunks : Not a binary glTF file", GLC_FileFormatException::WrongFileFormat);
+	}
+	if (qFromLittleEndian<quint32>(pData + 4) != glbVersion)
+	{
+		throwException("GLC_GltfToWorld::readChunks : Only glTF 2.0 is supported", GLC_FileFormatException::FileNotSupported);
+	}
+	const qint64 length= qFromLittleEndian<quint32>(pData + 8);
+	if (length > size)
+	{
+		throwException("GLC_GltfToWorld::readChunks : Truncated file", GLC_FileFormatException::WrongFileFormat);
+	}
+
+	// Chunks, the first one is the JSON chunk
+	QJsonObject root;
+	qint64 offset= 12;
+	bool jsonChunkFound= false;
+	while ((offset + 8) <= length)
+	{
+		const qint64 chunkLength= qFromLittleEndian<quint32>(pData + offset);
+		const quint32 chunkType= qFromLittleEndian<quint32>(pData + offset + 4);
+		offset+= 8;
+		if ((offset + chunkLength) > length)
+		{
+			throwException("GLC_GltfToWorld::readChunks : Truncated chunk", GLC_FileFormatException::WrongFileFormat);
+		}
+		if (!jsonChunkFound)
+		{
+			if (chunkType != glbJsonChunk)
+			{
+				throwException("GLC_GltfToWorld::readChunks : JSON chunk not found", GLC_FileFormatException::WrongFileFormat);
+			}
+			const QByteArray json(QByteArray::fromRawData(reinterpret_cast<const char*>(pData + offset), static_cast<int>(chunkLength)));
+			QJsonParseError parseError;
+			const QJsonDocument document(QJsonDocument::fromJson(json, &parseError));
+			if ((parseError.error != QJsonParseError::NoError) || !document.isObject())
+			{
+				throwException("GLC_GltfToWorld::readChunks : JSON error " + parseError.errorString(), GLC_FileFormatException::WrongFileFormat);
+			}
+			root= document.object();
+			jsonChunkFound= true;
+		}
+		else if ((chunkType == glbBinaryChunk) && (NULL == m_pBinaryChunk))
+		{
+			m_pBinaryChunk= pData + offset;
+			m_BinaryChunkSize= chunkLength;
+		}
+		offset+= chunkLength;
+	}
+	if (!jsonChunkFound)
+	{
+		throwException("GLC_GltfToWorld::readChunks : JSON chunk not found", GLC_FileFormatException::WrongFileFormat);
+	}
+
+	// Extensions like mesh compression are not supported
+	const QJsonArray extensionsRequired= root.value("extensionsRequired").toArray();
+	if (!extensionsRequired.isEmpty())
+	{
+		QString message("GLC_GltfToWorld::readChunks : Required extension not supported :");
+		for (const QJsonValue& extension : extensionsRequired)
+		{
+			message.append(' ' + extension.toString());
+		}
+		throwException(message, GLC_FileFormatException::FileNotSupported);
+	}
+
+	// Only the binary chunk buffer is supported
+	const QJsonArray buffers= root.value("buffers").toArray();
+	if (!buffers.isEmpty() && buffers.at(0).toObject().contains("uri"))
+	{
+		throwException("GLC_GltfToWorld::readChunks : External buffers are not supported", GLC_FileFormatException::FileNotSupported);
+	}
+
+	m_Accessors= root.value("accessors").toArray();
+	m_BufferViews= root.value("bufferViews").toArray();
+	m_Meshes= root.value("meshes").toArray();
+	m_Nodes= root.value("nodes").toArray();
+	m_Materials= root.value("materials").toArray();
+	m_Textures= root.value("textures").toArray();
+	m_Images= root.value("images").toArray();
+
+	return root;
+}
+
+// Return the data of the given accessor
+const uchar* GLC_GltfToWorld::accessorData(int accessorIndex, int componentCount, int* pComponentType, int* pCount, int* pStride)
+{
+	if ((accessorIndex < 0) || (accessorIndex >= m_Accessors.size()))
+	{
+		throwException("GLC_GltfToWorld::accessorData : Wrong accessor index", GLC_FileFormatException::WrongFileFormat);
+	}
+	const QJsonObject accessor= m_Accessors.at(accessorIndex).toObject();
+	if (accessor.contains("sparse"))
+	{
+		throwException("GLC_GltfToWorld::accessorData : Sparse accessor are not supported", GLC_FileFormatException::FileNotSupported);
+	}
+
+	*pComponentType= accessor.value("componentType").toInt();
+	const qint64 count= gltfInteger(accessor.value("count"), -1);
+	const int componentSize= gltfComponentSize(*pComponentType);
+	if ((gltfComponentCount(accessor.value("type").toString()) != componentCount) || (0 == componentSize)
+			|| (count < 0) || ((count * componentCount) > std::numeric_limits<int>::max()))
+	{
+		throwException("GLC_GltfToWorld::accessorData : Wrong accessor type", GLC_FileFormatException::WrongFileFormat);
+	}
+	*pCount= static_cast<int>(count);
+	const qint64 elementSize= componentSize * componentCount;
+	*pStride= static_cast<int>(elementSize);
+
+	// Accessor without buffer view is initialized with zeros
+	if (!accessor.contains("bufferView")) return NULL;
+
+	const int bufferViewIndex= accessor.value("bufferView").toInt(-1);
+	if ((bufferViewIndex < 0) || (bufferViewIndex >= m_BufferViews.size()))
+	{
+		throwException("GLC_GltfToWorld::accessorData : Wrong buffer view index", GLC_FileFormatException::WrongFileFormat);
+	}
+	const QJsonObject bufferView= m_BufferViews.at(bufferViewIndex).toObject();
+	if (bufferView.value("buffer").toInt(0) != 0)
+	{
+		throwException("GLC_GltfToWorld::accessorData : Only the binary chunk buffer is supported", GLC_FileFormatException::FileNotSupported);
+	}
+	const qint64 viewOffset= gltfInteger(bufferView.value("byteOffset"));
+	const qint64 viewLength= gltfInteger(bufferView.value("byteLength"));
+	const qint64 viewStride= gltfInteger(bufferView.value("byteStride"));
+	const qint64 offset= gltfInteger(accessor.value("byteOffset"));
+	const qint64 stride= (0 != viewStride) ? viewStride : elementSize;
+	if ((viewOffset < 0) || (viewLength < 0) || (offset < 0) || (stride < elementSize) || (stride > 252)
+			|| ((viewOffset + viewLength) > m_BinaryChunkSize)
+			|| ((count > 0) && ((offset + ((count - 1) * stride) + elementSize) > viewLength)))
+	{
+		throwException("GLC_GltfToWorld::accessorData : Accessor out of buffer range", GLC_FileFormatException::WrongFileFormat);
+	}
+	*pStride= static_cast<int>(stride);
+
+	return m_pBinaryChunk + viewOffset + offset;
+}
+
+// Return the float values of the given accessor
+GLfloatVector GLC_GltfToWorld::floatAccessor(int accessorIndex, int componentCount)
+{
+	int componentType;
+	int count;
+	int stride;
+	const uchar* pData= accessorData(accessorIndex, componentCount, &componentType, &count, &stride);
+
+	GLfloatVector subject(count * componentCount);
+	if (NULL == pData) return subject;
+
+	GLfloat* pTarget= subject.data();
+	if (gltfFloat == componentType)
+	{
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+		// Tightly packed floats are copied at once
+		if (stride == static_cast<int>(componentCount * sizeof(GLfloat)))
+		{
+			memcpy(pTarget, pData, static_cast<size_t>(count) * stride);
+			return subject;
+		}
+#endif
+		for (int i= 0; i < count; ++i)
+		{
+			const uchar* pElement= pData + (static_cast<qint64>(i) * stride);
+			for (int j= 0; j < componentCount; ++j)
+			{
+				*(pTarget++)= gltfFloatValue(pElement + (j * sizeof(GLfloat)));
+			}
+		}
+	}
+	else if (m_Accessors.at(accessorIndex).toObject().value("normalized").toBool()
+			&& ((gltfUnsignedByte == componentType) || (gltfUnsignedShort == componentType)))
+	{
+		for (int i= 0; i < count; ++i)
+		{
+			const uchar* pElement= pData + (static_cast<qint64>(i) * stride);
+			for (int j= 0; j < componentCount; ++j)
+			{
+				if (gltfUnsignedByte == componentType)
+				{
+					*(pTarget++)= static_cast<GLfloat>(pElement[j]) / 255.0f;
+				}
+				else
+				{
+					*(pTarget++)= static_cast<GLfloat>(qFromLittleEndian<quint16>(pElement + (j * 2))) / 65535.0f;
+				}
+			}
+		}
+	}
+	else
+	{
+		throwException("GLC_GltfToWorld::floatAccessor : Accessor component type not supported", GLC_FileFormatException::FileNotSupported);
+	}
+
+	return subject;
+}
+
+// Return the index of the given accessor
+IndexList GLC_GltfToWorld::indexAccessor(int accessorIndex)
+{
+	int componentType;
+	int count;
+	int stride;
+	const uchar* pData= accessorData(accessorIndex, 1, &componentType, &count, &stride);
+	if (NULL == pData)
+	{
+		throwException("GLC_GltfToWorld::indexAccessor : Index accessor without buffer view", GLC_FileFormatException::WrongFileFormat);
+	}
+
+	IndexList subject;
+	subject.reserve(count);
+	if (gltfUnsignedByte == componentType)
+	{
+		for (int i= 0; i < count; ++i)
+		{
+			subject.append(pData[static_cast<qint64>(i) * stride]);
+		}
+	}
+	else if (gltfUnsignedShort == componentType)
+	{
+		for (int i= 0; i < count; ++i)
+		{
+			subject.append(qFromLittleEndian<quint16>(pData + (static_cast<qint64>(i) * stride)));
+		}
+	}
+	else if (gltfUnsignedInt == componentType)
+	{
+		for (int i= 0; i < count; ++i)
+		{
+			subject.append(qFromLittleEndian<quint32>(pData + (static_cast<qint64>(i) * stride)));
+		}
+	}
+	else
+	{
+		throwException("GLC_GltfToWorld::indexAccessor : Wrong index component type", GLC_FileFormatException::WrongFileFormat);
+	}
+
+	return subject;
+}
+
+// Return the shared reference of the given glTF mesh
+GLC_StructReference* GLC_GltfToWorld::meshReference(int meshIndex)
+{
+	if (m_MeshReferenceHash.contains(meshIndex)) return m_MeshReferenceHash.value(meshIndex);
+
+	if ((meshIndex < 0) || (meshIndex >= m_Meshes.size()))
+	{
+		throwException("GLC_GltfToWorld::meshReference : Wrong mesh index", GLC_FileFormatException::WrongFileFormat);
+	}
+	const QJsonObject gltfMesh= m_Meshes.at(meshIndex).toObject();
+	const QString meshName= gltfMesh.value("name").toString();
+
+	// Primitives which share the same attributes are loaded in the same mesh
+	QHash<QString, GLC_Mesh*> meshHash;
+	QList<GLC_Mesh*> meshList;
+	QHash<GLC_Mesh*, IndexList> trianglesWithoutNormals;
+	const QJsonArray primitives= gltfMesh.value("primitives").toArray();
+	try
+	{
+		for (const QJsonValue& primitiveValue : primitives)
+		{
+			const QJsonObject primitive= primitiveValue.toObject();
+			const int mode= primitive.value("mode").toInt(gltfTriangles);
+			const QJsonObject attributes= primitive.value("attributes").toObject();
+			if (((gltfTriangles != mode) && (gltfTriangleStrip != mode) && (gltfTriangleFan != mode)) || !attributes.contains("POSITION"))
+			{
+				QStringList stringList(m_FileName);
+				stringList.append("GLC_GltfToWorld::meshReference : Primitive without triangles of mesh " + meshName + " ignored");
+				GLC_ErrorLog::addError(stringList);
+				continue;
+			}
+
+			const int positionAccessor= attributes.value("POSITION").toInt(-1);
+			const int normalAccessor= attributes.value("NORMAL").toInt(-1);
+			const int texelAccessor= attributes.value("TEXCOORD_0").toInt(-1);
+			const QString key(QString::number(positionAccessor) + '/' + QString::number(normalAccessor) + '/' + QString::number(texelAccessor));
+
+			GLC_Mesh* pMesh= meshHash.value(key);
+			if (NULL == pMesh)
+			{
+				pMesh= new GLC_Mesh();
+				pMesh->setName(meshName);
+				meshHash.insert(key, pMesh);
+				meshList.append(pMesh);
+
+				const GLfloatVector positions(floatAccessor(positionAccessor, 3));
+				pMesh->addVertice(positions);
+				if (-1 != normalAccessor)
+				{
+					const GLfloatVector normals(floatAccessor(normalAccessor, 3));
+					if (normals.size() != positions.size())
+					{
+						throwException("GLC_GltfToWorld::meshReference : Normal and position count differ", GLC_FileFormatException::WrongFileFormat);
+					}
+					pMesh->addNormals(normals);
+				}
+				else
+				{
+					trianglesWithoutNormals.insert(pMesh, IndexList());
+				}
+				if (-1 != texelAccessor)
+				{
+					GLfloatVector texels(floatAccessor(texelAccessor, 2));
+					if ((texels.size() / 2) != (positions.size() / 3))
+					{
+						throwException("GLC_GltfToWorld::meshReference : Texel and position count differ", GLC_FileFormatException::WrongFileFormat);
+					}
+					// glTF texture coordinates origin is the top left corner of the image
+					const int texelsSize= texels.size();
+					for (int i= 1; i < texelsSize; i+= 2)
+					{
+						texels[i]= 1.0f - texels.at(i);
+					}
+					pMesh->addTexels(texels);
+				}
+			}
+
+			const GLuint vertexCount= static_cast<GLuint>(pMesh->positionVector().size() / 3);
+			IndexList index;
+			if (primitive.contains("indices"))
+			{
+				index= indexAccessor(primitive.value("indices").toInt(-1));
+			}
+			else
+			{
+				index.reserve(static_cast<int>(vertexCount));
+				for (GLuint i= 0; i < vertexCount; ++i) index.append(i);
+			}
+			for (const GLuint value : index)
+			{
+				if (value >= vertexCount)
+				{
+					throwException("GLC_GltfToWorld::meshReference : Index out of range", GLC_FileFormatException::WrongFileFormat);
+				}
+			}
+
+			// Triangle strips and fans are converted to triangles
+			IndexList triangles;
+			const int indexCount= index.size();
+			if (gltfTriangles == mode)
+			{
+				triangles= index.mid(0, indexCount - (indexCount % 3));
+			}
+			else
+			{
+				triangles.reserve((indexCount - 2) * 3);
+				for (int i= 0; (i + 2) < indexCount; ++i)
+				{
+					if (gltfTriangleStrip == mode)
+					{
+						triangles << index.at(i) << index.at(i + 1 + (i % 2)) << index.at(i + 2 - (i % 2));
+					}
+					else
+					{
+						triangles << index.at(i + 1) << index.at(i + 2) << index.at(0);
+					}
+				}
+			}
+
+			if (!triangles.isEmpty())
+			{
+				GLC_Material* pMaterial= NULL;
+				if (primitive.contains("material"))
+				{
+					pMaterial= material(primitive.value("material").toInt(-1));
+				}
+				pMesh->addTriangles(pMaterial, triangles);
+				if (trianglesWithoutNormals.contains(pMesh))
+				{
+					trianglesWithoutNormals[pMesh].append(triangles);
+				}
+			}
+		}
+	}
+	catch (GLC_FileFormatException&)
+	{
+		qDeleteAll(meshList);
+		throw;
+	}
+
+	GLC_3DRep* pRep= new GLC_3DRep();
+	pRep->setName(meshName);
+	for (GLC_Mesh* pMesh : meshList)
+	{
+		if (trianglesWithoutNormals.contains(pMesh))
+		{
+			pMesh->addNormals(computeNormals(pMesh->positionVector(), trianglesWithoutNormals.value(pMesh)));
+		}
+		if (pMesh->faceCount(0) > 0)
+		{
+			pMesh->finish();
+			pRep->addGeom(pMesh);
+		}
+		else
+		{
+			delete pMesh;
+		}
+	}
+
+	GLC_StructReference* pReference= new GLC_StructReference(pRep);
+	m_MeshReferenceHash.insert(meshIndex, pReference);
+
+	return pReference;
+}
+
+// Return the material of the given glTF material
+GLC_Material* GLC_GltfToWorld::material(int materialIndex)
+{
+	if (m_MaterialHash.contains(materialIndex)) return m_MaterialHash.value(materialIndex);
+
+	if ((materialIndex < 0) || (materialIndex >= m_Materials.size()))
+	{
+		throwException("GLC_GltfToWorld::material : Wrong material index", GLC_FileFormatException::WrongFileFormat);
+	}
+	const QJsonObject gltfMaterial= m_Materials.at(materialIndex).toObject();
+	const QJsonObject pbr= gltfMaterial.value("pbrMetallicRoughness").toObject();
+
+	QColor diffuseColor(Qt::white);
+	const QJsonArray baseColor= pbr.value("baseColorFactor").toArray();
+	if (baseColor.size() == 4)
+	{
+		diffuseColor.setRgbF(baseColor.at(0).toDouble(), baseColor.at(1).toDouble(), baseColor.at(2).toDouble());
+	}
+	GLC_Material* pMaterial= new GLC_Material(diffuseColor);
+	const QString name= gltfMaterial.value("name").toString();
+	if (!name.isEmpty()) pMaterial->setName(name);
+
+	const double roughness= pbr.value("roughnessFactor").toDouble(1.0);
+	pMaterial->setShininess(static_cast<GLfloat>((1.0 - qBound(0.0, roughness, 1.0)) * 128.0));
+
+	const QJsonArray emissive= gltfMaterial.value("emissiveFactor").toArray();
+	if (emissive.size() == 3)
+	{
+		QColor emissiveColor;
+		emissiveColor.setRgbF(emissive.at(0).toDouble(), emissive.at(1).toDouble(), emissive.at(2).toDouble());
+		pMaterial->setEmissiveColor(emissiveColor);
+	}
+
+	if (pbr.contains("baseColorTexture"))
+	{
+		GLC_Texture* pTexture= texture(pbr.value("baseColorTexture").toObject().value("index").toInt(-1));
+		if (NULL != pTexture) pMaterial->setTexture(pTexture);
+	}
+
+	if ((baseColor.size() == 4) && (baseColor.at(3).toDouble() < 1.0))
+	{
+		pMaterial->setOpacity(baseColor.at(3).toDouble());
+	}
+
+	m_MaterialHash.insert(materialIndex, pMaterial);
+
+	return pMaterial;
+}
+
+// Return a new texture of the given glTF texture
+GLC_Texture* GLC_GltfToWorld::texture(int textureIndex)
+{
+	if ((textureIndex < 0) || (textureIndex >= m_Textures.size()))
+	{
+		throwException("GLC_GltfToWorld::texture : Wrong texture index", GLC_FileFormatException::WrongFileFormat);
+	}
+	const int imageIndex= m_Textures.at(textureIndex).toObject().value("source").toInt(-1);
+	if ((imageIndex < 0) || (imageIndex >= m_Images.size()))
+	{
+		throwException("GLC_GltfToWorld::texture : Wrong image index", GLC_FileFormatException::WrongFileFormat);
+	}
+
+	if (!m_ImageHash.contains(imageIndex))
+	{
+		const QJsonObject image= m_Images.at(imageIndex).toObject();
+		QImage textureImage;
+		if (image.contains("bufferView"))
+		{
+			const int bufferViewIndex= image.value("bufferView").toInt(-1);
+			if ((bufferViewIndex < 0) || (bufferViewIndex >= m_BufferViews.size()))
+			{
+				throwException("GLC_GltfToWorld::texture : Wrong buffer view index", GLC_FileFormatException::WrongFileFormat);
+			}
+			const QJsonObject bufferView= m_BufferViews.at(bufferViewIndex).toObject();
+			const qint64 offset= gltfInteger(bufferView.value("byteOffset"));
+			const qint64 length= gltfInteger(bufferView.value("byteLength"));
+			if ((offset < 0) || (length < 0) || ((offset + length) > m_BinaryChunkSize))
+			{
+				throwException("GLC_GltfToWorld::texture : Image out of buffer range", GLC_FileFormatException::WrongFileFormat);
+			}
+			textureImage= QImage::fromData(m_pBinaryChunk + offset, static_cast<int>(length));
+		}
+		else
+		{
+			const QString uri(image.value("uri").toString());
+			if (uri.startsWith("data:"))
+			{
+				textureImage= QImage::fromData(QByteArray::fromBase64(uri.mid(uri.indexOf(',') + 1).toLatin1()));
+			}
+			else if (!uri.isEmpty())
+			{
+				const QString imageFileName(QFileInfo(m_FileName).absolutePath() + QDir::separator() + uri);
+				textureImage= QImage(imageFileName);
+				m_ListOfAttachedFileName << imageFileName;
+			}
+		}
+		if (textureImage.isNull())
+		{
+			QStringList stringList(m_FileName);
+			stringList.append("GLC_GltfToWorld::texture : Failed to load image " + QString::number(imageIndex));
+			GLC_ErrorLog::addError(stringList);
+		}
+		m_ImageHash.insert(imageIndex, textureImage);
+	}
+
+	const QImage textureImage(m_ImageHash.value(imageIndex));
+	if (textureImage.isNull()) return NULL;
+	else return new GLC_Texture(textureImage);
+}
+
+// Add the given glTF node as a child of the given occurrence
+void GLC_GltfToWorld::addNode(int nodeIndex, GLC_StructOccurrence* pParent)
+{
+	if ((nodeIndex < 0) || (nodeIndex >= m_Nodes.size()) || m_NodePath.contains(nodeIndex))
+	{
+		throwException("GLC_GltfToWorld::addNode : Wrong node index", GLC_FileFormatException::WrongFileFormat);
+	}
+	const QJsonObject node= m_Nodes.at(nodeIndex).toObject();
+	const QString name= node.value("name").toString();
+	const QJsonArray children= node.value("children").toArray();
+	const int meshIndex= node.value("mesh").toInt(-1);
+
+	if (children.isEmpty())
+	{
+		// Instance of the shared mesh reference
+		if (-1 != meshIndex)
+		{
+			GLC_StructInstance* pInstance= new GLC_StructInstance(meshReference(meshIndex));
+			if (!name.isEmpty()) pInstance->setName(name);
+			pInstance->setMatrix(nodeMatrix(node));
+			pParent->addChild(pInstance);
+		}
+		return;
+	}
+
+	// Assembly, shared if the node has the extras of GLC_WorldToGltf
+	const QJsonObject extras= node.value("extras").toObject();
+	const int referenceId= extras.value("reference").toInt(-1);
+	GLC_StructOccurrence* pFirstOccurrence= m_ReferenceOccurrenceHash.value(referenceId, NULL);
+	if (NULL != pFirstOccurrence)
+	{
+		GLC_StructInstance* pInstance= new GLC_StructInstance(pFirstOccurrence->structReference());
+		if (!name.isEmpty()) pInstance->setName(name);
+		pInstance->setMatrix(nodeMatrix(node));
+		GLC_StructOccurrence* pOccurrence= pParent->addChild(pInstance);
+		const QList<GLC_StructOccurrence*> childOccurrences= pFirstOccurrence->children();
+		for (GLC_StructOccurrence* pChild : childOccurrences)
+		{
+			pOccurrence->addChild(pChild->clone(pOccurrence->worldHandle(), true));
+		}
+	}
+	else
+	{
+		GLC_StructReference* pReference= new GLC_StructReference(extras.value("referenceName").toString(name));
+		GLC_StructInstance* pInstance= new GLC_StructInstance(pReference);
+		if (!name.isEmpty()) pInstance->setName(name);
+		pInstance->setMatrix(nodeMatrix(node));
+		GLC_StructOccurrence* pOccurrence= pParent->addChild(pInstance);
+		if (-1 != meshIndex)
+		{
+			pOccurrence->addChild(new GLC_StructInstance(meshReference(meshIndex)));
+		}
+		m_NodePath.insert(nodeIndex);
+		for (const QJsonValue& child : children)
+		{
+			addNode(child.toInt(-1), pOccurrence);
+		}
+		m_NodePath.remove(nodeIndex);
+
+		if (-1 != referenceId)
+		{
+			m_ReferenceOccurrenceHash.insert(referenceId, pOccurrence);
+		}
+	}
+}
+
+// Return the matrix of the given glTF node
+GLC_Matrix4x4 GLC_GltfToWorld::nodeMatrix(const QJsonObject& node)
+{
+	double values[16];
+	const QJsonArray matrix= node.value("matrix").toArray();
+	if (matrix.size() == 16)
+	{
+		// Column major like GLC_Matrix4x4
+		for (int i= 0; i < 16; ++i)
+		{
+			values[i]= matrix.at(i).toDouble();
+		}
+	}
+	else
+	{
+		const QJsonArray translation= node.value("translation").toArray();
+		const QJsonArray rotation= node.value("rotation").toArray();
+		const QJsonArray scale= node.value("scale").toArray();
+
+		const double tx= (translation.size() == 3) ? translation.at(0).toDouble() : 0.0;
+		const double ty= (translation.size() == 3) ? translation.at(1).toDouble() : 0.0;
+		const double tz= (translation.size() == 3) ? translation.at(2).toDouble() : 0.0;
+		const double x= (rotation.size() == 4) ? rotation.at(0).toDouble() : 0.0;
+		const double y= (rotation.size() == 4) ? rotation.at(1).toDouble() : 0.0;
+		const double z= (rotation.size() == 4) ? rotation.at(2).toDouble() : 0.0;
+		const double w= (rotation.size() == 4) ? rotation.at(3).toDouble() : 1.0;
+		const double sx= (scale.size() == 3) ? scale.at(0).toDouble() : 1.0;
+		const double sy= (scale.size() == 3) ? scale.at(1).toDouble() : 1.0;
+		const double sz= (scale.size() == 3) ? scale.at(2).toDouble() : 1.0;
+
+		// Translation * Rotation * Scale
+		values[0]= (1.0 - 2.0 * (y * y + z * z)) * sx;
+		values[1]= (2.0 * (x * y + z * w)) * sx;
+		values[2]= (2.0 * (x * z - y * w)) * sx;
+		values[3]= 0.0;
+		values[4]= (2.0 * (x * y - z * w)) * sy;
+		values[5]= (1.0 - 2.0 * (x * x + z * z)) * sy;
+		values[6]= (2.0 * (y * z + x * w)) * sy;
+		values[7]= 0.0;
+		values[8]= (2.0 * (x * z + y * w)) * sz;
+		values[9]= (2.0 * (y * z - x * w)) * sz;
+		values[10]= (1.0 - 2.0 * (x * x + y * y)) * sz;
+		values[11]= 0.0;
+		values[12]= tx;
+		values[13]= ty;
+		values[14]= tz;
+		values[15]= 1.0;
+	}
+
+	GLC_Matrix4x4 resultMatrix(values);
+	resultMatrix.optimise();
+
+	return resultMatrix;
+}
+
+// Return the normals of the given positions and triangles index
+GLfloatVector GLC_GltfToWorld::computeNormals(const GLfloatVector& positions, const IndexList& index)
+{
+	// Sum of the not normalized triangle normals (weighted by area)
+	QVector<double> normals(positions.size(), 0.0);
+	const int indexCount= index.size();
+	for (int i= 0; (i + 2) < indexCount; i+= 3)
+	{
+		const int i1= static_cast<int>(index.at(i)) * 3;
+		const int i2= static_cast<int>(index.at(i + 1)) * 3;
+		const int i3= static_cast<int>(index.at(i + 2)) * 3;
+		const GLC_Vector3d p1(positions.at(i1), positions.at(i1 + 1), positions.at(i1 + 2));
+		const GLC_Vector3d p2(positions.at(i2), positions.at(i2 + 1), positions.at(i2 + 2));
+		const GLC_Vector3d p3(positions.at(i3), positions.at(i3 + 1), positions.at(i3 + 2));
+		const GLC_Vector3d normal((p2 - p1) ^ (p3 - p1));
+		for (int j= 0; j < 3; ++j)
+		{
+			const int vertex= static_cast<int>(index.at(i + j)) * 3;
+			normals[vertex]+= normal.x();
+			normals[vertex + 1]+= normal.y();
+			normals[vertex + 2]+= normal.z();
+		}
+	}
+
+	const int size= positions.size();
+	GLfloatVector subject(size);
+	for (int i= 0; i < size; i+= 3)
+	{
+		GLC_Vector3d normal(normals.at(i), normals.at(i + 1), normals.at(i + 2));
+		if (normal.length() > 0.0) normal.normalize();
+		subject[i]= static_cast<GLfloat>(normal.x());
+		subject[i + 1]= static_cast<GLfloat>(normal.y());
+		subject[i + 2]= static_cast<GLfloat>(normal.z());
+	}
+
+	return subject;
+}
@@ -0,0 +1,185 @@
+/****************************************************************************
+
+ This file is part of the GLC-lib library.
+ Copyright (C) 2005-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ http://glc-lib.sourceforge.net
+
+ GLC-lib is free software; you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation; either version 3 of the License, or
+ (at your option) any later version.
+
+ GLC-lib is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with GLC-lib; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+
+//! \file glc_gltftoworld.h interface for the GLC_GltfToWorld class.
+
+#ifndef GLC_GLTFTOWORLD_H_
+#define GLC_GLTFTOWORLD_H_
+
+#include <QString>
+#include <QObject>
+#include <QFile>
+#include <QHash>
+#include <QSet>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QImage>
+
+#include "../geometry/glc_mesh.h"
+#include "../maths/glc_matrix4x4.h"
+#include "../glc_fileformatexception.h"
+
+#include "../glc_config.h"
+
+class GLC_World;
+class GLC_StructReference;
+class GLC_StructOccurrence;
+class GLC_Material;
+class GLC_Texture;
+
+//////////////////////////////////////////////////////////////////////
+//! \class GLC_GltfToWorld
+/*! \brief GLC_GltfToWorld : Create an GLC_World from binary glTF 2.0 file (.glb) */
+
+/*! The binary chunk of the file is mapped and the meshes bulk data are
+ *  copied from the accessor ranges. List of elements extracted from the glTF
+ * 		- Node hierarchy and matrix (or translation, rotation and scale)
+ * 		- Triangles, triangle strips and triangle fans
+ * 		- Position, normal and first texture coordinate
+ * 		- Base color factor and texture of metallic roughness materials
+ *
+ *  A glTF mesh is loaded only once and shared by all nodes which use it.
+ *  Nodes written by GLC_WorldToGltf with the same reference extras share
+ *  the same GLC_StructReference.
+ *  Primitives without normals get the average normal of their triangles.*/
+//////////////////////////////////////////////////////////////////////
+class GLC_LIB_EXPORT GLC_GltfToWorld : public QObject
+{
+	Q_OBJECT
+//////////////////////////////////////////////////////////////////////
+/*! @name Constructor / Destructor */
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	GLC_GltfToWorld();
+	virtual ~GLC_GltfToWorld();
+//@}
+
+//////////////////////////////////////////////////////////////////////
+/*! @name Set Functions*/
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Create and return an GLC_World* from an input binary glTF file
+	GLC_World* CreateWorldFromGltf(QFile &file);
+
+	//! Get the list of attached files
+	inline QStringList listOfAttachedFileName() const
+	{return m_ListOfAttachedFileName;}
+//@}
+
+//////////////////////////////////////////////////////////////////////
+/*! @name Private services functions */
+//@{
+//////////////////////////////////////////////////////////////////////
+private:
+	//! clear gltfToWorld allocate memmory
+	void clear();
+
+	//! Clear and throw a file format exception with the given message and type
+	void throwException(const QString& message, GLC_FileFormatException::ExceptionType type);
+
+	//! Read the header and the chunks of the given mapped binary glTF
+	QJsonObject readChunks(const uchar* pData, qint64 size);
+
+	//! Return the data of the given accessor
+	/*! Set the component type, the number of elements and the stride of the accessor.
+	 *  Return NULL if the accessor has no buffer view (Elements are zero)*/
+	const uchar* accessorData(int accessorIndex, int componentCount, int* pComponentType, int* pCount, int* pStride);
+
+	//! Return the float values of the given accessor
+	GLfloatVector floatAccessor(int accessorIndex, int componentCount);
+
+	//! Return the index of the given accessor
+	IndexList indexAccessor(int accessorIndex);
+
+	//! Return the shared reference of the given glTF mesh
+	GLC_StructReference* meshReference(int meshIndex);
+
+	//! Return the material of the given glTF material
+	GLC_Material* material(int materialIndex);
+
+	//! Return a new texture of the given glTF texture, NULL if its image is not valid
+	GLC_Texture* texture(int textureIndex);
+
+	//! Add the given glTF node as a child of the given occurrence
+	void addNode(int nodeIndex, GLC_StructOccurrence* pParent);
+
+	//! Return the matrix of the given glTF node
+	static GLC_Matrix4x4 nodeMatrix(const QJsonObject& node);
+
+	//! Return the normals of the given positions and triangles index
+	static GLfloatVector computeNormals(const GLfloatVector& positions, const IndexList& index);
+
+//@}
+
+//////////////////////////////////////////////////////////////////////
+// Qt Signals
+//////////////////////////////////////////////////////////////////////
+	signals:
+	void currentQuantum(int);
+
+//////////////////////////////////////////////////////////////////////
+	/* Private members */
+//////////////////////////////////////////////////////////////////////
+private:
+	//! pointer to a GLC_World
+	GLC_World* m_pWorld;
+
+	//! The glTF File name
+	QString m_FileName;
+
+	//! The list of attached file name
+	QStringList m_ListOfAttachedFileName;
+
+	//! The glTF top level arrays
+	QJsonArray m_Accessors;
+	QJsonArray m_BufferViews;
+	QJsonArray m_Meshes;
+	QJsonArray m_Nodes;
+	QJsonArray m_Materials;
+	QJsonArray m_Textures;
+	QJsonArray m_Images;
+
+	//! The mapped binary chunk
+	const uchar* m_pBinaryChunk;
+
+	//! The size of the binary chunk
+	qint64 m_BinaryChunkSize;
+
+	//! Hash table of glTF mesh index to shared reference
+	QHash<int, GLC_StructReference*> m_MeshReferenceHash;
+
+	//! Hash table of glTF material index to material
+	QHash<int, GLC_Material*> m_MaterialHash;
+
+	//! Hash table of glTF image index to image
+	QHash<int, QImage> m_ImageHash;
+
+	//! Hash table of reference extras to the first occurrence of the reference
+	QHash<int, GLC_StructOccurrence*> m_ReferenceOccurrenceHash;
+
+	//! Index of the nodes which are being added
+	QSet<int> m_NodePath;
+};
+
+#endif /* GLC_GLTFTOWORLD_H_ */
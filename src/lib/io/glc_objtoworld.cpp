@@ -34,7 +34,255 @@
 #include "../sceneGraph/glc_structinstance.h"
 #include "../sceneGraph/glc_structoccurrence.h"
 #include <QTextStream>
+#include <QTextCodec>
 #include <QFileInfo>
+#include <QtConcurrent>
+#include <QThread>
+
+#include <cstring>
+#include <limits>
+
+// Number of bytes of OBJ file parsed by a thread at once
+static const qint64 objChunkSize= 4 * 1024 * 1024;
+
+// Exactly representable powers of ten
+static const double objPowersOfTen[]=
+{
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+// Record of an OBJ chunk which is replayed in file order
+class ObjChunkRecord
+{
+public:
+	enum RecordType
+	{
+		// Face parsed in the chunk
+		Face,
+		// Line scanned as text in the final pass
+		Line
+	};
+
+	RecordType m_Type;
+	// Line number in the chunk (last line of merged lines)
+	int m_LineNumber;
+	// The text of the record
+	const char* m_pBegin;
+	const char* m_pEnd;
+	// Number of vertex lines of the chunk parsed before this record
+	int m_PositionCount;
+	int m_NormalCount;
+	int m_TexelCount;
+	// Face type, offset and number of vertices of face values
+	int m_FaceType;
+	int m_FirstValue;
+	int m_VertexCount;
+};
+
+// Line aligned chunk of OBJ file
+class ObjChunk
+{
+public:
+	ObjChunk(const char* pBegin, const char* pEnd)
+		: m_pBegin(pBegin)
+		, m_pEnd(pEnd)
+		, m_LineCount(0)
+		, m_Positions()
+		, m_Normals()
+		, m_Texels()
+		, m_Records()
+		, m_FaceValues()
+	{}
+
+	const char* m_pBegin;
+	const char* m_pEnd;
+	int m_LineCount;
+	GLfloatVector m_Positions;
+	GLfloatVector m_Normals;
+	GLfloatVector m_Texels;
+	QVector<ObjChunkRecord> m_Records;
+	// Coordinate, texture coordinate and normal value of face vertices
+	QVector<int> m_FaceValues;
+};
+
+// Return true if the given character is a white space of QTextStream
+static inline bool isObjSpace(char character)
+{
+	return (' ' == character) || (('\t' <= character) && ('\r' >= character));
+}
+
+// Return true if the given character ends an OBJ keyword
+static inline bool isObjKeywordEnd(char character)
+{
+	return (' ' == character) || ('\t' == character);
+}
+
+static inline bool isObjDigit(char character)
+{
+	return (character >= '0') && (character <= '9');
+}
+
+// Return the end of the content of the line ending at the given new line
+static inline const char* objLineContentEnd(const char* pData, const char* pNewLine)
+{
+	if ((pNewLine > pData) && ('\r' == pNewLine[-1])) --pNewLine;
+	return pNewLine;
+}
+
+// Return the end of the chunk starting before the given position
+// The chunk ends after a line which is not merged with the next one
+static const char* objChunkEnd(const char* pData, const char* pPos, const char* pEnd)
+{
+	while (pPos < pEnd)
+	{
+		const char* pNewLine= static_cast<const char*>(memchr(pPos, '\n', pEnd - pPos));
+		if (NULL == pNewLine) return pEnd;
+		const char* pContentEnd= objLineContentEnd(pData, pNewLine);
+		pPos= pNewLine + 1;
+		if ((pContentEnd == pData) || ('\\' != pContentEnd[-1])) return pPos;
+	}
+	return pEnd;
+}
+
+// Scan a float of the form [+-]digits[.digits][(e|E)[+-]digits] whose conversion is exact
+// with a single floating point operation, return false otherwise.
+// The result is the same than QString::toFloat
+static bool scanObjFloat(const char* pPos, const char* pEnd, GLfloat* pValue)
+{
+	bool negative= false;
+	if ((pPos < pEnd) && (('-' == *pPos) || ('+' == *pPos)))
+	{
+		negative= ('-' == *pPos);
+		++pPos;
+	}
+
+	qint64 mantissa= 0;
+	int digitCount= 0;
+	int exponent= 0;
+
+	// Integer part
+	const char* pDigits= pPos;
+	while ((pPos < pEnd) && isObjDigit(*pPos))
+	{
+		if (++digitCount > 15) return false;
+		mantissa= (mantissa * 10) + (*pPos - '0');
+		++pPos;
+	}
+	if (pPos == pDigits) return false;
+
+	// Fractional part
+	if ((pPos < pEnd) && ('.' == *pPos))
+	{
+		++pPos;
+		pDigits= pPos;
+		while ((pPos < pEnd) && isObjDigit(*pPos))
+		{
+			if (++digitCount > 15) return false;
+			mantissa= (mantissa * 10) + (*pPos - '0');
+			--exponent;
+			++pPos;
+		}
+		if (pPos == pDigits) return false;
+	}
+
+	// Exponent part
+	if ((pPos < pEnd) && (('e' == *pPos) || ('E' == *pPos)))
+	{
+		++pPos;
+		bool negativeExponent= false;
+		if ((pPos < pEnd) && (('-' == *pPos) || ('+' == *pPos)))
+		{
+			negativeExponent= ('-' == *pPos);
+			++pPos;
+		}
+		pDigits= pPos;
+		int exponentValue= 0;
+		while ((pPos < pEnd) && isObjDigit(*pPos))
+		{
+			exponentValue= (exponentValue * 10) + (*pPos - '0');
+			if (exponentValue > 100) return false;
+			++pPos;
+		}
+		if (pPos == pDigits) return false;
+		exponent+= negativeExponent ? -exponentValue : exponentValue;
+	}
+	if ((pPos != pEnd) || (exponent < -22) || (exponent > 22)) return false;
+
+	double value= static_cast<double>(mantissa);
+	if (exponent < 0) value/= objPowersOfTen[-exponent];
+	else value*= objPowersOfTen[exponent];
+
+	*pValue= static_cast<GLfloat>(negative ? -value : value);
+	return true;
+}
+
+// Scan an integer of the form [+-]digits, return false if it may not fit in an int
+static bool scanObjInt(const char*& pPos, const char* pEnd, int* pValue)
+{
+	bool negative= false;
+	if ((pPos < pEnd) && (('-' == *pPos) || ('+' == *pPos)))
+	{
+		negative= ('-' == *pPos);
+		++pPos;
+	}
+	int value= 0;
+	int digitCount= 0;
+	while ((pPos < pEnd) && isObjDigit(*pPos))
+	{
+		if (++digitCount > 9) return false;
+		value= (value * 10) + (*pPos - '0');
+		++pPos;
+	}
+	*pValue= negative ? -value : value;
+	return digitCount > 0;
+}
+
+// Scan the given number of floats of the given text and append them to the given vector
+// Following tokens are ignored
+static bool scanObjFloats(const char* pPos, const char* pEnd, int count, GLfloatVector* pTarget)
+{
+	GLfloat values[3];
+	for (int i= 0; i < count; ++i)
+	{
+		while ((pPos < pEnd) && isObjSpace(*pPos)) ++pPos;
+		const char* pToken= pPos;
+		while ((pPos < pEnd) && !isObjSpace(*pPos)) ++pPos;
+		if ((pToken == pPos) || !scanObjFloat(pToken, pPos, &values[i])) return false;
+	}
+	for (int i= 0; i < count; ++i)
+	{
+		pTarget->append(values[i]);
+	}
+	return true;
+}
+
+// Return the line of the given record as read by QTextStream and merged by GLC_ObjToWorld
+static QString objRecordLine(const char* pBegin, const char* pEnd)
+{
+	QTextCodec* pCodec= QTextCodec::codecForLocale();
+	QString line;
+	bool mergeNextLine= true;
+	while (mergeNextLine)
+	{
+		QString physicalLine;
+		if (pBegin < pEnd)
+		{
+			const char* pNewLine= static_cast<const char*>(memchr(pBegin, '\n', pEnd - pBegin));
+			if (NULL == pNewLine) pNewLine= pEnd;
+			const char* pContentEnd= objLineContentEnd(pBegin, pNewLine);
+			physicalLine= pCodec->toUnicode(pBegin, static_cast<int>(pContentEnd - pBegin));
+			pBegin= (pNewLine < pEnd) ? (pNewLine + 1) : pEnd;
+		}
+		line.append(physicalLine);
+		mergeNextLine= line.endsWith(QChar('\\'));
+		if (mergeNextLine)
+		{
+			line.replace(QChar('\\'), QChar(' '));
+		}
+	}
+	return line;
+}
 
 //////////////////////////////////////////////////////////////////////
 // Constructor
@@ -59,6 +307,10 @@ GLC_ObjToWorld::GLC_ObjToWorld()
 , m_NormalOffset(0)
 , m_TextureOffset(0)
 , m_ResetIndex(false)
+, m_ParallelParsing(true)
+, m_ChunkPositionCount(0)
+, m_ChunkNormalCount(0)
+, m_ChunkTexelCount(0)
 {
 }
 
@@ -106,29 +358,72 @@ GLC_World* GLC_ObjToWorld::CreateWorldFromObj(QFile &file)
 	QString mtlLibLine;
 
 	//////////////////////////////////////////////////////////////////
-	// Searching mtllib attribute
+	// Map the file, read it if mapping is not possible
 	//////////////////////////////////////////////////////////////////
-	while (!objStream.atEnd() && !lineBuff.contains("mtllib"))
+	QByteArray fileContent;
+	uchar* pMappedData= NULL;
+	const char* pData= NULL;
+	const qint64 fileSize= file.size();
+	if (m_ParallelParsing)
 	{
-		++numberOfLine;
-		lineBuff= objStream.readLine();
-		if (lineBuff.contains("mtllib")) mtlLibLine= lineBuff;
+		pMappedData= file.map(0, fileSize);
+		pData= reinterpret_cast<const char*>(pMappedData);
+		if (NULL == pData)
+		{
+			fileContent= file.readAll();
+			file.reset();
+			pData= fileContent.constData();
+		}
 	}
 
-	//////////////////////////////////////////////////////////////////
-	// Count the number of lines of the OBJ file
-	//////////////////////////////////////////////////////////////////
-	while (!objStream.atEnd())
+	// Files with unicode byte order mark are decoded by QTextStream
+	const bool parseInParallel= m_ParallelParsing && !((fileSize >= 2)
+			&& (((pData[0] == '\xFF') && (pData[1] == '\xFE')) || ((pData[0] == '\xFE') && (pData[1] == '\xFF'))
+			|| ((fileSize >= 3) && (pData[0] == '\xEF') && (pData[1] == '\xBB') && (pData[2] == '\xBF'))));
+
+	if (parseInParallel)
 	{
-		++numberOfLine;
-		objStream.readLine();
+		//////////////////////////////////////////////////////////////////
+		// Searching mtllib attribute in the mapped data
+		//////////////////////////////////////////////////////////////////
+		const QByteArray content(QByteArray::fromRawData(pData, static_cast<int>(qMin(fileSize, static_cast<qint64>(std::numeric_limits<int>::max())))));
+		const int mtlLibIndex= content.indexOf("mtllib");
+		if (-1 != mtlLibIndex)
+		{
+			const int lineBegin= content.lastIndexOf('\n', mtlLibIndex) + 1;
+			int lineEnd= content.indexOf('\n', mtlLibIndex);
+			if (-1 == lineEnd) lineEnd= content.size();
+			const char* pContentEnd= objLineContentEnd(pData, pData + lineEnd);
+			mtlLibLine= QTextCodec::codecForLocale()->toUnicode(pData + lineBegin, static_cast<int>(pContentEnd - (pData + lineBegin)));
+		}
 	}
+	else
+	{
+		//////////////////////////////////////////////////////////////////
+		// Searching mtllib attribute
+		//////////////////////////////////////////////////////////////////
+		while (!objStream.atEnd() && !lineBuff.contains("mtllib"))
+		{
+			++numberOfLine;
+			lineBuff= objStream.readLine();
+			if (lineBuff.contains("mtllib")) mtlLibLine= lineBuff;
+		}
 
-	//////////////////////////////////////////////////////////////////
-	// Reset the stream
-	//////////////////////////////////////////////////////////////////
-	objStream.resetStatus();
-	objStream.seek(0);
+		//////////////////////////////////////////////////////////////////
+		// Count the number of lines of the OBJ file
+		//////////////////////////////////////////////////////////////////
+		while (!objStream.atEnd())
+		{
+			++numberOfLine;
+			objStream.readLine();
+		}
+
+		//////////////////////////////////////////////////////////////////
+		// Reset the stream
+		//////////////////////////////////////////////////////////////////
+		objStream.resetStatus();
+		objStream.seek(0);
+	}
 
 	//////////////////////////////////////////////////////////////////
 	// if mtl file found, load it
@@ -173,22 +468,42 @@ GLC_World* GLC_ObjToWorld::CreateWorldFromObj(QFile &file)
     m_NormalOffset= 0;
     m_TextureOffset= 0;
 
-	while (!objStream.atEnd())
+	if (parseInParallel)
 	{
-		++m_CurrentLineNumber;
-		lineBuff= objStream.readLine();
-
-		mergeLines(&lineBuff, &objStream);
-
-		scanLigne(lineBuff);
-		currentQuantumValue = static_cast<int>((static_cast<double>(m_CurrentLineNumber) / numberOfLine) * 100);
-		if (currentQuantumValue > previousQuantumValue)
+		try
+		{
+			scanChunks(pData, fileSize);
+		}
+		catch (GLC_FileFormatException&)
 		{
-			emit currentQuantum(currentQuantumValue);
+			if (NULL != pMappedData) file.unmap(pMappedData);
+			file.close();
+			throw;
 		}
-		previousQuantumValue= currentQuantumValue;
+	}
+	else
+	{
+		while (!objStream.atEnd())
+		{
+			++m_CurrentLineNumber;
+			lineBuff= objStream.readLine();
+
+			mergeLines(&lineBuff, &objStream);
 
+			scanLigne(lineBuff);
+			currentQuantumValue = static_cast<int>((static_cast<double>(m_CurrentLineNumber) / numberOfLine) * 100);
+			if (currentQuantumValue > previousQuantumValue)
+			{
+				emit currentQuantum(currentQuantumValue);
+			}
+			previousQuantumValue= currentQuantumValue;
+		}
+	}
+	if (NULL != pMappedData)
+	{
+		file.unmap(pMappedData);
 	}
+	fileContent.clear();
 	file.close();
 
 	addCurrentObjMeshToWorld();
@@ -260,7 +575,7 @@ void GLC_ObjToWorld::scanLigne(QString &line)
             m_ResetIndex= false;
         }
 		line.remove(0,2); // Remove first 2 char
-		m_Positions.append(extract3dVect(line));
+		m_Positions+= extract3dVect(line);
 		m_FaceType = notSet;
         ++m_VerticeIndex;
 	}
@@ -269,7 +584,7 @@ void GLC_ObjToWorld::scanLigne(QString &line)
 	else if (line.startsWith("vt ")|| line.startsWith(QString("vt") + QString(QChar(9))))
 	{
 		line.remove(0,3); // Remove first 3 char
-		m_Texels.append(extract2dVect(line));
+		m_Texels+= extract2dVect(line);
 		m_FaceType = notSet;
         ++m_TextureIndex;
 	}
@@ -278,7 +593,7 @@ void GLC_ObjToWorld::scanLigne(QString &line)
 	else if (line.startsWith("vn ") || line.startsWith(QString("vn") + QString(QChar(9))))
 	{
 		line.remove(0,3); // Remove first 3 char
-		m_Normals.append(extract3dVect(line));
+		m_Normals+= extract3dVect(line);
 		m_FaceType = notSet;
         ++m_NormalIndex;
 	}
@@ -356,9 +671,9 @@ void GLC_ObjToWorld::changeGroup(QString line)
 }
 
 // Extract a Vector from a string
-QList<float> GLC_ObjToWorld::extract3dVect(QString &line)
+QVector<float> GLC_ObjToWorld::extract3dVect(QString &line)
 {
-	QList<float> vectResult;
+	QVector<float> vectResult;
 	QTextStream stringVecteur(&line);
 
 	QString xString, yString, zString;
@@ -392,9 +707,9 @@ QList<float> GLC_ObjToWorld::extract3dVect(QString &line)
 }
 
 // Extract a Vector from a string
-QList<float> GLC_ObjToWorld::extract2dVect(QString &line)
+QVector<float> GLC_ObjToWorld::extract2dVect(QString &line)
 {
-	QList<float> vectResult;
+	QVector<float> vectResult;
 	QTextStream stringVecteur(&line);
 
 	QString xString, yString;
@@ -432,7 +747,6 @@ void GLC_ObjToWorld::extractFaceIndex(QString &line)
 
 	QList<GLuint> currentFaceIndex;
 
-    const bool currentObjMeshIsAlive= (nullptr != m_pCurrentObjMesh);
 	//////////////////////////////////////////////////////////////////
 	// Parse the line containing face index
 	//////////////////////////////////////////////////////////////////
@@ -441,61 +755,75 @@ void GLC_ObjToWorld::extractFaceIndex(QString &line)
 	{
 		streamFace >> buff;
 		extractVertexIndex(buff, coordinateIndex, normalIndex, textureCoordinateIndex);
+		addFaceVertex(coordinateIndex, normalIndex, textureCoordinateIndex, &currentFaceIndex, &polygonNormal);
+	}
+	addFace(&currentFaceIndex, polygonNormal);
+}
+
+// Add the given vertex to the current face and to the current mesh if it is a new one
+void GLC_ObjToWorld::addFaceVertex(int coordinateIndex, int normalIndex, int textureCoordinateIndex, QList<GLuint>* pFaceIndex, GLC_Vector3d* pPolygonNormal)
+{
+	if (nullptr == m_pCurrentObjMesh) return;
 
-        ObjVertice currentVertice(coordinateIndex, normalIndex, textureCoordinateIndex);
-        if (currentObjMeshIsAlive && (m_pCurrentObjMesh->m_ObjVerticeIndexMap.contains(currentVertice)))
+	const ObjVertice currentVertice(coordinateIndex, normalIndex, textureCoordinateIndex);
+	QHash<ObjVertice, GLuint>::const_iterator iVertice= m_pCurrentObjMesh->m_ObjVerticeIndexMap.constFind(currentVertice);
+	if (m_pCurrentObjMesh->m_ObjVerticeIndexMap.constEnd() != iVertice)
+	{
+		pFaceIndex->append(iVertice.value());
+	}
+	else
+	{
+		// Add Vertex to the mesh bulk data
+		m_pCurrentObjMesh->m_Positions.append(m_Positions.value(coordinateIndex * 3));
+		m_pCurrentObjMesh->m_Positions.append(m_Positions.value(coordinateIndex * 3 + 1));
+		m_pCurrentObjMesh->m_Positions.append(m_Positions.value(coordinateIndex * 3 + 2));
+		if (-1 != normalIndex)
 		{
-			currentFaceIndex.append(m_pCurrentObjMesh->m_ObjVerticeIndexMap.value(currentVertice));
-        }
-        else if (currentObjMeshIsAlive)
+			const double x= m_Normals.value(normalIndex * 3);
+			const double y= m_Normals.value(normalIndex * 3 + 1);
+			const double z= m_Normals.value(normalIndex * 3 + 2);
+			pPolygonNormal->setVect(x, y, z);
+			// Add Normal to the mesh bulk data
+			m_pCurrentObjMesh->m_Normals.append(x);
+			m_pCurrentObjMesh->m_Normals.append(y);
+			m_pCurrentObjMesh->m_Normals.append(z);
+		}
+		else
 		{
-			// Add Vertex to the mesh bulk data
-			m_pCurrentObjMesh->m_Positions.append(m_Positions.value(coordinateIndex * 3));
-			m_pCurrentObjMesh->m_Positions.append(m_Positions.value(coordinateIndex * 3 + 1));
-			m_pCurrentObjMesh->m_Positions.append(m_Positions.value(coordinateIndex * 3 + 2));
-			if (-1 != normalIndex)
-			{
-                const double x= m_Normals.value(normalIndex * 3);
-                const double y= m_Normals.value(normalIndex * 3 + 1);
-                const double z= m_Normals.value(normalIndex * 3 + 2);
-                polygonNormal.setVect(x, y, z);
-				// Add Normal to the mesh bulk data
-                m_pCurrentObjMesh->m_Normals.append(x);
-                m_pCurrentObjMesh->m_Normals.append(y);
-                m_pCurrentObjMesh->m_Normals.append(z);
-			}
-			else
-			{
-				// Add Null Normal to the mesh bulk data
-				m_pCurrentObjMesh->m_Normals.append(0.0f);
-				m_pCurrentObjMesh->m_Normals.append(0.0f);
-				m_pCurrentObjMesh->m_Normals.append(0.0f);
-			}
-			if (-1 != textureCoordinateIndex)
-			{
-				// Add texture coordinate to the mesh bulk data
-				m_pCurrentObjMesh->m_Texels.append(m_Texels.value(textureCoordinateIndex * 2));
-				m_pCurrentObjMesh->m_Texels.append(m_Texels.value(textureCoordinateIndex * 2 + 1));
-			}
-			else if (!m_pCurrentObjMesh->m_Texels.isEmpty())
-			{
-				// Add epmty texture coordinate
-				m_pCurrentObjMesh->m_Texels.append(0.0f);
-				m_pCurrentObjMesh->m_Texels.append(0.0f);
-			}
-			// Add the index to current face index
-			currentFaceIndex.append(m_pCurrentObjMesh->m_NextFreeIndex);
-			// Add ObjVertice to ObjVertice Map
-			m_pCurrentObjMesh->m_ObjVerticeIndexMap.insert(currentVertice, m_pCurrentObjMesh->m_NextFreeIndex);
-			// Increment next free index
-			++(m_pCurrentObjMesh->m_NextFreeIndex);
+			// Add Null Normal to the mesh bulk data
+			m_pCurrentObjMesh->m_Normals.append(0.0f);
+			m_pCurrentObjMesh->m_Normals.append(0.0f);
+			m_pCurrentObjMesh->m_Normals.append(0.0f);
 		}
-
+		if (-1 != textureCoordinateIndex)
+		{
+			// Add texture coordinate to the mesh bulk data
+			m_pCurrentObjMesh->m_Texels.append(m_Texels.value(textureCoordinateIndex * 2));
+			m_pCurrentObjMesh->m_Texels.append(m_Texels.value(textureCoordinateIndex * 2 + 1));
+		}
+		else if (!m_pCurrentObjMesh->m_Texels.isEmpty())
+		{
+			// Add epmty texture coordinate
+			m_pCurrentObjMesh->m_Texels.append(0.0f);
+			m_pCurrentObjMesh->m_Texels.append(0.0f);
+		}
+		// Add the index to current face index
+		pFaceIndex->append(m_pCurrentObjMesh->m_NextFreeIndex);
+		// Add ObjVertice to ObjVertice Map
+		m_pCurrentObjMesh->m_ObjVerticeIndexMap.insert(currentVertice, m_pCurrentObjMesh->m_NextFreeIndex);
+		// Increment next free index
+		++(m_pCurrentObjMesh->m_NextFreeIndex);
 	}
+}
+
+// Add the given face index to the current mesh
+void GLC_ObjToWorld::addFace(QList<GLuint>* pFaceIndex, const GLC_Vector3d& polygonNormal)
+{
+    const bool currentObjMeshIsAlive= (nullptr != m_pCurrentObjMesh);
 	//////////////////////////////////////////////////////////////////
 	// Check the number of face's vertex
 	//////////////////////////////////////////////////////////////////
-	const int size= currentFaceIndex.size();
+	const int size= pFaceIndex->size();
 	if (size < 3)
 	{
 		QStringList stringList(m_FileName);
@@ -510,26 +838,26 @@ void GLC_ObjToWorld::extractFaceIndex(QString &line)
 	{
 		if (size > 3)
 		{
-            GLC_Vector3d computedNormal= glc::triangulatePolygonClip2TRi(&currentFaceIndex, m_pCurrentObjMesh->m_Positions);
+            GLC_Vector3d computedNormal= glc::triangulatePolygonClip2TRi(pFaceIndex, m_pCurrentObjMesh->m_Positions);
             if (glc::compare(computedNormal.inverted(), polygonNormal))
             {
-                currentFaceIndex= glc::reverseTriangleIndexWindingOrder(currentFaceIndex);
+                *pFaceIndex= glc::reverseTriangleIndexWindingOrder(*pFaceIndex);
             }
 		}
-		m_pCurrentObjMesh->m_Index.append(currentFaceIndex);
+		m_pCurrentObjMesh->m_Index.append(*pFaceIndex);
     }
     else if (currentObjMeshIsAlive && (m_FaceType != notSet))
 	{
 		if (size > 3)
 		{
-            glc::triangulatePolygonClip2TRi(&currentFaceIndex, m_pCurrentObjMesh->m_Positions);
+            glc::triangulatePolygonClip2TRi(pFaceIndex, m_pCurrentObjMesh->m_Positions);
 		}
 		// Comput the face normal
-		if (currentFaceIndex.size() < 3) return;
-		GLC_Vector3df normal= computeNormal(currentFaceIndex.at(0), currentFaceIndex.at(1), currentFaceIndex.at(2));
+		if (pFaceIndex->size() < 3) return;
+		GLC_Vector3df normal= computeNormal(pFaceIndex->at(0), pFaceIndex->at(1), pFaceIndex->at(2));
 
         // Add Face normal to bulk data
-        QSet<GLuint> indexSet= QSet<GLuint>(currentFaceIndex.begin(), currentFaceIndex.end());
+        QSet<GLuint> indexSet= QSet<GLuint>(pFaceIndex->begin(), pFaceIndex->end());
         QSet<GLuint>::const_iterator iIndexSet= indexSet.constBegin();
 		while (indexSet.constEnd() != iIndexSet)
 		{
@@ -540,7 +868,7 @@ void GLC_ObjToWorld::extractFaceIndex(QString &line)
 			++iIndexSet;
 		}
 
-		m_pCurrentObjMesh->m_Index.append(currentFaceIndex);
+		m_pCurrentObjMesh->m_Index.append(*pFaceIndex);
 
 	}
 	else
@@ -948,3 +1276,332 @@ void GLC_ObjToWorld::addCurrentObjMeshToWorld()
 }
 
 
+
+// Scan the given mapped OBJ data by chunks parsed in parallel
+void GLC_ObjToWorld::scanChunks(const char* pData, qint64 size)
+{
+	const char* pEnd= pData + size;
+	QList<ObjChunk*> chunkList;
+	const char* pChunkBegin= pData;
+	while (pChunkBegin < pEnd)
+	{
+		const char* pChunkEnd= pEnd;
+		if ((pEnd - pChunkBegin) > objChunkSize)
+		{
+			pChunkEnd= objChunkEnd(pData, pChunkBegin + objChunkSize, pEnd);
+		}
+		chunkList.append(new ObjChunk(pChunkBegin, pChunkEnd));
+		pChunkBegin= pChunkEnd;
+	}
+
+	// Multi thread chunk parsing by group of chunks, replayed in file order
+	const int chunkCount= chunkList.count();
+	const int groupSize= qMax(1, QThread::idealThreadCount()) * 2;
+	int previousQuantumValue= 0;
+	int lineNumber= 0;
+	try
+	{
+		for (int firstChunk= 0; firstChunk < chunkCount; firstChunk+= groupSize)
+		{
+			const QList<ObjChunk*> currentChunkList= chunkList.mid(firstChunk, groupSize);
+			QtConcurrent::blockingMapped(currentChunkList, parseChunk);
+
+			const int currentChunkCount= currentChunkList.count();
+			for (int i= 0; i < currentChunkCount; ++i)
+			{
+				ObjChunk* pChunk= currentChunkList.at(i);
+				scanChunk(pChunk, lineNumber);
+				lineNumber+= pChunk->m_LineCount;
+
+				// Release the chunk data
+				delete pChunk;
+				chunkList[firstChunk + i]= NULL;
+			}
+
+			const int scannedChunkCount= qMin(chunkCount, firstChunk + groupSize);
+			const int currentQuantumValue = static_cast<int>((static_cast<double>(scannedChunkCount) / chunkCount) * 100);
+			if (currentQuantumValue > previousQuantumValue)
+			{
+				emit currentQuantum(currentQuantumValue);
+			}
+			previousQuantumValue= currentQuantumValue;
+		}
+	}
+	catch (GLC_FileFormatException&)
+	{
+		qDeleteAll(chunkList);
+		throw;
+	}
+}
+
+// Parse the vertices and faces of the given chunk, called from the thread pool
+ObjChunk* GLC_ObjToWorld::parseChunk(ObjChunk* pChunk)
+{
+	const char* pData= pChunk->m_pBegin;
+	const char* pEnd= pChunk->m_pEnd;
+	const char* pLine= pData;
+	int lineNumber= 0;
+	int values[3];
+	while (pLine < pEnd)
+	{
+		// Find the end of the line content and the begining of the next line
+		const char* pNewLine= static_cast<const char*>(memchr(pLine, '\n', pEnd - pLine));
+		if (NULL == pNewLine) pNewLine= pEnd;
+		const char* pContentEnd= objLineContentEnd(pLine, pNewLine);
+		const char* pNextLine= (pNewLine < pEnd) ? (pNewLine + 1) : pEnd;
+		++lineNumber;
+
+		ObjChunkRecord record;
+		record.m_Type= ObjChunkRecord::Line;
+		record.m_LineNumber= lineNumber;
+		record.m_pBegin= pLine;
+		record.m_pEnd= pNextLine;
+		record.m_PositionCount= pChunk->m_Positions.size() / 3;
+		record.m_NormalCount= pChunk->m_Normals.size() / 3;
+		record.m_TexelCount= pChunk->m_Texels.size() / 2;
+		record.m_FaceType= notSet;
+		record.m_FirstValue= 0;
+		record.m_VertexCount= 0;
+
+		// Merged lines and not ASCII lines are scanned as text
+		bool scanAsText= (pContentEnd > pLine) && ('\\' == pContentEnd[-1]);
+		if (scanAsText)
+		{
+			while ((pContentEnd > pLine) && ('\\' == pContentEnd[-1]))
+			{
+				if (pNextLine == pEnd)
+				{
+					// QTextStream returns an empty line
+					++record.m_LineNumber;
+					break;
+				}
+				pNewLine= static_cast<const char*>(memchr(pNextLine, '\n', pEnd - pNextLine));
+				if (NULL == pNewLine) pNewLine= pEnd;
+				pContentEnd= objLineContentEnd(pNextLine, pNewLine);
+				pNextLine= (pNewLine < pEnd) ? (pNewLine + 1) : pEnd;
+				++lineNumber;
+				record.m_LineNumber= lineNumber;
+			}
+			record.m_pEnd= pNextLine;
+		}
+		else
+		{
+			for (const char* pPos= pLine; pPos < pContentEnd; ++pPos)
+			{
+				if (0 != (*pPos & 0x80))
+				{
+					scanAsText= true;
+					break;
+				}
+			}
+		}
+
+		if (scanAsText)
+		{
+			pChunk->m_Records.append(record);
+			pLine= pNextLine;
+			continue;
+		}
+
+		// Trim the line
+		const char* pBegin= pLine;
+		while ((pBegin < pContentEnd) && isObjSpace(*pBegin)) ++pBegin;
+		const char* pStop= pContentEnd;
+		while ((pStop > pBegin) && isObjSpace(pStop[-1])) --pStop;
+		const qint64 length= pStop - pBegin;
+
+		if ((length > 2) && ('v' == pBegin[0]) && isObjKeywordEnd(pBegin[1]))
+		{
+			if (!scanObjFloats(pBegin + 2, pStop, 3, &(pChunk->m_Positions)))
+			{
+				pChunk->m_Records.append(record);
+			}
+		}
+		else if ((length > 3) && ('v' == pBegin[0]) && ('t' == pBegin[1]) && isObjKeywordEnd(pBegin[2]))
+		{
+			if (!scanObjFloats(pBegin + 3, pStop, 2, &(pChunk->m_Texels)))
+			{
+				pChunk->m_Records.append(record);
+			}
+		}
+		else if ((length > 3) && ('v' == pBegin[0]) && ('n' == pBegin[1]) && isObjKeywordEnd(pBegin[2]))
+		{
+			if (!scanObjFloats(pBegin + 3, pStop, 3, &(pChunk->m_Normals)))
+			{
+				pChunk->m_Records.append(record);
+			}
+		}
+		else if ((length > 2) && ('f' == pBegin[0]) && isObjKeywordEnd(pBegin[1]))
+		{
+			// All face vertices must have the same layout
+			record.m_FirstValue= pChunk->m_FaceValues.size();
+			bool isOk= true;
+			const char* pPos= pBegin + 2;
+			while (isOk && (pPos < pStop))
+			{
+				while ((pPos < pStop) && isObjSpace(*pPos)) ++pPos;
+				values[0]= 0;
+				values[1]= 0;
+				values[2]= 0;
+				int faceType= notSet;
+				if (scanObjInt(pPos, pStop, &values[0]))
+				{
+					faceType= coordinate;
+					if ((pPos < pStop) && ('/' == *pPos))
+					{
+						++pPos;
+						if ((pPos < pStop) && ('/' == *pPos))
+						{
+							++pPos;
+							if (scanObjInt(pPos, pStop, &values[2])) faceType= coordinateAndNormal;
+							else faceType= notSet;
+						}
+						else if (scanObjInt(pPos, pStop, &values[1]))
+						{
+							faceType= coordinateAndTexture;
+							if ((pPos < pStop) && ('/' == *pPos))
+							{
+								++pPos;
+								if (scanObjInt(pPos, pStop, &values[2])) faceType= coordinateAndTextureAndNormal;
+								else faceType= notSet;
+							}
+						}
+						else faceType= notSet;
+					}
+				}
+				isOk= (notSet != faceType) && ((pPos == pStop) || isObjSpace(*pPos))
+						&& ((0 == record.m_VertexCount) || (record.m_FaceType == faceType));
+				if (isOk)
+				{
+					record.m_FaceType= faceType;
+					pChunk->m_FaceValues.append(values[0]);
+					pChunk->m_FaceValues.append(values[1]);
+					pChunk->m_FaceValues.append(values[2]);
+					++record.m_VertexCount;
+				}
+			}
+			if (isOk)
+			{
+				record.m_Type= ObjChunkRecord::Face;
+			}
+			else
+			{
+				pChunk->m_FaceValues.resize(record.m_FirstValue);
+				record.m_FaceType= notSet;
+				record.m_VertexCount= 0;
+			}
+			pChunk->m_Records.append(record);
+		}
+		else if (((length > 6) && (0 == memcmp(pBegin, "usemtl", 6)) && isObjKeywordEnd(pBegin[6]))
+				|| ((length > 2) && (('g' == pBegin[0]) || ('o' == pBegin[0])) && isObjKeywordEnd(pBegin[1])))
+		{
+			pChunk->m_Records.append(record);
+		}
+
+		pLine= pNextLine;
+	}
+	pChunk->m_LineCount= lineNumber;
+
+	return pChunk;
+}
+
+// Replay the records of the given parsed chunk which starts after the given line number
+void GLC_ObjToWorld::scanChunk(const ObjChunk* pChunk, int lineNumber)
+{
+	m_ChunkPositionCount= 0;
+	m_ChunkNormalCount= 0;
+	m_ChunkTexelCount= 0;
+
+	const int recordCount= pChunk->m_Records.size();
+	for (int i= 0; i < recordCount; ++i)
+	{
+		const ObjChunkRecord& record= pChunk->m_Records.at(i);
+		appendChunkVertices(pChunk, record.m_PositionCount, record.m_NormalCount, record.m_TexelCount);
+		m_CurrentLineNumber= lineNumber + record.m_LineNumber;
+
+		bool scanAsText= (ObjChunkRecord::Line == record.m_Type);
+		if (!scanAsText)
+		{
+			m_ResetIndex= true;
+			// If there is no group or object in the OBJ file
+			if (nullptr == m_pCurrentObjMesh)
+			{
+				changeGroup("GLC_Default");
+			}
+			if (notSet == m_FaceType)
+			{
+				m_FaceType= static_cast<FaceType>(record.m_FaceType);
+			}
+			// A face whose layout differs from the current face type is scanned as text
+			scanAsText= (record.m_FaceType != m_FaceType);
+			if (!scanAsText)
+			{
+				extractFaceValues(pChunk->m_FaceValues.constData() + record.m_FirstValue, record.m_VertexCount);
+			}
+		}
+		if (scanAsText)
+		{
+			QString line(objRecordLine(record.m_pBegin, record.m_pEnd));
+			scanLigne(line);
+		}
+	}
+	appendChunkVertices(pChunk, pChunk->m_Positions.size() / 3, pChunk->m_Normals.size() / 3, pChunk->m_Texels.size() / 2);
+}
+
+// Append the vertices of the given chunk up to the given counts to the bulk data
+void GLC_ObjToWorld::appendChunkVertices(const ObjChunk* pChunk, int positionCount, int normalCount, int texelCount)
+{
+	// The sum of vertice index and offset is the number of parsed vertex lines
+	if (positionCount > m_ChunkPositionCount)
+	{
+		const int size= m_Positions.size();
+		m_Positions.resize(size + ((positionCount - m_ChunkPositionCount) * 3));
+		memcpy(m_Positions.data() + size, pChunk->m_Positions.constData() + (m_ChunkPositionCount * 3), (positionCount - m_ChunkPositionCount) * 3 * sizeof(float));
+		m_VerticeIndex+= positionCount - m_ChunkPositionCount;
+		m_ChunkPositionCount= positionCount;
+		m_FaceType= notSet;
+	}
+	if (normalCount > m_ChunkNormalCount)
+	{
+		const int size= m_Normals.size();
+		m_Normals.resize(size + ((normalCount - m_ChunkNormalCount) * 3));
+		memcpy(m_Normals.data() + size, pChunk->m_Normals.constData() + (m_ChunkNormalCount * 3), (normalCount - m_ChunkNormalCount) * 3 * sizeof(float));
+		m_NormalIndex+= normalCount - m_ChunkNormalCount;
+		m_ChunkNormalCount= normalCount;
+		m_FaceType= notSet;
+	}
+	if (texelCount > m_ChunkTexelCount)
+	{
+		const int size= m_Texels.size();
+		m_Texels.resize(size + ((texelCount - m_ChunkTexelCount) * 2));
+		memcpy(m_Texels.data() + size, pChunk->m_Texels.constData() + (m_ChunkTexelCount * 2), (texelCount - m_ChunkTexelCount) * 2 * sizeof(float));
+		m_TextureIndex+= texelCount - m_ChunkTexelCount;
+		m_ChunkTexelCount= texelCount;
+		m_FaceType= notSet;
+	}
+}
+
+// Extract a face from the given values (3 values per vertex) of a parsed chunk
+void GLC_ObjToWorld::extractFaceValues(const int* pValues, int vertexCount)
+{
+	const bool hasTexture= (m_FaceType == coordinateAndTexture) || (m_FaceType == coordinateAndTextureAndNormal);
+	const bool hasNormal= (m_FaceType == coordinateAndNormal) || (m_FaceType == coordinateAndTextureAndNormal);
+
+    GLC_Vector3d polygonNormal;
+	QList<GLuint> currentFaceIndex;
+	for (int i= 0; i < vertexCount; ++i)
+	{
+		int coordinateIndex= pValues[0] - 1;
+		int textureCoordinateIndex= hasTexture ? (pValues[1] - 1) : -1;
+		int normalIndex= hasNormal ? (pValues[2] - 1) : -1;
+		if (coordinateIndex < 0)
+		{
+			coordinateIndex= m_VerticeIndex + m_VerticeOffset + coordinateIndex + 1;
+			if (hasNormal) normalIndex= m_NormalIndex + m_NormalOffset + normalIndex + 1;
+			if (hasTexture) textureCoordinateIndex= m_TextureIndex + m_TextureOffset + textureCoordinateIndex + 1;
+		}
+		addFaceVertex(coordinateIndex, normalIndex, textureCoordinateIndex, &currentFaceIndex, &polygonNormal);
+		pValues+= 3;
+	}
+	addFace(&currentFaceIndex, polygonNormal);
+}
@@ -44,6 +44,7 @@
 
 class GLC_World;
 class GLC_ObjMtlLoader;
+class ObjChunk;
 
 //////////////////////////////////////////////////////////////////////
 //! \class GLC_ObjToWorld
@@ -55,6 +56,11 @@ class GLC_ObjMtlLoader;
  * 		- Face
  * 		- Texture coordinate
  * 		- Normal coordinate
+ *
+ * By default the file is mapped and parsed by line aligned chunks on the
+ * global thread pool. Groups, materials and faces are then replayed in
+ * file order, so the created world is the same than the one of the line by
+ * line parsing.
   */
 //////////////////////////////////////////////////////////////////////
 class GLC_LIB_EXPORT GLC_ObjToWorld : public QObject
@@ -75,21 +81,19 @@ public:
 	struct ObjVertice
 	{
 		ObjVertice()
-		: m_Values(3)
 		{
 			m_Values[0]= 0;
 			m_Values[1]= 0;
 			m_Values[2]= 0;
 		}
 		ObjVertice(int v1, int v2, int v3)
-		: m_Values(3)
 		{
 			m_Values[0]= v1;
 			m_Values[1]= v2;
 			m_Values[2]= v3;
 		}
 
-		QVector<int> m_Values;
+		int m_Values[3];
 	};
 
 	// Material assignement
@@ -169,6 +173,15 @@ public:
 
 	//! Get the list of attached files
 	inline QStringList listOfAttachedFileName() const{return m_ListOfAttachedFileName;}
+
+	//! Set parallel parsing of the OBJ file
+	/*! Parallel parsing is activated by default*/
+	inline void setParallelParsing(bool parallel)
+	{m_ParallelParsing= parallel;}
+
+	//! Return true if the OBJ file is parsed in parallel
+	inline bool parallelParsingIsActivated() const
+	{return m_ParallelParsing;}
 //@}
 
 //////////////////////////////////////////////////////////////////////
@@ -185,14 +198,20 @@ private:
 	void changeGroup(QString);
 
 	//! Extract a 3D Vector from a string
-	QList<float> extract3dVect(QString &);
+	QVector<float> extract3dVect(QString &);
 
 	//! Extract a 2D Vector from a string
-	QList<float> extract2dVect(QString &);
+	QVector<float> extract2dVect(QString &);
 
 	//! Extract a face from a string
 	void extractFaceIndex(QString &);
 
+	//! Add the given vertex to the current face and to the current mesh if it is a new one
+	void addFaceVertex(int coordinate, int normal, int textureCoordinate, QList<GLuint>* pFaceIndex, GLC_Vector3d* pPolygonNormal);
+
+	//! Add the given face index to the current mesh
+	void addFace(QList<GLuint>* pFaceIndex, const GLC_Vector3d& polygonNormal);
+
 	//! Set Current material index
 	void setCurrentMaterial(QString &line);
 
@@ -214,6 +233,20 @@ private:
 	//! Add the current Obj mesh to the world
 	void addCurrentObjMeshToWorld();
 
+	//! Scan the given mapped OBJ data by chunks parsed in parallel
+	void scanChunks(const char* pData, qint64 size);
+
+	//! Parse the vertices and faces of the given chunk, called from the thread pool
+	static ObjChunk* parseChunk(ObjChunk* pChunk);
+
+	//! Replay the records of the given parsed chunk which starts after the given line number
+	void scanChunk(const ObjChunk* pChunk, int lineNumber);
+
+	//! Append the vertices of the given chunk up to the given counts to the bulk data
+	void appendChunkVertices(const ObjChunk* pChunk, int positionCount, int normalCount, int texelCount);
+
+	//! Extract a face from the given values (3 values per vertex) of a parsed chunk
+	void extractFaceValues(const int* pValues, int vertexCount);
 
 
 //////////////////////////////////////////////////////////////////////
@@ -254,13 +287,13 @@ private:
 	QStringList m_ListOfAttachedFileName;
 
 	//! The position bulk data
-	QList<float> m_Positions;
+	QVector<float> m_Positions;
 
 	//! The normal bulk data
-	QList<float> m_Normals;
+	QVector<float> m_Normals;
 
 	//! The texture coordinate bulk data
-	QList<float> m_Texels;
+	QVector<float> m_Texels;
 
     int m_VerticeIndex;
     int m_NormalIndex;
@@ -273,14 +306,23 @@ private:
 
     bool m_ResetIndex;
 
+	//! Flag to know if the OBJ file is parsed in parallel
+	bool m_ParallelParsing;
+
+	//! Number of vertices of the current chunk already added to the bulk data
+	int m_ChunkPositionCount;
+	int m_ChunkNormalCount;
+	int m_ChunkTexelCount;
 };
 
 // To use ObjVertice as a QHash key
 inline bool operator==(const GLC_ObjToWorld::ObjVertice& vertice1, const GLC_ObjToWorld::ObjVertice& vertice2)
-{ return (vertice1.m_Values == vertice2.m_Values);}
+{ return (vertice1.m_Values[0] == vertice2.m_Values[0]) && (vertice1.m_Values[1] == vertice2.m_Values[1])
+		&& (vertice1.m_Values[2] == vertice2.m_Values[2]);}
 
 inline uint qHash(const GLC_ObjToWorld::ObjVertice& vertice)
-{ return qHash(QString::number(vertice.m_Values.at(0)) + QString::number(vertice.m_Values.at(1)) + QString::number(vertice.m_Values.at(2)));}
+{ return (static_cast<uint>(vertice.m_Values[0]) * 73856093U) ^ (static_cast<uint>(vertice.m_Values[1]) * 19349663U)
+		^ (static_cast<uint>(vertice.m_Values[2]) * 83492791U);}
 
 
 #endif /*GLC_OBJTOWORLD_H_*/
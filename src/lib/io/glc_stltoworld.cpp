@@ -32,6 +32,87 @@
 #include <QTextStream>
 #include <QFileInfo>
 #include <QDataStream>
+#include <QtEndian>
+#include <QtConcurrent>
+#include <QtMath>
+#include <QThread>
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+// Size of binary STL header (80 bytes comment + 4 bytes facet count)
+static const qint64 binaryStlHeaderSize= 84;
+// Size of a binary STL facet record
+static const qint64 binaryStlFacetSize= 50;
+// Number of facets decoded by a thread at once
+static const quint32 binaryStlChunkSize= 65536;
+
+class StlFacetChunk
+{
+public:
+	StlFacetChunk(const uchar* pData, quint32 firstFacet, quint32 facetCount, GLfloat* pPositions, GLfloat* pNormals)
+		: m_pData(pData)
+		, m_FirstFacet(firstFacet)
+		, m_FacetCount(facetCount)
+		, m_pPositions(pPositions)
+		, m_pNormals(pNormals)
+	{}
+
+	const uchar* m_pData;
+	quint32 m_FirstFacet;
+	quint32 m_FacetCount;
+	GLfloat* m_pPositions;
+	GLfloat* m_pNormals;
+};
+
+// Key of a vertex in the welding spatial hash
+class StlWeldKey
+{
+public:
+	qint64 m_X;
+	qint64 m_Y;
+	qint64 m_Z;
+
+	inline bool operator==(const StlWeldKey& other) const
+	{return (m_X == other.m_X) && (m_Y == other.m_Y) && (m_Z == other.m_Z);}
+};
+
+inline uint qHash(const StlWeldKey& key, uint seed= 0)
+{
+	const quint64 hash= (static_cast<quint64>(key.m_X) * 73856093ULL)
+			^ (static_cast<quint64>(key.m_Y) * 19349663ULL)
+			^ (static_cast<quint64>(key.m_Z) * 83492791ULL);
+	return static_cast<uint>(hash ^ (hash >> 32)) ^ seed;
+}
+
+// Return the little endian float stored at the given address
+static inline float binaryStlFloat(const uchar* pData)
+{
+	const quint32 value= qFromLittleEndian<quint32>(pData);
+	float subject;
+	memcpy(&subject, &value, sizeof(float));
+	return subject;
+}
+
+// Return the welding key coordinate of the given value
+static inline qint64 weldKeyCoordinate(float value, double precision)
+{
+	qint64 subject;
+	if (precision > 0.0)
+	{
+		subject= static_cast<qint64>(qFloor(static_cast<double>(value) / precision));
+	}
+	else
+	{
+		// Adding 0.0 turns -0.0 into 0.0
+		const float positiveZero= value + 0.0f;
+		quint32 bits;
+		memcpy(&bits, &positiveZero, sizeof(float));
+		subject= static_cast<qint64>(bits);
+	}
+	return subject;
+}
 
 GLC_StlToWorld::GLC_StlToWorld()
 : QObject()
@@ -44,6 +125,8 @@ GLC_StlToWorld::GLC_StlToWorld()
 , m_VertexBulk()
 , m_NormalBulk()
 , m_CurrentIndex(0)
+, m_WeldVertices(false)
+, m_WeldPrecision(0.0)
 {
 
 }
@@ -80,32 +163,37 @@ GLC_World* GLC_StlToWorld::CreateWorldFromStl(QFile &file)
 	int currentQuantumValue= 0;
 	int numberOfLine= 0;
 
-	// Attach the stream to the file
-	m_StlStream.setDevice(&file);
-
 	// QString buffer
 	QString lineBuff;
 
 	//////////////////////////////////////////////////////////////////
-	// Count the number of lines of the STL file
-    // And test if the STL file is ASCII
+	// Test if the file size match the binary STL facet count
+	// Otherwise count the number of lines of the STL file
+	// And test if the STL file is ASCII
 	//////////////////////////////////////////////////////////////////
-    bool stlIsAscii= false;
-	while (!m_StlStream.atEnd())
+	const qint64 binaryFacetCount= binaryStlFacetCount(file);
+	const bool stlIsBinary= (binaryFacetCount >= 0) && (file.size() == (binaryStlHeaderSize + (binaryFacetCount * binaryStlFacetSize)));
+	bool stlIsAscii= false;
+	if (!stlIsBinary)
 	{
-		++numberOfLine;
-        const QString currentLine= m_StlStream.readLine();
-        if (!stlIsAscii)
-        {
-            stlIsAscii= currentLine.contains("facet", Qt::CaseInsensitive);
-        }
+		// Attach the stream to the file
+		m_StlStream.setDevice(&file);
+		while (!m_StlStream.atEnd())
+		{
+			++numberOfLine;
+			const QString currentLine= m_StlStream.readLine();
+			if (!stlIsAscii)
+			{
+				stlIsAscii= currentLine.contains("facet", Qt::CaseInsensitive);
+			}
+		}
+		//////////////////////////////////////////////////////////////////
+		// Reset the stream
+		//////////////////////////////////////////////////////////////////
+		m_StlStream.resetStatus();
+		m_StlStream.seek(0);
 	}
 
-	//////////////////////////////////////////////////////////////////
-	// Reset the stream
-	//////////////////////////////////////////////////////////////////
-	m_StlStream.resetStatus();
-	m_StlStream.seek(0);
 	//////////////////////////////////////////////////////////////////
 	// Read Buffer and create the world
 	//////////////////////////////////////////////////////////////////
@@ -115,28 +203,22 @@ GLC_World* GLC_StlToWorld::CreateWorldFromStl(QFile &file)
 	// Search Object section in the STL
 
 	// Test if the STL File is ASCII or Binary
-	++m_CurrentLineNumber;
-	lineBuff= m_StlStream.readLine();
-	lineBuff= lineBuff.trimmed().toLower();
-    if (!stlIsAscii)
+	if (!stlIsAscii)
 	{
 		// The STL File is not ASCII trying to load Binary STL File
 		m_pCurrentMesh= new GLC_Mesh();
-        if (lineBuff.startsWith("solid"))
-        {
-            lineBuff.remove(0, 5);
-            lineBuff= lineBuff.trimmed();
-            m_pCurrentMesh->setName(lineBuff);
-        }
+		file.reset();
+		lineBuff= QString::fromLatin1(file.read(80));
+		lineBuff= lineBuff.trimmed().toLower();
+		if (lineBuff.startsWith("solid"))
+		{
+			lineBuff.remove(0, 5);
+			lineBuff= lineBuff.trimmed();
+			m_pCurrentMesh->setName(lineBuff);
+		}
 
 		file.reset();
 		LoadBinariStl(file);
-		m_pCurrentMesh->addTriangles(NULL, m_CurrentFace);
-		m_CurrentFace.clear();
-		m_pCurrentMesh->addVertice(m_VertexBulk.toVector());
-		m_VertexBulk.clear();
-		m_pCurrentMesh->addNormals(m_NormalBulk.toVector());
-		m_NormalBulk.clear();
 		m_pCurrentMesh->finish();
 		GLC_3DRep* pRep= new GLC_3DRep(m_pCurrentMesh);
 		m_pCurrentMesh= NULL;
@@ -145,15 +227,18 @@ GLC_World* GLC_StlToWorld::CreateWorldFromStl(QFile &file)
 	else
 	{
 		// The STL File is ASCII
+		++m_CurrentLineNumber;
+		lineBuff= m_StlStream.readLine();
+		lineBuff= lineBuff.trimmed().toLower();
 		m_pCurrentMesh= new GLC_Mesh();
-        if (lineBuff.startsWith("solid"))
-        {
-            lineBuff.remove(0, 5);
-            lineBuff= lineBuff.trimmed();
-            m_pCurrentMesh->setName(lineBuff);
-        }
-        // Read the mesh facet
-        int previousQuantumValue= 0;
+		if (lineBuff.startsWith("solid"))
+		{
+			lineBuff.remove(0, 5);
+			lineBuff= lineBuff.trimmed();
+			m_pCurrentMesh->setName(lineBuff);
+		}
+		// Read the mesh facet
+		int previousQuantumValue= 0;
 
 		while (!m_StlStream.atEnd())
 		{
@@ -172,6 +257,12 @@ GLC_World* GLC_StlToWorld::CreateWorldFromStl(QFile &file)
 	return m_pWorld;
 }
 
+void GLC_StlToWorld::setVertexWelding(bool weld, double precision)
+{
+	m_WeldVertices= weld;
+	m_WeldPrecision= qMax(0.0, precision);
+}
+
 /////////////////////////////////////////////////////////////////////
 // Private services Functions
 //////////////////////////////////////////////////////////////////////
@@ -357,83 +448,263 @@ GLC_Vector3df GLC_StlToWorld::extract3dVect(QString &line)
 // Load Binarie STL File
 void GLC_StlToWorld::LoadBinariStl(QFile &file)
 {
-	// Create Working variables
-	int previousQuantumValue= 0;
-
-	QDataStream stlBinFile(&file);
-	stlBinFile.setVersion(QDataStream::Qt_4_6);
-	stlBinFile.setFloatingPointPrecision(QDataStream::SinglePrecision);
-	stlBinFile.setByteOrder(QDataStream::LittleEndian);
-
-	// Skip 80 Bytes STL header
-	int SkipedData= stlBinFile.skipRawData(80);
-	// Check if an error occur
-	if (-1 == SkipedData)
+	// Read the number of facet
+	const qint64 numberOfFacet= binaryStlFacetCount(file);
+	if (-1 == numberOfFacet)
 	{
-		QString message= "GLC_StlToWorld::LoadBinariStl : Failed to skip Header of binary STL";
+		QString message= "GLC_StlToWorld::LoadBinariStl : Failed to read the number of facets of binary STL";
 		GLC_FileFormatException fileFormatException(message, m_FileName, GLC_FileFormatException::WrongFileFormat);
 		clear();
 		throw(fileFormatException);
 	}
-	// Read the number of facet
-	quint32 numberOfFacet= 0;
-	stlBinFile >> numberOfFacet;
-	// Check if an error occur
-	if (QDataStream::Ok != stlBinFile.status())
+	if (file.size() < (binaryStlHeaderSize + (numberOfFacet * binaryStlFacetSize)))
 	{
-		QString message= "GLC_StlToWorld::LoadBinariStl : Failed to read the number of facets of binary STL";
+		QString message= "GLC_StlToWorld::LoadBinariStl : Failed to read the facets of binary STL";
+		GLC_FileFormatException fileFormatException(message, m_FileName, GLC_FileFormatException::WrongFileFormat);
+		clear();
+		throw(fileFormatException);
+	}
+	if ((numberOfFacet * 9) > std::numeric_limits<int>::max())
+	{
+		QString message= "GLC_StlToWorld::LoadBinariStl : Too many facets in binary STL";
 		GLC_FileFormatException fileFormatException(message, m_FileName, GLC_FileFormatException::WrongFileFormat);
 		clear();
 		throw(fileFormatException);
 	}
-	for (quint32 i= 0; i < numberOfFacet; ++i)
+
+	// Map the file, read it if mapping is not possible
+	QByteArray fileContent;
+	uchar* pMappedData= file.map(0, file.size());
+	const uchar* pData= pMappedData;
+	if (NULL == pData)
+	{
+		file.reset();
+		fileContent= file.readAll();
+		pData= reinterpret_cast<const uchar*>(fileContent.constData());
+	}
+
+	// Pre-sized bulk data
+	const quint32 facetCount= static_cast<quint32>(numberOfFacet);
+	const int bulkSize= static_cast<int>(numberOfFacet * 9);
+	GLfloatVector positions(bulkSize);
+	GLfloatVector normals(bulkSize);
+
+	QList<StlFacetChunk*> chunkList;
+	for (quint32 firstFacet= 0; firstFacet < facetCount; firstFacet+= binaryStlChunkSize)
+	{
+		const quint32 chunkFacetCount= qMin(binaryStlChunkSize, facetCount - firstFacet);
+		chunkList.append(new StlFacetChunk(pData, firstFacet, chunkFacetCount, positions.data(), normals.data()));
+	}
+
+	// Multi thread facet decoding, by group of chunks in order to report progress
+	const int chunkCount= chunkList.count();
+	const int groupSize= qMax(1, QThread::idealThreadCount()) * 4;
+	int previousQuantumValue= 0;
+	for (int firstChunk= 0; firstChunk < chunkCount; firstChunk+= groupSize)
 	{
-		// Extract the facet normal
-		float nx, ny, nz;
-		stlBinFile >> nx >> ny >> nz;
-		// Check if an error occur
-		if (QDataStream::Ok != stlBinFile.status())
+		QList<StlFacetChunk*> currentChunkList= chunkList.mid(firstChunk, groupSize);
+		QtConcurrent::blockingMap(currentChunkList, decodeBinaryFacetChunk);
+
+		const int decodedChunkCount= qMin(chunkCount, firstChunk + groupSize);
+		const int currentQuantumValue = static_cast<int>((static_cast<double>(decodedChunkCount) / chunkCount) * 100);
+		if (currentQuantumValue > previousQuantumValue)
 		{
-			QString message= "GLC_StlToWorld::LoadBinariStl : Failed to read the Normal of binary STL";
-			GLC_FileFormatException fileFormatException(message, m_FileName, GLC_FileFormatException::WrongFileFormat);
-			clear();
-			throw(fileFormatException);
+			emit currentQuantum(currentQuantumValue);
 		}
+		previousQuantumValue= currentQuantumValue;
+	}
+	qDeleteAll(chunkList);
 
-		// Extract the 3 Vertexs
-		for (int j= 0; j < 3; ++j)
+	if (NULL != pMappedData)
+	{
+		file.unmap(pMappedData);
+	}
+	fileContent.clear();
+
+	if (m_WeldVertices)
+	{
+		addWeldedBinaryStlData(positions, normals);
+	}
+	else
+	{
+		const GLuint vertexCount= static_cast<GLuint>(bulkSize / 3);
+		m_CurrentFace.reserve(bulkSize / 3);
+		for (GLuint i= 0; i < vertexCount; ++i)
+		{
+			m_CurrentFace.append(m_CurrentIndex + i);
+		}
+		m_CurrentIndex+= vertexCount;
+
+		m_pCurrentMesh->addTriangles(NULL, m_CurrentFace);
+		m_CurrentFace.clear();
+		m_pCurrentMesh->addVertice(positions);
+		m_pCurrentMesh->addNormals(normals);
+	}
+}
+
+// Return the number of facet of the given file if it is a binary STL, -1 otherwise
+qint64 GLC_StlToWorld::binaryStlFacetCount(QFile &file)
+{
+	qint64 subject= -1;
+	if (file.size() >= binaryStlHeaderSize)
+	{
+		const qint64 currentPos= file.pos();
+		if (file.seek(80))
 		{
-			float x, y, z;
-			stlBinFile >> x >> y >> z;
-			// Check if an error occur
-			if (QDataStream::Ok != stlBinFile.status())
+			const QByteArray facetCountData= file.read(4);
+			if (facetCountData.size() == 4)
 			{
-				QString message= "GLC_StlToWorld::LoadBinariStl : Failed to read the Vertex of binary STL";
-				GLC_FileFormatException fileFormatException(message, m_FileName, GLC_FileFormatException::WrongFileFormat);
-				clear();
-				throw(fileFormatException);
+				subject= static_cast<qint64>(qFromLittleEndian<quint32>(reinterpret_cast<const uchar*>(facetCountData.constData())));
 			}
-			m_VertexBulk.append(x);
-			m_VertexBulk.append(y);
-			m_VertexBulk.append(z);
+		}
+		file.seek(currentPos);
+	}
+	return subject;
+}
 
-			m_NormalBulk.append(nx);
-			m_NormalBulk.append(ny);
-			m_NormalBulk.append(nz);
+// Decode the facets of the given chunk of a binary STL
+void GLC_StlToWorld::decodeBinaryFacetChunk(StlFacetChunk* pChunk)
+{
+	const uchar* pRecord= pChunk->m_pData + binaryStlHeaderSize + (static_cast<qint64>(pChunk->m_FirstFacet) * binaryStlFacetSize);
+	GLfloat* pPosition= pChunk->m_pPositions + (static_cast<qint64>(pChunk->m_FirstFacet) * 9);
+	GLfloat* pNormal= pChunk->m_pNormals + (static_cast<qint64>(pChunk->m_FirstFacet) * 9);
 
-			m_CurrentFace.append(m_CurrentIndex);
-			++m_CurrentIndex;
-		}
-        const int currentQuantumValue = static_cast<int>((static_cast<double>(i + 1) / numberOfFacet) * 100);
-		if (currentQuantumValue > previousQuantumValue)
+	const quint32 facetCount= pChunk->m_FacetCount;
+	for (quint32 i= 0; i < facetCount; ++i)
+	{
+		// The facet normal followed by the 3 vertexs and 2 fill-bytes
+		const GLfloat nx= binaryStlFloat(pRecord);
+		const GLfloat ny= binaryStlFloat(pRecord + 4);
+		const GLfloat nz= binaryStlFloat(pRecord + 8);
+		const uchar* pVertex= pRecord + 12;
+		for (int j= 0; j < 3; ++j)
 		{
-			emit currentQuantum(currentQuantumValue);
+			pPosition[0]= binaryStlFloat(pVertex);
+			pPosition[1]= binaryStlFloat(pVertex + 4);
+			pPosition[2]= binaryStlFloat(pVertex + 8);
+			pNormal[0]= nx;
+			pNormal[1]= ny;
+			pNormal[2]= nz;
+			pPosition+= 3;
+			pNormal+= 3;
+			pVertex+= 12;
 		}
-		previousQuantumValue= currentQuantumValue;
+		pRecord+= binaryStlFacetSize;
+	}
+}
+
+// Weld vertices of binary STL bulk data and fill the current mesh
+void GLC_StlToWorld::addWeldedBinaryStlData(const GLfloatVector& positions, const GLfloatVector& normals)
+{
+	const int vertexCount= positions.size() / 3;
+
+	// Cells of the precision contain the index of their kept vertices
+	QMultiHash<StlWeldKey, GLuint> weldHash;
+	weldHash.reserve(vertexCount / 4);
+	const double squaredPrecision= m_WeldPrecision * m_WeldPrecision;
+	// Vertices closer than the precision can lie in neighbouring cells
+	const int neighbourRange= (m_WeldPrecision > 0.0) ? 1 : 0;
+
+	GLfloatVector weldedPositions;
+	weldedPositions.reserve(positions.size() / 4);
+	GLfloatVector weldedNormals;
+	weldedNormals.reserve(positions.size() / 4);
+	m_CurrentFace.reserve(vertexCount);
+
+	const GLfloat* pPosition= positions.constData();
+	const GLfloat* pNormal= normals.constData();
+	for (int iFacet= 0; iFacet < vertexCount; iFacet+= 3)
+	{
+		GLuint facetIndex[3];
+		for (int j= 0; j < 3; ++j)
+		{
+			const int offset= (iFacet + j) * 3;
+			StlWeldKey key;
+			key.m_X= weldKeyCoordinate(pPosition[offset], m_WeldPrecision);
+			key.m_Y= weldKeyCoordinate(pPosition[offset + 1], m_WeldPrecision);
+			key.m_Z= weldKeyCoordinate(pPosition[offset + 2], m_WeldPrecision);
+
+			// Search the nearest kept vertex in the cell of the vertex and its neighbours
+			bool found= false;
+			double nearestSquaredDistance= squaredPrecision;
+			for (int dx= -neighbourRange; dx <= neighbourRange; ++dx)
+			{
+				for (int dy= -neighbourRange; dy <= neighbourRange; ++dy)
+				{
+					for (int dz= -neighbourRange; dz <= neighbourRange; ++dz)
+					{
+						StlWeldKey neighbourKey;
+						neighbourKey.m_X= key.m_X + dx;
+						neighbourKey.m_Y= key.m_Y + dy;
+						neighbourKey.m_Z= key.m_Z + dz;
+
+						QMultiHash<StlWeldKey, GLuint>::const_iterator iVertex= weldHash.constFind(neighbourKey);
+						while ((iVertex != weldHash.constEnd()) && (iVertex.key() == neighbourKey))
+						{
+							const int weldedOffset= static_cast<int>(iVertex.value() - m_CurrentIndex) * 3;
+							const double deltaX= static_cast<double>(weldedPositions.at(weldedOffset)) - pPosition[offset];
+							const double deltaY= static_cast<double>(weldedPositions.at(weldedOffset + 1)) - pPosition[offset + 1];
+							const double deltaZ= static_cast<double>(weldedPositions.at(weldedOffset + 2)) - pPosition[offset + 2];
+							const double squaredDistance= (deltaX * deltaX) + (deltaY * deltaY) + (deltaZ * deltaZ);
+							// Without precision, the key is the exact position
+							if ((0 == neighbourRange) || (squaredDistance <= nearestSquaredDistance))
+							{
+								found= true;
+								nearestSquaredDistance= squaredDistance;
+								facetIndex[j]= iVertex.value();
+							}
+							++iVertex;
+						}
+					}
+				}
+			}
 
-		// Skip 2 fill-bytes not needed !!!!
-		stlBinFile.skipRawData(2);
+			if (found)
+			{
+				const int weldedOffset= static_cast<int>(facetIndex[j] - m_CurrentIndex) * 3;
+				weldedNormals[weldedOffset]+= pNormal[offset];
+				weldedNormals[weldedOffset + 1]+= pNormal[offset + 1];
+				weldedNormals[weldedOffset + 2]+= pNormal[offset + 2];
+			}
+			else
+			{
+				facetIndex[j]= m_CurrentIndex + static_cast<GLuint>(weldedPositions.size() / 3);
+				weldHash.insert(key, facetIndex[j]);
+				weldedPositions.append(pPosition[offset]);
+				weldedPositions.append(pPosition[offset + 1]);
+				weldedPositions.append(pPosition[offset + 2]);
+				weldedNormals.append(pNormal[offset]);
+				weldedNormals.append(pNormal[offset + 1]);
+				weldedNormals.append(pNormal[offset + 2]);
+			}
+		}
+		// Facets collapsed by welding are removed
+		if ((facetIndex[0] != facetIndex[1]) && (facetIndex[1] != facetIndex[2]) && (facetIndex[0] != facetIndex[2]))
+		{
+			m_CurrentFace.append(facetIndex[0]);
+			m_CurrentFace.append(facetIndex[1]);
+			m_CurrentFace.append(facetIndex[2]);
+		}
+	}
+	weldHash.clear();
 
+	// Normalize accumulated normals
+	const int weldedNormalsSize= weldedNormals.size();
+	GLfloat* pWeldedNormal= weldedNormals.data();
+	for (int i= 0; i < weldedNormalsSize; i+= 3)
+	{
+		const GLfloat length= std::sqrt((pWeldedNormal[i] * pWeldedNormal[i]) + (pWeldedNormal[i + 1] * pWeldedNormal[i + 1]) + (pWeldedNormal[i + 2] * pWeldedNormal[i + 2]));
+		if (length > 0.0f)
+		{
+			pWeldedNormal[i]/= length;
+			pWeldedNormal[i + 1]/= length;
+			pWeldedNormal[i + 2]/= length;
+		}
 	}
-}
+	m_CurrentIndex+= static_cast<GLuint>(weldedPositions.size() / 3);
 
+	m_pCurrentMesh->addTriangles(NULL, m_CurrentFace);
+	m_CurrentFace.clear();
+	m_pCurrentMesh->addVertice(weldedPositions);
+	m_pCurrentMesh->addNormals(weldedNormals);
+}
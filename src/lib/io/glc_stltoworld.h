@@ -36,6 +36,7 @@
 #include "../glc_config.h"
 
 class GLC_World;
+class StlFacetChunk;
 
 //////////////////////////////////////////////////////////////////////
 //! \class GLC_StlToWorld
@@ -67,6 +68,27 @@ public:
 public:
 	//! Create and return an GLC_World* from an input STL File
 	GLC_World* CreateWorldFromStl(QFile &file);
+
+	//! Set vertex welding of binary STL file to the given flag
+	/*! If welding is activated, each vertex of binary STL is merged with the nearest
+	 *  previously kept vertex closer than the given precision, the resulting mesh is indexed
+	 *  and its normals are the average of the facet normals. If precision is 0.0, only
+	 *  identical vertices are merged.*/
+	void setVertexWelding(bool weld, double precision= 0.0);
+//@}
+
+//////////////////////////////////////////////////////////////////////
+/*! @name Get Functions*/
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Return true if vertex welding of binary STL file is activated
+	inline bool vertexWeldingIsActivated() const
+	{return m_WeldVertices;}
+
+	//! Return the vertex welding precision
+	inline double vertexWeldingPrecision() const
+	{return m_WeldPrecision;}
 //@}
 
 //////////////////////////////////////////////////////////////////////
@@ -83,6 +105,14 @@ private:
 	//! Load Binarie STL File
 	void LoadBinariStl(QFile &);
 
+	//! Return the number of facet of the given file if it is a binary STL, -1 otherwise
+	static qint64 binaryStlFacetCount(QFile &);
+
+	//! Decode the facets of the given chunk of a binary STL
+	static void decodeBinaryFacetChunk(StlFacetChunk* pChunk);
+
+	//! Weld vertices of binary STL bulk data and fill the current mesh
+	void addWeldedBinaryStlData(const GLfloatVector& positions, const GLfloatVector& normals);
 
 
 //@}
@@ -123,6 +153,12 @@ private:
 
 	//! The current index
 	GLuint m_CurrentIndex;
+
+	//! Binary STL vertex welding flag
+	bool m_WeldVertices;
+
+	//! Binary STL vertex welding precision
+	double m_WeldPrecision;
 };
 
 #endif /*GLC_STLTOWORLD_H_*/
@@ -0,0 +1,229 @@
+/****************************************************************************
+
+ This file is part of the GLC-lib library.
+ Copyright (C) 2005-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ http://glc-lib.sourceforge.net
+
+ GLC-lib is free software; you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation; either version 3 of the License, or
+ (at your option) any later version.
+
+ GLC-lib is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with GLC-lib; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+
+//! \file glc_textscanner.cpp implementation of allocation free number scanning of text.
+
+#include "glc_textscanner.h"
+
+#include <cmath>
+#include <limits>
+
+// Exactly representable powers of ten
+static const double exactPowersOfTen[]=
+{
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+// Above this value the mantissa digits are ignored
+static const quint64 maxMantissa= Q_UINT64_C(100000000000000000);
+
+// Apply the given power of ten to the given value
+static inline double scaleByPowerOfTen(double value, int exponent)
+{
+	if (exponent >= 0)
+	{
+		if (exponent <= 22) value*= exactPowersOfTen[exponent];
+		else value*= std::pow(10.0, exponent);
+	}
+	else
+	{
+		if (exponent >= -22) value/= exactPowersOfTen[-exponent];
+		else value/= std::pow(10.0, -exponent);
+	}
+	return value;
+}
+
+static inline bool isDigit(ushort code)
+{
+	return (code >= '0') && (code <= '9');
+}
+
+// Skip separators, return false if the end is reached
+static inline bool skipSeparators(const QChar*& pPos, const QChar* pEnd)
+{
+	while ((pPos < pEnd) && glcTextScanner::isSeparator(*pPos))
+	{
+		++pPos;
+	}
+	return pPos < pEnd;
+}
+
+// Skip the current token
+static inline void skipToken(const QChar*& pPos, const QChar* pEnd)
+{
+	while ((pPos < pEnd) && !glcTextScanner::isSeparator(*pPos))
+	{
+		++pPos;
+	}
+}
+
+int glcTextScanner::tokenCount(QStringView text)
+{
+	int count= 0;
+	bool inToken= false;
+	const QChar* pPos= text.data();
+	const QChar* pEnd= pPos + text.size();
+	while (pPos < pEnd)
+	{
+		const bool separator= isSeparator(*pPos);
+		if (!separator && !inToken) ++count;
+		inToken= !separator;
+		++pPos;
+	}
+	return count;
+}
+
+void glcTextScanner::appendFloats(QStringView text, GLfloatVector* pTarget)
+{
+	pTarget->reserve(pTarget->size() + tokenCount(text));
+
+	const QChar* pPos= text.data();
+	const QChar* pEnd= pPos + text.size();
+	GLfloat value;
+	while (skipSeparators(pPos, pEnd))
+	{
+		if (!scanFloat(pPos, pEnd, &value))
+		{
+			// A malformed number is read as 0
+			value= 0.0f;
+			skipToken(pPos, pEnd);
+		}
+		pTarget->append(value);
+	}
+}
+
+void glcTextScanner::appendIndexes(QStringView text, IndexList* pTarget)
+{
+	pTarget->reserve(pTarget->size() + tokenCount(text));
+
+	const QChar* pPos= text.data();
+	const QChar* pEnd= pPos + text.size();
+	GLuint value;
+	while (skipSeparators(pPos, pEnd))
+	{
+		if (!scanUInt(pPos, pEnd, &value))
+		{
+			// A malformed number is read as 0
+			value= 0;
+			skipToken(pPos, pEnd);
+		}
+		pTarget->append(value);
+	}
+}
+
+bool glcTextScanner::scanFloat(const QChar*& pPos, const QChar* pEnd, GLfloat* pValue)
+{
+	const QChar* pCurrent= pPos;
+	bool negative= false;
+	if ((pCurrent < pEnd) && ((pCurrent->unicode() == '-') || (pCurrent->unicode() == '+')))
+	{
+		negative= (pCurrent->unicode() == '-');
+		++pCurrent;
+	}
+
+	quint64 mantissa= 0;
+	int exponent= 0;
+	bool hasDigit= false;
+
+	// Integer part
+	while ((pCurrent < pEnd) && isDigit(pCurrent->unicode()))
+	{
+		if (mantissa < maxMantissa) mantissa= (mantissa * 10) + (pCurrent->unicode() - '0');
+		else ++exponent;
+		hasDigit= true;
+		++pCurrent;
+	}
+
+	// Fractional part
+	if ((pCurrent < pEnd) && (pCurrent->unicode() == '.'))
+	{
+		++pCurrent;
+		while ((pCurrent < pEnd) && isDigit(pCurrent->unicode()))
+		{
+			if (mantissa < maxMantissa)
+			{
+				mantissa= (mantissa * 10) + (pCurrent->unicode() - '0');
+				--exponent;
+			}
+			hasDigit= true;
+			++pCurrent;
+		}
+	}
+	if (!hasDigit) return false;
+
+	// Exponent part
+	if ((pCurrent < pEnd) && ((pCurrent->unicode() == 'e') || (pCurrent->unicode() == 'E')))
+	{
+		++pCurrent;
+		bool negativeExponent= false;
+		if ((pCurrent < pEnd) && ((pCurrent->unicode() == '-') || (pCurrent->unicode() == '+')))
+		{
+			negativeExponent= (pCurrent->unicode() == '-');
+			++pCurrent;
+		}
+		if ((pCurrent == pEnd) || !isDigit(pCurrent->unicode())) return false;
+		int exponentValue= 0;
+		while ((pCurrent < pEnd) && isDigit(pCurrent->unicode()))
+		{
+			if (exponentValue < 1000) exponentValue= (exponentValue * 10) + (pCurrent->unicode() - '0');
+			++pCurrent;
+		}
+		exponent+= negativeExponent ? -exponentValue : exponentValue;
+	}
+
+	// The number must be followed by a separator
+	if ((pCurrent < pEnd) && !isSeparator(*pCurrent)) return false;
+
+	double value= static_cast<double>(mantissa);
+	if ((0 != mantissa) && (0 != exponent))
+	{
+		value= scaleByPowerOfTen(value, exponent);
+	}
+	*pValue= static_cast<GLfloat>(negative ? -value : value);
+	pPos= pCurrent;
+
+	return true;
+}
+
+bool glcTextScanner::scanUInt(const QChar*& pPos, const QChar* pEnd, GLuint* pValue)
+{
+	const QChar* pCurrent= pPos;
+	if ((pCurrent < pEnd) && (pCurrent->unicode() == '+')) ++pCurrent;
+	if ((pCurrent == pEnd) || !isDigit(pCurrent->unicode())) return false;
+
+	quint64 value= 0;
+	while ((pCurrent < pEnd) && isDigit(pCurrent->unicode()))
+	{
+		value= (value * 10) + (pCurrent->unicode() - '0');
+		if (value > std::numeric_limits<GLuint>::max()) return false;
+		++pCurrent;
+	}
+
+	// The number must be followed by a separator
+	if ((pCurrent < pEnd) && !isSeparator(*pCurrent)) return false;
+
+	*pValue= static_cast<GLuint>(value);
+	pPos= pCurrent;
+
+	return true;
+}
@@ -0,0 +1,68 @@
+/****************************************************************************
+
+ This file is part of the GLC-lib library.
+ Copyright (C) 2005-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ http://glc-lib.sourceforge.net
+
+ GLC-lib is free software; you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation; either version 3 of the License, or
+ (at your option) any later version.
+
+ GLC-lib is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with GLC-lib; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+
+//! \file glc_textscanner.h interface for allocation free number scanning of text.
+
+#ifndef GLC_TEXTSCANNER_H_
+#define GLC_TEXTSCANNER_H_
+
+#include <QStringView>
+
+#include "../glc_global.h"
+
+#include "../glc_config.h"
+
+//////////////////////////////////////////////////////////////////////
+/*! \namespace glcTextScanner
+ *  \brief Scan numbers of a text directly into GLC_lib bulk data
+
+ *  Numbers are separated by white spaces or commas. The scanned values are
+ *  appended to the target container without creating intermediate strings.
+ *  Like QString::toFloat() and QString::toUInt(), a malformed token is
+ *  appended as 0. The scan functions return false if a token is not a valid number.*/
+//////////////////////////////////////////////////////////////////////
+namespace glcTextScanner
+{
+	//! Return the number of tokens separated by white spaces or commas of the given text
+	GLC_LIB_EXPORT int tokenCount(QStringView text);
+
+	//! Append the floats of the given text to the given vector
+	GLC_LIB_EXPORT void appendFloats(QStringView text, GLfloatVector* pTarget);
+
+	//! Append the unsigned integers of the given text to the given index list
+	GLC_LIB_EXPORT void appendIndexes(QStringView text, IndexList* pTarget);
+
+	//! Scan a float from the given position, move the position after the float
+	GLC_LIB_EXPORT bool scanFloat(const QChar*& pPos, const QChar* pEnd, GLfloat* pValue);
+
+	//! Scan an unsigned integer from the given position, move the position after the integer
+	GLC_LIB_EXPORT bool scanUInt(const QChar*& pPos, const QChar* pEnd, GLuint* pValue);
+
+	//! Return true if the given character separates tokens
+	inline bool isSeparator(const QChar& character)
+	{
+		const ushort code= character.unicode();
+		return (code == ' ') || (code == ',') || (code == '\n') || (code == '\r') || (code == '\t');
+	}
+}
+
+#endif /* GLC_TEXTSCANNER_H_ */
@@ -0,0 +1,481 @@
+/****************************************************************************
+
+ This file is part of the GLC-lib library.
+ Copyright (C) 2005-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ http://glc-lib.sourceforge.net
+
+ GLC-lib is free software; you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation; either version 3 of the License, or
+ (at your option) any later version.
+
+ GLC-lib is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with GLC-lib; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+
+//! \file glc_worldtogltf.cpp implementation of the GLC_WorldToGltf class.
+
+#include "glc_worldtogltf.h"
+#include "../sceneGraph/glc_structreference.h"
+#include "../sceneGraph/glc_structinstance.h"
+#include "../sceneGraph/glc_structoccurrence.h"
+#include "../geometry/glc_3drep.h"
+#include "../geometry/glc_mesh.h"
+#include "../shading/glc_material.h"
+#include "../shading/glc_texture.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QBuffer>
+#include <QJsonDocument>
+#include <QtEndian>
+
+#include <cstring>
+#include <limits>
+
+// Binary glTF magic ("glTF"), version and chunk types
+static const quint32 glbMagic= 0x46546C67;
+static const quint32 glbVersion= 2;
+static const quint32 glbJsonChunk= 0x4E4F534A;
+static const quint32 glbBinaryChunk= 0x004E4942;
+
+// glTF accessor component types and buffer view targets
+static const int gltfUnsignedShort= 5123;
+static const int gltfUnsignedInt= 5125;
+static const int gltfFloat= 5126;
+static const int gltfArrayBuffer= 34962;
+static const int gltfElementArrayBuffer= 34963;
+
+// Append the given value as a little endian 32 bits integer
+static void appendUInt32(QByteArray& data, quint32 value)
+{
+	uchar buffer[4];
+	qToLittleEndian<quint32>(value, buffer);
+	data.append(reinterpret_cast<const char*>(buffer), 4);
+}
+
+GLC_WorldToGltf::GLC_WorldToGltf(const GLC_World& world)
+: QObject()
+, m_World(world)
+, m_FileName()
+, m_Nodes()
+, m_Meshes()
+, m_Materials()
+, m_Textures()
+, m_Images()
+, m_Accessors()
+, m_BufferViews()
+, m_BinaryData()
+, m_ReferenceMeshHash()
+, m_ReferenceIdHash()
+, m_MeshAttributesHash()
+, m_MaterialHash()
+, m_TextureHash()
+{
+
+}
+
+GLC_WorldToGltf::~GLC_WorldToGltf()
+{
+
+}
+
+bool GLC_WorldToGltf::exportToFile(const QString& fileName)
+{
+	clear();
+	m_FileName= fileName;
+	emit currentQuantum(0);
+
+	// Nodes
+	QJsonArray rootNodes;
+	const QList<GLC_StructOccurrence*> children= m_World.rootOccurrence()->children();
+	const int childCount= children.size();
+	int previousQuantumValue= 0;
+	for (int i= 0; i < childCount; ++i)
+	{
+		rootNodes.append(writeNode(children.at(i)));
+
+		const int currentQuantumValue= static_cast<int>((static_cast<double>(i + 1) / childCount) * 100);
+		if (currentQuantumValue > previousQuantumValue)
+		{
+			emit currentQuantum(currentQuantumValue);
+		}
+		previousQuantumValue= currentQuantumValue;
+	}
+
+	// JSON chunk
+	QJsonObject asset;
+	asset.insert("version", "2.0");
+	asset.insert("generator", "GLC_lib");
+
+	QJsonObject scene;
+	scene.insert("nodes", rootNodes);
+	const QString sceneName(m_World.rootOccurrence()->structReference()->name());
+	if (!sceneName.isEmpty()) scene.insert("name", sceneName);
+
+	QJsonObject root;
+	root.insert("asset", asset);
+	root.insert("scene", 0);
+	root.insert("scenes", QJsonArray() << scene);
+	// glTF arrays must not be empty
+	if (!m_Nodes.isEmpty()) root.insert("nodes", m_Nodes);
+	if (!m_Meshes.isEmpty()) root.insert("meshes", m_Meshes);
+	if (!m_Materials.isEmpty()) root.insert("materials", m_Materials);
+	if (!m_Textures.isEmpty()) root.insert("textures", m_Textures);
+	if (!m_Images.isEmpty()) root.insert("images", m_Images);
+	if (!m_Accessors.isEmpty()) root.insert("accessors", m_Accessors);
+	if (!m_BufferViews.isEmpty()) root.insert("bufferViews", m_BufferViews);
+	if (!m_BinaryData.isEmpty())
+	{
+		QJsonObject buffer;
+		buffer.insert("byteLength", m_BinaryData.size());
+		root.insert("buffers", QJsonArray() << buffer);
+	}
+
+	// Chunks are 4 bytes aligned, JSON with spaces and binary with zeros
+	QByteArray json(QJsonDocument(root).toJson(QJsonDocument::Compact));
+	json.append(QByteArray((4 - (json.size() % 4)) % 4, ' '));
+	m_BinaryData.append(QByteArray((4 - (m_BinaryData.size() % 4)) % 4, '\0'));
+
+	QByteArray header;
+	const int binaryChunkSize= m_BinaryData.isEmpty() ? 0 : (8 + m_BinaryData.size());
+	appendUInt32(header, glbMagic);
+	appendUInt32(header, glbVersion);
+	appendUInt32(header, static_cast<quint32>(12 + 8 + json.size() + binaryChunkSize));
+	appendUInt32(header, static_cast<quint32>(json.size()));
+	appendUInt32(header, glbJsonChunk);
+
+	bool subject= false;
+	QFile exportFile(m_FileName);
+	if (exportFile.open(QIODevice::WriteOnly))
+	{
+		subject= (exportFile.write(header) == header.size()) && (exportFile.write(json) == json.size());
+		if (subject && !m_BinaryData.isEmpty())
+		{
+			QByteArray binaryHeader;
+			appendUInt32(binaryHeader, static_cast<quint32>(m_BinaryData.size()));
+			appendUInt32(binaryHeader, glbBinaryChunk);
+			subject= (exportFile.write(binaryHeader) == binaryHeader.size()) && (exportFile.write(m_BinaryData) == m_BinaryData.size());
+		}
+		exportFile.close();
+	}
+	clear();
+
+	return subject;
+}
+
+void GLC_WorldToGltf::clear()
+{
+	m_Nodes= QJsonArray();
+	m_Meshes= QJsonArray();
+	m_Materials= QJsonArray();
+	m_Textures= QJsonArray();
+	m_Images= QJsonArray();
+	m_Accessors= QJsonArray();
+	m_BufferViews= QJsonArray();
+	m_BinaryData.clear();
+	m_ReferenceMeshHash.clear();
+	m_ReferenceIdHash.clear();
+	m_MeshAttributesHash.clear();
+	m_MaterialHash.clear();
+	m_TextureHash.clear();
+}
+
+int GLC_WorldToGltf::writeNode(const GLC_StructOccurrence* pOcc)
+{
+	// Reserve the node index, children are written before this node
+	const int index= m_Nodes.size();
+	m_Nodes.append(QJsonObject());
+
+	const GLC_StructInstance* pInstance= pOcc->structInstance();
+	GLC_StructReference* pRef= pOcc->structReference();
+
+	QJsonObject node;
+	const QString name(pInstance->name());
+	if (!name.isEmpty()) node.insert("name", name);
+
+	const GLC_Matrix4x4 matrix(pOcc->isFlexible() ? pOcc->occurrenceRelativeMatrix() : pInstance->relativeMatrix());
+	if (matrix != GLC_Matrix4x4())
+	{
+		node.insert("matrix", matrixArray(matrix));
+	}
+
+	const int mesh= meshIndex(pRef);
+	if (-1 != mesh) node.insert("mesh", mesh);
+
+	if (pOcc->hasChild())
+	{
+		QJsonArray childNodes;
+		const QList<GLC_StructOccurrence*> children= pOcc->children();
+		for (const GLC_StructOccurrence* pChild : children)
+		{
+			childNodes.append(writeNode(pChild));
+		}
+		node.insert("children", childNodes);
+
+		// Id of the assembly reference used to share it again on reading
+		if (!m_ReferenceIdHash.contains(pRef))
+		{
+			m_ReferenceIdHash.insert(pRef, m_ReferenceIdHash.size());
+		}
+		QJsonObject extras;
+		extras.insert("reference", m_ReferenceIdHash.value(pRef));
+		extras.insert("referenceName", pRef->name());
+		node.insert("extras", extras);
+	}
+
+	m_Nodes.replace(index, node);
+
+	return index;
+}
+
+int GLC_WorldToGltf::meshIndex(GLC_StructReference* pRef)
+{
+	if (m_ReferenceMeshHash.contains(pRef)) return m_ReferenceMeshHash.value(pRef);
+
+	QJsonArray primitives;
+	GLC_3DRep* pRep= NULL;
+	if (pRef->hasRepresentation())
+	{
+		pRep= dynamic_cast<GLC_3DRep*>(pRef->representationHandle());
+	}
+	if (NULL != pRep)
+	{
+		const int count= pRep->numberOfBody();
+		for (int i= 0; i < count; ++i)
+		{
+			GLC_Mesh* pMesh= dynamic_cast<GLC_Mesh*>(pRep->geomAt(i));
+			if ((NULL == pMesh) || pMesh->isEmpty()) continue;
+
+			const int vertexCount= pMesh->positionVector().size() / 3;
+			const QSet<GLC_Material*> materialSet(pMesh->materialSet());
+			for (GLC_Material* pMat : materialSet)
+			{
+				const IndexList index(pMesh->getEquivalentTrianglesStripsFansIndex(0, pMat->id()));
+				if (index.isEmpty()) continue;
+
+				QJsonObject primitive;
+				primitive.insert("attributes", meshAttributes(pMesh));
+				primitive.insert("indices", writeIndexAccessor(index, vertexCount));
+				primitive.insert("material", materialIndex(pMat));
+				primitives.append(primitive);
+			}
+		}
+	}
+
+	int subject= -1;
+	if (!primitives.isEmpty())
+	{
+		QJsonObject mesh;
+		if (!pRef->name().isEmpty()) mesh.insert("name", pRef->name());
+		mesh.insert("primitives", primitives);
+		subject= m_Meshes.size();
+		m_Meshes.append(mesh);
+	}
+	m_ReferenceMeshHash.insert(pRef, subject);
+
+	return subject;
+}
+
+QJsonObject GLC_WorldToGltf::meshAttributes(const GLC_Mesh* pMesh)
+{
+	if (m_MeshAttributesHash.contains(pMesh)) return m_MeshAttributesHash.value(pMesh);
+
+	QJsonObject attributes;
+	attributes.insert("POSITION", writeFloatAccessor(pMesh->positionVector(), 3, true));
+	if (pMesh->normalVector().size() == pMesh->positionVector().size())
+	{
+		attributes.insert("NORMAL", writeFloatAccessor(pMesh->normalVector(), 3));
+	}
+	if ((pMesh->texelVector().size() / 2) == (pMesh->positionVector().size() / 3))
+	{
+		// glTF texture coordinates origin is the top left corner of the image
+		GLfloatVector texels(pMesh->texelVector());
+		const int texelsSize= texels.size();
+		for (int i= 1; i < texelsSize; i+= 2)
+		{
+			texels[i]= 1.0f - texels.at(i);
+		}
+		attributes.insert("TEXCOORD_0", writeFloatAccessor(texels, 2));
+	}
+	m_MeshAttributesHash.insert(pMesh, attributes);
+
+	return attributes;
+}
+
+int GLC_WorldToGltf::materialIndex(GLC_Material* pMat)
+{
+	if (m_MaterialHash.contains(pMat)) return m_MaterialHash.value(pMat);
+
+	const QColor diffuseColor(pMat->diffuseColor());
+	QJsonObject pbr;
+	pbr.insert("baseColorFactor", QJsonArray() << diffuseColor.redF() << diffuseColor.greenF() << diffuseColor.blueF() << pMat->opacity());
+	pbr.insert("metallicFactor", 0.0);
+	pbr.insert("roughnessFactor", 1.0 - qBound(0.0, static_cast<double>(pMat->shininess()) / 128.0, 1.0));
+	if (pMat->hasTexture())
+	{
+		const int texture= textureIndex(pMat->textureHandle());
+		if (-1 != texture)
+		{
+			QJsonObject textureInfo;
+			textureInfo.insert("index", texture);
+			pbr.insert("baseColorTexture", textureInfo);
+		}
+	}
+
+	QJsonObject material;
+	if (!pMat->name().isEmpty()) material.insert("name", pMat->name());
+	material.insert("pbrMetallicRoughness", pbr);
+	const QColor emissiveColor(pMat->emissiveColor());
+	if ((emissiveColor.red() != 0) || (emissiveColor.green() != 0) || (emissiveColor.blue() != 0))
+	{
+		material.insert("emissiveFactor", QJsonArray() << emissiveColor.redF() << emissiveColor.greenF() << emissiveColor.blueF());
+	}
+	if (pMat->opacity() < 1.0)
+	{
+		material.insert("alphaMode", "BLEND");
+	}
+
+	const int subject= m_Materials.size();
+	m_Materials.append(material);
+	m_MaterialHash.insert(pMat, subject);
+
+	return subject;
+}
+
+int GLC_WorldToGltf::textureIndex(const GLC_Texture* pTexture)
+{
+	if (m_TextureHash.contains(pTexture)) return m_TextureHash.value(pTexture);
+
+	int subject= -1;
+	QByteArray imageData;
+	QBuffer imageBuffer(&imageData);
+	imageBuffer.open(QIODevice::WriteOnly);
+	if (!pTexture->imageOfTexture().isNull() && pTexture->imageOfTexture().save(&imageBuffer, "PNG"))
+	{
+		QJsonObject image;
+		const QString name(QFileInfo(pTexture->fileName()).completeBaseName());
+		if (!name.isEmpty()) image.insert("name", name);
+		image.insert("bufferView", writeBufferView(imageData));
+		image.insert("mimeType", "image/png");
+		m_Images.append(image);
+
+		QJsonObject texture;
+		texture.insert("source", m_Images.size() - 1);
+		subject= m_Textures.size();
+		m_Textures.append(texture);
+	}
+	m_TextureHash.insert(pTexture, subject);
+
+	return subject;
+}
+
+int GLC_WorldToGltf::writeBufferView(const QByteArray& data, int target)
+{
+	// Each buffer view starts on a 4 bytes boundary
+	m_BinaryData.append(QByteArray((4 - (m_BinaryData.size() % 4)) % 4, '\0'));
+
+	QJsonObject bufferView;
+	bufferView.insert("buffer", 0);
+	bufferView.insert("byteOffset", m_BinaryData.size());
+	bufferView.insert("byteLength", data.size());
+	if (0 != target) bufferView.insert("target", target);
+	m_BinaryData.append(data);
+
+	m_BufferViews.append(bufferView);
+
+	return m_BufferViews.size() - 1;
+}
+
+int GLC_WorldToGltf::writeFloatAccessor(const GLfloatVector& values, int componentCount, bool withBounds)
+{
+	const int size= values.size();
+	QByteArray data(size * static_cast<int>(sizeof(GLfloat)), Qt::Uninitialized);
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+	memcpy(data.data(), values.constData(), static_cast<size_t>(data.size()));
+#else
+	for (int i= 0; i < size; ++i)
+	{
+		quint32 value;
+		memcpy(&value, values.constData() + i, sizeof(GLfloat));
+		qToLittleEndian<quint32>(value, data.data() + (i * sizeof(GLfloat)));
+	}
+#endif
+
+	QJsonObject accessor;
+	accessor.insert("bufferView", writeBufferView(data, gltfArrayBuffer));
+	accessor.insert("componentType", gltfFloat);
+	accessor.insert("count", size / componentCount);
+	accessor.insert("type", (componentCount == 3) ? "VEC3" : "VEC2");
+	if (withBounds && (size >= componentCount))
+	{
+		QVector<double> minValues(componentCount, std::numeric_limits<double>::max());
+		QVector<double> maxValues(componentCount, -std::numeric_limits<double>::max());
+		for (int i= 0; i < size; ++i)
+		{
+			const int component= i % componentCount;
+			minValues[component]= qMin(minValues.at(component), static_cast<double>(values.at(i)));
+			maxValues[component]= qMax(maxValues.at(component), static_cast<double>(values.at(i)));
+		}
+		QJsonArray minArray;
+		QJsonArray maxArray;
+		for (int i= 0; i < componentCount; ++i)
+		{
+			minArray.append(minValues.at(i));
+			maxArray.append(maxValues.at(i));
+		}
+		accessor.insert("min", minArray);
+		accessor.insert("max", maxArray);
+	}
+	m_Accessors.append(accessor);
+
+	return m_Accessors.size() - 1;
+}
+
+int GLC_WorldToGltf::writeIndexAccessor(const IndexList& index, int vertexCount)
+{
+	const int count= index.size();
+	const bool shortIndex= vertexCount < 65536;
+	QByteArray data(count * (shortIndex ? 2 : 4), Qt::Uninitialized);
+	uchar* pData= reinterpret_cast<uchar*>(data.data());
+	for (int i= 0; i < count; ++i)
+	{
+		if (shortIndex)
+		{
+			qToLittleEndian<quint16>(static_cast<quint16>(index.at(i)), pData + (i * 2));
+		}
+		else
+		{
+			qToLittleEndian<quint32>(index.at(i), pData + (i * 4));
+		}
+	}
+
+	QJsonObject accessor;
+	accessor.insert("bufferView", writeBufferView(data, gltfElementArrayBuffer));
+	accessor.insert("componentType", shortIndex ? gltfUnsignedShort : gltfUnsignedInt);
+	accessor.insert("count", count);
+	accessor.insert("type", "SCALAR");
+	m_Accessors.append(accessor);
+
+	return m_Accessors.size() - 1;
+}
+
+QJsonArray GLC_WorldToGltf::matrixArray(const GLC_Matrix4x4& matrix)
+{
+	// Column major like GLC_Matrix4x4
+	QJsonArray subject;
+	const double* pData= matrix.getData();
+	for (int i= 0; i < 16; ++i)
+	{
+		subject.append(pData[i]);
+	}
+
+	return subject;
+}
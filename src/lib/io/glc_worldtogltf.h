@@ -0,0 +1,160 @@
+/****************************************************************************
+
+ This file is part of the GLC-lib library.
+ Copyright (C) 2005-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ http://glc-lib.sourceforge.net
+
+ GLC-lib is free software; you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation; either version 3 of the License, or
+ (at your option) any later version.
+
+ GLC-lib is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with GLC-lib; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+
+//! \file glc_worldtogltf.h interface for the GLC_WorldToGltf class.
+
+#ifndef GLC_WORLDTOGLTF_H
+#define GLC_WORLDTOGLTF_H
+
+#include <QString>
+#include <QObject>
+#include <QHash>
+#include <QByteArray>
+#include <QJsonArray>
+#include <QJsonObject>
+
+#include "../sceneGraph/glc_world.h"
+
+#include "../glc_config.h"
+
+class GLC_StructOccurrence;
+class GLC_StructReference;
+class GLC_Mesh;
+class GLC_Material;
+class GLC_Texture;
+
+//////////////////////////////////////////////////////////////////////
+//! \class GLC_WorldToGltf
+/*! \brief GLC_WorldToGltf : Export a GLC_World to a binary glTF 2.0 (.glb) file */
+
+/*! The mesh data of each shared GLC_StructReference is written only once,
+ *  every instance of the reference use the same glTF mesh.
+ *  glTF nodes can't be shared, so the nodes of assemblies are duplicated
+ *  and the reference id is written in the node extras.
+ *  GLC_GltfToWorld use the extras to share the assemblies references again.
+ *  Only the first level of detail is exported.*/
+//////////////////////////////////////////////////////////////////////
+class GLC_LIB_EXPORT GLC_WorldToGltf : public QObject
+{
+	Q_OBJECT
+//////////////////////////////////////////////////////////////////////
+/*! @name Constructor / Destructor */
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	GLC_WorldToGltf(const GLC_World& world);
+	virtual ~GLC_WorldToGltf();
+//@}
+
+//////////////////////////////////////////////////////////////////////
+/*! @name Set Functions*/
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Save the world to the specified file name
+	bool exportToFile(const QString& fileName);
+
+//@}
+
+//////////////////////////////////////////////////////////////////////
+/*! @name Private services functions */
+//@{
+//////////////////////////////////////////////////////////////////////
+private:
+	//! Clear the glTF arrays and the binary data
+	void clear();
+
+	//! Write the given occurrence and its children and return its node index
+	int writeNode(const GLC_StructOccurrence* pOcc);
+
+	//! Return the glTF mesh index of the given reference, -1 if it has no mesh
+	int meshIndex(GLC_StructReference* pRef);
+
+	//! Return the attributes of the given mesh
+	QJsonObject meshAttributes(const GLC_Mesh* pMesh);
+
+	//! Return the glTF material index of the given material
+	int materialIndex(GLC_Material* pMat);
+
+	//! Return the glTF texture index of the given texture, -1 if its image is not valid
+	int textureIndex(const GLC_Texture* pTexture);
+
+	//! Append the given data to the binary chunk and return its buffer view index
+	int writeBufferView(const QByteArray& data, int target= 0);
+
+	//! Write an accessor of the given float values and return its index
+	int writeFloatAccessor(const GLfloatVector& values, int componentCount, bool withBounds= false);
+
+	//! Write an accessor of the given index and return its index
+	int writeIndexAccessor(const IndexList& index, int vertexCount);
+
+	//! Return the glTF matrix of the given matrix
+	static QJsonArray matrixArray(const GLC_Matrix4x4& matrix);
+
+//@}
+
+//////////////////////////////////////////////////////////////////////
+// Qt Signals
+//////////////////////////////////////////////////////////////////////
+signals:
+	void currentQuantum(int);
+
+//////////////////////////////////////////////////////////////////////
+	/* Private members */
+//////////////////////////////////////////////////////////////////////
+private:
+	//! The world to export
+	GLC_World m_World;
+
+	//! The file absolute path
+	QString m_FileName;
+
+	//! The glTF top level arrays
+	QJsonArray m_Nodes;
+	QJsonArray m_Meshes;
+	QJsonArray m_Materials;
+	QJsonArray m_Textures;
+	QJsonArray m_Images;
+	QJsonArray m_Accessors;
+	QJsonArray m_BufferViews;
+
+	//! The binary chunk data
+	QByteArray m_BinaryData;
+
+	//! Hash table of reference to glTF mesh index
+	QHash<const GLC_StructReference*, int> m_ReferenceMeshHash;
+
+	//! Hash table of assembly reference to its id in the node extras
+	QHash<const GLC_StructReference*, int> m_ReferenceIdHash;
+
+	//! Hash table of mesh to its glTF attributes
+	QHash<const GLC_Mesh*, QJsonObject> m_MeshAttributesHash;
+
+	//! Hash table of material to glTF material index
+	QHash<const GLC_Material*, int> m_MaterialHash;
+
+	//! Hash table of texture to glTF texture index
+	QHash<const GLC_Texture*, int> m_TextureHash;
+
+};
+
+#endif // GLC_WORLDTOGLTF_H
@@ -0,0 +1,340 @@
+/****************************************************************************
+
+ This file is part of the GLC-lib library.
+ Copyright (C) 2005-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ http://glc-lib.sourceforge.net
+
+ GLC-lib is free software; you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation; either version 3 of the License, or
+ (at your option) any later version.
+
+ GLC-lib is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with GLC-lib; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+
+//! \file glc_worldtostl.cpp implementation of the GLC_WorldToStl class.
+
+#include "glc_worldtostl.h"
+#include "../sceneGraph/glc_structreference.h"
+#include "../sceneGraph/glc_structoccurrence.h"
+#include "../geometry/glc_3drep.h"
+#include "../geometry/glc_mesh.h"
+#include "../glc_errorlog.h"
+
+#include <QFile>
+#include <QHash>
+#include <QtConcurrent>
+#include <QThread>
+#include <QtEndian>
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+// Size of binary STL header (80 bytes comment + 4 bytes facet count)
+static const int binaryStlHeaderSize= 84;
+// Size of a binary STL facet record
+static const qint64 binaryStlFacetSize= 50;
+// Number of facets written by a thread at once
+static const int binaryStlChunkSize= 16384;
+
+// A mesh to export and its triangles index
+class StlExportMesh
+{
+public:
+	StlExportMesh(const GLC_Mesh* pMesh)
+		: m_pMesh(pMesh)
+		, m_Index()
+	{}
+
+	const GLC_Mesh* m_pMesh;
+	QVector<GLuint> m_Index;
+};
+
+// A range of triangles of an occurrence mesh to write
+class StlExportChunk
+{
+public:
+	StlExportChunk(const StlExportMesh* pMesh, const GLC_Matrix4x4& matrix, int firstTriangle, int triangleCount)
+		: m_pMesh(pMesh)
+		, m_Matrix(matrix)
+		, m_FirstTriangle(firstTriangle)
+		, m_TriangleCount(triangleCount)
+		, m_pTarget(NULL)
+	{}
+
+	const StlExportMesh* m_pMesh;
+	GLC_Matrix4x4 m_Matrix;
+	int m_FirstTriangle;
+	int m_TriangleCount;
+	uchar* m_pTarget;
+};
+
+// Write the given float in little endian at the given address
+static inline void binaryStlWriteFloat(uchar* pData, GLfloat value)
+{
+	quint32 subject;
+	memcpy(&subject, &value, sizeof(GLfloat));
+	qToLittleEndian<quint32>(subject, pData);
+}
+
+GLC_WorldToStl::GLC_WorldToStl(const GLC_World& world)
+: QObject()
+, m_World(world)
+{
+
+}
+
+GLC_WorldToStl::~GLC_WorldToStl()
+{
+
+}
+
+bool GLC_WorldToStl::exportToFile(const QString& fileName)
+{
+	bool subject= false;
+	QFile exportFile(fileName);
+	if (exportFile.open(QIODevice::WriteOnly))
+	{
+		subject= exportToDevice(&exportFile);
+		exportFile.close();
+	}
+	else
+	{
+		QStringList stringList("GLC_WorldToStl::exportToFile");
+		stringList.append("Unable to open " + fileName);
+		GLC_ErrorLog::addError(stringList);
+	}
+
+	return subject;
+}
+
+bool GLC_WorldToStl::exportToDevice(QIODevice* pDevice)
+{
+	emit currentQuantum(0);
+
+	// Meshes of the occurrences, each mesh is flattened once
+	QHash<const GLC_Mesh*, StlExportMesh*> meshHash;
+	QList<StlExportMesh*> meshList;
+	QList<QPair<GLC_Matrix4x4, StlExportMesh*> > occurrenceMeshList;
+	const QList<GLC_StructOccurrence*> occurrenceList(m_World.listOfOccurrence());
+	for (const GLC_StructOccurrence* pOcc : occurrenceList)
+	{
+		GLC_StructReference* pRef= pOcc->structReference();
+		if (!pRef->hasRepresentation() || !pRef->representationIsLoaded()) continue;
+		GLC_3DRep* pRep= dynamic_cast<GLC_3DRep*>(pRef->representationHandle());
+		if (NULL == pRep) continue;
+
+		const GLC_Matrix4x4 matrix(pOcc->absoluteMatrix());
+		const int bodyCount= pRep->numberOfBody();
+		for (int i= 0; i < bodyCount; ++i)
+		{
+			const GLC_Mesh* pMesh= dynamic_cast<const GLC_Mesh*>(pRep->geomAt(i));
+			if ((NULL == pMesh) || pMesh->isEmpty()) continue;
+
+			StlExportMesh* pExportMesh= meshHash.value(pMesh, NULL);
+			if (NULL == pExportMesh)
+			{
+				pExportMesh= new StlExportMesh(pMesh);
+				meshHash.insert(pMesh, pExportMesh);
+				meshList.append(pExportMesh);
+			}
+			occurrenceMeshList.append(qMakePair(matrix, pExportMesh));
+		}
+	}
+	QtConcurrent::blockingMapped(meshList, flattenMesh);
+
+	// Chunks of facets
+	QList<StlExportChunk*> chunkList;
+	qint64 facetCount= 0;
+	const int occurrenceMeshCount= occurrenceMeshList.size();
+	for (int i= 0; i < occurrenceMeshCount; ++i)
+	{
+		const StlExportMesh* pExportMesh= occurrenceMeshList.at(i).second;
+		const int triangleCount= pExportMesh->m_Index.size() / 3;
+		for (int firstTriangle= 0; firstTriangle < triangleCount; firstTriangle+= binaryStlChunkSize)
+		{
+			const int chunkTriangleCount= qMin(binaryStlChunkSize, triangleCount - firstTriangle);
+			chunkList.append(new StlExportChunk(pExportMesh, occurrenceMeshList.at(i).first, firstTriangle, chunkTriangleCount));
+		}
+		facetCount+= triangleCount;
+	}
+
+	bool subject= facetCount <= std::numeric_limits<quint32>::max();
+	if (!subject)
+	{
+		QStringList stringList("GLC_WorldToStl::exportToDevice");
+		stringList.append("Too many facets for binary STL");
+		GLC_ErrorLog::addError(stringList);
+	}
+	else
+	{
+		// The header must not begin with "solid" which is used by ASCII STL
+		QByteArray header("Binary STL exported by GLC_lib");
+		header.append(QByteArray(binaryStlHeaderSize - header.size(), '\0'));
+		qToLittleEndian<quint32>(static_cast<quint32>(facetCount), reinterpret_cast<uchar*>(header.data()) + 80);
+		subject= (pDevice->write(header) == header.size());
+	}
+
+	// Multi thread facet writing, by group of chunks in order to bound the memory usage
+	const int chunkCount= chunkList.count();
+	const int groupSize= qMax(1, QThread::idealThreadCount()) * 2;
+	int previousQuantumValue= 0;
+	QByteArray buffer;
+	for (int firstChunk= 0; subject && (firstChunk < chunkCount); firstChunk+= groupSize)
+	{
+		const QList<StlExportChunk*> currentChunkList= chunkList.mid(firstChunk, groupSize);
+		qint64 bufferSize= 0;
+		for (const StlExportChunk* pChunk : currentChunkList)
+		{
+			bufferSize+= pChunk->m_TriangleCount * binaryStlFacetSize;
+		}
+		buffer.resize(static_cast<int>(bufferSize));
+		uchar* pTarget= reinterpret_cast<uchar*>(buffer.data());
+		for (StlExportChunk* pChunk : currentChunkList)
+		{
+			pChunk->m_pTarget= pTarget;
+			pTarget+= pChunk->m_TriangleCount * binaryStlFacetSize;
+		}
+		QtConcurrent::blockingMapped(currentChunkList, fillFacetChunk);
+
+		subject= (pDevice->write(buffer) == buffer.size());
+
+		const int writtenChunkCount= qMin(chunkCount, firstChunk + groupSize);
+		const int currentQuantumValue = static_cast<int>((static_cast<double>(writtenChunkCount) / chunkCount) * 100);
+		if (currentQuantumValue > previousQuantumValue)
+		{
+			emit currentQuantum(currentQuantumValue);
+		}
+		previousQuantumValue= currentQuantumValue;
+	}
+	qDeleteAll(chunkList);
+	qDeleteAll(meshList);
+
+	if (subject) emit currentQuantum(100);
+
+	return subject;
+}
+
+// Convert the triangles, strips and fans of the master LOD of the given mesh to triangles
+StlExportMesh* GLC_WorldToStl::flattenMesh(StlExportMesh* pExportMesh)
+{
+	const GLC_Mesh* pMesh= pExportMesh->m_pMesh;
+	QVector<GLuint>& index= pExportMesh->m_Index;
+	const QList<GLC_uint> materialIds(pMesh->materialIds());
+	for (const GLC_uint materialId : materialIds)
+	{
+		if (pMesh->containsTriangles(0, materialId))
+		{
+			index+= pMesh->getTrianglesIndex(0, materialId);
+		}
+
+		// Same orientation than GLC_Mesh::getEquivalentTrianglesStripsFansIndex
+		if (pMesh->containsStrips(0, materialId))
+		{
+			const QList<QVector<GLuint> > stripsIndex(pMesh->getStripsIndex(0, materialId));
+			for (const QVector<GLuint>& strip : stripsIndex)
+			{
+				const int stripSize= strip.size();
+				if (stripSize < 3) continue;
+				index << strip.at(0) << strip.at(1) << strip.at(2);
+				for (int j= 3; j < stripSize; ++j)
+				{
+					if ((j % 2) != 0)
+					{
+						index << strip.at(j) << strip.at(j - 1) << strip.at(j - 2);
+					}
+					else
+					{
+						index << strip.at(j) << strip.at(j - 2) << strip.at(j - 1);
+					}
+				}
+			}
+		}
+
+		if (pMesh->containsFans(0, materialId))
+		{
+			const QList<QVector<GLuint> > fansIndex(pMesh->getFansIndex(0, materialId));
+			for (const QVector<GLuint>& fan : fansIndex)
+			{
+				const int fanSize= fan.size();
+				for (int j= 1; j < (fanSize - 1); ++j)
+				{
+					index << fan.at(0) << fan.at(j) << fan.at(j + 1);
+				}
+			}
+		}
+	}
+
+	return pExportMesh;
+}
+
+// Write the facets of the given chunk
+StlExportChunk* GLC_WorldToStl::fillFacetChunk(StlExportChunk* pChunk)
+{
+	const double* m= pChunk->m_Matrix.getData();
+	// A mirror matrix reverses the orientation of the facets
+	const bool reverse= pChunk->m_Matrix.determinant() < 0.0;
+	const GLfloat* pPositions= pChunk->m_pMesh->m_pMesh->positionVector().constData();
+	const GLuint* pIndex= pChunk->m_pMesh->m_Index.constData() + (static_cast<qint64>(pChunk->m_FirstTriangle) * 3);
+	uchar* pRecord= pChunk->m_pTarget;
+
+	const int triangleCount= pChunk->m_TriangleCount;
+	for (int i= 0; i < triangleCount; ++i)
+	{
+		double vertex[3][3];
+		for (int j= 0; j < 3; ++j)
+		{
+			const GLfloat* pPosition= pPositions + (static_cast<qint64>(pIndex[reverse ? (2 - j) : j]) * 3);
+			const double x= pPosition[0];
+			const double y= pPosition[1];
+			const double z= pPosition[2];
+			vertex[j][0]= m[0] * x + m[4] * y + m[8] * z + m[12];
+			vertex[j][1]= m[1] * x + m[5] * y + m[9] * z + m[13];
+			vertex[j][2]= m[2] * x + m[6] * y + m[10] * z + m[14];
+		}
+		pIndex+= 3;
+
+		// The facet normal followed by the 3 vertexs and 2 fill-bytes
+		const double ux= vertex[1][0] - vertex[0][0];
+		const double uy= vertex[1][1] - vertex[0][1];
+		const double uz= vertex[1][2] - vertex[0][2];
+		const double vx= vertex[2][0] - vertex[0][0];
+		const double vy= vertex[2][1] - vertex[0][1];
+		const double vz= vertex[2][2] - vertex[0][2];
+		double nx= uy * vz - uz * vy;
+		double ny= uz * vx - ux * vz;
+		double nz= ux * vy - uy * vx;
+		const double length= std::sqrt(nx * nx + ny * ny + nz * nz);
+		if (length > 0.0)
+		{
+			nx/= length;
+			ny/= length;
+			nz/= length;
+		}
+		binaryStlWriteFloat(pRecord, static_cast<GLfloat>(nx));
+		binaryStlWriteFloat(pRecord + 4, static_cast<GLfloat>(ny));
+		binaryStlWriteFloat(pRecord + 8, static_cast<GLfloat>(nz));
+		uchar* pVertex= pRecord + 12;
+		for (int j= 0; j < 3; ++j)
+		{
+			binaryStlWriteFloat(pVertex, static_cast<GLfloat>(vertex[j][0]));
+			binaryStlWriteFloat(pVertex + 4, static_cast<GLfloat>(vertex[j][1]));
+			binaryStlWriteFloat(pVertex + 8, static_cast<GLfloat>(vertex[j][2]));
+			pVertex+= 12;
+		}
+		pVertex[0]= 0;
+		pVertex[1]= 0;
+		pRecord+= binaryStlFacetSize;
+	}
+
+	return pChunk;
+}
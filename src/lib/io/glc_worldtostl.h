@@ -0,0 +1,104 @@
+/****************************************************************************
+
+ This file is part of the GLC-lib library.
+ Copyright (C) 2005-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ http://glc-lib.sourceforge.net
+
+ GLC-lib is free software; you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation; either version 3 of the License, or
+ (at your option) any later version.
+
+ GLC-lib is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with GLC-lib; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+
+//! \file glc_worldtostl.h interface for the GLC_WorldToStl class.
+
+#ifndef GLC_WORLDTOSTL_H
+#define GLC_WORLDTOSTL_H
+
+#include <QString>
+#include <QObject>
+#include <QIODevice>
+#include <QVector>
+
+#include "../sceneGraph/glc_world.h"
+
+#include "../glc_config.h"
+
+class GLC_Mesh;
+class StlExportMesh;
+class StlExportChunk;
+
+//////////////////////////////////////////////////////////////////////
+//! \class GLC_WorldToStl
+/*! \brief GLC_WorldToStl : Export a GLC_World to a binary STL file */
+
+/*! Each mesh of each occurrence is written with the occurrence absolute matrix.
+ *  Triangle strips and fans are converted to triangles once by mesh.
+ *  The facets are written by groups of chunks filled on the global thread pool,
+ *  so the world is never merged in memory.
+ *  Only the master LOD of the loaded representations is exported.*/
+//////////////////////////////////////////////////////////////////////
+class GLC_LIB_EXPORT GLC_WorldToStl : public QObject
+{
+	Q_OBJECT
+//////////////////////////////////////////////////////////////////////
+/*! @name Constructor / Destructor */
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	GLC_WorldToStl(const GLC_World& world);
+	virtual ~GLC_WorldToStl();
+//@}
+
+//////////////////////////////////////////////////////////////////////
+/*! @name Set Functions*/
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Save the world to the specified file name
+	bool exportToFile(const QString& fileName);
+
+	//! Write the world to the given opened device
+	bool exportToDevice(QIODevice* pDevice);
+
+//@}
+
+//////////////////////////////////////////////////////////////////////
+/*! @name Private services functions */
+//@{
+//////////////////////////////////////////////////////////////////////
+private:
+	//! Convert the triangles, strips and fans of the master LOD of the given mesh to triangles
+	static StlExportMesh* flattenMesh(StlExportMesh* pMesh);
+
+	//! Write the facets of the given chunk
+	static StlExportChunk* fillFacetChunk(StlExportChunk* pChunk);
+
+//@}
+
+//////////////////////////////////////////////////////////////////////
+// Qt Signals
+//////////////////////////////////////////////////////////////////////
+signals:
+	void currentQuantum(int);
+
+//////////////////////////////////////////////////////////////////////
+	/* Private members */
+//////////////////////////////////////////////////////////////////////
+private:
+	//! The world to export
+	GLC_World m_World;
+
+};
+
+#endif // GLC_WORLDTOSTL_H
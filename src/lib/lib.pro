@@ -112,13 +112,17 @@ HEADERS_GLC_IO +=   io/glc_objmtlloader.h \
                     io/glc_worldto3ds.h \
                     io/glc_bsreptoworld.h \
                     io/glc_xmlutil.h \
+                    io/glc_textscanner.h \
                     io/glc_fileloader.h \
                     io/glc_worldreaderplugin.h \
                     io/glc_worldreaderhandler.h \
                     io/glc_worldtoobj.h \
                     io/glc_assimptoworld.h \
                     io/glc_colladaxmlelement.h \
-                    io/glc_worldtocollada.h
+                    io/glc_worldtocollada.h \
+                    io/glc_gltftoworld.h \
+                    io/glc_worldtogltf.h \
+                    io/glc_worldtostl.h
 
 HEADERS_GLC_SCENEGRAPH +=   sceneGraph/glc_3dviewcollection.h \
                             sceneGraph/glc_3dviewinstance.h \
@@ -131,7 +135,10 @@ HEADERS_GLC_SCENEGRAPH +=   sceneGraph/glc_3dviewcollection.h \
                             sceneGraph/glc_spacepartitioning.h \
                             sceneGraph/glc_octree.h \
                             sceneGraph/glc_octreenode.h \
-                            sceneGraph/glc_selectionset.h
+                            sceneGraph/glc_bvh.h \
+                            sceneGraph/glc_lodscheduler.h \
+                            sceneGraph/glc_selectionset.h \
+                            sceneGraph/glc_transformhierarchy.h
 							
 HEADERS_GLC_GEOMETRY += geometry/glc_geometry.h \
                         geometry/glc_circle.h \
@@ -149,6 +156,10 @@ HEADERS_GLC_GEOMETRY += geometry/glc_geometry.h \
                         geometry/glc_pointsprite.h \
                         geometry/glc_bsrep.h \
                         geometry/glc_wiredata.h \
+                        geometry/glc_sharpedgeextractor.h \
+                        geometry/glc_meshsimplifier.h \
+                        geometry/glc_vertexcacheoptimizer.h \
+                        geometry/glc_vertexcompression.h \
                         geometry/glc_arrow.h \
                         geometry/glc_polylines.h \
                         geometry/glc_disc.h \
@@ -197,7 +208,10 @@ HEADERS_GLC_VIEWPORT +=	viewport/glc_camera.h \
                         viewport/glc_defaulteventinterpreter.h \
                         viewport/glc_screenshotsettings.h \
                         viewport/glc_openglviewwidget.h \
-                        viewport/glc_openglviewinterface.h
+                        viewport/glc_openglviewinterface.h \
+                        viewport/glc_raycaster.h \
+                        viewport/glc_frustumculler.h \
+                        viewport/glc_occlusionculler.h
 
 HEADERS_GLC += glc_global.h \
                glc_object.h \
@@ -339,7 +353,11 @@ SOURCES +=	io/glc_objmtlloader.cpp \
                 io/glc_fileloader.cpp \
                 io/glc_worldtoobj.cpp \
                 io/glc_assimptoworld.cpp \
-                io/glc_worldtocollada.cpp
+                io/glc_worldtocollada.cpp \
+                io/glc_textscanner.cpp \
+                io/glc_gltftoworld.cpp \
+                io/glc_worldtogltf.cpp \
+                io/glc_worldtostl.cpp
 
 SOURCES +=	sceneGraph/glc_3dviewcollection.cpp \
                 sceneGraph/glc_3dviewinstance.cpp \
@@ -351,8 +369,11 @@ SOURCES +=	sceneGraph/glc_3dviewcollection.cpp \
                 sceneGraph/glc_spacepartitioning.cpp \
                 sceneGraph/glc_octree.cpp \
                 sceneGraph/glc_octreenode.cpp \
+                sceneGraph/glc_bvh.cpp \
+                sceneGraph/glc_lodscheduler.cpp \
                 sceneGraph/glc_selectionset.cpp \
-                sceneGraph/glc_structoccurrence.cpp
+                sceneGraph/glc_structoccurrence.cpp \
+                sceneGraph/glc_transformhierarchy.cpp
 
 SOURCES +=	geometry/glc_geometry.cpp \
                 geometry/glc_circle.cpp \
@@ -370,6 +391,10 @@ SOURCES +=	geometry/glc_geometry.cpp \
                 geometry/glc_pointsprite.cpp \
                 geometry/glc_bsrep.cpp \
                 geometry/glc_wiredata.cpp \
+                geometry/glc_sharpedgeextractor.cpp \
+                geometry/glc_meshsimplifier.cpp \
+                geometry/glc_vertexcacheoptimizer.cpp \
+                geometry/glc_vertexcompression.cpp \
                 geometry/glc_arrow.cpp \
                 geometry/glc_polylines.cpp \
                 geometry/glc_disc.cpp \
@@ -418,7 +443,10 @@ SOURCES +=	viewport/glc_camera.cpp \
                 viewport/glc_inputeventinterpreter.cpp \
                 viewport/glc_defaulteventinterpreter.cpp \
                 viewport/glc_screenshotsettings.cpp \
-                viewport/glc_openglviewwidget.cpp
+                viewport/glc_openglviewwidget.cpp \
+                viewport/glc_raycaster.cpp \
+                viewport/glc_frustumculler.cpp \
+                viewport/glc_occlusionculler.cpp
 
 		
 SOURCES +=	glc_global.cpp \
@@ -553,6 +581,7 @@ HEADERS_INST = GLC_BoundingBox \
                GLC_ErrorLog \
                GLC_TraceLog \
                glcXmlUtil \
+               glcTextScanner \
                GLC_RenderState \
                GLC_FileLoader \
                GLC_WorldReaderPlugin \
@@ -590,7 +619,20 @@ HEADERS_INST = GLC_BoundingBox \
                GLC_Polygon \
                GLC_OpenGLViewInterface \
                GLC_WorldToCollada \
-               GLC_Image
+               GLC_Image \
+               GLC_GltfToWorld \
+               GLC_WorldToGltf \
+               GLC_WorldToStl \
+               GLC_Bvh \
+               GLC_RayCaster \
+               GLC_FrustumCuller \
+               GLC_OcclusionCuller \
+               GLC_LodScheduler \
+               GLC_TransformHierarchy \
+               GLC_SharpEdgeExtractor \
+               GLC_MeshSimplifier \
+               GLC_VertexCacheOptimizer \
+               GLC_VertexCompression
 
 
 include (../../install.pri)
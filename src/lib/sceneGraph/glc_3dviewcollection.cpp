@@ -23,15 +23,19 @@
 //! \file glc_3dviewcollection.cpp implementation of the GLC_3DViewCollection class.
 
 #include <QtDebug>
+#include <algorithm>
 
 #include "glc_3dviewcollection.h"
 #include "../shading/glc_material.h"
+#include "../geometry/glc_geometry.h"
 #include "../glc_openglexception.h"
 #include "../shading/glc_selectionmaterial.h"
 #include "../glc_state.h"
 #include "../shading/glc_shader.h"
 #include "../viewport/glc_viewport.h"
 #include "glc_spacepartitioning.h"
+#include "../viewport/glc_occlusionculler.h"
+#include "glc_lodscheduler.h"
 #include "../glc_context.h"
 #include "../glc_contextmanager.h"
 
@@ -50,8 +54,15 @@ GLC_3DViewCollection::GLC_3DViewCollection()
 , m_pViewport(nullptr)
 , m_pSpacePartitioning(nullptr)
 , m_UseSpacePartitioning(false)
+, m_pOcclusionCuller(nullptr)
+, m_OcclusionIsValid(false)
+, m_pLodScheduler(nullptr)
 , m_IsViewable(true)
 , m_UseOrderRendering(false)
+, m_RenderQueues()
+, m_InstanceBuffer(QOpenGLBuffer::VertexBuffer)
+, m_InstancedGroup()
+, m_InstanceMatrices()
 {
 }
 
@@ -59,6 +70,8 @@ GLC_3DViewCollection::~GLC_3DViewCollection()
 {
 	// Delete all collection's elements and the collection bounding box
 	clear();
+	delete m_pOcclusionCuller;
+	delete m_pLodScheduler;
 }
 //////////////////////////////////////////////////////////////////////
 // Set Functions
@@ -107,6 +120,7 @@ bool GLC_3DViewCollection::unBindShader(GLC_uint shaderId)
 		}
 		pShaderNodeHash->clear();
 		delete pShaderNodeHash;
+		invalidateRenderQueue();
         subject= true;
 	}
 	Q_ASSERT(!m_ShadedPointerViewInstanceHash.contains(shaderId));
@@ -141,6 +155,7 @@ bool GLC_3DViewCollection::add(const GLC_3DViewInstance& node, GLC_uint shaderID
 	}
 
 	m_3DViewInstanceHash.insert(key, node);
+	invalidateOcclusion();
 	// Create an GLC_3DViewInstance pointer of the inserted instance
 	ViewInstancesHash::iterator iNode= m_3DViewInstanceHash.find(key);
 	GLC_3DViewInstance* pInstance= &(iNode.value());
@@ -173,6 +188,7 @@ bool GLC_3DViewCollection::add(const GLC_3DViewInstance& node, GLC_uint shaderID
 		m_SelectedInstances.insert(key, pInstance);
         subject=true;
 	}
+	invalidateRenderQueue(key);
 
     return subject;
 }
@@ -181,6 +197,7 @@ void GLC_3DViewCollection::changeShadingGroup(GLC_uint instanceId, GLC_uint shad
 {
 	// Test if the specified instance exist
 	Q_ASSERT(m_3DViewInstanceHash.contains(instanceId));
+	invalidateRenderQueue(instanceId);
 	// Get the instance shading group
 	const GLuint instanceShadingGroup= shadingGroup(instanceId);
 	// Get a pointer to the instance
@@ -230,6 +247,7 @@ void GLC_3DViewCollection::changeShadingGroup(GLC_uint instanceId, GLC_uint shad
 	{
 		m_MainInstances.insert(instanceId, pInstance);
 	}
+	invalidateRenderQueue(instanceId);
 }
 
 bool GLC_3DViewCollection::remove(GLC_uint key)
@@ -244,7 +262,13 @@ bool GLC_3DViewCollection::remove(GLC_uint key)
 			// if the geometry is selected, unselect it
             unselect(key);
 		}
+		invalidateRenderQueue(key);
+		invalidateOcclusion();
 
+		if (isInAShadingGroup(key))
+		{
+			m_ShadedPointerViewInstanceHash.value(m_ShaderGroup.take(key))->remove(key);
+		}
         m_MainInstances.remove(key);
         m_3DViewInstanceHash.remove(key);		// Delete the conteneur
 
@@ -268,6 +292,7 @@ void GLC_3DViewCollection::clear(void)
     qDeleteAll(m_ShadedPointerViewInstanceHash);
     m_ShadedPointerViewInstanceHash.clear();
 	m_ShaderGroup.clear();
+	m_RenderQueues.clear();
 
 	// Clear main Hash table
     m_3DViewInstanceHash.clear();
@@ -275,6 +300,15 @@ void GLC_3DViewCollection::clear(void)
 	// delete the space partitioning
 	delete m_pSpacePartitioning;
     m_pSpacePartitioning= nullptr;
+
+    if (nullptr != m_pOcclusionCuller)
+    {
+        m_pOcclusionCuller->clearCache();
+    }
+    if (nullptr != m_pLodScheduler)
+    {
+        m_pLodScheduler->clearHistory();
+    }
 }
 
 bool GLC_3DViewCollection::select(GLC_uint key, bool primitive)
@@ -289,6 +323,7 @@ bool GLC_3DViewCollection::select(GLC_uint key, bool primitive)
         if ((iNode != m_3DViewInstanceHash.end()) && (iSelectedNode == m_SelectedInstances.end()))
         {	// Ok, the key exist and the node is not selected
             GLC_3DViewInstance* pSelectedInstance= &(iNode.value());
+            invalidateRenderQueue(key);
             m_SelectedInstances.insert(pSelectedInstance->id(), pSelectedInstance);
 
             // Remove Selected Node from is previous collection
@@ -301,6 +336,7 @@ bool GLC_3DViewCollection::select(GLC_uint key, bool primitive)
                 m_MainInstances.remove(key);
             }
             pSelectedInstance->select(primitive);
+            invalidateRenderQueue(key);
 
             subject= true;
         }
@@ -312,6 +348,7 @@ bool GLC_3DViewCollection::select(GLC_uint key, bool primitive)
 void GLC_3DViewCollection::selectAll(bool allShowState)
 {
 	unselectAll();
+	invalidateRenderQueue();
 	ViewInstancesHash::iterator iNode= m_3DViewInstanceHash.begin();
 	while (iNode != m_3DViewInstanceHash.end())
 	{
@@ -340,6 +377,7 @@ bool GLC_3DViewCollection::unselect(GLC_uint key)
 
 	if (iSelectedNode != m_SelectedInstances.end())
 	{	// Ok, the key exist and the node is selected
+		invalidateRenderQueue(key);
 		iSelectedNode.value()->unselect();
 
         GLC_3DViewInstance* pSelectedNode= iSelectedNode.value();
@@ -354,6 +392,7 @@ bool GLC_3DViewCollection::unselect(GLC_uint key)
 		{
 			m_MainInstances.insert(key, pSelectedNode);
 		}
+		invalidateRenderQueue(key);
 
         subject= true;
 
@@ -386,6 +425,7 @@ void GLC_3DViewCollection::unselectAll()
     }
     // Clear selected node hash table
     m_SelectedInstances.clear();
+    invalidateRenderQueue();
 }
 
 void GLC_3DViewCollection::setPolygonModeForAll(GLenum face, GLenum mode)
@@ -397,6 +437,8 @@ void GLC_3DViewCollection::setPolygonModeForAll(GLenum face, GLenum mode)
     	iEntry.value().setPolygonMode(face, mode);
         ++iEntry;
     }
+    // Only filled instances are occluders
+    invalidateOcclusion();
 
 }
 
@@ -406,6 +448,7 @@ void GLC_3DViewCollection::setVisibility(const GLC_uint key, const bool visibili
 	if (iNode != m_3DViewInstanceHash.end())
 	{	// Ok, the key exist
 		iNode.value().setVisibility(visibility);
+		invalidateOcclusion();
 	}
 }
 
@@ -418,6 +461,7 @@ void GLC_3DViewCollection::showAll()
      	iEntry.value().setVisibility(true);
         ++iEntry;
     }
+    invalidateOcclusion();
 }
 
 void GLC_3DViewCollection::hideAll()
@@ -429,6 +473,7 @@ void GLC_3DViewCollection::hideAll()
     	iEntry.value().setVisibility(false);
         ++iEntry;
     }
+    invalidateOcclusion();
 }
 
 void GLC_3DViewCollection::bindSpacePartitioning(GLC_SpacePartitioning* pSpacePartitioning)
@@ -455,15 +500,84 @@ void GLC_3DViewCollection::unbindSpacePartitioning()
     }
 }
 
+void GLC_3DViewCollection::bindOcclusionCuller(GLC_OcclusionCuller* pOcclusionCuller)
+{
+    Q_ASSERT(nullptr != pOcclusionCuller);
+    if (pOcclusionCuller == m_pOcclusionCuller) return;
+
+    unbindOcclusionCuller();
+    m_pOcclusionCuller= pOcclusionCuller;
+    invalidateOcclusion();
+}
+
+void GLC_3DViewCollection::unbindOcclusionCuller()
+{
+    if (nullptr != m_pOcclusionCuller)
+    {
+        m_pOcclusionCuller->restoreOccludedInstances(this);
+        delete m_pOcclusionCuller;
+        m_pOcclusionCuller= nullptr;
+    }
+}
+
+void GLC_3DViewCollection::bindLodScheduler(GLC_LodScheduler* pLodScheduler)
+{
+    Q_ASSERT(nullptr != pLodScheduler);
+    if (pLodScheduler == m_pLodScheduler) return;
+
+    unbindLodScheduler();
+    m_pLodScheduler= pLodScheduler;
+}
+
+void GLC_3DViewCollection::unbindLodScheduler()
+{
+    if (nullptr != m_pLodScheduler)
+    {
+        m_pLodScheduler->clearSchedule(this);
+        delete m_pLodScheduler;
+        m_pLodScheduler= nullptr;
+    }
+}
+
 void GLC_3DViewCollection::updateInstanceViewableState(GLC_Matrix4x4* pMatrix)
 {
-    if ((nullptr != m_pViewport) && m_UseSpacePartitioning && (nullptr != m_pSpacePartitioning))
+    const bool useSpacePartitioning= m_UseSpacePartitioning && (nullptr != m_pSpacePartitioning);
+
+    // Occluders cut by clip planes would hide the parts they show, no instance is occluded
+    const bool clipPlaneIsUsed= (nullptr != m_pViewport) && m_pViewport->clipPlaneIsUsed();
+    if ((nullptr != m_pOcclusionCuller) && clipPlaneIsUsed)
+    {
+        m_pOcclusionCuller->restoreOccludedInstances(this);
+    }
+
+    if ((nullptr != m_pViewport) && (useSpacePartitioning || (nullptr != m_pOcclusionCuller)))
 	{
-		if (m_pViewport->updateFrustum(pMatrix))
+		// Instance changes since the last culling invalidate the occlusion, even if the camera is still
+		const bool frustumIsUpdated= m_pViewport->updateFrustum(pMatrix);
+		if (frustumIsUpdated || ((nullptr != m_pOcclusionCuller) && !m_OcclusionIsValid))
         {
-            m_pSpacePartitioning->updateViewableInstances(m_pViewport->frustum());
+            // Occluded instances of the previous frame are set viewable before being tested again
+            if (nullptr != m_pOcclusionCuller)
+            {
+                m_pOcclusionCuller->restoreOccludedInstances(this);
+            }
+            if (useSpacePartitioning)
+            {
+                m_pSpacePartitioning->updateViewableInstances(m_pViewport->frustum());
+            }
+            if ((nullptr != m_pOcclusionCuller) && !clipPlaneIsUsed)
+            {
+                m_pOcclusionCuller->cull(this, (nullptr != pMatrix) ? *pMatrix : m_pViewport->compositionMatrix());
+            }
+            m_OcclusionIsValid= true;
         }
 	}
+
+    // The schedule depends on the camera and on the budget, it is updated on each frame
+    if ((nullptr != m_pViewport) && (nullptr != m_pLodScheduler))
+    {
+        m_pLodScheduler->schedule(this, *m_pViewport);
+    }
 }
 
 void GLC_3DViewCollection::updateInstanceViewableState(const GLC_Frustum& frustum)
@@ -482,6 +596,25 @@ void GLC_3DViewCollection::updateSpacePartitionning()
     }
 }
 
+void GLC_3DViewCollection::updateInstanceSpacePartitionning(GLC_uint key)
+{
+    if ((nullptr != m_pSpacePartitioning) && m_3DViewInstanceHash.contains(key))
+    {
+        m_pSpacePartitioning->updateInstance(instanceHandle(key));
+    }
+    invalidateOcclusion();
+}
+
+void GLC_3DViewCollection::invalidateRenderQueue()
+{
+	m_RenderQueues.clear();
+}
+
+void GLC_3DViewCollection::invalidateRenderQueue(GLC_uint instanceId)
+{
+	m_RenderQueues.remove(renderGroup(instanceId));
+}
+
 void GLC_3DViewCollection::setVboUsage(bool usage)
 {
 	ViewInstancesHash::iterator iEntry= m_3DViewInstanceHash.begin();
@@ -705,7 +838,7 @@ void GLC_3DViewCollection::glDraw(GLC_uint groupId, glc::RenderFlag renderFlag)
 	// Normal GLC_3DViewInstance
 	if ((groupId == 0) && !m_MainInstances.isEmpty())
 	{
-		glDrawInstancesOf(&m_MainInstances, renderFlag);
+		glDrawRenderQueue(0, renderFlag);
 
 	}
 	// Selected GLC_3DVIewInstance
@@ -713,7 +846,7 @@ void GLC_3DViewCollection::glDraw(GLC_uint groupId, glc::RenderFlag renderFlag)
 	{
 		if (GLC_State::selectionShaderUsed()) GLC_SelectionMaterial::useShader();
 
-		glDrawInstancesOf(&m_SelectedInstances, renderFlag);
+		glDrawRenderQueue(1, renderFlag);
 
 		if (GLC_State::selectionShaderUsed()) GLC_SelectionMaterial::unUseShader();
 	}
@@ -722,10 +855,8 @@ void GLC_3DViewCollection::glDraw(GLC_uint groupId, glc::RenderFlag renderFlag)
 	{
 	    if(m_ShadedPointerViewInstanceHash.contains(groupId) && !m_ShadedPointerViewInstanceHash.value(groupId)->isEmpty())
 	    {
-	    	PointerViewInstanceHash* pNodeHash= m_ShadedPointerViewInstanceHash.value(groupId);
-
 	    	GLC_Shader::use(groupId);
-	    	glDrawInstancesOf(pNodeHash, renderFlag);
+	    	glDrawRenderQueue(groupId, renderFlag);
 	    	GLC_Shader::unuse();
 	    }
 	}
@@ -738,3 +869,139 @@ void GLC_3DViewCollection::glDraw(GLC_uint groupId, glc::RenderFlag renderFlag)
 		glEnable(GL_DEPTH_TEST);
 	}
 }
+
+//////////////////////////////////////////////////////////////////////
+// Private services Functions
+//////////////////////////////////////////////////////////////////////
+
+const QVector<GLC_3DViewCollection::RenderRecord>& GLC_3DViewCollection::renderQueue(GLC_uint groupId)
+{
+	RenderQueueHash::iterator iQueue= m_RenderQueues.find(groupId);
+	if (iQueue == m_RenderQueues.end())
+	{
+		// The queue is missing or has been invalidated, rebuild it
+		const PointerViewInstanceHash* pHash= nullptr;
+		if (0 == groupId) pHash= &m_MainInstances;
+		else if (1 == groupId) pHash= &m_SelectedInstances;
+		else pHash= m_ShadedPointerViewInstanceHash.value(groupId, nullptr);
+
+		QVector<RenderRecord> queue;
+		if (nullptr != pHash)
+		{
+			queue.reserve(pHash->size());
+			PointerViewInstanceHash::const_iterator iEntry= pHash->constBegin();
+			while (iEntry != pHash->constEnd())
+			{
+				RenderRecord record;
+				record.m_Key= renderKey(iEntry.value());
+				record.m_pInstance= iEntry.value();
+				queue.append(record);
+				++iEntry;
+			}
+			std::sort(queue.begin(), queue.end());
+		}
+		iQueue= m_RenderQueues.insert(groupId, queue);
+	}
+
+	return iQueue.value();
+}
+
+GLC_uint GLC_3DViewCollection::renderGroup(GLC_uint instanceId) const
+{
+	GLC_uint subject;
+	if (m_SelectedInstances.contains(instanceId))
+	{
+		subject= 1;
+	}
+	else
+	{
+		subject= m_ShaderGroup.value(instanceId, 0);
+	}
+	return subject;
+}
+
+quint64 GLC_3DViewCollection::renderKey(GLC_3DViewInstance* pInstance) const
+{
+	// Key layout from most to least significant bits :
+	// no opaque pass (1), transparent pass (1), order weight (16), material (22), geometry (24)
+	quint64 subject= 0;
+	if (pInstance->isTransparent() && !pInstance->isSelected())
+	{
+		subject|= RenderKeyNoOpaqueBit;
+	}
+	if (pInstance->hasTransparentMaterials())
+	{
+		subject|= RenderKeyTransparentBit;
+	}
+
+	if (m_UseOrderRendering)
+	{
+		const quint64 order= static_cast<quint64>(qBound(-32768, pInstance->orderWeight(), 32767) + 32768);
+		subject|= order << 46;
+	}
+
+	GLC_Geometry* pGeom= pInstance->geomAt(0);
+	if (nullptr != pGeom)
+	{
+		GLC_Material* pMaterial= pGeom->firstMaterial();
+		if (nullptr != pMaterial)
+		{
+			subject|= (static_cast<quint64>(pMaterial->id()) & Q_UINT64_C(0x3FFFFF)) << 24;
+		}
+		subject|= static_cast<quint64>(pGeom->id()) & Q_UINT64_C(0xFFFFFF);
+	}
+
+	return subject;
+}
+
+bool GLC_3DViewCollection::instancingIsUsable(glc::RenderFlag renderFlag) const
+{
+	// Selection needs an id color by instance and LOD are chosen by instance
+	bool subject= GLC_State::isInstancingActivated() && GLC_State::vboUsed() && !GLC_State::isInSelectionMode()
+			&& ((renderFlag == glc::ShadingFlag) || (renderFlag == glc::TransparentRenderFlag))
+			&& !m_UseLod && (nullptr == m_pLodScheduler) && GLC_Shader::hasActiveShader();
+
+	// The shader must place the instances
+	subject= subject && (GLC_Shader::currentShaderHandle()->instanceMatrixAttributeId() != -1);
+
+	return subject;
+}
+
+void GLC_3DViewCollection::glDrawInstanced(const QVector<GLC_3DViewInstance*>& instances, glc::RenderFlag renderFlag)
+{
+	const int count= instances.size();
+	GLC_Context* pContext= GLC_ContextManager::instance()->currentContext();
+
+	// Column major model view matrices, computed in double precision so far instances
+	// don't lose precision when they are converted to float
+	const GLC_Matrix4x4 viewMatrix(pContext->modelViewMatrix());
+	m_InstanceMatrices.resize(count * 16);
+	GLfloat* pData= m_InstanceMatrices.data();
+	for (int i= 0; i < count; ++i)
+	{
+		const GLC_Matrix4x4 modelViewMatrix(viewMatrix * instances.at(i)->matrix());
+		const double* pMatrixData= modelViewMatrix.getData();
+		for (int j= 0; j < 16; ++j)
+		{
+			pData[i * 16 + j]= static_cast<GLfloat>(pMatrixData[j]);
+		}
+	}
+
+	if (!m_InstanceBuffer.isCreated())
+	{
+		m_InstanceBuffer.create();
+		m_InstanceBuffer.setUsagePattern(QOpenGLBuffer::StreamDraw);
+	}
+	m_InstanceBuffer.bind();
+	m_InstanceBuffer.allocate(pData, count * 16 * static_cast<int>(sizeof(GLfloat)));
+
+	pContext->glcUseInstanceMatrixPointer(0);
+	m_InstanceBuffer.release();
+	pContext->glcEnableInstancing(true);
+
+	// The first instance draws the geometries they share
+	instances.first()->renderInstanced(renderFlag, count);
+
+	pContext->glcEnableInstancing(false);
+	pContext->glcDisableInstanceMatrixClientState();
+}
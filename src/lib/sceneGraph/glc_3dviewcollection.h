@@ -27,6 +27,8 @@
 
 
 #include <QHash>
+#include <QVector>
+#include <QOpenGLBuffer>
 #include "glc_3dviewinstance.h"
 #include "../glc_global.h"
 #include "../viewport/glc_frustum.h"
@@ -34,6 +36,8 @@
 #include "../glc_config.h"
 
 class GLC_SpacePartitioning;
+class GLC_OcclusionCuller;
+class GLC_LodScheduler;
 class GLC_Material;
 class GLC_Shader;
 class GLC_Viewport;
@@ -156,6 +160,14 @@ public:
     GLC_SpacePartitioning* spacePartitioningHandle()
 	{return m_pSpacePartitioning;}
 
+	//! Return an handle to the occlusion culler, NULL if not bound
+    GLC_OcclusionCuller* occlusionCullerHandle()
+	{return m_pOcclusionCuller;}
+
+	//! Return an handle to the LOD scheduler, NULL if not bound
+    GLC_LodScheduler* lodSchedulerHandle()
+	{return m_pLodScheduler;}
+
 	//! Return true if the collection is viewable
     bool isViewable() const
 	{return m_IsViewable;}
@@ -232,7 +244,10 @@ public:
 
 	//! Set the Show or noShow state
     void swapShowState()
-	{m_IsInShowSate= !m_IsInShowSate;}
+	{
+		m_IsInShowSate= !m_IsInShowSate;
+		invalidateOcclusion();
+	}
 
 	//! Set the LOD usage
     void setLodUsage(const bool usage, GLC_Viewport* pView)
@@ -247,6 +262,22 @@ public:
 	//! Unbind the space partitioning
 	void unbindSpacePartitioning();
 
+	//! Bind the occlusion culler, the collection takes its ownership
+	/*! The occlusion culler is run after the space partitioning by updateInstanceViewableState()
+	 *  when the frustum is updated or when the occlusion is invalidated*/
+	void bindOcclusionCuller(GLC_OcclusionCuller* pOcclusionCuller);
+
+	//! Unbind and delete the occlusion culler
+	void unbindOcclusionCuller();
+
+	//! Bind the LOD scheduler, the collection takes its ownership
+	/*! The LOD of the viewable bodies are scheduled by updateInstanceViewableState()
+	 *  after culling, if a viewport is attached*/
+	void bindLodScheduler(GLC_LodScheduler* pLodScheduler);
+
+	//! Unbind and delete the LOD scheduler
+	void unbindLodScheduler();
+
 	//! Use the space partitioning
     void setSpacePartitionningUsage(bool use)
 	{m_UseSpacePartitioning= use;}
@@ -262,6 +293,10 @@ public:
     //! Update space partitionning
     void updateSpacePartitionning();
 
+    //! Update the instance of the given key in the space partitionning
+    /*! Must be called when the matrix of the instance has changed*/
+    void updateInstanceSpacePartitionning(GLC_uint key);
+
 	//! Set the attached viewport of this collection
     void setAttachedViewport(GLC_Viewport* pViewport)
 	{m_pViewport= pViewport;}
@@ -274,7 +309,24 @@ public:
 	void setVboUsage(bool usage);
 
     void setOrderRenderingUsage(bool use)
-    {m_UseOrderRendering= use;}
+    {
+        m_UseOrderRendering= use;
+        invalidateRenderQueue();
+    }
+
+	//! Invalidate the render queues of all groups
+	/*! Must be called when instances are modified through their handle
+	 *  (render properties, materials, order weight)*/
+	void invalidateRenderQueue();
+
+	//! Invalidate the render queue of the group containing the given instance
+	void invalidateRenderQueue(GLC_uint instanceId);
+
+	//! Invalidate the occlusion culling, occluded instances are tested again on the next frame
+	/*! Called by the collection when instances are added, removed, shown, hidden or moved.
+	 *  Must be called when instances are modified through their handle*/
+	inline void invalidateOcclusion()
+	{m_OcclusionIsValid= false;}
 
     void setMeshWireColorAndLineWidth(const QColor& color, GLfloat lineWidth);
 
@@ -303,14 +355,48 @@ public:
 //////////////////////////////////////////////////////////////////////
 
 private:
+	//! A render queue record
+	/*! The key sorts the records by pass, order weight, material and geometry.
+	 *  Materials may change after the queue is built, so the pass of an instance
+	 *  is checked again on draw*/
+	struct RenderRecord
+	{
+		quint64 m_Key;
+		GLC_3DViewInstance* m_pInstance;
+
+		inline bool operator<(const RenderRecord& other) const
+		{return m_Key < other.m_Key;}
+	};
+
+	//! Render key bit set when the instance is not drawn in the opaque pass
+	static const quint64 RenderKeyNoOpaqueBit= Q_UINT64_C(1) << 63;
+
+	//! Render key bit set when the instance is drawn in the transparent pass
+	static const quint64 RenderKeyTransparentBit= Q_UINT64_C(1) << 62;
+
+	//! Render queue of each group
+	typedef QHash<GLC_uint, QVector<RenderRecord> > RenderQueueHash;
+
 	//! Display collection's member
 	void glDraw(GLC_uint groupID, glc::RenderFlag renderFlag);
 
-	//! Draw instances of a PointerViewInstanceHash
-	inline void glDrawInstancesOf(PointerViewInstanceHash*, glc::RenderFlag);
+	//! Draw the render queue of the given group
+	inline void glDrawRenderQueue(GLC_uint groupId, glc::RenderFlag renderFlag);
+
+	//! Return the up to date render queue of the given group
+	const QVector<RenderRecord>& renderQueue(GLC_uint groupId);
+
+	//! Return the render queue group of the given instance
+	GLC_uint renderGroup(GLC_uint instanceId) const;
 
-    //! Draw orded instances of a PointerViewInstanceHash
-    inline void glDrawOrderedInstancesOf(PointerViewInstanceHash*, glc::RenderFlag);
+	//! Return the render key of the given instance
+	quint64 renderKey(GLC_3DViewInstance* pInstance) const;
+
+	//! Return true if instances can be drawn by instanced rendering with the given render flag
+	bool instancingIsUsable(glc::RenderFlag renderFlag) const;
+
+	//! Draw the given instances, sharing their rendering, with one instanced draw
+	void glDrawInstanced(const QVector<GLC_3DViewInstance*>& instances, glc::RenderFlag renderFlag);
 
 //@}
 
@@ -348,132 +434,91 @@ private:
 	//! The space partition usage
 	bool m_UseSpacePartitioning;
 
+	//! The occlusion culler
+	GLC_OcclusionCuller* m_pOcclusionCuller;
+
+	//! False if the occluded instances must be tested again even if the frustum is unchanged
+	bool m_OcclusionIsValid;
+
+	//! The LOD scheduler
+	GLC_LodScheduler* m_pLodScheduler;
+
 	//! Viewable state
 	bool m_IsViewable;
 
     bool m_UseOrderRendering;
 
+	//! The render queue of each group sorted by render key, a missing queue is rebuilt on draw
+	RenderQueueHash m_RenderQueues;
+
+	//! The buffer of the instance matrices of an instanced draw
+	QOpenGLBuffer m_InstanceBuffer;
+
+	//! The instances of the current instanced draw
+	QVector<GLC_3DViewInstance*> m_InstancedGroup;
+
+	//! The model view matrices of the instances of the current instanced draw
+	QVector<GLfloat> m_InstanceMatrices;
+
 private:
     Q_DISABLE_COPY(GLC_3DViewCollection)
 };
 
-// Draw instances of a PointerViewInstanceHash
-void GLC_3DViewCollection::glDrawInstancesOf(PointerViewInstanceHash* pHash, glc::RenderFlag renderFlag)
+// Draw the render queue of the given group
+void GLC_3DViewCollection::glDrawRenderQueue(GLC_uint groupId, glc::RenderFlag renderFlag)
 {
-	bool forceDisplay= false;
-	if (GLC_State::isInSelectionMode())
-	{
-		forceDisplay= true;
-	}
+	const QVector<RenderRecord>& queue= renderQueue(groupId);
+	const int count= queue.size();
 
-	PointerViewInstanceHash::iterator iEntry= pHash->begin();
-	// The current instance
-	GLC_3DViewInstance* pCurInstance;
-	if (forceDisplay)
-	{
-        if (m_UseOrderRendering)
-        {
-            QList<GLC_3DViewInstance*> instanceList= pHash->values();
-            std::sort(instanceList.begin(), instanceList.end(), GLC_3DViewInstance::firstIsLower);
-            const int count= instanceList.count();
-            for (int i= 0; i < count; ++i)
-            {
-                pCurInstance= instanceList.at(i);
-                if ((pCurInstance->viewableFlag() != GLC_3DViewInstance::NoViewable) && (pCurInstance->isVisible() == m_IsInShowSate))
-                {
-                    pCurInstance->render(renderFlag, m_UseLod, m_pViewport);
-                }
-            }
-        }
-        else
-        {
-            while (iEntry != pHash->constEnd())
-            {
-                pCurInstance= iEntry.value();
-                if ((pCurInstance->viewableFlag() != GLC_3DViewInstance::NoViewable) && (pCurInstance->isVisible() == m_IsInShowSate))
-                {
-                    pCurInstance->render(renderFlag, m_UseLod, m_pViewport);
-                }
-                ++iEntry;
-            }
-        }
-	}
-    else if (m_UseOrderRendering)
-    {
-        glDrawOrderedInstancesOf(pHash, renderFlag);
-    }
-	else
+	// Pass filter, everything is drawn in selection and wire mode
+	const bool transparentPass= !GLC_State::isInSelectionMode() && (renderFlag == glc::TransparentRenderFlag);
+	const bool opaquePass= !GLC_State::isInSelectionMode() && (renderFlag != glc::TransparentRenderFlag) && (renderFlag != glc::WireRenderFlag);
+
+	const bool useInstancing= instancingIsUsable(renderFlag);
+	for (int i= 0; i < count; ++i)
 	{
-		if (!(renderFlag == glc::TransparentRenderFlag))
+		const RenderRecord& record= queue.at(i);
+		GLC_3DViewInstance* pCurInstance= record.m_pInstance;
+
+		// The transparency is not taken from the key, it may have changed since the queue was built
+		bool isInPass= true;
+		if (transparentPass) isInPass= pCurInstance->hasTransparentMaterials();
+		else if (opaquePass) isInPass= !pCurInstance->isTransparent() || pCurInstance->isSelected();
+
+		if (isInPass)
 		{
-			while (iEntry != pHash->constEnd())
+			if ((pCurInstance->viewableFlag() != GLC_3DViewInstance::NoViewable) && (pCurInstance->isVisible() == m_IsInShowSate))
 			{
-				pCurInstance= iEntry.value();
-				if ((pCurInstance->viewableFlag() != GLC_3DViewInstance::NoViewable) && (pCurInstance->isVisible() == m_IsInShowSate))
+				// Gather the following instances sharing the rendering of the current one
+				m_InstancedGroup.clear();
+				if (useInstancing && pCurInstance->isInstanceable(m_pViewport))
 				{
-					if (!pCurInstance->isTransparent() || pCurInstance->renderPropertiesHandle()->isSelected() || (renderFlag == glc::WireRenderFlag))
+					m_InstancedGroup.append(pCurInstance);
+					while ((i + 1) < count)
 					{
-						pCurInstance->render(renderFlag, m_UseLod, m_pViewport);
+						const RenderRecord& nextRecord= queue.at(i + 1);
+						GLC_3DViewInstance* pNextInstance= nextRecord.m_pInstance;
+						if ((nextRecord.m_Key == record.m_Key) && (pNextInstance->isVisible() == m_IsInShowSate)
+								&& pNextInstance->isInstanceable(m_pViewport) && pNextInstance->sharesRenderingWith(*pCurInstance))
+						{
+							m_InstancedGroup.append(pNextInstance);
+							++i;
+						}
+						else break;
 					}
 				}
-				++iEntry;
-			}
-		}
-		else
-		{
-			while (iEntry != pHash->constEnd())
-			{
-				pCurInstance= iEntry.value();
-				if ((pCurInstance->viewableFlag() != GLC_3DViewInstance::NoViewable) && (pCurInstance->isVisible() == m_IsInShowSate))
+
+				if (m_InstancedGroup.size() > 1)
 				{
-					if (pCurInstance->hasTransparentMaterials())
-					{
-						pCurInstance->render(renderFlag, m_UseLod, m_pViewport);
-					}
+					glDrawInstanced(m_InstancedGroup, renderFlag);
+				}
+				else
+				{
+					pCurInstance->render(renderFlag, m_UseLod, m_pViewport);
 				}
-				++iEntry;
 			}
-	   }
+		}
 	}
 }
 
-// Draw instances of a PointerViewInstanceHash
-void GLC_3DViewCollection::glDrawOrderedInstancesOf(PointerViewInstanceHash* pHash, glc::RenderFlag renderFlag)
-{
-    // The current instance
-    GLC_3DViewInstance* pCurInstance;
-    QList<GLC_3DViewInstance*> instanceList= pHash->values();
-    std::sort(instanceList.begin(), instanceList.end(), GLC_3DViewInstance::firstIsLower);
-    const int count= instanceList.count();
-    if (!(renderFlag == glc::TransparentRenderFlag))
-    {
-        for (int i= 0; i < count; ++i)
-        {
-            pCurInstance= instanceList.at(i);
-            if ((pCurInstance->viewableFlag() != GLC_3DViewInstance::NoViewable) && (pCurInstance->isVisible() == m_IsInShowSate))
-            {
-                if (!pCurInstance->isTransparent() || pCurInstance->renderPropertiesHandle()->isSelected() || (renderFlag == glc::WireRenderFlag))
-                {
-                    pCurInstance->render(renderFlag, m_UseLod, m_pViewport);
-                }
-            }
-        }
-    }
-    else
-    {
-        for (int i= 0; i < count; ++i)
-        {
-            pCurInstance= instanceList.at(i);
-            if ((pCurInstance->viewableFlag() != GLC_3DViewInstance::NoViewable) && (pCurInstance->isVisible() == m_IsInShowSate))
-            {
-                if (pCurInstance->hasTransparentMaterials())
-                {
-                    pCurInstance->render(renderFlag, m_UseLod, m_pViewport);
-                }
-            }
-        }
-   }
-
-}
-
 #endif //GLC_3DVIEWCOLLECTION_H_
@@ -22,7 +22,10 @@
 
 //! \file glc_instance.cpp implementation of the GLC_3DViewInstance class.
 
+#include <typeinfo>
+
 #include "glc_3dviewinstance.h"
+#include "../geometry/glc_mesh.h"
 #include "../shading/glc_selectionmaterial.h"
 #include "../viewport/glc_viewport.h"
 #include "../glc_state.h"
@@ -47,6 +50,7 @@ GLC_3DViewInstance::GLC_3DViewInstance()
     , m_DefaultLOD(m_GlobalDefaultLOD)
     , m_ViewableFlag(GLC_3DViewInstance::FullViewable)
     , m_ViewableGeomFlag()
+    , m_ScheduledLodValues()
     , m_pRenderState(new GLC_RenderState)
     , m_OrderWeight(0)
 {
@@ -66,6 +70,7 @@ GLC_3DViewInstance::GLC_3DViewInstance(GLC_Geometry* pGeom)
     , m_DefaultLOD(m_GlobalDefaultLOD)
     , m_ViewableFlag(GLC_3DViewInstance::FullViewable)
     , m_ViewableGeomFlag()
+    , m_ScheduledLodValues()
     , m_pRenderState(new GLC_RenderState)
     , m_OrderWeight(0)
 {
@@ -86,6 +91,7 @@ GLC_3DViewInstance::GLC_3DViewInstance(GLC_Geometry* pGeom, GLC_uint id)
     , m_DefaultLOD(m_GlobalDefaultLOD)
     , m_ViewableFlag(GLC_3DViewInstance::FullViewable)
     , m_ViewableGeomFlag()
+    , m_ScheduledLodValues()
     , m_pRenderState(new GLC_RenderState)
     , m_OrderWeight(0)
 {
@@ -106,6 +112,7 @@ GLC_3DViewInstance::GLC_3DViewInstance(const GLC_3DRep& rep)
     , m_DefaultLOD(m_GlobalDefaultLOD)
     , m_ViewableFlag(GLC_3DViewInstance::FullViewable)
     , m_ViewableGeomFlag()
+    , m_ScheduledLodValues()
     , m_pRenderState(new GLC_RenderState)
     , m_OrderWeight(0)
 {
@@ -125,6 +132,7 @@ GLC_3DViewInstance::GLC_3DViewInstance(const GLC_3DRep& rep, GLC_uint id)
     , m_DefaultLOD(m_GlobalDefaultLOD)
     , m_ViewableFlag(GLC_3DViewInstance::FullViewable)
     , m_ViewableGeomFlag()
+    , m_ScheduledLodValues()
     , m_pRenderState(new GLC_RenderState)
     , m_OrderWeight(0)
 {
@@ -145,6 +153,7 @@ GLC_3DViewInstance::GLC_3DViewInstance(const GLC_3DViewInstance& inputNode)
     , m_DefaultLOD(inputNode.m_DefaultLOD)
     , m_ViewableFlag(inputNode.m_ViewableFlag)
     , m_ViewableGeomFlag(inputNode.m_ViewableGeomFlag)
+    , m_ScheduledLodValues(inputNode.m_ScheduledLodValues)
     , m_pRenderState(inputNode.m_pRenderState->clone())
     , m_OrderWeight(inputNode.m_OrderWeight)
 
@@ -182,6 +191,7 @@ GLC_3DViewInstance& GLC_3DViewInstance::operator=(const GLC_3DViewInstance& inpu
 		m_DefaultLOD= inputNode.m_DefaultLOD;
 		m_ViewableFlag= inputNode.m_ViewableFlag;
 		m_ViewableGeomFlag= inputNode.m_ViewableGeomFlag;
+		m_ScheduledLodValues= inputNode.m_ScheduledLodValues;
 
         delete m_pRenderState;
         m_pRenderState= inputNode.m_pRenderState->clone();
@@ -376,7 +386,21 @@ void GLC_3DViewInstance::render(glc::RenderFlag renderFlag, bool useLod, GLC_Vie
 
 
 
-        if (useLod && (nullptr != pView))
+        if (m_ScheduledLodValues.size() == bodyCount)
+        {
+            // The LOD of the bodies have been chosen by a LOD scheduler
+            for (int i= 0; i < bodyCount; ++i)
+            {
+                const int lodValue= m_ScheduledLodValues.at(i);
+                if (m_ViewableGeomFlag.at(i) && (lodValue <= 100))
+                {
+                    m_3DRep.geomAt(i)->setCurrentLod(lodValue);
+                    m_RenderProperties.setCurrentBodyIndex(i);
+                    m_3DRep.geomAt(i)->render(m_RenderProperties);
+                }
+            }
+        }
+        else if (useLod && (nullptr != pView))
         {
             for (int i= 0; i < bodyCount; ++i)
             {
@@ -510,6 +534,75 @@ int GLC_3DViewInstance::renderForPrimitiveSelection(GLC_uint bodyId)
     }
 }
 
+// Return true if this instance can be drawn by instanced rendering in the given view
+bool GLC_3DViewInstance::isInstanceable(GLC_Viewport* pView)
+{
+    bool subject= !m_3DRep.isEmpty() && (m_ViewableFlag == FullViewable) && !m_RenderProperties.isSelected()
+            && (m_RenderProperties.renderingMode() == glc::NormalRenderMode) && m_ScheduledLodValues.isEmpty()
+            && (m_AbsoluteMatrix.type() != GLC_Matrix4x4::Indirect) && (typeid(*m_pRenderState) == typeid(GLC_RenderState));
+
+    const int bodyCount= m_3DRep.numberOfBody();
+    const bool pixelCulling= GLC_State::isPixelCullingActivated() && (nullptr != pView);
+    for (int i= 0; subject && (i < bodyCount); ++i)
+    {
+        GLC_Geometry* pGeom= m_3DRep.geomAt(i);
+        subject= (nullptr != dynamic_cast<GLC_Mesh*>(pGeom)) && pGeom->vboIsUsed() && m_ViewableGeomFlag.value(i, true);
+
+        // A pixel culled body is only skipped by the regular rendering
+        if (subject && pixelCulling)
+        {
+            subject= choseLod(pGeom->boundingBox(), pView, false) <= 100;
+        }
+    }
+
+    return subject;
+}
+
+// Return true if this instance and the given one can be drawn by the same instanced draw
+bool GLC_3DViewInstance::sharesRenderingWith(const GLC_3DViewInstance& other) const
+{
+    const int bodyCount= m_3DRep.numberOfBody();
+    bool subject= (bodyCount == other.m_3DRep.numberOfBody()) && (m_DefaultLOD == other.m_DefaultLOD)
+            && (m_RenderProperties.polyFaceMode() == other.m_RenderProperties.polyFaceMode())
+            && (m_RenderProperties.polygonMode() == other.m_RenderProperties.polygonMode());
+
+    for (int i= 0; subject && (i < bodyCount); ++i)
+    {
+        subject= (m_3DRep.geomAt(i) == other.m_3DRep.geomAt(i));
+    }
+
+    return subject;
+}
+
+// Display the geometries of this instance once by instance matrix
+void GLC_3DViewInstance::renderInstanced(glc::RenderFlag renderFlag, int instanceCount)
+{
+    Q_ASSERT(!GLC_State::isInSelectionMode());
+    if (m_3DRep.isEmpty()) return;
+    const int bodyCount= m_3DRep.numberOfBody();
+
+    m_RenderProperties.setRenderingFlag(renderFlag);
+
+    // The instance matrices contain the view, so the model view matrix is the identity
+    GLC_Context* pContext= GLC_ContextManager::instance()->currentContext();
+    pContext->glcPushMatrix();
+    pContext->glcLoadIdentity();
+    glPolygonMode(m_RenderProperties.polyFaceMode(), m_RenderProperties.polygonMode());
+    m_pRenderState->modifyOpenGLState();
+
+    GLC_State::setDrawInstanceCount(instanceCount);
+    for (int i= 0; i < bodyCount; ++i)
+    {
+        m_3DRep.geomAt(i)->setCurrentLod(m_DefaultLOD);
+        m_RenderProperties.setCurrentBodyIndex(i);
+        m_3DRep.geomAt(i)->render(m_RenderProperties);
+    }
+    GLC_State::setDrawInstanceCount(0);
+
+    pContext->glcPopMatrix();
+    m_pRenderState->restoreOpenGLState();
+}
+
 //////////////////////////////////////////////////////////////////////
 // private services functions
 //////////////////////////////////////////////////////////////////////
@@ -188,6 +188,11 @@ public:
     int defaultLodValue() const
 	{return m_DefaultLOD;}
 
+	//! Return the scheduled LOD value of the body of the given index
+	/*! Return -1 if the LOD of the bodies of this instance are not scheduled*/
+    int scheduledLodValue(int index) const
+	{return m_ScheduledLodValues.value(index, -1);}
+
 	//! Return the instance representation
     GLC_3DRep representation() const
 	{return m_3DRep;}
@@ -270,6 +275,12 @@ public:
     void setDefaultLodValue(int lod)
 	{m_DefaultLOD= lod;}
 
+	//! Set the LOD values of the bodies of this instance chosen by a LOD scheduler
+	/*! Scheduled values replace the values chosen at rendering, a value greater than 100
+	 *  means that the body is not rendered. An empty vector removes the schedule.*/
+    void setScheduledLodValues(const QVector<int>& values)
+	{m_ScheduledLodValues= values;}
+
 	//! Set the viewable flag
     inline bool setViewable(GLC_3DViewInstance::Viewable flag);
 
@@ -310,6 +321,19 @@ public:
 	//! Display the instance in Primitive selection mode of the specified body id and return the body index
 	int renderForPrimitiveSelection(GLC_uint);
 
+	//! Return true if this instance can be drawn by instanced rendering in the given view
+	/*! The instance must be fully viewable and not pixel culled, not selected, rendered in
+	 *  normal mode with a direct matrix and the default render state, and made of meshes using VBO*/
+	bool isInstanceable(GLC_Viewport* pView);
+
+	//! Return true if this instance and the given one can be drawn by the same instanced draw
+	/*! They must share their geometries, default LOD and polygon mode*/
+	bool sharesRenderingWith(const GLC_3DViewInstance& other) const;
+
+	//! Display the geometries of this instance once by instance matrix
+	/*! The given count of instance model view matrices must be in use, the matrix of this instance is not used*/
+	void renderInstanced(glc::RenderFlag renderFlag, int instanceCount);
+
 
 private:
 	//! Set instance visualisation properties
@@ -372,6 +396,9 @@ private:
 	//! vector of Flag to know if geometies of this instance are viewable
 	QVector<bool> m_ViewableGeomFlag;
 
+	//! The LOD values of the bodies chosen by a LOD scheduler, empty if not scheduled
+	QVector<int> m_ScheduledLodValues;
+
     //! This instance rendering state
     GLC_RenderState* m_pRenderState;
 
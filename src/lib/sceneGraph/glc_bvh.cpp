@@ -0,0 +1,708 @@
+/****************************************************************************
+
+ This file is part of the GLC-lib library.
+ Copyright (C) 2005-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ http://glc-lib.sourceforge.net
+
+ GLC-lib is free software; you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation; either version 3 of the License, or
+ (at your option) any later version.
+
+ GLC-lib is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with GLC-lib; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+
+//! \file glc_bvh.cpp implementation for the GLC_Bvh class.
+
+#include "glc_bvh.h"
+#include "glc_3dviewcollection.h"
+#include "glc_3dviewinstance.h"
+#include "../viewport/glc_frustumculler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// Number of bins used to evaluate the surface area heuristic
+static const int bvhBinCount= 16;
+// Alignment of the nodes array
+static const size_t bvhNodeAlignment= 64;
+
+// A BVH node, the bounds of its two children fill a cache line with the children index
+/* If the count of a child is greater than 0, the child is a leaf and m_Child is the index
+ * of its first instance. If the count is 0, m_Child is the index of the child node.
+ * If the count is negative, the child is empty*/
+class alignas(64) BvhNode
+{
+public:
+	float m_MinX[2];
+	float m_MinY[2];
+	float m_MinZ[2];
+	float m_MaxX[2];
+	float m_MaxY[2];
+	float m_MaxZ[2];
+	qint32 m_Child[2];
+	qint32 m_Count[2];
+};
+Q_STATIC_ASSERT(sizeof(BvhNode) == 64);
+
+// An instance bounding box used to build the BVH
+class BvhPrimitive
+{
+public:
+	double m_Min[3];
+	double m_Max[3];
+	double m_Center[3];
+	GLC_3DViewInstance* m_pInstance;
+};
+
+// A range of primitives to store in the given child of the given node
+class BvhBuildTask
+{
+public:
+	int m_Node;
+	int m_Slot;
+	int m_First;
+	int m_Count;
+};
+
+// Predicate true for primitives whose centroid is in a bin lower or equal to the given bin
+class BvhBinPredicate
+{
+public:
+	BvhBinPredicate(int axis, double origin, double scale, int bin)
+	: m_Axis(axis)
+	, m_Origin(origin)
+	, m_Scale(scale)
+	, m_Bin(bin)
+	{}
+
+	bool operator()(const BvhPrimitive& primitive) const
+	{
+		const int bin= static_cast<int>((primitive.m_Center[m_Axis] - m_Origin) * m_Scale);
+		return qBound(0, bin, bvhBinCount - 1) <= m_Bin;
+	}
+
+private:
+	int m_Axis;
+	double m_Origin;
+	double m_Scale;
+	int m_Bin;
+};
+
+// Return the greatest float lower or equal to the given value
+static inline float bvhFloatDown(double value)
+{
+	float subject= static_cast<float>(value);
+	if (static_cast<double>(subject) > value) subject= std::nextafter(subject, -std::numeric_limits<float>::max());
+	return subject;
+}
+
+// Return the lowest float greater or equal to the given value
+static inline float bvhFloatUp(double value)
+{
+	float subject= static_cast<float>(value);
+	if (static_cast<double>(subject) < value) subject= std::nextafter(subject, std::numeric_limits<float>::max());
+	return subject;
+}
+
+// Return the half surface area of the given box
+static inline double bvhHalfArea(const double* pMin, const double* pMax)
+{
+	const double dx= pMax[0] - pMin[0];
+	const double dy= pMax[1] - pMin[1];
+	const double dz= pMax[2] - pMin[2];
+	return dx * dy + dy * dz + dz * dx;
+}
+
+// Set the given child of the given node empty
+static void bvhSetEmptyChild(BvhNode* pNode, int slot)
+{
+	const float maxValue= std::numeric_limits<float>::max();
+	pNode->m_MinX[slot]= pNode->m_MinY[slot]= pNode->m_MinZ[slot]= maxValue;
+	pNode->m_MaxX[slot]= pNode->m_MaxY[slot]= pNode->m_MaxZ[slot]= -maxValue;
+	pNode->m_Child[slot]= 0;
+	pNode->m_Count[slot]= -1;
+}
+
+// Return the split index of the given range of primitives, -1 if the range should be a leaf
+/* The primitives are partitioned around the returned index*/
+static int bvhSahSplit(BvhPrimitive* pPrimitives, int first, int count, const double* pMin, const double* pMax, bool forceSplit)
+{
+	// The split axis is the one with the greatest centroid extent
+	double centerMin[3];
+	double centerMax[3];
+	for (int j= 0; j < 3; ++j)
+	{
+		centerMin[j]= pPrimitives[first].m_Center[j];
+		centerMax[j]= centerMin[j];
+	}
+	for (int i= first + 1; i < (first + count); ++i)
+	{
+		for (int j= 0; j < 3; ++j)
+		{
+			centerMin[j]= qMin(centerMin[j], pPrimitives[i].m_Center[j]);
+			centerMax[j]= qMax(centerMax[j], pPrimitives[i].m_Center[j]);
+		}
+	}
+	int axis= 0;
+	for (int j= 1; j < 3; ++j)
+	{
+		if ((centerMax[j] - centerMin[j]) > (centerMax[axis] - centerMin[axis])) axis= j;
+	}
+	const double extent= centerMax[axis] - centerMin[axis];
+	if (!(extent > 0.0))
+	{
+		// All centroids are equal
+		return forceSplit ? (first + count / 2) : -1;
+	}
+
+	// Fill the bins
+	int binCount[bvhBinCount];
+	double binMin[bvhBinCount][3];
+	double binMax[bvhBinCount][3];
+	for (int b= 0; b < bvhBinCount; ++b)
+	{
+		binCount[b]= 0;
+		for (int j= 0; j < 3; ++j)
+		{
+			binMin[b][j]= std::numeric_limits<double>::max();
+			binMax[b][j]= -std::numeric_limits<double>::max();
+		}
+	}
+	const double binScale= bvhBinCount / extent;
+	for (int i= first; i < (first + count); ++i)
+	{
+		const BvhPrimitive& primitive= pPrimitives[i];
+		const int b= qBound(0, static_cast<int>((primitive.m_Center[axis] - centerMin[axis]) * binScale), bvhBinCount - 1);
+		++binCount[b];
+		for (int j= 0; j < 3; ++j)
+		{
+			binMin[b][j]= qMin(binMin[b][j], primitive.m_Min[j]);
+			binMax[b][j]= qMax(binMax[b][j], primitive.m_Max[j]);
+		}
+	}
+
+	// Area and count of the right side of each split plane
+	double rightArea[bvhBinCount];
+	int rightCount[bvhBinCount];
+	double boxMin[3];
+	double boxMax[3];
+	int accumulatedCount= 0;
+	for (int j= 0; j < 3; ++j)
+	{
+		boxMin[j]= std::numeric_limits<double>::max();
+		boxMax[j]= -std::numeric_limits<double>::max();
+	}
+	for (int b= bvhBinCount - 1; b > 0; --b)
+	{
+		accumulatedCount+= binCount[b];
+		for (int j= 0; j < 3; ++j)
+		{
+			boxMin[j]= qMin(boxMin[j], binMin[b][j]);
+			boxMax[j]= qMax(boxMax[j], binMax[b][j]);
+		}
+		rightCount[b]= accumulatedCount;
+		rightArea[b]= (accumulatedCount > 0) ? bvhHalfArea(boxMin, boxMax) : 0.0;
+	}
+
+	// Best split plane, the split after bin b
+	int bestBin= -1;
+	double bestCost= std::numeric_limits<double>::max();
+	accumulatedCount= 0;
+	for (int j= 0; j < 3; ++j)
+	{
+		boxMin[j]= std::numeric_limits<double>::max();
+		boxMax[j]= -std::numeric_limits<double>::max();
+	}
+	for (int b= 0; b < (bvhBinCount - 1); ++b)
+	{
+		accumulatedCount+= binCount[b];
+		for (int j= 0; j < 3; ++j)
+		{
+			boxMin[j]= qMin(boxMin[j], binMin[b][j]);
+			boxMax[j]= qMax(boxMax[j], binMax[b][j]);
+		}
+		if ((accumulatedCount == 0) || (rightCount[b + 1] == 0)) continue;
+
+		const double cost= bvhHalfArea(boxMin, boxMax) * accumulatedCount + rightArea[b + 1] * rightCount[b + 1];
+		if (cost < bestCost)
+		{
+			bestCost= cost;
+			bestBin= b;
+		}
+	}
+
+	// The cost of a traversal step is the one of an instance test
+	const double parentArea= bvhHalfArea(pMin, pMax);
+	if ((-1 == bestBin) || (!forceSplit && ((parentArea + bestCost) >= (parentArea * count))))
+	{
+		return forceSplit ? (first + count / 2) : -1;
+	}
+
+	const BvhBinPredicate predicate(axis, centerMin[axis], binScale, bestBin);
+	BvhPrimitive* pMiddle= std::partition(pPrimitives + first, pPrimitives + first + count, predicate);
+	const int subject= static_cast<int>(pMiddle - pPrimitives);
+	if ((subject == first) || (subject == (first + count)))
+	{
+		return first + count / 2;
+	}
+
+	return subject;
+}
+
+GLC_Bvh::GLC_Bvh(GLC_3DViewCollection* pCollection)
+: GLC_SpacePartitioning(pCollection)
+, m_pNodes(NULL)
+, m_NodeCount(0)
+, m_Instances()
+, m_CullingPlanes()
+, m_MaximumLeafSize(4)
+{
+
+}
+
+GLC_Bvh::GLC_Bvh(const GLC_Bvh& bvh)
+: GLC_SpacePartitioning(bvh)
+, m_pNodes(NULL)
+, m_NodeCount(0)
+, m_Instances()
+, m_CullingPlanes()
+, m_MaximumLeafSize(bvh.m_MaximumLeafSize)
+{
+
+}
+
+GLC_Bvh::~GLC_Bvh()
+{
+	clear();
+}
+
+GLC_SpacePartitioning* GLC_Bvh::clone()
+{
+	GLC_SpacePartitioning* pSubject= new GLC_Bvh(*this);
+
+	return pSubject;
+}
+
+QList<GLC_3DViewInstance*> GLC_Bvh::listOfIntersectedInstances(const GLC_BoundingBox& bBox)
+{
+	if (NULL == m_pNodes)
+	{
+		updateSpacePartitioning();
+	}
+
+	QList<GLC_3DViewInstance*> subject;
+	const GLC_Point3d& lower= bBox.lowerCorner();
+	const GLC_Point3d& upper= bBox.upperCorner();
+
+	QVector<int> nodeStack;
+	nodeStack.append(0);
+	while (!nodeStack.isEmpty())
+	{
+		const BvhNode& node= m_pNodes[nodeStack.takeLast()];
+		for (int slot= 0; slot < 2; ++slot)
+		{
+			if ((node.m_Count[slot] < 0)
+					|| (node.m_MinX[slot] > upper.x()) || (node.m_MaxX[slot] < lower.x())
+					|| (node.m_MinY[slot] > upper.y()) || (node.m_MaxY[slot] < lower.y())
+					|| (node.m_MinZ[slot] > upper.z()) || (node.m_MaxZ[slot] < lower.z()))
+			{
+				continue;
+			}
+
+			if (node.m_Count[slot] > 0)
+			{
+				const int end= node.m_Child[slot] + node.m_Count[slot];
+				for (int i= node.m_Child[slot]; i < end; ++i)
+				{
+					GLC_3DViewInstance* pInstance= m_Instances.at(i);
+					if (pInstance->boundingBox().intersect(bBox))
+					{
+						subject.append(pInstance);
+					}
+				}
+			}
+			else
+			{
+				nodeStack.append(node.m_Child[slot]);
+			}
+		}
+	}
+
+	return subject;
+}
+
+QList<GLC_3DViewInstance*> GLC_Bvh::listOfInstancesIntersectingRay(const GLC_Line3d& ray)
+{
+	if (NULL == m_pNodes)
+	{
+		updateSpacePartitioning();
+	}
+
+	QList<GLC_3DViewInstance*> subject;
+	const GLC_Point3d origin(ray.startingPoint());
+	const GLC_Vector3d direction(ray.direction());
+	double inverse[3];
+	for (int j= 0; j < 3; ++j)
+	{
+		inverse[j]= (direction.data()[j] != 0.0) ? (1.0 / direction.data()[j]) : 0.0;
+	}
+
+	QVector<int> nodeStack;
+	nodeStack.append(0);
+	while (!nodeStack.isEmpty())
+	{
+		const BvhNode& node= m_pNodes[nodeStack.takeLast()];
+		for (int slot= 0; slot < 2; ++slot)
+		{
+			if (node.m_Count[slot] < 0) continue;
+
+			const double lower[3]= {node.m_MinX[slot], node.m_MinY[slot], node.m_MinZ[slot]};
+			const double upper[3]= {node.m_MaxX[slot], node.m_MaxY[slot], node.m_MaxZ[slot]};
+			double nearDistance= 0.0;
+			double farDistance= std::numeric_limits<double>::max();
+			for (int j= 0; (j < 3) && (nearDistance <= farDistance); ++j)
+			{
+				if (direction.data()[j] == 0.0)
+				{
+					if ((origin.data()[j] < lower[j]) || (origin.data()[j] > upper[j])) farDistance= -1.0;
+				}
+				else
+				{
+					double t1= (lower[j] - origin.data()[j]) * inverse[j];
+					double t2= (upper[j] - origin.data()[j]) * inverse[j];
+					if (t1 > t2) qSwap(t1, t2);
+					nearDistance= qMax(nearDistance, t1);
+					farDistance= qMin(farDistance, t2);
+				}
+			}
+			if (nearDistance > farDistance) continue;
+
+			if (node.m_Count[slot] > 0)
+			{
+				const int end= node.m_Child[slot] + node.m_Count[slot];
+				for (int i= node.m_Child[slot]; i < end; ++i)
+				{
+					GLC_3DViewInstance* pInstance= m_Instances.at(i);
+					if (pInstance->boundingBox().intersectRay(ray))
+					{
+						subject.append(pInstance);
+					}
+				}
+			}
+			else
+			{
+				nodeStack.append(node.m_Child[slot]);
+			}
+		}
+	}
+
+	return subject;
+}
+
+QList<GLC_3DViewInstance*> GLC_Bvh::listOfInstancesInFrustum(const GLC_Frustum& frustum)
+{
+	if (NULL == m_pNodes)
+	{
+		updateSpacePartitioning();
+	}
+
+	QList<GLC_3DViewInstance*> subject;
+	const GLC_FrustumCuller culler(frustum);
+	QVector<int> nodeStack;
+	nodeStack.append(0);
+	while (!nodeStack.isEmpty())
+	{
+		const int nodeIndex= nodeStack.takeLast();
+		const BvhNode& node= m_pNodes[nodeIndex];
+
+		quint8 childLocalisations[2];
+		culler.localizeBoundingBoxes(node.m_MinX, node.m_MinY, node.m_MinZ, node.m_MaxX, node.m_MaxY, node.m_MaxZ, 2, childLocalisations);
+		for (int slot= 0; slot < 2; ++slot)
+		{
+			if (node.m_Count[slot] < 0) continue;
+
+			const GLC_Frustum::Localisation localisation= static_cast<GLC_Frustum::Localisation>(childLocalisations[slot]);
+			if (localisation == GLC_Frustum::OutFrustum) continue;
+
+			if (localisation == GLC_Frustum::InFrustum)
+			{
+				int first, end;
+				childRange(nodeIndex, slot, &first, &end);
+				for (int i= first; i < end; ++i)
+				{
+					subject.append(m_Instances.at(i));
+				}
+			}
+			else if (node.m_Count[slot] > 0)
+			{
+				const int end= node.m_Child[slot] + node.m_Count[slot];
+				for (int i= node.m_Child[slot]; i < end; ++i)
+				{
+					GLC_3DViewInstance* pInstance= m_Instances.at(i);
+					if (culler.localizeBoundingBox(pInstance->boundingBox()) != GLC_Frustum::OutFrustum)
+					{
+						subject.append(pInstance);
+					}
+				}
+			}
+			else
+			{
+				nodeStack.append(node.m_Child[slot]);
+			}
+		}
+	}
+
+	return subject;
+}
+
+void GLC_Bvh::updateViewableInstances(const GLC_Frustum& frustum)
+{
+	if (NULL == m_pNodes)
+	{
+		updateSpacePartitioning();
+	}
+
+	// Each instance is in one leaf, so its viewable flag is set only once
+	GLC_FrustumCuller culler(frustum);
+	QVector<quint8> leafLocalisations;
+	QVector<int> nodeStack;
+	nodeStack.append(0);
+	while (!nodeStack.isEmpty())
+	{
+		const int nodeIndex= nodeStack.takeLast();
+		const BvhNode& node= m_pNodes[nodeIndex];
+
+		// The two children are tested together
+		quint8 childLocalisations[2];
+		culler.localizeBoundingBoxes(node.m_MinX, node.m_MinY, node.m_MinZ, node.m_MaxX, node.m_MaxY, node.m_MaxZ, 2, childLocalisations);
+		for (int slot= 0; slot < 2; ++slot)
+		{
+			if (node.m_Count[slot] < 0) continue;
+
+			const GLC_Frustum::Localisation localisation= static_cast<GLC_Frustum::Localisation>(childLocalisations[slot]);
+			if (localisation == GLC_Frustum::OutFrustum)
+			{
+				int first, end;
+				childRange(nodeIndex, slot, &first, &end);
+				setRangeViewable(first, end, GLC_3DViewInstance::NoViewable);
+			}
+			else if (localisation == GLC_Frustum::InFrustum)
+			{
+				int first, end;
+				childRange(nodeIndex, slot, &first, &end);
+				setRangeViewable(first, end, GLC_3DViewInstance::FullViewable);
+			}
+			else if (node.m_Count[slot] > 0)
+			{
+				const int first= node.m_Child[slot];
+				const int count= node.m_Count[slot];
+				culler.clearBoundingBoxes();
+				for (int i= first; i < (first + count); ++i)
+				{
+					culler.appendBoundingBox(m_Instances.at(i)->boundingBox());
+				}
+				leafLocalisations.resize(count);
+				culler.localizeBoundingBoxes(leafLocalisations.data(), m_CullingPlanes.data() + first);
+				for (int i= 0; i < count; ++i)
+				{
+					updateInstanceViewable(m_Instances.at(first + i), static_cast<GLC_Frustum::Localisation>(leafLocalisations.at(i)), frustum);
+				}
+			}
+			else
+			{
+				nodeStack.append(node.m_Child[slot]);
+			}
+		}
+	}
+}
+
+void GLC_Bvh::updateSpacePartitioning()
+{
+	clear();
+
+	// The bounding box of the instances
+	QVector<BvhPrimitive> primitives;
+	const QList<GLC_3DViewInstance*> instanceList(m_pCollection->instancesHandle());
+	primitives.reserve(instanceList.size());
+	for (GLC_3DViewInstance* pInstance : instanceList)
+	{
+		const GLC_BoundingBox instanceBox(pInstance->boundingBox());
+		if (instanceBox.isEmpty()) continue;
+
+		BvhPrimitive primitive;
+		const GLC_Point3d& lower= instanceBox.lowerCorner();
+		const GLC_Point3d& upper= instanceBox.upperCorner();
+		for (int j= 0; j < 3; ++j)
+		{
+			primitive.m_Min[j]= lower.data()[j];
+			primitive.m_Max[j]= upper.data()[j];
+			primitive.m_Center[j]= (lower.data()[j] + upper.data()[j]) * 0.5;
+		}
+		primitive.m_pInstance= pInstance;
+		primitives.append(primitive);
+	}
+
+	// A binary tree has less inner nodes than leaves, the root node is added
+	const int count= primitives.size();
+	m_pNodes= static_cast<BvhNode*>(qMallocAligned(static_cast<size_t>(qMax(1, count)) * sizeof(BvhNode), bvhNodeAlignment));
+	Q_CHECK_PTR(m_pNodes);
+	m_NodeCount= 1;
+	bvhSetEmptyChild(m_pNodes, 0);
+	bvhSetEmptyChild(m_pNodes, 1);
+
+	// Top down construction without recursion
+	BvhPrimitive* pPrimitives= primitives.data();
+	QVector<BvhBuildTask> taskStack;
+	if (count > 0)
+	{
+		BvhBuildTask rootTask= {0, 0, 0, count};
+		taskStack.append(rootTask);
+	}
+	while (!taskStack.isEmpty())
+	{
+		const BvhBuildTask task= taskStack.takeLast();
+
+		double boxMin[3];
+		double boxMax[3];
+		for (int j= 0; j < 3; ++j)
+		{
+			boxMin[j]= pPrimitives[task.m_First].m_Min[j];
+			boxMax[j]= pPrimitives[task.m_First].m_Max[j];
+		}
+		for (int i= task.m_First + 1; i < (task.m_First + task.m_Count); ++i)
+		{
+			for (int j= 0; j < 3; ++j)
+			{
+				boxMin[j]= qMin(boxMin[j], pPrimitives[i].m_Min[j]);
+				boxMax[j]= qMax(boxMax[j], pPrimitives[i].m_Max[j]);
+			}
+		}
+
+		BvhNode* pNode= m_pNodes + task.m_Node;
+		const int slot= task.m_Slot;
+		pNode->m_MinX[slot]= bvhFloatDown(boxMin[0]);
+		pNode->m_MinY[slot]= bvhFloatDown(boxMin[1]);
+		pNode->m_MinZ[slot]= bvhFloatDown(boxMin[2]);
+		pNode->m_MaxX[slot]= bvhFloatUp(boxMax[0]);
+		pNode->m_MaxY[slot]= bvhFloatUp(boxMax[1]);
+		pNode->m_MaxZ[slot]= bvhFloatUp(boxMax[2]);
+
+		int split= -1;
+		if (task.m_Count > 1)
+		{
+			split= bvhSahSplit(pPrimitives, task.m_First, task.m_Count, boxMin, boxMax, task.m_Count > m_MaximumLeafSize);
+		}
+
+		if (-1 == split)
+		{
+			pNode->m_Child[slot]= task.m_First;
+			pNode->m_Count[slot]= task.m_Count;
+		}
+		else
+		{
+			const int childIndex= m_NodeCount++;
+			Q_ASSERT(childIndex < qMax(1, count));
+			pNode->m_Child[slot]= childIndex;
+			pNode->m_Count[slot]= 0;
+
+			BvhBuildTask rightTask= {childIndex, 1, split, task.m_First + task.m_Count - split};
+			BvhBuildTask leftTask= {childIndex, 0, task.m_First, split - task.m_First};
+			taskStack.append(rightTask);
+			taskStack.append(leftTask);
+		}
+	}
+
+	m_Instances.resize(count);
+	for (int i= 0; i < count; ++i)
+	{
+		m_Instances[i]= pPrimitives[i].m_pInstance;
+	}
+	m_CullingPlanes.fill(0, count);
+}
+
+void GLC_Bvh::clear()
+{
+	qFreeAligned(m_pNodes);
+	m_pNodes= NULL;
+	m_NodeCount= 0;
+	m_Instances.clear();
+	m_CullingPlanes.clear();
+}
+
+void GLC_Bvh::setMaximumLeafSize(int size)
+{
+	m_MaximumLeafSize= qMax(1, size);
+	if (NULL != m_pNodes)
+	{
+		updateSpacePartitioning();
+	}
+}
+
+void GLC_Bvh::childRange(int nodeIndex, int slot, int* pFirst, int* pEnd) const
+{
+	// The instances of a sub tree are contiguous, from its leftmost leaf to its rightmost leaf
+	const BvhNode* pNode= m_pNodes + nodeIndex;
+	int currentSlot= slot;
+	while (0 == pNode->m_Count[currentSlot])
+	{
+		pNode= m_pNodes + pNode->m_Child[currentSlot];
+		currentSlot= 0;
+	}
+	*pFirst= pNode->m_Child[currentSlot];
+
+	pNode= m_pNodes + nodeIndex;
+	currentSlot= slot;
+	while (0 == pNode->m_Count[currentSlot])
+	{
+		pNode= m_pNodes + pNode->m_Child[currentSlot];
+		currentSlot= 1;
+	}
+	*pEnd= pNode->m_Child[currentSlot] + pNode->m_Count[currentSlot];
+}
+
+void GLC_Bvh::setRangeViewable(int first, int end, int flag)
+{
+	for (int i= first; i < end; ++i)
+	{
+		m_Instances.at(i)->setViewable(static_cast<GLC_3DViewInstance::Viewable>(flag));
+	}
+}
+
+void GLC_Bvh::updateInstanceViewable(GLC_3DViewInstance* pInstance, GLC_Frustum::Localisation instanceLocalisation, const GLC_Frustum& frustum)
+{
+	if (instanceLocalisation == GLC_Frustum::OutFrustum)
+	{
+		pInstance->setViewable(GLC_3DViewInstance::NoViewable);
+	}
+	else if (instanceLocalisation == GLC_Frustum::InFrustum)
+	{
+		pInstance->setViewable(GLC_3DViewInstance::FullViewable);
+	}
+	else
+	{
+		pInstance->setViewable(GLC_3DViewInstance::PartialViewable);
+		//Update the geometries viewable property of the instance
+		const GLC_Matrix4x4 instanceMat= pInstance->matrix();
+		const int size= pInstance->numberOfBody();
+		for (int i= 0; i < size; ++i)
+		{
+			// Get the geometry bounding box
+			const GLC_BoundingBox geomBox= pInstance->geomAt(i)->boundingBox();
+			const GLC_Point3d center(instanceMat * geomBox.center());
+			const double radius= geomBox.boundingSphereRadius() * instanceMat.scalingX();
+			const GLC_Frustum::Localisation geomLocalisation= frustum.localizeSphere(center, radius);
+
+			pInstance->setGeomViewable(i, geomLocalisation != GLC_Frustum::OutFrustum);
+		}
+	}
+}
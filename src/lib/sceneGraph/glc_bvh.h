@@ -0,0 +1,145 @@
+/****************************************************************************
+
+ This file is part of the GLC-lib library.
+ Copyright (C) 2005-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ http://glc-lib.sourceforge.net
+
+ GLC-lib is free software; you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation; either version 3 of the License, or
+ (at your option) any later version.
+
+ GLC-lib is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with GLC-lib; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+
+//! \file glc_bvh.h interface for the GLC_Bvh class.
+
+#ifndef GLC_BVH_H_
+#define GLC_BVH_H_
+
+#include <QVector>
+
+#include "glc_spacepartitioning.h"
+#include "../glc_config.h"
+
+class GLC_3DViewInstance;
+class BvhNode;
+
+//////////////////////////////////////////////////////////////////////
+//! \class GLC_Bvh
+/*! \brief GLC_Bvh : represent space partioning implementation with a bounding volume hierarchy */
+
+/*! The hierarchy is built with the surface area heuristic over the instances
+ *  bounding boxes, each instance is referenced by only one leaf.
+ *  Nodes are stored in a flat array of cache line aligned nodes, each node
+ *  holds the bounds of its two children in structure of arrays layout.
+ *  The bounds are stored in float rounded outward.
+ *  Instances with an empty bounding box are not referenced.*/
+//////////////////////////////////////////////////////////////////////
+class GLC_LIB_EXPORT GLC_Bvh : public GLC_SpacePartitioning
+{
+//////////////////////////////////////////////////////////////////////
+/*! @name Constructor / Destructor */
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Create an empty BVH of the given 3D view collection
+	GLC_Bvh(GLC_3DViewCollection*);
+
+	//! Create the BVH from the given BVH
+	/*! The hierarchy is not copied, it is built on first use*/
+	GLC_Bvh(const GLC_Bvh&);
+
+	//! Destructor
+	virtual ~GLC_Bvh();
+
+	virtual GLC_SpacePartitioning* clone();
+
+//@}
+
+//////////////////////////////////////////////////////////////////////
+/*! \name Get Functions*/
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Return the list off instances inside or intersect the given bounding box
+	virtual QList<GLC_3DViewInstance*> listOfIntersectedInstances(const GLC_BoundingBox& bBox);
+
+	//! Return the list off instances whose bounding box is intersected by the given ray
+	virtual QList<GLC_3DViewInstance*> listOfInstancesIntersectingRay(const GLC_Line3d& ray);
+
+	//! Return the list off instances whose bounding box is inside or intersects the given frustum
+	virtual QList<GLC_3DViewInstance*> listOfInstancesInFrustum(const GLC_Frustum& frustum);
+
+	//! Return the number of nodes of this BVH
+	inline int nodeCount() const
+	{return m_NodeCount;}
+
+	//! Return the maximum number of instances in a leaf
+	inline int maximumLeafSize() const
+	{return m_MaximumLeafSize;}
+
+//@}
+//////////////////////////////////////////////////////////////////////
+/*! \name Set Functions*/
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+
+	//! Update the viewable 3d view instance of this BVH from the given frustum
+	virtual void updateViewableInstances(const GLC_Frustum&);
+
+	//! Update this BVH space partionning
+	virtual void updateSpacePartitioning();
+
+	//! Clear the space partionning
+	virtual void clear();
+
+	//! Set the maximum number of instances in a leaf
+	/*! If space partitionning is already done, update it*/
+	void setMaximumLeafSize(int size);
+
+//@}
+
+//////////////////////////////////////////////////////////////////////
+// Private services function
+//////////////////////////////////////////////////////////////////////
+private:
+	//! Return the first and the end instance index of the given node child
+	void childRange(int nodeIndex, int slot, int* pFirst, int* pEnd) const;
+
+	//! Set the viewable flag of the instances of the given range
+	void setRangeViewable(int first, int end, int flag);
+
+	//! Update the viewable flag of the given instance from its localisation in the given frustum
+	static void updateInstanceViewable(GLC_3DViewInstance* pInstance, GLC_Frustum::Localisation localisation, const GLC_Frustum& frustum);
+
+//////////////////////////////////////////////////////////////////////
+// Private members
+//////////////////////////////////////////////////////////////////////
+private:
+	//! The flat array of nodes, the root node is the first one
+	BvhNode* m_pNodes;
+
+	//! The number of nodes
+	int m_NodeCount;
+
+	//! The instances sorted by leaf
+	QVector<GLC_3DViewInstance*> m_Instances;
+
+	//! The plane which has rejected each instance on the previous culling
+	QVector<quint8> m_CullingPlanes;
+
+	//! The maximum number of instances in a leaf
+	int m_MaximumLeafSize;
+};
+
+#endif /* GLC_BVH_H_ */
@@ -0,0 +1,345 @@
+/****************************************************************************
+
+ This file is part of the GLC-lib library.
+ Copyright (C) 2005-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ http://glc-lib.sourceforge.net
+
+ GLC-lib is free software; you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation; either version 3 of the License, or
+ (at your option) any later version.
+
+ GLC-lib is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with GLC-lib; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+
+//! \file glc_lodscheduler.cpp implementation for the GLC_LodScheduler class.
+
+#include "glc_lodscheduler.h"
+#include "glc_3dviewcollection.h"
+#include "glc_3dviewinstance.h"
+#include "../viewport/glc_viewport.h"
+#include "../geometry/glc_mesh.h"
+#include "../glc_renderstatistics.h"
+#include "../glc_state.h"
+
+#include <algorithm>
+#include <limits>
+
+// The effective triangle budget is not lower than this part of the triangle budget
+static const double lodSchedulerMinimumBudgetRatio= 0.01;
+
+// A body whose LOD is scheduled
+class LodSchedulerBody
+{
+public:
+	// The index of the instance LOD values
+	int m_Instance;
+	// The index of the body in its instance
+	int m_Body;
+	// The index of the first LOD of the body in the candidates
+	int m_FirstCandidate;
+	int m_LodCount;
+	// The LOD of the previous schedule, -1 if none
+	int m_PreviousLod;
+	int m_Lod;
+};
+
+// Return the coarsest LOD of the given body whose error is under the given threshold
+static inline int lodSchedulerLod(const LodSchedulerBody& body, const double* pErrors, double threshold)
+{
+	int subject= body.m_LodCount - 1;
+	while ((subject > 0) && (pErrors[body.m_FirstCandidate + subject] > threshold))
+	{
+		--subject;
+	}
+	return subject;
+}
+
+// Return the triangle count of the given bodies with the given threshold
+static unsigned long lodSchedulerTriangleCount(const QVector<LodSchedulerBody>& bodies, const QVector<double>& errors, const QVector<unsigned int>& triangles, double threshold)
+{
+	unsigned long subject= 0;
+	const int count= bodies.size();
+	for (int i= 0; i < count; ++i)
+	{
+		const LodSchedulerBody& body= bodies.at(i);
+		subject+= triangles.at(body.m_FirstCandidate + lodSchedulerLod(body, errors.constData(), threshold));
+	}
+	return subject;
+}
+
+// Return the LOD value of GLC_Geometry::setCurrentLod() of the given LOD index
+static inline int lodSchedulerLodValue(int lod, int lodCount)
+{
+	return qMin(100, (100 * lod + lodCount - 1) / lodCount);
+}
+
+GLC_LodScheduler::GLC_LodScheduler(unsigned long triangleBudget)
+: m_TriangleBudget(triangleBudget)
+, m_EffectiveTriangleBudget(triangleBudget)
+, m_FrameTimeBudget(0.0)
+, m_TargetScreenSpaceError(1.0)
+, m_Hysteresis(0.25)
+, m_ScreenSpaceErrorThreshold(0.0)
+, m_ScheduledTriangleCount(0)
+, m_PreviousLods()
+{
+
+}
+
+GLC_LodScheduler::~GLC_LodScheduler()
+{
+
+}
+
+void GLC_LodScheduler::schedule(GLC_3DViewCollection* pCollection, const GLC_Viewport& viewport)
+{
+	Q_ASSERT(NULL != pCollection);
+
+	const GLC_Camera* pCamera= viewport.cameraHandle();
+	const GLC_Point3d eye(pCamera->eye());
+	const double orthoCover= pCamera->distEyeTarget() * viewport.viewTangent();
+	const double viewHeight= static_cast<double>(viewport.viewVSize());
+	const bool pixelCulling= GLC_State::isPixelCullingActivated();
+	const double pixelCullingRatio= viewport.minimumStaticPixelCullingRatio();
+	const bool showState= pCollection->showState();
+
+	// Collect the LOD candidates of the viewable bodies
+	QVector<GLC_3DViewInstance*> instances;
+	QVector<QVector<int> > lodValues;
+	QVector<LodSchedulerBody> bodies;
+	QVector<double> errors;
+	QVector<unsigned int> triangles;
+	unsigned long fixedTriangleCount= 0;
+
+	const QList<GLC_3DViewInstance*> instanceList(pCollection->instancesHandle());
+	const int instanceCount= instanceList.count();
+	for (int i= 0; i < instanceCount; ++i)
+	{
+		GLC_3DViewInstance* pInstance= instanceList.at(i);
+		if ((pInstance->viewableFlag() == GLC_3DViewInstance::NoViewable) || (pInstance->isVisible() != showState)) continue;
+
+		const int bodyCount= pInstance->numberOfBody();
+		if (0 == bodyCount) continue;
+
+		const GLC_Matrix4x4& matrix= pInstance->matrix();
+		const double scaling= qMax(qMax(matrix.scalingX(), matrix.scalingY()), matrix.scalingZ());
+		const int instanceIndex= instances.size();
+		instances.append(pInstance);
+		lodValues.append(QVector<int>(bodyCount, 0));
+		QVector<int>& values= lodValues.last();
+
+		const bool fullViewable= (pInstance->viewableFlag() == GLC_3DViewInstance::FullViewable);
+		for (int body= 0; body < bodyCount; ++body)
+		{
+			if (!fullViewable && !pInstance->isGeomViewable(body)) continue;
+
+			GLC_Geometry* pGeom= pInstance->geomAt(body);
+			const GLC_BoundingBox& box= pGeom->boundingBox();
+			const double diameter= box.boundingSphereRadius() * 2.0 * scaling;
+			double cover= orthoCover;
+			if (!viewport.useOrtho())
+			{
+				cover= (matrix * box.center() - eye).length() * viewport.viewTangent();
+			}
+			cover= qMax(cover, std::numeric_limits<double>::min());
+
+			// Same pixel culling than GLC_3DViewInstance::choseLod()
+			if (pixelCulling && ((diameter / cover * 100.0) < pixelCullingRatio))
+			{
+				values[body]= 110;
+				continue;
+			}
+
+			GLC_Mesh* pMesh= dynamic_cast<GLC_Mesh*>(pGeom);
+			const int lodCount= (NULL != pMesh) ? pMesh->lodCount() : 0;
+			if (lodCount < 2)
+			{
+				fixedTriangleCount+= pGeom->faceCount(0);
+				continue;
+			}
+
+			LodSchedulerBody schedulerBody;
+			schedulerBody.m_Instance= instanceIndex;
+			schedulerBody.m_Body= body;
+			schedulerBody.m_FirstCandidate= errors.size();
+			schedulerBody.m_LodCount= lodCount;
+			schedulerBody.m_PreviousLod= m_PreviousLods.value(qMakePair(pInstance->id(), body), -1);
+			if (schedulerBody.m_PreviousLod >= lodCount) schedulerBody.m_PreviousLod= -1;
+			schedulerBody.m_Lod= 0;
+
+			bool useAccuracy= true;
+			for (int lod= 1; (lod < lodCount) && useAccuracy; ++lod)
+			{
+				useAccuracy= pMesh->containsLod(lod) && (pMesh->getLodAccuracy(lod) > 0.0);
+			}
+
+			const double pixelsByUnit= viewHeight / cover;
+			const unsigned int finestTriangleCount= qMax(1u, pMesh->faceCount(0));
+			double previousError= 0.0;
+			for (int lod= 0; lod < lodCount; ++lod)
+			{
+				const unsigned int triangleCount= pMesh->faceCount(lod);
+				double error= 0.0;
+				if (lod > 0)
+				{
+					if (useAccuracy)
+					{
+						error= pMesh->getLodAccuracy(lod) * scaling * pixelsByUnit;
+					}
+					else
+					{
+						const double removedRatio= 1.0 - static_cast<double>(triangleCount) / static_cast<double>(finestTriangleCount);
+						error= diameter * pixelsByUnit * qMax(0.0, removedRatio);
+					}
+				}
+				// The error doesn't decrease with coarser LOD
+				previousError= qMax(previousError, error);
+				errors.append(previousError);
+				triangles.append(triangleCount);
+			}
+			bodies.append(schedulerBody);
+		}
+	}
+
+	// Search the smallest threshold fitting in the budget
+	const unsigned long availableTriangleCount= (m_EffectiveTriangleBudget > fixedTriangleCount) ? (m_EffectiveTriangleBudget - fixedTriangleCount) : 0;
+	double threshold= m_TargetScreenSpaceError;
+	if (lodSchedulerTriangleCount(bodies, errors, triangles, threshold) > availableTriangleCount)
+	{
+		QVector<double> thresholds(errors);
+		std::sort(thresholds.begin(), thresholds.end());
+		thresholds.erase(std::unique(thresholds.begin(), thresholds.end()), thresholds.end());
+		QVector<double>::iterator iFirst= std::upper_bound(thresholds.begin(), thresholds.end(), m_TargetScreenSpaceError);
+		int lower= static_cast<int>(iFirst - thresholds.begin());
+		int upper= thresholds.size() - 1;
+		if (lower > upper)
+		{
+			threshold= thresholds.last();
+		}
+		else
+		{
+			// The triangle count decreases when the threshold increases
+			while (lower < upper)
+			{
+				const int middle= (lower + upper) / 2;
+				if (lodSchedulerTriangleCount(bodies, errors, triangles, thresholds.at(middle)) > availableTriangleCount)
+				{
+					lower= middle + 1;
+				}
+				else
+				{
+					upper= middle;
+				}
+			}
+			threshold= thresholds.at(lower);
+		}
+	}
+
+	// Choose the LOD with hysteresis
+	const double* pErrors= errors.constData();
+	const double coarserThreshold= threshold * (1.0 - m_Hysteresis);
+	const int bodyCount= bodies.size();
+	unsigned long triangleCount= fixedTriangleCount;
+	for (int i= 0; i < bodyCount; ++i)
+	{
+		LodSchedulerBody& body= bodies[i];
+		body.m_Lod= lodSchedulerLod(body, pErrors, threshold);
+		if ((body.m_PreviousLod >= 0) && (body.m_Lod >= body.m_PreviousLod))
+		{
+			body.m_Lod= qMax(body.m_PreviousLod, lodSchedulerLod(body, pErrors, coarserThreshold));
+		}
+		triangleCount+= triangles.at(body.m_FirstCandidate + body.m_Lod);
+	}
+	if (triangleCount > qMax(m_EffectiveTriangleBudget, fixedTriangleCount))
+	{
+		// The previous LOD don't fit in the budget
+		triangleCount= fixedTriangleCount;
+		for (int i= 0; i < bodyCount; ++i)
+		{
+			LodSchedulerBody& body= bodies[i];
+			body.m_Lod= lodSchedulerLod(body, pErrors, threshold);
+			triangleCount+= triangles.at(body.m_FirstCandidate + body.m_Lod);
+		}
+	}
+
+	// Set the LOD values of the instances
+	m_PreviousLods.clear();
+	QVector<unsigned int> lodCount;
+	for (int i= 0; i < bodyCount; ++i)
+	{
+		const LodSchedulerBody& body= bodies.at(i);
+		lodValues[body.m_Instance][body.m_Body]= lodSchedulerLodValue(body.m_Lod, body.m_LodCount);
+		m_PreviousLods.insert(qMakePair(instances.at(body.m_Instance)->id(), body.m_Body), body.m_Lod);
+		if (lodCount.size() <= body.m_Lod) lodCount.resize(body.m_Lod + 1);
+		++lodCount[body.m_Lod];
+	}
+	const int scheduledInstanceCount= instances.size();
+	for (int i= 0; i < scheduledInstanceCount; ++i)
+	{
+		instances.at(i)->setScheduledLodValues(lodValues.at(i));
+	}
+
+	m_ScreenSpaceErrorThreshold= threshold;
+	m_ScheduledTriangleCount= triangleCount;
+	GLC_RenderStatistics::setLodSchedule(m_EffectiveTriangleBudget, triangleCount, threshold, lodCount);
+}
+
+void GLC_LodScheduler::clearSchedule(GLC_3DViewCollection* pCollection)
+{
+	Q_ASSERT(NULL != pCollection);
+	const QList<GLC_3DViewInstance*> instanceList(pCollection->instancesHandle());
+	const int count= instanceList.count();
+	for (int i= 0; i < count; ++i)
+	{
+		instanceList.at(i)->setScheduledLodValues(QVector<int>());
+	}
+	clearHistory();
+}
+
+void GLC_LodScheduler::clearHistory()
+{
+	m_PreviousLods.clear();
+}
+
+void GLC_LodScheduler::setTriangleBudget(unsigned long triangleBudget)
+{
+	m_TriangleBudget= triangleBudget;
+	m_EffectiveTriangleBudget= triangleBudget;
+}
+
+void GLC_LodScheduler::setFrameTimeBudget(double frameTime)
+{
+	m_FrameTimeBudget= qMax(0.0, frameTime);
+	m_EffectiveTriangleBudget= m_TriangleBudget;
+}
+
+void GLC_LodScheduler::setLastFrameTime(double frameTime)
+{
+	if ((m_FrameTimeBudget > 0.0) && (frameTime > 0.0))
+	{
+		// Damped proportional control, the frame time is supposed linear in the triangle count
+		const double ratio= qBound(0.5, m_FrameTimeBudget / frameTime, 2.0);
+		const double budget= static_cast<double>(m_EffectiveTriangleBudget) * (1.0 + (ratio - 1.0) * 0.5);
+		const double minimumBudget= static_cast<double>(m_TriangleBudget) * lodSchedulerMinimumBudgetRatio;
+		m_EffectiveTriangleBudget= static_cast<unsigned long>(qBound(minimumBudget, budget, static_cast<double>(m_TriangleBudget)));
+	}
+}
+
+void GLC_LodScheduler::setTargetScreenSpaceError(double error)
+{
+	m_TargetScreenSpaceError= qMax(0.0, error);
+}
+
+void GLC_LodScheduler::setHysteresis(double hysteresis)
+{
+	m_Hysteresis= qBound(0.0, hysteresis, 1.0);
+}
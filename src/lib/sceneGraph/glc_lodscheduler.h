@@ -0,0 +1,172 @@
+/****************************************************************************
+
+ This file is part of the GLC-lib library.
+ Copyright (C) 2005-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ http://glc-lib.sourceforge.net
+
+ GLC-lib is free software; you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation; either version 3 of the License, or
+ (at your option) any later version.
+
+ GLC-lib is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with GLC-lib; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+
+//! \file glc_lodscheduler.h interface for the GLC_LodScheduler class.
+
+#ifndef GLC_LODSCHEDULER_H_
+#define GLC_LODSCHEDULER_H_
+
+#include <QHash>
+#include <QPair>
+
+#include "../glc_global.h"
+#include "../glc_config.h"
+
+class GLC_3DViewCollection;
+class GLC_Viewport;
+
+//////////////////////////////////////////////////////////////////////
+//! \class GLC_LodScheduler
+/*! \brief GLC_LodScheduler : Choose the LOD of all viewable bodies under a triangle budget */
+
+/*! Each frame, the LOD candidates of the viewable meshes of a collection are collected
+ *  with their triangle count and their screen space error in pixels. The error of a LOD
+ *  is its accuracy (GLC_Mesh::getLodAccuracy()) projected at the body distance, or if
+ *  the mesh LOD have no accuracy, the body projected diameter weighted by the part of
+ *  the triangles removed by the LOD.
+ *
+ *  A single screen space error threshold is then searched, the smallest one for which
+ *  each body uses its coarsest LOD under the threshold and the total triangle count fits
+ *  in the budget. The threshold is not smaller than the target screen space error.
+ *
+ *  To avoid popping, a body keeps its previous LOD until it is too coarse or until a
+ *  coarser LOD is under the threshold reduced by the hysteresis, if the budget allows it.
+ *
+ *  The triangle budget can be driven by a frame time budget with setLastFrameTime().
+ *  Chosen LOD and budget usage are reported to GLC_RenderStatistics.*/
+//////////////////////////////////////////////////////////////////////
+class GLC_LIB_EXPORT GLC_LodScheduler
+{
+//////////////////////////////////////////////////////////////////////
+/*! @name Constructor / Destructor */
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Construct a LOD scheduler with the given triangle budget
+	explicit GLC_LodScheduler(unsigned long triangleBudget= 2000000);
+
+	//! Destructor
+	~GLC_LodScheduler();
+//@}
+
+//////////////////////////////////////////////////////////////////////
+/*! \name Get Functions*/
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Return the maximum number of triangles of a frame
+	inline unsigned long triangleBudget() const
+	{return m_TriangleBudget;}
+
+	//! Return the triangle budget used by the next schedule
+	/*! It is lower than the triangle budget if the frame time budget is exceeded*/
+	inline unsigned long effectiveTriangleBudget() const
+	{return m_EffectiveTriangleBudget;}
+
+	//! Return the frame time budget in milliseconds, 0 if not used
+	inline double frameTimeBudget() const
+	{return m_FrameTimeBudget;}
+
+	//! Return the target screen space error in pixels
+	inline double targetScreenSpaceError() const
+	{return m_TargetScreenSpaceError;}
+
+	//! Return the hysteresis, the relative error reduction needed to use a coarser LOD
+	inline double hysteresis() const
+	{return m_Hysteresis;}
+
+	//! Return the screen space error threshold in pixels of the last schedule
+	inline double screenSpaceErrorThreshold() const
+	{return m_ScreenSpaceErrorThreshold;}
+
+	//! Return the triangle count of the last schedule
+	inline unsigned long scheduledTriangleCount() const
+	{return m_ScheduledTriangleCount;}
+
+	//! Return the number of bodies with LOD candidates in the last schedule
+	inline int scheduledBodyCount() const
+	{return m_PreviousLods.size();}
+//@}
+
+//////////////////////////////////////////////////////////////////////
+/*! \name Set Functions*/
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Choose the LOD of the viewable bodies of the given collection seen from the given viewport
+	void schedule(GLC_3DViewCollection* pCollection, const GLC_Viewport& viewport);
+
+	//! Remove the schedule of the instances of the given collection
+	void clearSchedule(GLC_3DViewCollection* pCollection);
+
+	//! Forget the LOD chosen by the previous schedule
+	void clearHistory();
+
+	//! Set the maximum number of triangles of a frame
+	void setTriangleBudget(unsigned long triangleBudget);
+
+	//! Set the frame time budget in milliseconds, 0 to not use it
+	void setFrameTimeBudget(double frameTime);
+
+	//! Set the time of the last rendered frame in milliseconds
+	/*! If a frame time budget is used, the effective triangle budget is adapted*/
+	void setLastFrameTime(double frameTime);
+
+	//! Set the target screen space error in pixels
+	void setTargetScreenSpaceError(double error);
+
+	//! Set the hysteresis, between 0 and 1
+	void setHysteresis(double hysteresis);
+//@}
+
+//////////////////////////////////////////////////////////////////////
+// Private members
+//////////////////////////////////////////////////////////////////////
+private:
+	//! The maximum number of triangles of a frame
+	unsigned long m_TriangleBudget;
+
+	//! The triangle budget adapted to the frame time budget
+	unsigned long m_EffectiveTriangleBudget;
+
+	//! The frame time budget in milliseconds
+	double m_FrameTimeBudget;
+
+	//! The target screen space error in pixels
+	double m_TargetScreenSpaceError;
+
+	//! The hysteresis
+	double m_Hysteresis;
+
+	//! The screen space error threshold of the last schedule
+	double m_ScreenSpaceErrorThreshold;
+
+	//! The triangle count of the last schedule
+	unsigned long m_ScheduledTriangleCount;
+
+	//! The LOD index chosen by the last schedule by instance id and body index
+	QHash<QPair<GLC_uint, int>, int> m_PreviousLods;
+
+	Q_DISABLE_COPY(GLC_LodScheduler)
+};
+
+#endif /* GLC_LODSCHEDULER_H_ */
@@ -32,6 +32,8 @@ GLC_Octree::GLC_Octree(GLC_3DViewCollection* pCollection)
 : GLC_SpacePartitioning(pCollection)
 , m_pRootNode(NULL)
 , m_OctreeDepth(m_DefaultOctreeDepth)
+, m_IsLoose(false)
+, m_InstanceNodeHash()
 {
 
 }
@@ -40,6 +42,8 @@ GLC_Octree::GLC_Octree(const GLC_Octree& octree)
 : GLC_SpacePartitioning(octree)
 , m_pRootNode(NULL)
 , m_OctreeDepth(octree.m_OctreeDepth)
+, m_IsLoose(octree.m_IsLoose)
+, m_InstanceNodeHash()
 {
 
 }
@@ -81,22 +85,84 @@ void GLC_Octree::updateViewableInstances(const GLC_Frustum& frustum)
 
 void GLC_Octree::updateSpacePartitioning()
 {
-	delete m_pRootNode;
+	clear();
 	m_pRootNode= new GLC_OctreeNode(m_pCollection->boundingBox(true));
+	m_pRootNode->setLoose(m_IsLoose);
 	// fill the octree
 	QList<GLC_3DViewInstance*> instanceList(m_pCollection->instancesHandle());
 	const int size= instanceList.size();
-	for (int i= 0; i < size; ++i)
+	if (m_IsLoose)
 	{
-		m_pRootNode->addInstance(instanceList.at(i), m_OctreeDepth);
+		m_InstanceNodeHash.reserve(size);
+		for (int i= 0; i < size; ++i)
+		{
+			GLC_3DViewInstance* pInstance= instanceList.at(i);
+			if (!pInstance->boundingBox().isEmpty())
+			{
+				m_InstanceNodeHash.insert(pInstance->id(), m_pRootNode->addLooseInstance(pInstance, m_OctreeDepth));
+			}
+		}
+	}
+	else
+	{
+		for (int i= 0; i < size; ++i)
+		{
+			m_pRootNode->addInstance(instanceList.at(i), m_OctreeDepth);
+		}
+		m_pRootNode->removeEmptyChildren();
 	}
-	m_pRootNode->removeEmptyChildren();
 }
 
 void GLC_Octree::clear()
 {
 	delete m_pRootNode;
 	m_pRootNode= NULL;
+	m_InstanceNodeHash.clear();
+}
+
+void GLC_Octree::updateInstance(GLC_3DViewInstance* pInstance)
+{
+	if (!m_IsLoose || (NULL == m_pRootNode)) return;
+
+	GLC_OctreeNode* pPreviousNode= m_InstanceNodeHash.value(pInstance->id(), NULL);
+	const GLC_BoundingBox instanceBox(pInstance->boundingBox());
+	if (instanceBox.isEmpty())
+	{
+		if (NULL != pPreviousNode)
+		{
+			pPreviousNode->removeInstance(pInstance);
+			m_InstanceNodeHash.remove(pInstance->id());
+		}
+		return;
+	}
+
+	// The instance must stay inside the root node loose bounding box
+	const GLC_BoundingBox& rootBox= m_pRootNode->cullingBoundingBox();
+	const GLC_Point3d& lower= instanceBox.lowerCorner();
+	const GLC_Point3d& upper= instanceBox.upperCorner();
+	if ((lower.x() < rootBox.lowerCorner().x()) || (lower.y() < rootBox.lowerCorner().y()) || (lower.z() < rootBox.lowerCorner().z())
+			|| (upper.x() > rootBox.upperCorner().x()) || (upper.y() > rootBox.upperCorner().y()) || (upper.z() > rootBox.upperCorner().z()))
+	{
+		// The octree is rebuilt on next use
+		clear();
+		return;
+	}
+
+	GLC_OctreeNode* pNode= m_pRootNode->addLooseInstance(pInstance, m_OctreeDepth);
+	if (pNode != pPreviousNode)
+	{
+		if (NULL != pPreviousNode) pPreviousNode->removeInstance(pInstance);
+		m_InstanceNodeHash.insert(pInstance->id(), pNode);
+	}
+}
+
+void GLC_Octree::setLooseMode(bool loose)
+{
+	m_IsLoose= loose;
+	if (NULL != m_pRootNode)
+	{
+		updateSpacePartitioning();
+	}
 }
 
 void GLC_Octree::setDepth(int depth)
@@ -24,7 +24,10 @@
 #ifndef GLC_OCTREE_H_
 #define GLC_OCTREE_H_
 
+#include <QHash>
+
 #include "glc_spacepartitioning.h"
+#include "../glc_global.h"
 #include "../glc_config.h"
 
 class GLC_OctreeNode;
@@ -34,6 +37,11 @@ class GLC_3DViewInstance;
 //////////////////////////////////////////////////////////////////////
 //! \class GLC_Octree
 /*! \brief GLC_Octree : represent space partioning implementation with octree */
+
+/*! In loose mode each instance is stored in a single node whose bounding box,
+ *  enlarged by half its size, contains the instance. A moved instance is then
+ *  relocated by updateInstance() without rebuilding the octree, which is only rebuilt
+ *  when an instance leaves the octree bounds.*/
 //////////////////////////////////////////////////////////////////////
 class GLC_LIB_EXPORT GLC_Octree : public GLC_SpacePartitioning
 {
@@ -66,6 +74,10 @@ public:
 	//! Return the list off instances inside or intersect the given bounding box
 	virtual QList<GLC_3DViewInstance*> listOfIntersectedInstances(const GLC_BoundingBox& bBox);
 
+	//! Return true if this octree is a loose octree
+	inline bool looseModeIsUsed() const
+	{return m_IsLoose;}
+
 //@}
 //////////////////////////////////////////////////////////////////////
 /*! \name Set Functions*/
@@ -82,6 +94,14 @@ public:
 	//! Clear the space partionning
 	virtual void clear();
 
+	//! Update the given instance after a change of its bounding box
+	/*! In loose mode the instance is moved to its new node, else nothing is done*/
+	virtual void updateInstance(GLC_3DViewInstance* pInstance);
+
+	//! Set this octree loose mode
+	/*! If space partitionning is already done, update it*/
+	void setLooseMode(bool loose);
+
 	//! Set this octree depth
 	/*! If space partitionning is already done, update it*/
 	void setDepth(int);
@@ -113,6 +133,12 @@ private:
 	//! Octree depth
 	int m_OctreeDepth;
 
+	//! Flag to know if this octree is a loose octree
+	bool m_IsLoose;
+
+	//! The node of each instance id in loose mode
+	QHash<GLC_uint, GLC_OctreeNode*> m_InstanceNodeHash;
+
 	//! The default octree Depth
 	static int m_DefaultOctreeDepth;
 };
@@ -22,6 +22,7 @@
 //! \file glc_octreenode.cpp implementation for the GLC_OctreeNode class.
 
 #include "glc_octreenode.h"
+#include "../viewport/glc_frustumculler.h"
 
 bool GLC_OctreeNode::m_useBoundingSphere= true;
 
@@ -31,6 +32,9 @@ GLC_OctreeNode::GLC_OctreeNode(const GLC_BoundingBox& boundingBox, GLC_OctreeNod
 , m_Children()
 , m_3DViewInstanceSet()
 , m_Empty(true)
+, m_IsLoose(false)
+, m_LooseBoundingBox()
+, m_CullingPlanes()
 {
 
 
@@ -42,6 +46,9 @@ GLC_OctreeNode::GLC_OctreeNode(const GLC_OctreeNode& octreeNode, GLC_OctreeNode*
 , m_Children()
 , m_3DViewInstanceSet(octreeNode.m_3DViewInstanceSet)
 , m_Empty(octreeNode.m_Empty)
+, m_IsLoose(octreeNode.m_IsLoose)
+, m_LooseBoundingBox(octreeNode.m_LooseBoundingBox)
+, m_CullingPlanes()
 {
 	if (!octreeNode.m_Children.isEmpty())
 	{
@@ -121,6 +128,7 @@ void GLC_OctreeNode::addChildren()
 		upper.setVect(xLower + dX, yLower + dY, zLower + dZ);
 		GLC_BoundingBox box(lower, upper);
 		pOctreeNode= new GLC_OctreeNode(box, this);
+		pOctreeNode->setLoose(m_IsLoose);
 		m_Children.append(pOctreeNode);
 	}
 	{ // Child 2
@@ -128,6 +136,7 @@ void GLC_OctreeNode::addChildren()
 		upper.setVect(xUpper, yLower + dY, zLower + dZ);
 		GLC_BoundingBox box(lower, upper);
 		pOctreeNode= new GLC_OctreeNode(box, this);
+		pOctreeNode->setLoose(m_IsLoose);
 		m_Children.append(pOctreeNode);
 	}
 	{ // Child 3
@@ -135,6 +144,7 @@ void GLC_OctreeNode::addChildren()
 		upper.setVect(xUpper, yUpper, zLower + dZ);
 		GLC_BoundingBox box(lower, upper);
 		pOctreeNode= new GLC_OctreeNode(box, this);
+		pOctreeNode->setLoose(m_IsLoose);
 		m_Children.append(pOctreeNode);
 	}
 	{ // Child 4
@@ -142,6 +152,7 @@ void GLC_OctreeNode::addChildren()
 		upper.setVect(xLower + dX, yUpper, zLower + dZ);
 		GLC_BoundingBox box(lower, upper);
 		pOctreeNode= new GLC_OctreeNode(box, this);
+		pOctreeNode->setLoose(m_IsLoose);
 		m_Children.append(pOctreeNode);
 	}
 	{ // Child 5
@@ -149,6 +160,7 @@ void GLC_OctreeNode::addChildren()
 		upper.setVect(xLower + dX, yLower + dY, zUpper);
 		GLC_BoundingBox box(lower, upper);
 		pOctreeNode= new GLC_OctreeNode(box, this);
+		pOctreeNode->setLoose(m_IsLoose);
 		m_Children.append(pOctreeNode);
 	}
 	{ // Child 6
@@ -156,6 +168,7 @@ void GLC_OctreeNode::addChildren()
 		upper.setVect(xUpper, yLower + dY, zUpper);
 		GLC_BoundingBox box(lower, upper);
 		pOctreeNode= new GLC_OctreeNode(box, this);
+		pOctreeNode->setLoose(m_IsLoose);
 		m_Children.append(pOctreeNode);
 	}
 	{ // Child 7
@@ -163,6 +176,7 @@ void GLC_OctreeNode::addChildren()
 		upper.setVect(xUpper, yUpper, zUpper);
 		GLC_BoundingBox box(lower, upper);
 		pOctreeNode= new GLC_OctreeNode(box, this);
+		pOctreeNode->setLoose(m_IsLoose);
 		m_Children.append(pOctreeNode);
 	}
 	{ // Child 8
@@ -170,6 +184,7 @@ void GLC_OctreeNode::addChildren()
 		upper.setVect(xLower + dX, yUpper, zUpper);
 		GLC_BoundingBox box(lower, upper);
 		pOctreeNode= new GLC_OctreeNode(box, this);
+		pOctreeNode->setLoose(m_IsLoose);
 		m_Children.append(pOctreeNode);
 	}
 }
@@ -221,77 +236,64 @@ void GLC_OctreeNode::addInstance(GLC_3DViewInstance* pInstance, int depth)
 }
 
 
-void GLC_OctreeNode::updateViewableInstances(const GLC_Frustum& frustum, QSet<GLC_3DViewInstance*>* pInstanceSet)
+GLC_OctreeNode* GLC_OctreeNode::addLooseInstance(GLC_3DViewInstance* pInstance, int depth)
 {
+	Q_ASSERT(m_IsLoose);
+	const GLC_BoundingBox instanceBox= pInstance->boundingBox();
+	const GLC_Point3d center(instanceBox.center());
+	const GLC_Vector3d instanceSize(instanceBox.size());
 
-	bool firstCall= false;
-	// Create the set of viewable instance if necessary
-	if (NULL == pInstanceSet)
+	GLC_OctreeNode* pNode= this;
+	pNode->m_Empty= false;
+	while (depth > 0)
 	{
-		pInstanceSet= new QSet<GLC_3DViewInstance*>();
-		firstCall= true;
-	}
+		// The instance fits in the loose box of the child containing its center
+		// if it is not larger than the child
+		const GLC_Vector3d childSize(pNode->m_BoundingBox.size() * 0.5);
+		if ((instanceSize.x() > childSize.x()) || (instanceSize.y() > childSize.y()) || (instanceSize.z() > childSize.z()))
+		{
+			break;
+		}
 
-	// Test the localisation of current octree node
-	GLC_Frustum::Localisation nodeLocalisation= frustum.localizeBoundingBox(m_BoundingBox);
-	if (nodeLocalisation == GLC_Frustum::OutFrustum)
-	{
-		disableViewFlag(pInstanceSet);
-	}
-	else if (nodeLocalisation == GLC_Frustum::InFrustum)
-	{
-		unableViewFlag(pInstanceSet);
-	}
-	else // The current node intersect the frustum
-	{
-		QSet<GLC_3DViewInstance*>::iterator iInstance= m_3DViewInstanceSet.begin();
-		while (m_3DViewInstanceSet.constEnd() != iInstance)
+		if (pNode->m_Children.isEmpty())
 		{
-			// Test if the instances is in the viewable set
-			if (!pInstanceSet->contains(*iInstance))
-			{
-				GLC_3DViewInstance* pCurrentInstance= (*iInstance);
-				// Test the localisation of the current instance
-				GLC_Frustum::Localisation instanceLocalisation= frustum.localizeBoundingBox(pCurrentInstance->boundingBox());
+			pNode->addChildren();
+		}
 
-				if (instanceLocalisation == GLC_Frustum::OutFrustum)
-				{
-					pCurrentInstance->setViewable(GLC_3DViewInstance::NoViewable);
-				}
-				else if (instanceLocalisation == GLC_Frustum::InFrustum)
-				{
-					pInstanceSet->insert(pCurrentInstance);
-					pCurrentInstance->setViewable(GLC_3DViewInstance::FullViewable);
-				}
-				else
-				{
-					pInstanceSet->insert(pCurrentInstance);
-					pCurrentInstance->setViewable(GLC_3DViewInstance::PartialViewable);
-					//Update the geometries viewable property of the instance
-					GLC_Matrix4x4 instanceMat= pCurrentInstance->matrix();
-					const int size= pCurrentInstance->numberOfBody();
-					for (int i= 0; i < size; ++i)
-					{
-						// Get the geometry bounding box
-						GLC_BoundingBox geomBox= pCurrentInstance->geomAt(i)->boundingBox();
-						GLC_Point3d center(instanceMat * geomBox.center());
-						double radius= geomBox.boundingSphereRadius() * instanceMat.scalingX();
-						GLC_Frustum::Localisation geomLocalisation= frustum.localizeSphere(center, radius);
+		// Children order is the one of addChildren()
+		const GLC_Point3d nodeCenter(pNode->m_BoundingBox.center());
+		const bool upperX= center.x() >= nodeCenter.x();
+		const bool upperY= center.y() >= nodeCenter.y();
+		const bool upperZ= center.z() >= nodeCenter.z();
+		int childIndex= upperY ? (upperX ? 2 : 3) : (upperX ? 1 : 0);
+		if (upperZ) childIndex+= 4;
+
+		pNode= pNode->m_Children.at(childIndex);
+		pNode->m_Empty= false;
+		--depth;
+	}
+	pNode->m_3DViewInstanceSet.insert(pInstance);
 
-						pCurrentInstance->setGeomViewable(i, geomLocalisation != GLC_Frustum::OutFrustum);
-					}
-				}
-			}
+	return pNode;
+}
 
-			++iInstance;
-		}
-		const int size= m_Children.size();
-		for (int i= 0; i < size; ++i)
-		{
-			m_Children.at(i)->updateViewableInstances(frustum, pInstanceSet);
-		}
+void GLC_OctreeNode::removeInstance(GLC_3DViewInstance* pInstance)
+{
+	m_3DViewInstanceSet.remove(pInstance);
+}
+
+void GLC_OctreeNode::updateViewableInstances(const GLC_Frustum& frustum, QSet<GLC_3DViewInstance*>* pInstanceSet)
+{
+	GLC_FrustumCuller culler(frustum);
+	if (NULL == pInstanceSet)
+	{
+		QSet<GLC_3DViewInstance*> instanceSet;
+		updateViewableInstances(&culler, &instanceSet);
+	}
+	else
+	{
+		updateViewableInstances(&culler, pInstanceSet);
 	}
-	if (firstCall) delete pInstanceSet;
 }
 
 
@@ -329,11 +331,122 @@ void GLC_OctreeNode::removeEmptyChildren()
 	}
 }
 
+void GLC_OctreeNode::setLoose(bool loose)
+{
+	Q_ASSERT(m_Children.isEmpty());
+	m_IsLoose= loose;
+	if (m_IsLoose && !m_BoundingBox.isEmpty())
+	{
+		const GLC_Vector3d halfSize(m_BoundingBox.size() * 0.5);
+		m_LooseBoundingBox= GLC_BoundingBox(m_BoundingBox.lowerCorner() - halfSize, m_BoundingBox.upperCorner() + halfSize);
+	}
+	else
+	{
+		m_LooseBoundingBox= m_BoundingBox;
+	}
+}
+
 void GLC_OctreeNode::useBoundingSphereIntersection(bool use)
 {
 	m_useBoundingSphere= use;
 }
 
+void GLC_OctreeNode::updateViewableInstances(GLC_FrustumCuller* pCuller, QSet<GLC_3DViewInstance*>* pInstanceSet)
+{
+	// Test the localisation of current octree node
+	GLC_Frustum::Localisation nodeLocalisation= pCuller->localizeBoundingBox(cullingBoundingBox());
+	if (nodeLocalisation == GLC_Frustum::OutFrustum)
+	{
+		disableViewFlag(pInstanceSet);
+	}
+	else if (nodeLocalisation == GLC_Frustum::InFrustum)
+	{
+		unableViewFlag(pInstanceSet);
+	}
+	else // The current node intersect the frustum
+	{
+		// Pack the bounding boxes of the instances which are not in the viewable set
+		const int setSize= m_3DViewInstanceSet.size();
+		if (m_CullingPlanes.size() != setSize)
+		{
+			m_CullingPlanes.fill(0, setSize);
+		}
+		QVector<GLC_3DViewInstance*> instances;
+		QVector<int> setIndexes;
+		instances.reserve(setSize);
+		setIndexes.reserve(setSize);
+		pCuller->clearBoundingBoxes();
+		int setIndex= 0;
+		QSet<GLC_3DViewInstance*>::iterator iInstance= m_3DViewInstanceSet.begin();
+		while (m_3DViewInstanceSet.constEnd() != iInstance)
+		{
+			if (!pInstanceSet->contains(*iInstance))
+			{
+				instances.append(*iInstance);
+				setIndexes.append(setIndex);
+				pCuller->appendBoundingBox((*iInstance)->boundingBox());
+			}
+			++setIndex;
+			++iInstance;
+		}
+
+		const int count= instances.size();
+		QVector<quint8> localisations(count);
+		QVector<quint8> coherency(count);
+		for (int i= 0; i < count; ++i)
+		{
+			coherency[i]= m_CullingPlanes.at(setIndexes.at(i));
+		}
+		pCuller->localizeBoundingBoxes(localisations.data(), coherency.data());
+
+		const GLC_Frustum& frustum= pCuller->frustum();
+		for (int i= 0; i < count; ++i)
+		{
+			m_CullingPlanes[setIndexes.at(i)]= coherency.at(i);
+			GLC_3DViewInstance* pCurrentInstance= instances.at(i);
+			const GLC_Frustum::Localisation instanceLocalisation= static_cast<GLC_Frustum::Localisation>(localisations.at(i));
+
+			if (instanceLocalisation == GLC_Frustum::OutFrustum)
+			{
+				pCurrentInstance->setViewable(GLC_3DViewInstance::NoViewable);
+			}
+			else if (instanceLocalisation == GLC_Frustum::InFrustum)
+			{
+				pInstanceSet->insert(pCurrentInstance);
+				pCurrentInstance->setViewable(GLC_3DViewInstance::FullViewable);
+			}
+			else
+			{
+				pInstanceSet->insert(pCurrentInstance);
+				pCurrentInstance->setViewable(GLC_3DViewInstance::PartialViewable);
+				//Update the geometries viewable property of the instance
+				GLC_Matrix4x4 instanceMat= pCurrentInstance->matrix();
+				const int size= pCurrentInstance->numberOfBody();
+				for (int j= 0; j < size; ++j)
+				{
+					// Get the geometry bounding box
+					GLC_BoundingBox geomBox= pCurrentInstance->geomAt(j)->boundingBox();
+					GLC_Point3d center(instanceMat * geomBox.center());
+					double radius= geomBox.boundingSphereRadius() * instanceMat.scalingX();
+					GLC_Frustum::Localisation geomLocalisation= frustum.localizeSphere(center, radius);
+
+					pCurrentInstance->setGeomViewable(j, geomLocalisation != GLC_Frustum::OutFrustum);
+				}
+			}
+		}
+
+		const int size= m_Children.size();
+		for (int i= 0; i < size; ++i)
+		{
+			// Loose octree nodes keep their empty children
+			if (!m_Children.at(i)->isEmpty())
+			{
+				m_Children.at(i)->updateViewableInstances(pCuller, pInstanceSet);
+			}
+		}
+	}
+}
+
 void GLC_OctreeNode::unableViewFlag(QSet<GLC_3DViewInstance*>* pInstanceSet)
 {
 	QSet<GLC_3DViewInstance*>::iterator iInstance= m_3DViewInstanceSet.begin();
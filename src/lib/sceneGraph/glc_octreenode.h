@@ -31,8 +31,10 @@
 #include "../viewport/glc_frustum.h"
 #include <QList>
 #include <QSet>
+#include <QVector>
 
 class GLC_LIB_EXPORT GLC_OctreeNode;
+class GLC_FrustumCuller;
 
 //////////////////////////////////////////////////////////////////////
 //! \class GLC_OctreeNode
@@ -65,6 +67,15 @@ public:
 	inline GLC_BoundingBox& boundingBox()
 	{return m_BoundingBox;}
 
+	//! Return true if this octree node is a loose octree node
+	inline bool isLoose() const
+	{return m_IsLoose;}
+
+	//! Return the bounding box used to cull this octree node
+	/*! The bounding box of a loose node is enlarged by half its size in each direction*/
+	inline const GLC_BoundingBox& cullingBoundingBox() const
+	{return m_IsLoose ? m_LooseBoundingBox : m_BoundingBox;}
+
 	//! Return True if this octree node intersect the bounding box
 	inline bool intersect(const GLC_BoundingBox& boundingBox);
 
@@ -114,6 +125,15 @@ public:
 	//! Add 3d view instance in this octree node branch
 	void addInstance(GLC_3DViewInstance*, int);
 
+	//! Add 3d view instance in a single node of this loose octree node branch and return this node
+	/*! The instance is stored in the deepest node, up to the given depth,
+	 *  whose loose bounding box contains the instance bounding box*/
+	GLC_OctreeNode* addLooseInstance(GLC_3DViewInstance*, int);
+
+	//! Remove the given 3d view instance from this octree node
+	/*! Children of this octree node are not modified*/
+	void removeInstance(GLC_3DViewInstance*);
+
 	//! Update 3d view instances visibility of this octree node branch from the given frustum
 	/*! Viewable 3d view instance are inserted the the given set if exist also the set is created*/
 	void updateViewableInstances(const GLC_Frustum&, QSet<GLC_3DViewInstance*>* pInstanceSet= NULL);
@@ -121,6 +141,10 @@ public:
 	//! Remove empty child octree node from this octree node
 	void removeEmptyChildren();
 
+	//! Set this octree node loose, children inherit of this mode
+	/*! Must be called before adding children*/
+	void setLoose(bool loose);
+
 	//! Set intersection to bounding sphere
 	static void useBoundingSphereIntersection(bool);
 //@}
@@ -129,6 +153,9 @@ public:
 // Private services function
 //////////////////////////////////////////////////////////////////////
 private:
+	//! Update 3d view instances visibility of this octree node branch with the given culler
+	void updateViewableInstances(GLC_FrustumCuller*, QSet<GLC_3DViewInstance*>*);
+
 	//! Unable the node and sub node view flag
 	void unableViewFlag(QSet<GLC_3DViewInstance*>*);
 
@@ -154,6 +181,15 @@ private:
 	//! Flag to know if the node is empty
 	bool m_Empty;
 
+	//! Flag to know if the node is a loose octree node
+	bool m_IsLoose;
+
+	//! Octree node loose bounding box
+	GLC_BoundingBox m_LooseBoundingBox;
+
+	//! The plane which has rejected each instance of the set on the previous culling
+	QVector<quint8> m_CullingPlanes;
+
 	//! Flag to know if intersection is calculated with bounding sphere
 	static bool m_useBoundingSphere;
 
@@ -162,9 +198,9 @@ private:
 bool GLC_OctreeNode::intersect(const GLC_BoundingBox& boundingBox)
 {
 	if (m_useBoundingSphere)
-		return m_BoundingBox.intersectBoundingSphere(boundingBox);
+		return cullingBoundingBox().intersectBoundingSphere(boundingBox);
 	else
-		return m_BoundingBox.intersect(boundingBox);
+		return cullingBoundingBox().intersect(boundingBox);
 }
 
 #endif /* GLC_OCTREENODE_H_ */
@@ -23,6 +23,8 @@
 
 #include "glc_spacepartitioning.h"
 #include "glc_3dviewcollection.h"
+#include "glc_3dviewinstance.h"
+#include "../viewport/glc_frustumculler.h"
 
 #include <QtGlobal>
 
@@ -45,6 +47,47 @@ GLC_SpacePartitioning::~GLC_SpacePartitioning()
 
 }
 
+QList<GLC_3DViewInstance*> GLC_SpacePartitioning::listOfInstancesIntersectingRay(const GLC_Line3d& ray)
+{
+    QList<GLC_3DViewInstance*> subject;
+    const QList<GLC_3DViewInstance*> instanceList(m_pCollection->instancesHandle());
+    const int count= instanceList.count();
+    for (int i= 0; i < count; ++i)
+    {
+        GLC_3DViewInstance* pInstance= instanceList.at(i);
+        if (pInstance->boundingBox().intersectRay(ray))
+        {
+            subject.append(pInstance);
+        }
+    }
+
+    return subject;
+}
+
+QList<GLC_3DViewInstance*> GLC_SpacePartitioning::listOfInstancesInFrustum(const GLC_Frustum& frustum)
+{
+    QList<GLC_3DViewInstance*> subject;
+    const QList<GLC_3DViewInstance*> instanceList(m_pCollection->instancesHandle());
+    const GLC_FrustumCuller culler(frustum);
+    const int count= instanceList.count();
+    for (int i= 0; i < count; ++i)
+    {
+        GLC_3DViewInstance* pInstance= instanceList.at(i);
+        const GLC_BoundingBox& box= pInstance->boundingBox();
+        if (!box.isEmpty() && (culler.localizeBoundingBox(box) != GLC_Frustum::OutFrustum))
+        {
+            subject.append(pInstance);
+        }
+    }
+
+    return subject;
+}
+
+void GLC_SpacePartitioning::updateInstance(GLC_3DViewInstance*)
+{
+
+}
+
 void GLC_SpacePartitioning::set3DViewCollection(GLC_3DViewCollection *pCollection)
 {
     Q_ASSERT(NULL != pCollection);
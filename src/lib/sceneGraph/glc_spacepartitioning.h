@@ -27,6 +27,7 @@
 #include "../glc_config.h"
 #include "../glc_boundingbox.h"
 #include "../viewport/glc_frustum.h"
+#include "../maths/glc_line3d.h"
 
 class GLC_3DViewCollection;
 class GLC_3DViewInstance;
@@ -66,6 +67,13 @@ public:
 	//! Return the list off instances inside or intersect the given bounding box
 	virtual QList<GLC_3DViewInstance*> listOfIntersectedInstances(const GLC_BoundingBox&)= 0;
 
+	//! Return the list off instances whose bounding box is intersected by the given ray
+	/*! The default implementation tests every instance of the collection*/
+	virtual QList<GLC_3DViewInstance*> listOfInstancesIntersectingRay(const GLC_Line3d& ray);
+
+	//! Return the list off instances whose bounding box is inside or intersects the given frustum
+	/*! The default implementation tests every instance of the collection*/
+	virtual QList<GLC_3DViewInstance*> listOfInstancesInFrustum(const GLC_Frustum& frustum);
 
 //@}
 //////////////////////////////////////////////////////////////////////
@@ -83,6 +91,10 @@ public:
 	//! Clear the space partionning
 	virtual void clear()= 0;
 
+	//! Update the given instance after a change of its bounding box
+	/*! The default implementation does nothing, the space partitioning must be updated*/
+	virtual void updateInstance(GLC_3DViewInstance*);
+
     //! Set the collection to use
     void set3DViewCollection(GLC_3DViewCollection* pCollection);
 
@@ -25,6 +25,8 @@
 #include "glc_structinstance.h"
 #include "glc_structreference.h"
 #include "glc_structoccurrence.h"
+#include "glc_worldhandle.h"
+#include "glc_transformhierarchy.h"
 
 // Default constructor
 GLC_StructInstance::GLC_StructInstance(GLC_StructReference* pStructReference)
@@ -183,9 +185,27 @@ GLC_StructInstance::~GLC_StructInstance()
 
 void GLC_StructInstance::updateOccurrencesAbsoluteMatrix()
 {
+	// Occurrences of worlds using a transform hierarchy are updated in one batch per world
+	QList<GLC_TransformHierarchy*> hierarchies;
 	const int occurrenceCount= m_ListOfOccurrences.count();
 	for (int i= 0; i < occurrenceCount; ++i)
 	{
-		m_ListOfOccurrences.at(i)->updateChildrenAbsoluteMatrix();
+		GLC_StructOccurrence* pOccurrence= m_ListOfOccurrences.at(i);
+		GLC_WorldHandle* pWorldHandle= pOccurrence->worldHandle();
+		GLC_TransformHierarchy* pHierarchy= (NULL != pWorldHandle) ? pWorldHandle->transformHierarchyHandle() : NULL;
+		if ((NULL != pHierarchy) && pHierarchy->setDirty(pOccurrence))
+		{
+			if (!hierarchies.contains(pHierarchy)) hierarchies.append(pHierarchy);
+		}
+		else
+		{
+			pOccurrence->updateChildrenAbsoluteMatrix();
+		}
+	}
+
+	const int hierarchyCount= hierarchies.count();
+	for (int i= 0; i < hierarchyCount; ++i)
+	{
+		hierarchies.at(i)->update();
 	}
 }
@@ -26,6 +26,7 @@
 #include "glc_3dviewcollection.h"
 #include "glc_structreference.h"
 #include "glc_worldhandle.h"
+#include "glc_transformhierarchy.h"
 #include "../glc_errorlog.h"
 
 GLC_StructOccurrence::GLC_StructOccurrence()
@@ -41,6 +42,10 @@ GLC_StructOccurrence::GLC_StructOccurrence()
 , m_pRenderProperties(nullptr)
 , m_AutomaticCreationOf3DViewInstance(true)
 , m_pRelativeMatrix(nullptr)
+, m_BoundingBox()
+, m_LocalBoundingBox()
+, m_BoundingBoxIsValid(false)
+, m_LocalBoundingBoxIsValid(false)
 {
 	// Update instance
 	m_pStructInstance->structOccurrenceCreated(this);
@@ -59,6 +64,10 @@ GLC_StructOccurrence::GLC_StructOccurrence(GLC_StructInstance* pStructInstance,
 , m_pRenderProperties(nullptr)
 , m_AutomaticCreationOf3DViewInstance(true)
 , m_pRelativeMatrix(nullptr)
+, m_BoundingBox()
+, m_LocalBoundingBox()
+, m_BoundingBoxIsValid(false)
+, m_LocalBoundingBoxIsValid(false)
 {
 	doCreateOccurrenceFromInstance(shaderId);
 }
@@ -76,6 +85,10 @@ GLC_StructOccurrence::GLC_StructOccurrence(GLC_StructInstance* pStructInstance,
 , m_pRenderProperties(nullptr)
 , m_AutomaticCreationOf3DViewInstance(true)
 , m_pRelativeMatrix(nullptr)
+, m_BoundingBox()
+, m_LocalBoundingBox()
+, m_BoundingBoxIsValid(false)
+, m_LocalBoundingBoxIsValid(false)
 {
 	doCreateOccurrenceFromInstance(shaderId);
 }
@@ -93,6 +106,10 @@ GLC_StructOccurrence::GLC_StructOccurrence(GLC_3DRep* pRep)
 , m_pRenderProperties(nullptr)
 , m_AutomaticCreationOf3DViewInstance(true)
 , m_pRelativeMatrix(nullptr)
+, m_BoundingBox()
+, m_LocalBoundingBox()
+, m_BoundingBoxIsValid(false)
+, m_LocalBoundingBoxIsValid(false)
 {
 	m_pStructInstance= new GLC_StructInstance(pRep);
 
@@ -113,6 +130,10 @@ GLC_StructOccurrence::GLC_StructOccurrence(GLC_3DRep* pRep, GLC_uint id)
 , m_pRenderProperties(nullptr)
 , m_AutomaticCreationOf3DViewInstance(true)
 , m_pRelativeMatrix(nullptr)
+, m_BoundingBox()
+, m_LocalBoundingBox()
+, m_BoundingBoxIsValid(false)
+, m_LocalBoundingBoxIsValid(false)
 {
 	m_pStructInstance= new GLC_StructInstance(pRep);
 
@@ -133,6 +154,10 @@ GLC_StructOccurrence::GLC_StructOccurrence(GLC_WorldHandle* pWorldHandle, const
 , m_pRenderProperties(nullptr)
 , m_AutomaticCreationOf3DViewInstance(structOccurrence.m_AutomaticCreationOf3DViewInstance)
 , m_pRelativeMatrix(nullptr)
+, m_BoundingBox()
+, m_LocalBoundingBox()
+, m_BoundingBoxIsValid(false)
+, m_LocalBoundingBoxIsValid(false)
 {
 	if (shareInstance)
 	{
@@ -178,6 +203,7 @@ GLC_StructOccurrence::GLC_StructOccurrence(GLC_WorldHandle* pWorldHandle, const
         if (nullptr != m_pRenderProperties && this->has3DViewInstance())
 		{
 			m_pWorldHandle->collection()->instanceHandle(id())->setRenderProperties(*m_pRenderProperties);
+			m_pWorldHandle->collection()->invalidateRenderQueue(id());
 			delete m_pRenderProperties;
             m_pRenderProperties= nullptr;
 		}
@@ -430,80 +456,57 @@ bool GLC_StructOccurrence::isVisible() const
 
 GLC_BoundingBox GLC_StructOccurrence::boundingBox() const
 {
-	GLC_BoundingBox boundingBox;
-
-    if (nullptr != m_pWorldHandle)
+	if (!m_BoundingBoxIsValid)
 	{
-		if (has3DViewInstance())
-		{
-			Q_ASSERT(m_pWorldHandle->collection()->contains(id()));
-			boundingBox= m_pWorldHandle->collection()->instanceHandle(id())->boundingBox();
-		}
-		else
+		m_BoundingBox= GLC_BoundingBox();
+		if (nullptr != m_pWorldHandle)
 		{
-			if (hasChild())
+			if (has3DViewInstance())
 			{
-                QList<GLC_StructOccurrence*> childrenList= children();
-				const int size= childrenList.size();
-
+				Q_ASSERT(m_pWorldHandle->collection()->contains(id()));
+				m_BoundingBox= m_pWorldHandle->collection()->instanceHandle(id())->boundingBox();
+			}
+			else
+			{
+				const int size= m_Childs.size();
 				for (int i= 0; i < size; ++i)
 				{
-					boundingBox.combine(childrenList.at(i)->boundingBox());
+					m_BoundingBox.combine(m_Childs.at(i)->boundingBox());
 				}
 			}
 		}
+		m_BoundingBoxIsValid= true;
 	}
 
-    return boundingBox;
+	return m_BoundingBox;
 }
 
 GLC_BoundingBox GLC_StructOccurrence::obbBoundingBox() const
 {
-    GLC_BoundingBox subject;
+	if (!m_LocalBoundingBoxIsValid)
+	{
+		// The local box is only valid together with the absolute one (see invalidateBoundingBox())
+		boundingBox();
+		m_LocalBoundingBox= GLC_BoundingBox();
+		if ((nullptr != m_pWorldHandle) && !has3DViewInstance())
+		{
+			m_LocalBoundingBox= localBoundingBox(GLC_Matrix4x4());
+		}
+		m_LocalBoundingBoxIsValid= true;
+	}
 
-    if (nullptr != m_pWorldHandle)
-    {
-        if (has3DViewInstance())
-        {
-            Q_ASSERT(m_pWorldHandle->collection()->contains(id()));
-            subject= m_pWorldHandle->collection()->instanceHandle(id())->boundingBox();
-        }
-        else
-        {
-            if (hasChild())
-            {
-                const QList<GLC_StructOccurrence*> childrenList(children());
-
-                const bool changePosition= (m_AbsoluteMatrix != GLC_Matrix4x4());
-                if (changePosition)
-                {
-                    const GLC_Matrix4x4 saveMatrix(m_AbsoluteMatrix);
-                    const_cast<GLC_StructOccurrence*>(this)->m_AbsoluteMatrix.setToIdentity();
-                    for (GLC_StructOccurrence* pOcc : childrenList)
-                    {
-                        pOcc->updateChildrenAbsoluteMatrix();
-                        GLC_BoundingBox childBbox(pOcc->boundingBox());
-                        subject.combine(childBbox);
-                    }
-                    const_cast<GLC_StructOccurrence*>(this)->m_AbsoluteMatrix= saveMatrix;
-                    for (GLC_StructOccurrence* pOcc : childrenList)
-                    {
-                        pOcc->updateChildrenAbsoluteMatrix();
-                    }
-                    subject.transform(m_AbsoluteMatrix);
-                }
-                else
-                {
-                    for (GLC_StructOccurrence* pOcc : childrenList)
-                    {
-                        subject.combine(pOcc->boundingBox());
-                    }
-                }
-            }
-        }
-    }
+	GLC_BoundingBox subject;
+	if (has3DViewInstance() || (m_AbsoluteMatrix == GLC_Matrix4x4()))
+	{
+		subject= m_BoundingBox;
+	}
+	else
+	{
+		subject= m_LocalBoundingBox;
+		subject.transform(m_AbsoluteMatrix);
+	}
 
-    return subject;
+	return subject;
 }
 
 unsigned int GLC_StructOccurrence::nodeCount() const
@@ -684,12 +687,29 @@ GLC_StructOccurrence* GLC_StructOccurrence::updateAbsoluteMatrix()
     if ((nullptr != m_pWorldHandle) && m_pWorldHandle->collection()->contains(m_Uid))
 	{
 		m_pWorldHandle->collection()->instanceHandle(m_Uid)->setMatrix(m_AbsoluteMatrix);
+		m_pWorldHandle->collection()->updateInstanceSpacePartitionning(m_Uid);
 	}
+	invalidateBoundingBox();
 	return this;
 }
 
 GLC_StructOccurrence* GLC_StructOccurrence::updateChildrenAbsoluteMatrix()
 {
+	// Use the flattened hierarchy of the world if any, it is rebuilt when the root is updated
+	GLC_TransformHierarchy* pHierarchy= (nullptr != m_pWorldHandle) ? m_pWorldHandle->transformHierarchyHandle() : nullptr;
+	if (nullptr != pHierarchy)
+	{
+		if (!pHierarchy->isValid() && (m_pWorldHandle->rootOccurrence() == this))
+		{
+			pHierarchy->build();
+		}
+		if (pHierarchy->setDirty(this))
+		{
+			pHierarchy->update();
+			return this;
+		}
+	}
+
 	updateAbsoluteMatrix();
 	const int size= m_Childs.size();
 	for (int i= 0; i < size; ++i)
@@ -699,6 +719,21 @@ GLC_StructOccurrence* GLC_StructOccurrence::updateChildrenAbsoluteMatrix()
 	return this;
 }
 
+void GLC_StructOccurrence::invalidateBoundingBox()
+{
+	m_BoundingBoxIsValid= false;
+	m_LocalBoundingBoxIsValid= false;
+
+	// A valid box implies valid boxes in the whole branch, so stop at the first invalid ancestor
+	GLC_StructOccurrence* pParent= m_pParent;
+	while ((nullptr != pParent) && pParent->m_BoundingBoxIsValid)
+	{
+		pParent->m_BoundingBoxIsValid= false;
+		pParent->m_LocalBoundingBoxIsValid= false;
+		pParent= pParent->m_pParent;
+	}
+}
+
 void GLC_StructOccurrence::addChild(GLC_StructOccurrence* pChild)
 {
 	Q_ASSERT(pChild->isOrphan());
@@ -707,6 +742,10 @@ void GLC_StructOccurrence::addChild(GLC_StructOccurrence* pChild)
     pChild->setVisibility(this->isVisible());
 	m_Childs.append(pChild);
 	pChild->m_pParent= this;
+    if (nullptr != m_pWorldHandle)
+	{
+		m_pWorldHandle->invalidateTransformHierarchy();
+	}
     if (nullptr == pChild->m_pWorldHandle)
 	{
 		pChild->setWorldHandle(m_pWorldHandle);
@@ -733,6 +772,10 @@ void GLC_StructOccurrence::insertChild(int index, GLC_StructOccurrence* pChild)
 	// Get occurrence reference
 	m_Childs.insert(index, pChild);
 	pChild->m_pParent= this;
+    if (nullptr != m_pWorldHandle)
+	{
+		m_pWorldHandle->invalidateTransformHierarchy();
+	}
     if (nullptr == pChild->m_pWorldHandle)
 	{
 		pChild->setWorldHandle(m_pWorldHandle);
@@ -783,6 +826,7 @@ bool GLC_StructOccurrence::removeChild(GLC_StructOccurrence* pChild)
 	Q_ASSERT(pChild->m_pParent == this);
     pChild->m_pParent= nullptr;
 	pChild->detach();
+	invalidateBoundingBox();
 
 	return m_Childs.removeOne(pChild);
 }
@@ -821,6 +865,7 @@ bool GLC_StructOccurrence::create3DViewInstance(GLuint shaderId)
 			{
 				m_pWorldHandle->collection()->select(m_Uid);
 			}
+			invalidateBoundingBox();
 		}
 	}
 	return subject;
@@ -830,6 +875,7 @@ bool GLC_StructOccurrence::remove3DViewInstance()
 {
     if (nullptr != m_pWorldHandle)
 	{
+		invalidateBoundingBox();
 		return m_pWorldHandle->collection()->remove(m_Uid);
 	}
 	else return false;
@@ -847,6 +893,7 @@ void GLC_StructOccurrence::setWorldHandle(GLC_WorldHandle* pWorldHandle)
 	}
 
 	m_pWorldHandle= pWorldHandle;
+	invalidateBoundingBox();
 
     if (nullptr != m_pWorldHandle)
 	{
@@ -902,6 +949,7 @@ bool GLC_StructOccurrence::unloadRepresentation()
 
             // Remove this occurence 3DVIew instance
             unloadResult= m_pWorldHandle->collection()->remove(m_Uid);
+            invalidateBoundingBox();
 
             // Check if there is another Occurrence with the same representation
             QSet<GLC_StructOccurrence*> occurrenceSet= pRef->setOfStructOccurrence();
@@ -957,6 +1005,7 @@ void GLC_StructOccurrence::setRenderProperties(const GLC_RenderProperties& rende
 	if (has3DViewInstance())
 	{
 		m_pWorldHandle->collection()->instanceHandle(m_Uid)->setRenderProperties(renderProperties);
+		m_pWorldHandle->collection()->invalidateRenderQueue(m_Uid);
 	}
 
     if (propagate && hasChild())
@@ -1042,6 +1091,7 @@ void GLC_StructOccurrence::makeFlexible(const GLC_Matrix4x4& relativeMatrix, boo
 {
 	delete m_pRelativeMatrix;
 	m_pRelativeMatrix= new GLC_Matrix4x4(relativeMatrix);
+	invalidateBoundingBox();
 
     if (update) updateChildrenAbsoluteMatrix();
 }
@@ -1050,6 +1100,7 @@ void GLC_StructOccurrence::makeRigid(bool update)
 {
 	delete m_pRelativeMatrix;
     m_pRelativeMatrix= nullptr;
+	invalidateBoundingBox();
 
     if (update) updateChildrenAbsoluteMatrix();
 }
@@ -1090,6 +1141,7 @@ void GLC_StructOccurrence::detach()
 		}
 		m_pWorldHandle->removeOccurrence(this);
         m_pWorldHandle= nullptr;
+		invalidateBoundingBox();
 		if (!m_Childs.isEmpty())
 		{
 			const int size= m_Childs.size();
@@ -1134,3 +1186,32 @@ void GLC_StructOccurrence::doCreateOccurrenceFromInstance(GLuint shaderId)
 	// Update instance
 	m_pStructInstance->structOccurrenceCreated(this);
 }
+
+GLC_BoundingBox GLC_StructOccurrence::localBoundingBox(const GLC_Matrix4x4& matrix) const
+{
+	GLC_BoundingBox subject;
+	if (has3DViewInstance())
+	{
+		subject= m_pWorldHandle->collection()->instanceHandle(m_Uid)->representation().boundingBox();
+		subject.transform(matrix);
+	}
+	else
+	{
+		const int size= m_Childs.size();
+		for (int i= 0; i < size; ++i)
+		{
+			const GLC_StructOccurrence* pChild= m_Childs.at(i);
+			GLC_Matrix4x4 childMatrix;
+			if (nullptr == pChild->m_pRelativeMatrix)
+			{
+				childMatrix= pChild->m_pStructInstance->relativeMatrix();
+			}
+			else
+			{
+				childMatrix= *(pChild->m_pRelativeMatrix);
+			}
+			subject.combine(pChild->localBoundingBox(matrix * childMatrix));
+		}
+	}
+	return subject;
+}
@@ -44,6 +44,8 @@ typedef QList<QPair<QString, uint> > GLC_OccurencePath;
 //////////////////////////////////////////////////////////////////////
 class GLC_LIB_EXPORT GLC_StructOccurrence
 {
+	friend class GLC_TransformHierarchy;
+
 //////////////////////////////////////////////////////////////////////
 /*! @name Constructor / Destructor */
 //@{
@@ -165,8 +167,11 @@ public:
 	bool isVisible() const;
 
 	//! Return the occurrence Bounding Box
+	/*! The box is cached and only recomputed after invalidateBoundingBox()*/
 	GLC_BoundingBox boundingBox() const;
 
+	//! Return the occurrence Bounding Box computed in the occurrence frame and then transformed by the absolute matrix
+	/*! The box is cached and only recomputed after invalidateBoundingBox()*/
     GLC_BoundingBox obbBoundingBox() const;
 
 	//! Return the occurrence number of this occurrence
@@ -234,6 +239,10 @@ public:
 	//! Update children obsolute Matrix
     GLC_StructOccurrence* updateChildrenAbsoluteMatrix();
 
+	//! Invalidate the cached bounding boxes of this occurrence and of its ancestors
+	/*! Must be called when the geometry of the representation is modified in place*/
+	void invalidateBoundingBox();
+
 	//! Add Child
 	/*! The new child must be orphan*/
     void addChild(GLC_StructOccurrence*);
@@ -321,6 +330,9 @@ private:
 	//! Create occurrence from instance and given shader id
 	void doCreateOccurrenceFromInstance(GLuint shaderId);
 
+	//! Return the bounding box of this occurrence branch placed with the given matrix
+	GLC_BoundingBox localBoundingBox(const GLC_Matrix4x4& matrix) const;
+
 //////////////////////////////////////////////////////////////////////
 // Private members
 //////////////////////////////////////////////////////////////////////
@@ -361,6 +373,19 @@ private:
 	//! The relative matrix of this occurrence if this occurrence is flexible
 	GLC_Matrix4x4* m_pRelativeMatrix;
 
+	//! The cached bounding box of this occurrence
+	mutable GLC_BoundingBox m_BoundingBox;
+
+	//! The cached bounding box of this occurrence expressed in its own frame
+	mutable GLC_BoundingBox m_LocalBoundingBox;
+
+	//! Flag to know if the cached bounding box is up to date
+	mutable bool m_BoundingBoxIsValid;
+
+	//! Flag to know if the cached local bounding box is up to date
+	/*! Only set when m_BoundingBoxIsValid is also set*/
+	mutable bool m_LocalBoundingBoxIsValid;
+
    Q_DISABLE_COPY(GLC_StructOccurrence)
 };
 
@@ -0,0 +1,317 @@
+/****************************************************************************
+
+ This file is part of the GLC-lib library.
+ Copyright (C) 2005-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ http://glc-lib.sourceforge.net
+
+ GLC-lib is free software; you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation; either version 3 of the License, or
+ (at your option) any later version.
+
+ GLC-lib is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with GLC-lib; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+
+//! \file glc_transformhierarchy.cpp implementation for the GLC_TransformHierarchy class.
+
+#include "glc_transformhierarchy.h"
+#include "glc_worldhandle.h"
+#include "glc_structoccurrence.h"
+#include "glc_structinstance.h"
+#include "glc_3dviewcollection.h"
+#include "glc_3dviewinstance.h"
+#include "glc_spacepartitioning.h"
+
+#include <QtConcurrent>
+#include <algorithm>
+
+// Number of occurrences of a job
+static const int transformHierarchyChunkSize= 1024;
+
+// A chunk of occurrences of the same level
+class TransformHierarchyJob
+{
+public:
+	GLC_TransformHierarchy* m_pHierarchy;
+	GLC_Matrix4x4* m_pRelativeMatrices;
+	GLC_Matrix4x4* m_pAbsoluteMatrices;
+	const int* m_pIndexes;
+	int m_Count;
+};
+
+GLC_TransformHierarchy::GLC_TransformHierarchy(GLC_WorldHandle* pWorldHandle)
+: m_pWorldHandle(pWorldHandle)
+, m_IsValid(false)
+, m_Occurrences()
+, m_Instances()
+, m_Parents()
+, m_FirstChilds()
+, m_ChildCounts()
+, m_LevelOffsets()
+, m_RelativeMatrices()
+, m_AbsoluteMatrices()
+, m_Indexes()
+, m_Dirty()
+, m_DirtyIndexes()
+, m_Updated()
+, m_LastUpdateCount(0)
+{
+	Q_ASSERT(NULL != pWorldHandle);
+}
+
+GLC_TransformHierarchy::~GLC_TransformHierarchy()
+{
+
+}
+
+void GLC_TransformHierarchy::build()
+{
+	m_Occurrences.clear();
+	m_Instances.clear();
+	m_Parents.clear();
+	m_FirstChilds.clear();
+	m_ChildCounts.clear();
+	m_LevelOffsets.clear();
+	m_RelativeMatrices.clear();
+	m_AbsoluteMatrices.clear();
+	m_Indexes.clear();
+	m_DirtyIndexes.clear();
+
+	// Breadth first traversal, the children of an occurrence are appended together
+	m_Occurrences.append(m_pWorldHandle->rootOccurrence());
+	m_Parents.append(-1);
+	m_LevelOffsets.append(0);
+	int levelEnd= 1;
+	for (int i= 0; i < m_Occurrences.size(); ++i)
+	{
+		if (i == levelEnd)
+		{
+			m_LevelOffsets.append(i);
+			levelEnd= m_Occurrences.size();
+		}
+		const GLC_StructOccurrence* pOccurrence= m_Occurrences.at(i);
+		const int childCount= pOccurrence->m_Childs.size();
+		m_FirstChilds.append(m_Occurrences.size());
+		m_ChildCounts.append(childCount);
+		for (int j= 0; j < childCount; ++j)
+		{
+			m_Occurrences.append(pOccurrence->m_Childs.at(j));
+			m_Parents.append(i);
+		}
+	}
+	const int count= m_Occurrences.size();
+	m_LevelOffsets.append(count);
+
+	m_Instances.fill(NULL, count);
+	m_RelativeMatrices.resize(count);
+	m_AbsoluteMatrices.resize(count);
+	m_Indexes.reserve(count);
+	for (int i= 0; i < count; ++i)
+	{
+		GLC_StructOccurrence* pOccurrence= m_Occurrences.at(i);
+		m_Indexes.insert(pOccurrence, i);
+		m_RelativeMatrices[i]= (NULL != pOccurrence->m_pRelativeMatrix) ? *(pOccurrence->m_pRelativeMatrix) : pOccurrence->m_pStructInstance->relativeMatrix();
+		m_AbsoluteMatrices[i]= pOccurrence->m_AbsoluteMatrix;
+	}
+
+	// The root is dirty, so the whole hierarchy is updated
+	m_Dirty.fill(false, count);
+	m_Updated.fill(false, count);
+	m_Dirty.setBit(0);
+	m_DirtyIndexes.append(0);
+	m_IsValid= true;
+}
+
+void GLC_TransformHierarchy::invalidate()
+{
+	m_IsValid= false;
+	m_DirtyIndexes.clear();
+	m_Dirty.fill(false);
+}
+
+bool GLC_TransformHierarchy::setDirty(const GLC_StructOccurrence* pOccurrence)
+{
+	const int index= m_IsValid ? indexOf(pOccurrence) : -1;
+	if (index < 0) return false;
+
+	if (!m_Dirty.testBit(index))
+	{
+		m_Dirty.setBit(index);
+		m_DirtyIndexes.append(index);
+	}
+	return true;
+}
+
+void GLC_TransformHierarchy::update()
+{
+	if (!m_IsValid || m_DirtyIndexes.isEmpty()) return;
+
+	// Indexes are sorted by level
+	std::sort(m_DirtyIndexes.begin(), m_DirtyIndexes.end());
+	const int dirtyCount= m_DirtyIndexes.size();
+	int dirtyIndex= 0;
+
+	QVector<int> updatedIndexes;
+	QVector<int> subTreeRoots;
+	QVector<int> previousLevel;
+	QVector<int> currentLevel;
+	const int levels= levelCount();
+	for (int level= 0; (level < levels) && (!previousLevel.isEmpty() || (dirtyIndex < dirtyCount)); ++level)
+	{
+		currentLevel.clear();
+
+		// The children of the occurrences updated at the previous level
+		const int previousCount= previousLevel.size();
+		for (int i= 0; i < previousCount; ++i)
+		{
+			const int parent= previousLevel.at(i);
+			const int end= m_FirstChilds.at(parent) + m_ChildCounts.at(parent);
+			for (int child= m_FirstChilds.at(parent); child < end; ++child)
+			{
+				m_Updated.setBit(child);
+				currentLevel.append(child);
+			}
+		}
+
+		// The dirty occurrences of this level which are not in an updated sub tree
+		const int levelEnd= m_LevelOffsets.at(level + 1);
+		while ((dirtyIndex < dirtyCount) && (m_DirtyIndexes.at(dirtyIndex) < levelEnd))
+		{
+			const int index= m_DirtyIndexes.at(dirtyIndex);
+			m_Dirty.clearBit(index);
+			if (!m_Updated.testBit(index))
+			{
+				m_Updated.setBit(index);
+				currentLevel.append(index);
+				subTreeRoots.append(index);
+			}
+			++dirtyIndex;
+		}
+
+		// The parents of a level are up to date
+		runJobs(currentLevel, computeJob);
+		updatedIndexes+= currentLevel;
+		previousLevel.swap(currentLevel);
+	}
+	m_DirtyIndexes.clear();
+
+	// The instances of the collection may have changed since the last update
+	GLC_3DViewCollection* pCollection= m_pWorldHandle->collection();
+	const int updatedCount= updatedIndexes.size();
+	for (int i= 0; i < updatedCount; ++i)
+	{
+		const int index= updatedIndexes.at(i);
+		const GLC_uint id= m_Occurrences.at(index)->id();
+		m_Instances[index]= pCollection->contains(id) ? pCollection->instanceHandle(id) : NULL;
+	}
+
+	// Publish the matrices in one batch
+	runJobs(updatedIndexes, publishJob);
+
+	const int subTreeCount= subTreeRoots.size();
+	for (int i= 0; i < subTreeCount; ++i)
+	{
+		m_Occurrences.at(subTreeRoots.at(i))->invalidateBoundingBox();
+	}
+
+	GLC_SpacePartitioning* pSpacePartitioning= pCollection->spacePartitioningHandle();
+	for (int i= 0; i < updatedCount; ++i)
+	{
+		const int index= updatedIndexes.at(i);
+		m_Updated.clearBit(index);
+		if ((NULL != pSpacePartitioning) && (NULL != m_Instances.at(index)))
+		{
+			pSpacePartitioning->updateInstance(m_Instances.at(index));
+		}
+	}
+	// Moved instances may have been or may become occluders
+	if (updatedCount > 0)
+	{
+		pCollection->invalidateOcclusion();
+	}
+	m_LastUpdateCount= updatedCount;
+}
+
+void GLC_TransformHierarchy::runJobs(const QVector<int>& indexes, void (*pFunction)(TransformHierarchyJob&))
+{
+	const int count= indexes.size();
+	if (0 == count) return;
+
+	const int jobCount= (count + transformHierarchyChunkSize - 1) / transformHierarchyChunkSize;
+	QVector<TransformHierarchyJob> jobs(jobCount);
+	GLC_Matrix4x4* pRelativeMatrices= m_RelativeMatrices.data();
+	GLC_Matrix4x4* pAbsoluteMatrices= m_AbsoluteMatrices.data();
+	for (int i= 0; i < jobCount; ++i)
+	{
+		TransformHierarchyJob& job= jobs[i];
+		job.m_pHierarchy= this;
+		job.m_pRelativeMatrices= pRelativeMatrices;
+		job.m_pAbsoluteMatrices= pAbsoluteMatrices;
+		job.m_pIndexes= indexes.constData() + i * transformHierarchyChunkSize;
+		job.m_Count= qMin(transformHierarchyChunkSize, count - i * transformHierarchyChunkSize);
+	}
+
+	if (1 == jobCount)
+	{
+		pFunction(jobs[0]);
+	}
+	else
+	{
+		QtConcurrent::blockingMap(jobs, pFunction);
+	}
+}
+
+void GLC_TransformHierarchy::computeJob(TransformHierarchyJob& job)
+{
+	const GLC_TransformHierarchy* pHierarchy= job.m_pHierarchy;
+	const int* pParents= pHierarchy->m_Parents.constData();
+	GLC_StructOccurrence* const* pOccurrences= pHierarchy->m_Occurrences.constData();
+	GLC_Matrix4x4* pRelativeMatrices= job.m_pRelativeMatrices;
+	GLC_Matrix4x4* pAbsoluteMatrices= job.m_pAbsoluteMatrices;
+	for (int i= 0; i < job.m_Count; ++i)
+	{
+		const int index= job.m_pIndexes[i];
+		const int parent= pParents[index];
+
+		// Relative matrices of a sub tree may have been changed without marking them dirty
+		const GLC_StructOccurrence* pOccurrence= pOccurrences[index];
+		pRelativeMatrices[index]= (NULL != pOccurrence->m_pRelativeMatrix) ? *(pOccurrence->m_pRelativeMatrix) : pOccurrence->m_pStructInstance->relativeMatrix();
+
+		if (parent < 0)
+		{
+			pAbsoluteMatrices[index]= pRelativeMatrices[index];
+		}
+		else
+		{
+			pAbsoluteMatrices[index]= pAbsoluteMatrices[parent] * pRelativeMatrices[index];
+		}
+	}
+}
+
+void GLC_TransformHierarchy::publishJob(TransformHierarchyJob& job)
+{
+	const GLC_TransformHierarchy* pHierarchy= job.m_pHierarchy;
+	GLC_StructOccurrence* const* pOccurrences= pHierarchy->m_Occurrences.constData();
+	GLC_3DViewInstance* const* pInstances= pHierarchy->m_Instances.constData();
+	const GLC_Matrix4x4* pAbsoluteMatrices= job.m_pAbsoluteMatrices;
+	for (int i= 0; i < job.m_Count; ++i)
+	{
+		const int index= job.m_pIndexes[i];
+		GLC_StructOccurrence* pOccurrence= pOccurrences[index];
+		pOccurrence->m_AbsoluteMatrix= pAbsoluteMatrices[index];
+		pOccurrence->m_BoundingBoxIsValid= false;
+		pOccurrence->m_LocalBoundingBoxIsValid= false;
+		if (NULL != pInstances[index])
+		{
+			pInstances[index]->setMatrix(pAbsoluteMatrices[index]);
+		}
+	}
+}
@@ -0,0 +1,194 @@
+/****************************************************************************
+
+ This file is part of the GLC-lib library.
+ Copyright (C) 2005-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ http://glc-lib.sourceforge.net
+
+ GLC-lib is free software; you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation; either version 3 of the License, or
+ (at your option) any later version.
+
+ GLC-lib is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with GLC-lib; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+
+//! \file glc_transformhierarchy.h interface for the GLC_TransformHierarchy class.
+
+#ifndef GLC_TRANSFORMHIERARCHY_H_
+#define GLC_TRANSFORMHIERARCHY_H_
+
+#include <QBitArray>
+#include <QHash>
+#include <QVector>
+
+#include "../maths/glc_matrix4x4.h"
+#include "../glc_global.h"
+#include "../glc_config.h"
+
+class GLC_WorldHandle;
+class GLC_StructOccurrence;
+class GLC_3DViewInstance;
+class TransformHierarchyJob;
+
+//////////////////////////////////////////////////////////////////////
+//! \class GLC_TransformHierarchy
+/*! \brief GLC_TransformHierarchy : Flattened occurrence transform hierarchy of a world */
+
+/*! The occurrences of the world are stored in breadth first order with the index of
+ *  their parent, so the children of an occurrence are contiguous and each level
+ *  of the tree is a range. Relative and absolute matrices are stored in contiguous arrays.
+ *
+ *  Occurrences whose relative matrix has changed are marked in a dirty bitset.
+ *  update() reads again the relative matrices of the dirty sub trees and computes
+ *  their absolute matrices level by level, each level in parallel on the global
+ *  thread pool, then publishes them in one batch to the occurrences and to their
+ *  3D view instances.
+ *
+ *  A structure change of the world invalidates the hierarchy, it is rebuilt by build().*/
+//////////////////////////////////////////////////////////////////////
+class GLC_LIB_EXPORT GLC_TransformHierarchy
+{
+//////////////////////////////////////////////////////////////////////
+/*! @name Constructor / Destructor */
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Construct the transform hierarchy of the given world handle
+	/*! The hierarchy is invalid until build() is called*/
+	explicit GLC_TransformHierarchy(GLC_WorldHandle* pWorldHandle);
+
+	//! Destructor
+	~GLC_TransformHierarchy();
+//@}
+
+//////////////////////////////////////////////////////////////////////
+/*! \name Get Functions*/
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Return true if the hierarchy match the structure of the world
+	inline bool isValid() const
+	{return m_IsValid;}
+
+	//! Return the number of occurrences of the hierarchy
+	inline int count() const
+	{return m_Occurrences.size();}
+
+	//! Return the number of levels of the hierarchy
+	inline int levelCount() const
+	{return qMax(0, m_LevelOffsets.size() - 1);}
+
+	//! Return the index of the given occurrence, -1 if it is not in the hierarchy
+	inline int indexOf(const GLC_StructOccurrence* pOccurrence) const
+	{return m_Indexes.value(pOccurrence, -1);}
+
+	//! Return the parent index of the occurrence of the given index, -1 for the root
+	inline int parentIndex(int index) const
+	{return m_Parents.at(index);}
+
+	//! Return the absolute matrix of the occurrence of the given index
+	inline const GLC_Matrix4x4& absoluteMatrix(int index) const
+	{return m_AbsoluteMatrices.at(index);}
+
+	//! Return true if some occurrences are dirty
+	inline bool isDirty() const
+	{return !m_DirtyIndexes.isEmpty();}
+
+	//! Return the number of occurrences updated by the last update()
+	inline int lastUpdateCount() const
+	{return m_LastUpdateCount;}
+//@}
+
+//////////////////////////////////////////////////////////////////////
+/*! \name Set Functions*/
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Build the hierarchy from the root occurrence of the world, all occurrences are dirty
+	void build();
+
+	//! Invalidate the hierarchy after a structure change of the world
+	void invalidate();
+
+	//! Mark the given occurrence dirty and return true if it is in the hierarchy
+	/*! The absolute matrices of the occurrence and of its children are updated by the next update()*/
+	bool setDirty(const GLC_StructOccurrence* pOccurrence);
+
+	//! Update the absolute matrices of the dirty sub trees and publish them
+	void update();
+//@}
+
+//////////////////////////////////////////////////////////////////////
+// Private services function
+//////////////////////////////////////////////////////////////////////
+private:
+	//! Run the given job on the given indexes, in parallel if there are enough indexes
+	void runJobs(const QVector<int>& indexes, void (*pFunction)(TransformHierarchyJob&));
+
+	//! Compute the absolute matrices of the given job
+	static void computeJob(TransformHierarchyJob& job);
+
+	//! Publish the absolute matrices of the given job to occurrences and instances
+	static void publishJob(TransformHierarchyJob& job);
+
+//////////////////////////////////////////////////////////////////////
+// Private members
+//////////////////////////////////////////////////////////////////////
+private:
+	//! The world handle of this hierarchy
+	GLC_WorldHandle* m_pWorldHandle;
+
+	//! Flag to know if the hierarchy match the world structure
+	bool m_IsValid;
+
+	//! The occurrences in breadth first order
+	QVector<GLC_StructOccurrence*> m_Occurrences;
+
+	//! The 3D view instance of each occurrence, refreshed before each publication
+	QVector<GLC_3DViewInstance*> m_Instances;
+
+	//! The index of the parent of each occurrence, -1 for the root
+	QVector<int> m_Parents;
+
+	//! The index of the first child of each occurrence
+	QVector<int> m_FirstChilds;
+
+	//! The number of children of each occurrence
+	QVector<int> m_ChildCounts;
+
+	//! The first index of each level, the last value is the occurrence count
+	QVector<int> m_LevelOffsets;
+
+	//! The relative matrix of each occurrence, read again for each computed occurrence
+	QVector<GLC_Matrix4x4> m_RelativeMatrices;
+
+	//! The absolute matrix of each occurrence
+	QVector<GLC_Matrix4x4> m_AbsoluteMatrices;
+
+	//! The index of each occurrence
+	QHash<const GLC_StructOccurrence*, int> m_Indexes;
+
+	//! The dirty occurrences bitset
+	QBitArray m_Dirty;
+
+	//! The dirty occurrences indexes
+	QVector<int> m_DirtyIndexes;
+
+	//! The occurrences updated by the current update, reset after each update
+	QBitArray m_Updated;
+
+	//! The number of occurrences updated by the last update
+	int m_LastUpdateCount;
+
+	Q_DISABLE_COPY(GLC_TransformHierarchy)
+};
+
+#endif /* GLC_TRANSFORMHIERARCHY_H_ */
@@ -28,6 +28,7 @@
 
 #include "../glc_selectionevent.h"
 #include "../geometry/glc_mesh.h"
+#include "../geometry/glc_meshsimplifier.h"
 
 GLC_World::GLC_World()
 : m_pWorldHandle(new GLC_WorldHandle())
@@ -124,7 +125,6 @@ void GLC_World::updateSelection(const GLC_SelectionEvent &selectionEvent)
 
 void GLC_World::createSharpEdges(double precision, double angleThreshold)
 {
-    angleThreshold= glc::toRadian(angleThreshold);
     QList<GLC_StructReference*> referenceList= references();
     const int count= referenceList.count();
     for (int i= 0; i < count; ++i)
@@ -148,6 +148,37 @@ void GLC_World::createSharpEdges(double precision, double angleThreshold)
     }
 }
 
+int GLC_World::createLods(const GLC_MeshSimplifier& simplifier)
+{
+    // Meshes shared by several references are simplified once
+    QList<GLC_Mesh*> meshes;
+    QSet<GLC_Mesh*> meshSet;
+    QList<GLC_StructReference*> referenceList= references();
+    const int count= referenceList.count();
+    for (int i= 0; i < count; ++i)
+    {
+        GLC_StructReference* pRef= referenceList.at(i);
+        if (pRef->hasRepresentation())
+        {
+            GLC_3DRep* pRep= dynamic_cast<GLC_3DRep*>(pRef->representationHandle());
+            if (nullptr != pRep)
+            {
+                for (int j= 0; j < pRep->numberOfBody(); ++j)
+                {
+                    GLC_Mesh* pMesh= dynamic_cast<GLC_Mesh*>(pRep->geomAt(j));
+                    if ((nullptr != pMesh) && !meshSet.contains(pMesh))
+                    {
+                        meshSet.insert(pMesh);
+                        meshes.append(pMesh);
+                    }
+                }
+            }
+        }
+    }
+
+    return simplifier.simplify(meshes);
+}
+
 void GLC_World::setUnitFactor(double factor)
 {
     GLC_Matrix4x4 scaleMatrix;
@@ -35,6 +35,7 @@
 #include "../glc_config.h"
 
 class GLC_SelectionEvent;
+class GLC_MeshSimplifier;
 
 //////////////////////////////////////////////////////////////////////
 //! \class GLC_World
@@ -273,6 +274,10 @@ public:
 
     void createSharpEdges(double precision, double angleThreshold);
 
+	//! Generate the LOD chain of the meshes of this world with the given simplifier and return the number of LOD created
+	/*! Meshes are simplified in parallel, meshes which already have LODs are left unchanged*/
+    int createLods(const GLC_MeshSimplifier& simplifier);
+
     void setUnitFactor(double factor);
 //@}
 
@@ -24,6 +24,7 @@
 
 #include "glc_worldhandle.h"
 #include "glc_structreference.h"
+#include "glc_transformhierarchy.h"
 #include "../glc_selectionevent.h"
 
 GLC_WorldHandle::GLC_WorldHandle()
@@ -33,6 +34,7 @@ GLC_WorldHandle::GLC_WorldHandle()
 , m_OccurrenceHash()
 , m_UpVector(glc::Z_AXIS)
 , m_SelectionSet(this)
+, m_pTransformHierarchy(NULL)
 {
     m_pRoot->setWorldHandle(this);
 }
@@ -44,6 +46,7 @@ GLC_WorldHandle::GLC_WorldHandle(GLC_StructOccurrence *pOcc)
     , m_OccurrenceHash()
     , m_UpVector(glc::Z_AXIS)
     , m_SelectionSet(this)
+    , m_pTransformHierarchy(NULL)
 {
     Q_ASSERT(pOcc->isOrphan());
     pOcc->setWorldHandle(this);
@@ -52,6 +55,7 @@ GLC_WorldHandle::GLC_WorldHandle(GLC_StructOccurrence *pOcc)
 GLC_WorldHandle::~GLC_WorldHandle()
 {
     delete m_pRoot;
+    delete m_pTransformHierarchy;
 }
 
 // Return the list of instance
@@ -114,6 +118,7 @@ GLC_StructOccurrence *GLC_WorldHandle::occurrenceFromPath(GLC_OccurencePath path
 void GLC_WorldHandle::replaceRootOccurrence(GLC_StructOccurrence *pOcc)
 {
     Q_ASSERT(pOcc->isOrphan());
+    invalidateTransformHierarchy();
     delete m_pRoot;
     m_pRoot= pOcc;
     m_pRoot->setWorldHandle(this);
@@ -121,6 +126,7 @@ void GLC_WorldHandle::replaceRootOccurrence(GLC_StructOccurrence *pOcc)
 
 GLC_StructOccurrence *GLC_WorldHandle::takeRootOccurrence()
 {
+    invalidateTransformHierarchy();
     GLC_StructOccurrence* pSubject= m_pRoot;
     pSubject->makeOrphan();
 
@@ -135,6 +141,7 @@ void GLC_WorldHandle::addOccurrence(GLC_StructOccurrence* pOccurrence, bool isSe
 {
     Q_ASSERT(!m_OccurrenceHash.contains(pOccurrence->id()));
     m_OccurrenceHash.insert(pOccurrence->id(), pOccurrence);
+    invalidateTransformHierarchy();
     GLC_StructReference* pRef= pOccurrence->structReference();
 	Q_ASSERT(NULL != pRef);
 
@@ -154,6 +161,7 @@ void GLC_WorldHandle::removeOccurrence(GLC_StructOccurrence* pOccurrence)
     m_SelectionSet.remove(pOccurrence);
     // Remove the occurrence from the main occurrence hash table
     m_OccurrenceHash.remove(pOccurrence->id());
+    invalidateTransformHierarchy();
 	// Remove instance representation from the collection
     m_Collection.remove(pOccurrence->id());
 
@@ -164,6 +172,37 @@ void GLC_WorldHandle::removeOccurrence(GLC_StructOccurrence* pOccurrence)
     }
 }
 
+void GLC_WorldHandle::removeAllOccurrences()
+{
+    m_OccurrenceHash.clear();
+    invalidateTransformHierarchy();
+}
+
+void GLC_WorldHandle::setTransformHierarchyUsage(bool usage)
+{
+	if (usage == transformHierarchyIsUsed()) return;
+
+	if (usage)
+	{
+		m_pTransformHierarchy= new GLC_TransformHierarchy(this);
+		m_pTransformHierarchy->build();
+		m_pTransformHierarchy->update();
+	}
+	else
+	{
+		delete m_pTransformHierarchy;
+		m_pTransformHierarchy= NULL;
+	}
+}
+
+void GLC_WorldHandle::invalidateTransformHierarchy()
+{
+	if (NULL != m_pTransformHierarchy)
+	{
+		m_pTransformHierarchy->invalidate();
+	}
+}
+
 void GLC_WorldHandle::select(GLC_uint occurrenceId)
 {
     Q_ASSERT(m_OccurrenceHash.contains(occurrenceId));
@@ -251,6 +290,7 @@ void GLC_WorldHandle::showHideSelected3DViewInstance()
 		GLC_3DViewInstance* pCurrentInstance= selected3dviewInstance.at(i);
 		pCurrentInstance->setVisibility(!pCurrentInstance->isVisible());
 	}
+	m_Collection.invalidateOcclusion();
 }
 
 void GLC_WorldHandle::setSelected3DViewInstanceVisibility(bool isVisible)
@@ -262,6 +302,7 @@ void GLC_WorldHandle::setSelected3DViewInstanceVisibility(bool isVisible)
 		GLC_3DViewInstance* pCurrentInstance= selected3dviewInstance.at(i);
 		pCurrentInstance->setVisibility(isVisible);
     }
+	m_Collection.invalidateOcclusion();
 }
 
 void GLC_WorldHandle::updateSelectedInstanceFromSelectionSet()
@@ -33,6 +33,7 @@
 #include "../glc_config.h"
 
 class GLC_SelectionEvent;
+class GLC_TransformHierarchy;
 
 //////////////////////////////////////////////////////////////////////
 //! \class GLC_WorldHandle
@@ -123,6 +124,14 @@ public:
     //! Return the occurence of the given path
     GLC_StructOccurrence* occurrenceFromPath(GLC_OccurencePath path) const;
 
+	//! Return true if this world handle use a flattened transform hierarchy
+	bool transformHierarchyIsUsed() const
+	{return NULL != m_pTransformHierarchy;}
+
+	//! Return an handle to the transform hierarchy, NULL if it is not used
+	GLC_TransformHierarchy* transformHierarchyHandle() const
+	{return m_pTransformHierarchy;}
+
 //@}
 
 //////////////////////////////////////////////////////////////////////
@@ -151,8 +160,15 @@ public:
     void removeOccurrence(GLC_StructOccurrence* pOccurrence);
 
     //! All Occurrence has been removed
-    void removeAllOccurrences()
-    {m_OccurrenceHash.clear();}
+    void removeAllOccurrences();
+
+	//! Set the usage of a flattened transform hierarchy
+	/*! The hierarchy propagates absolute matrices level by level in parallel.
+	 *  It is invalidated by structure changes and rebuilt when the root occurrence is updated*/
+	void setTransformHierarchyUsage(bool usage);
+
+	//! Invalidate the transform hierarchy after a structure change
+	void invalidateTransformHierarchy();
 
 	//! Set the world Up Vector
     void setUpVector(const GLC_Vector3d& vect)
@@ -218,6 +234,9 @@ private:
 	//! This world selectionSet
 	GLC_SelectionSet m_SelectionSet;
 
+	//! The flattened transform hierarchy, NULL if not used
+	GLC_TransformHierarchy* m_pTransformHierarchy;
+
 private:
     Q_DISABLE_COPY(GLC_WorldHandle)
 };
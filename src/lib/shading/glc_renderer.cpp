@@ -128,6 +128,7 @@ void GLC_Renderer::apply()
 			}
 			++iRender;
 		}
+		m_pCollection->invalidateRenderQueue();
 	}
 }
 
@@ -222,6 +223,7 @@ void GLC_Renderer::propagateRenderProperties(GLC_StructOccurrence *pOcc, const G
         if (apply)
         {
             pOcc->worldHandle()->collection()->instanceHandle(pOcc->id())->setRenderProperties(properties);
+            pOcc->worldHandle()->collection()->invalidateRenderQueue(pOcc->id());
         }
     }
     else if (pOcc->hasChild())
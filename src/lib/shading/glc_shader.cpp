@@ -47,6 +47,7 @@ GLC_Shader::GLC_Shader()
 , m_TextcoordAttributeId(-1)
 , m_ColorAttributeId(-1)
 , m_NormalAttributeId(-1)
+, m_InstanceMatrixAttributeId(-1)
 , m_ModelViewLocationId(-1)
 , m_MvpLocationId(-1)
 , m_InvModelViewLocationId(-1)
@@ -54,6 +55,11 @@ GLC_Shader::GLC_Shader()
 , m_TwosidedEnableStateId(-1)
 , m_LightsEnableStateId(-1)
 , m_ColorMaterialStateId(-1)
+, m_DecodePositionId(-1)
+, m_PositionOffsetId(-1)
+, m_PositionScaleId(-1)
+, m_DecodeNormalId(-1)
+, m_EnableInstancingId(-1)
 , m_LightsPositionId()
 , m_LightsAmbientColorId()
 , m_LightsDiffuseColorId()
@@ -78,12 +84,18 @@ GLC_Shader::GLC_Shader(QFile& vertexShaderFile, QFile& fragmentShaderFile)
 , m_TextcoordAttributeId(-1)
 , m_ColorAttributeId(-1)
 , m_NormalAttributeId(-1)
+, m_InstanceMatrixAttributeId(-1)
 , m_ModelViewLocationId(-1)
 , m_MvpLocationId(-1)
 , m_InvModelViewLocationId(-1)
 , m_EnableLightingId(-1)
 , m_TwosidedEnableStateId(-1)
 , m_LightsEnableStateId(-1)
+, m_DecodePositionId(-1)
+, m_PositionOffsetId(-1)
+, m_PositionScaleId(-1)
+, m_DecodeNormalId(-1)
+, m_EnableInstancingId(-1)
 , m_LightsPositionId()
 , m_LightsAmbientColorId()
 , m_LightsDiffuseColorId()
@@ -109,12 +121,18 @@ GLC_Shader::GLC_Shader(const GLC_Shader& shader)
 , m_TextcoordAttributeId(-1)
 , m_ColorAttributeId(-1)
 , m_NormalAttributeId(-1)
+, m_InstanceMatrixAttributeId(-1)
 , m_ModelViewLocationId(-1)
 , m_MvpLocationId(-1)
 , m_InvModelViewLocationId(-1)
 , m_EnableLightingId(-1)
 , m_TwosidedEnableStateId(-1)
 , m_LightsEnableStateId(-1)
+, m_DecodePositionId(-1)
+, m_PositionOffsetId(-1)
+, m_PositionScaleId(-1)
+, m_DecodeNormalId(-1)
+, m_EnableInstancingId(-1)
 , m_LightsPositionId()
 , m_LightsAmbientColorId()
 , m_LightsDiffuseColorId()
@@ -266,6 +284,7 @@ void GLC_Shader::createAndCompileProgrammShader()
 		//qDebug() << "m_ColorAttributeId " << m_ColorAttributeId;
 		m_NormalAttributeId= m_ProgramShader.attributeLocation("a_normal");
 		//qDebug() << "m_NormalAttributeId " << m_NormalAttributeId;
+		m_InstanceMatrixAttributeId= m_ProgramShader.attributeLocation("a_instance_matrix");
 
 		m_ModelViewLocationId= m_ProgramShader.uniformLocation("modelview_matrix");
 		//qDebug() << "m_ModelViewLocationId " << m_ModelViewLocationId;
@@ -281,6 +300,11 @@ void GLC_Shader::createAndCompileProgrammShader()
 		//qDebug() << "m_LightsEnableStateId " << m_LightsEnableStateId;
         m_ColorMaterialStateId= m_ProgramShader.uniformLocation("enable_color_material");
         //qDebug() << "m_ColorMaterialStateId " << m_ColorMaterialStateId;
+        m_DecodePositionId= m_ProgramShader.uniformLocation("decode_position");
+        m_PositionOffsetId= m_ProgramShader.uniformLocation("position_offset");
+        m_PositionScaleId= m_ProgramShader.uniformLocation("position_scale");
+        m_DecodeNormalId= m_ProgramShader.uniformLocation("decode_normal");
+        m_EnableInstancingId= m_ProgramShader.uniformLocation("enable_instancing");
 		const int size= GLC_Light::maxLightCount();
 		for (int i= (GL_LIGHT0); i < (size + GL_LIGHT0); ++i)
 		{
@@ -106,6 +106,10 @@ public:
 	inline int normalAttributeId() const
 	{return m_NormalAttributeId;}
 
+	//! Return the id of the first column of the instance matrix attribute
+	inline int instanceMatrixAttributeId() const
+	{return m_InstanceMatrixAttributeId;}
+
 	//! Return the number of shader
 	static int shaderCount();
 
@@ -151,6 +155,26 @@ public:
     inline int colorMaterialStateId() const
     {return m_ColorMaterialStateId;}
 
+    //! Return the quantized position decoding state id
+    inline int decodePositionId() const
+    {return m_DecodePositionId;}
+
+    //! Return the quantized position offset id
+    inline int positionOffsetId() const
+    {return m_PositionOffsetId;}
+
+    //! Return the quantized position scale id
+    inline int positionScaleId() const
+    {return m_PositionScaleId;}
+
+    //! Return the octahedral normal decoding state id
+    inline int decodeNormalId() const
+    {return m_DecodeNormalId;}
+
+    //! Return the instancing enable state id
+    inline int enableInstancingId() const
+    {return m_EnableInstancingId;}
+
     //! Return the light position id of the given light id
     inline int lightPositionId(GLenum lightId) const
     {return m_LightsPositionId.value(lightId);}
@@ -288,6 +312,9 @@ private:
 	//! The Normal attribute id
 	int m_NormalAttributeId;
 
+	//! The instance matrix attribute id, the matrix uses 4 consecutive locations
+	int m_InstanceMatrixAttributeId;
+
 	//! The modelView location matrix id
 	int m_ModelViewLocationId;
 
@@ -309,6 +336,21 @@ private:
     //! Color material usage
     int m_ColorMaterialStateId;
 
+    //! Quantized position decoding state id
+    int m_DecodePositionId;
+
+    //! Quantized position offset id
+    int m_PositionOffsetId;
+
+    //! Quantized position scale id
+    int m_PositionScaleId;
+
+    //! Octahedral normal decoding state id
+    int m_DecodeNormalId;
+
+    //! Instancing enable state id
+    int m_EnableInstancingId;
+
 	//! Lights positions id
 	QMap<GLenum, int> m_LightsPositionId;
 
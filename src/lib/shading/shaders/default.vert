@@ -56,6 +56,15 @@ uniform float   rescale_normal_factor;
 uniform vec4    ucp_eqn; // user clip plane equation
 uniform bool    enable_ucp;
 
+// Compressed vertex attributes
+uniform bool    decode_position;    // a_position is quantized in the box of position_offset and position_scale
+uniform vec3    position_offset;
+uniform vec3    position_scale;
+uniform bool    decode_normal;      // a_normal.xy is octahedral encoded in the [0, 1] range
+
+// Instanced rendering
+uniform bool    enable_instancing;  // a_instance_matrix is the model view matrix of the drawn instance
+
 
 // vertex attribute - not all of them may be passed in
 attribute vec4  a_position;          // this attribute is always specified
@@ -63,6 +72,7 @@ attribute vec2  a_textcoord0;        // available if enable_tex[0] is true
 
 attribute vec4  a_color;             // available if !enable_lighting or (enable_lightnig && enable_color_material)
 attribute vec3  a_normal;            // available if xform_normal is set (riquired for lighting)
+attribute mat4  a_instance_matrix;   // available if enable_instancing is true
 
 // varying variables output by the vertex shader
 varying vec2    v_textcoord;
@@ -77,6 +87,18 @@ vec3            n;
 vec4            mat_ambient_color;
 vec4            mat_diffuse_color;
 
+vec3 octahedral_decode(vec2 encoded)
+{
+    vec2 e= encoded * 2.0 - c_one;
+    vec3 v= vec3(e, c_one - abs(e.x) - abs(e.y));
+    if (v.z < c_zero)
+    {
+        vec2 signs= vec2(e.x >= c_zero ? c_one : -c_one, e.y >= c_zero ? c_one : -c_one);
+        v.xy= (c_one - abs(e.yx)) * signs;
+    }
+    return normalize(v);
+}
+
 vec4 lighting_equation(int i)
 {
     vec4    computed_color= vec4(c_zero, c_zero, c_zero, c_zero);
@@ -193,15 +215,30 @@ void main()
 {
     int i, j;
 
+    // Decode compressed vertex attributes
+    vec4 position= a_position;
+    if (decode_position)
+    {
+        position= vec4(position_offset + position_scale * a_position.xyz, c_one);
+    }
+    vec3 normal= decode_normal ? octahedral_decode(a_normal.xy) : a_normal;
+
+    // Place the instance in eye space, the model view matrix is the identity
+    if (enable_instancing)
+    {
+        position= a_instance_matrix * position;
+        normal= normalize(mat3(a_instance_matrix[0].xyz, a_instance_matrix[1].xyz, a_instance_matrix[2].xyz) * normal);
+    }
+
     // do we need to transform p
     if (xform_eye_p)
     {
-        p_eye= modelview_matrix * a_position;
+        p_eye= modelview_matrix * position;
     }
 
     if (enable_lighting)
     {
-        n= inv_modelview_matrix * a_normal;
+        n= inv_modelview_matrix * normal;
         if (rescale_normal)
         {
             n= rescale_normal_factor * n;
@@ -239,7 +276,7 @@ void main()
     v_ucp_factor= enable_ucp ? dot(p_eye, ucp_eqn) : c_zero;
     v_fog_factor= enable_fog ? compute_fog() : c_one;
 
-    gl_Position= mvp_matrix * a_position;
+    gl_Position= mvp_matrix * position;
 }
 
 
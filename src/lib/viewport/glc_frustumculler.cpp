@@ -0,0 +1,307 @@
+/****************************************************************************
+
+ This file is part of the GLC-lib library.
+ Copyright (C) 2005-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ http://glc-lib.sourceforge.net
+
+ GLC-lib is free software; you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation; either version 3 of the License, or
+ (at your option) any later version.
+
+ GLC-lib is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with GLC-lib; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+
+//! \file glc_frustumculler.cpp implementation for the GLC_FrustumCuller class.
+
+#include "glc_frustumculler.h"
+
+#include <cmath>
+#include <limits>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define GLC_FRUSTUMCULLER_AVX
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define GLC_FRUSTUMCULLER_SSE
+#endif
+
+// Return the localisation of a packed box from its out and intersect flags
+static inline quint8 frustumCullerLocalisation(bool isOut, bool isIntersect)
+{
+	if (isOut) return static_cast<quint8>(GLC_Frustum::OutFrustum);
+	else if (isIntersect) return static_cast<quint8>(GLC_Frustum::IntersectFrustum);
+	else return static_cast<quint8>(GLC_Frustum::InFrustum);
+}
+
+// Store the rejecting plane of the boxes rejected for the first time
+static inline void frustumCullerSetCoherency(quint8* pCoherency, int first, int newOutMask, int plane)
+{
+	while (0 != newOutMask)
+	{
+		int lane= 0;
+		while (0 == (newOutMask & (1 << lane))) ++lane;
+		pCoherency[first + lane]= static_cast<quint8>(plane);
+		newOutMask&= ~(1 << lane);
+	}
+}
+
+#if defined(GLC_FRUSTUMCULLER_AVX)
+// Localize 8 packed boxes
+static void frustumCullerLocalize8(const float (*pPlanes)[4], const float* const* ppNear, const float* const* ppFar
+		, int first, quint8* pLocalisation, quint8* pCoherency)
+{
+	const __m256 zero= _mm256_setzero_ps();
+	const int startPlane= (NULL != pCoherency) ? (pCoherency[first] % 6) : 0;
+	int outMask= 0;
+	int intersectMask= 0;
+	for (int k= 0; (k < 6) && (outMask != 0xFF); ++k)
+	{
+		const int p= (startPlane + k) % 6;
+		const __m256 a= _mm256_set1_ps(pPlanes[p][0]);
+		const __m256 b= _mm256_set1_ps(pPlanes[p][1]);
+		const __m256 c= _mm256_set1_ps(pPlanes[p][2]);
+		const __m256 d= _mm256_set1_ps(pPlanes[p][3]);
+
+		// The farthest corner in the plane normal direction is behind the plane
+		const float* const* ppPlaneFar= ppFar + 3 * p;
+		const __m256 farDistance= _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(a, _mm256_loadu_ps(ppPlaneFar[0] + first))
+				, _mm256_mul_ps(b, _mm256_loadu_ps(ppPlaneFar[1] + first)))
+				, _mm256_add_ps(_mm256_mul_ps(c, _mm256_loadu_ps(ppPlaneFar[2] + first)), d));
+		const int planeOutMask= _mm256_movemask_ps(_mm256_cmp_ps(farDistance, zero, _CMP_LT_OQ));
+		if (NULL != pCoherency) frustumCullerSetCoherency(pCoherency, first, planeOutMask & ~outMask, p);
+		outMask|= planeOutMask;
+
+		// The nearest corner is behind the plane
+		const float* const* ppPlaneNear= ppNear + 3 * p;
+		const __m256 nearDistance= _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(a, _mm256_loadu_ps(ppPlaneNear[0] + first))
+				, _mm256_mul_ps(b, _mm256_loadu_ps(ppPlaneNear[1] + first)))
+				, _mm256_add_ps(_mm256_mul_ps(c, _mm256_loadu_ps(ppPlaneNear[2] + first)), d));
+		intersectMask|= _mm256_movemask_ps(_mm256_cmp_ps(nearDistance, zero, _CMP_LT_OQ));
+	}
+
+	for (int lane= 0; lane < 8; ++lane)
+	{
+		pLocalisation[first + lane]= frustumCullerLocalisation(0 != (outMask & (1 << lane)), 0 != (intersectMask & (1 << lane)));
+	}
+}
+#endif
+
+#if defined(GLC_FRUSTUMCULLER_SSE)
+// Localize 4 packed boxes
+static void frustumCullerLocalize4(const float (*pPlanes)[4], const float* const* ppNear, const float* const* ppFar
+		, int first, quint8* pLocalisation, quint8* pCoherency)
+{
+	const __m128 zero= _mm_setzero_ps();
+	const int startPlane= (NULL != pCoherency) ? (pCoherency[first] % 6) : 0;
+	int outMask= 0;
+	int intersectMask= 0;
+	for (int k= 0; (k < 6) && (outMask != 0xF); ++k)
+	{
+		const int p= (startPlane + k) % 6;
+		const __m128 a= _mm_set1_ps(pPlanes[p][0]);
+		const __m128 b= _mm_set1_ps(pPlanes[p][1]);
+		const __m128 c= _mm_set1_ps(pPlanes[p][2]);
+		const __m128 d= _mm_set1_ps(pPlanes[p][3]);
+
+		// The farthest corner in the plane normal direction is behind the plane
+		const float* const* ppPlaneFar= ppFar + 3 * p;
+		const __m128 farDistance= _mm_add_ps(_mm_add_ps(_mm_mul_ps(a, _mm_loadu_ps(ppPlaneFar[0] + first))
+				, _mm_mul_ps(b, _mm_loadu_ps(ppPlaneFar[1] + first)))
+				, _mm_add_ps(_mm_mul_ps(c, _mm_loadu_ps(ppPlaneFar[2] + first)), d));
+		const int planeOutMask= _mm_movemask_ps(_mm_cmplt_ps(farDistance, zero));
+		if (NULL != pCoherency) frustumCullerSetCoherency(pCoherency, first, planeOutMask & ~outMask, p);
+		outMask|= planeOutMask;
+
+		// The nearest corner is behind the plane
+		const float* const* ppPlaneNear= ppNear + 3 * p;
+		const __m128 nearDistance= _mm_add_ps(_mm_add_ps(_mm_mul_ps(a, _mm_loadu_ps(ppPlaneNear[0] + first))
+				, _mm_mul_ps(b, _mm_loadu_ps(ppPlaneNear[1] + first)))
+				, _mm_add_ps(_mm_mul_ps(c, _mm_loadu_ps(ppPlaneNear[2] + first)), d));
+		intersectMask|= _mm_movemask_ps(_mm_cmplt_ps(nearDistance, zero));
+	}
+
+	for (int lane= 0; lane < 4; ++lane)
+	{
+		pLocalisation[first + lane]= frustumCullerLocalisation(0 != (outMask & (1 << lane)), 0 != (intersectMask & (1 << lane)));
+	}
+}
+#endif
+
+GLC_FrustumCuller::GLC_FrustumCuller(const GLC_Frustum& frustum)
+: m_Frustum(frustum)
+, m_MinX()
+, m_MinY()
+, m_MinZ()
+, m_MaxX()
+, m_MaxY()
+, m_MaxZ()
+{
+	const GLC_Plane planes[6]= {frustum.leftClippingPlane(), frustum.rightClippingPlane()
+								, frustum.topClippingPlane(), frustum.bottomClippingPlane()
+								, frustum.nearClippingPlane(), frustum.farClippingPlane()};
+	for (int i= 0; i < 6; ++i)
+	{
+		m_Planes[i][0]= static_cast<float>(planes[i].coefA());
+		m_Planes[i][1]= static_cast<float>(planes[i].coefB());
+		m_Planes[i][2]= static_cast<float>(planes[i].coefC());
+		m_Planes[i][3]= static_cast<float>(planes[i].coefD());
+	}
+}
+
+int GLC_FrustumCuller::batchSize()
+{
+#if defined(GLC_FRUSTUMCULLER_AVX)
+	return 8;
+#elif defined(GLC_FRUSTUMCULLER_SSE)
+	return 4;
+#else
+	return 1;
+#endif
+}
+
+GLC_Frustum::Localisation GLC_FrustumCuller::localizeBoundingBox(const GLC_BoundingBox& box) const
+{
+	if (box.isEmpty()) return GLC_Frustum::OutFrustum;
+
+	const GLC_Plane planes[6]= {m_Frustum.leftClippingPlane(), m_Frustum.rightClippingPlane()
+								, m_Frustum.topClippingPlane(), m_Frustum.bottomClippingPlane()
+								, m_Frustum.nearClippingPlane(), m_Frustum.farClippingPlane()};
+	const GLC_Point3d& lower= box.lowerCorner();
+	const GLC_Point3d& upper= box.upperCorner();
+
+	GLC_Frustum::Localisation subject= GLC_Frustum::InFrustum;
+	for (int i= 0; i < 6; ++i)
+	{
+		const GLC_Plane& plane= planes[i];
+		const GLC_Point3d farCorner((plane.coefA() >= 0.0) ? upper.x() : lower.x()
+				, (plane.coefB() >= 0.0) ? upper.y() : lower.y()
+				, (plane.coefC() >= 0.0) ? upper.z() : lower.z());
+		if (plane.distanceToPoint(farCorner) < 0.0) return GLC_Frustum::OutFrustum;
+
+		const GLC_Point3d nearCorner((plane.coefA() >= 0.0) ? lower.x() : upper.x()
+				, (plane.coefB() >= 0.0) ? lower.y() : upper.y()
+				, (plane.coefC() >= 0.0) ? lower.z() : upper.z());
+		if (plane.distanceToPoint(nearCorner) < 0.0) subject= GLC_Frustum::IntersectFrustum;
+	}
+
+	return subject;
+}
+
+void GLC_FrustumCuller::localizeBoundingBoxes(const float* pMinX, const float* pMinY, const float* pMinZ
+		, const float* pMaxX, const float* pMaxY, const float* pMaxZ
+		, int count, quint8* pLocalisation, quint8* pCoherency) const
+{
+	// Nearest and farthest corner coordinates of each plane
+	const float* pLower[3]= {pMinX, pMinY, pMinZ};
+	const float* pUpper[3]= {pMaxX, pMaxY, pMaxZ};
+	const float* ppNear[18];
+	const float* ppFar[18];
+	for (int p= 0; p < 6; ++p)
+	{
+		for (int j= 0; j < 3; ++j)
+		{
+			const bool positive= m_Planes[p][j] >= 0.0f;
+			ppNear[3 * p + j]= positive ? pLower[j] : pUpper[j];
+			ppFar[3 * p + j]= positive ? pUpper[j] : pLower[j];
+		}
+	}
+
+	int first= 0;
+#if defined(GLC_FRUSTUMCULLER_AVX)
+	for (; (first + 8) <= count; first+= 8)
+	{
+		frustumCullerLocalize8(m_Planes, ppNear, ppFar, first, pLocalisation, pCoherency);
+	}
+#endif
+#if defined(GLC_FRUSTUMCULLER_SSE)
+	for (; (first + 4) <= count; first+= 4)
+	{
+		frustumCullerLocalize4(m_Planes, ppNear, ppFar, first, pLocalisation, pCoherency);
+	}
+#endif
+	for (; first < count; ++first)
+	{
+		pLocalisation[first]= static_cast<quint8>(localizePackedBoundingBox(ppNear, ppFar, first, pCoherency));
+	}
+}
+
+void GLC_FrustumCuller::appendBoundingBox(const GLC_BoundingBox& box)
+{
+	if (box.isEmpty())
+	{
+		const float maxValue= std::numeric_limits<float>::max();
+		m_MinX.append(maxValue);
+		m_MinY.append(maxValue);
+		m_MinZ.append(maxValue);
+		m_MaxX.append(-maxValue);
+		m_MaxY.append(-maxValue);
+		m_MaxZ.append(-maxValue);
+		return;
+	}
+
+	const double lower[3]= {box.lowerCorner().x(), box.lowerCorner().y(), box.lowerCorner().z()};
+	const double upper[3]= {box.upperCorner().x(), box.upperCorner().y(), box.upperCorner().z()};
+	float roundedLower[3];
+	float roundedUpper[3];
+	for (int j= 0; j < 3; ++j)
+	{
+		roundedLower[j]= static_cast<float>(lower[j]);
+		if (static_cast<double>(roundedLower[j]) > lower[j]) roundedLower[j]= std::nextafter(roundedLower[j], -std::numeric_limits<float>::max());
+		roundedUpper[j]= static_cast<float>(upper[j]);
+		if (static_cast<double>(roundedUpper[j]) < upper[j]) roundedUpper[j]= std::nextafter(roundedUpper[j], std::numeric_limits<float>::max());
+	}
+	m_MinX.append(roundedLower[0]);
+	m_MinY.append(roundedLower[1]);
+	m_MinZ.append(roundedLower[2]);
+	m_MaxX.append(roundedUpper[0]);
+	m_MaxY.append(roundedUpper[1]);
+	m_MaxZ.append(roundedUpper[2]);
+}
+
+void GLC_FrustumCuller::clearBoundingBoxes()
+{
+	// Keep the capacity of the vectors
+	m_MinX.resize(0);
+	m_MinY.resize(0);
+	m_MinZ.resize(0);
+	m_MaxX.resize(0);
+	m_MaxY.resize(0);
+	m_MaxZ.resize(0);
+}
+
+GLC_Frustum::Localisation GLC_FrustumCuller::localizePackedBoundingBox(const float* const* ppNear, const float* const* ppFar, int index, quint8* pCoherency) const
+{
+	const int startPlane= (NULL != pCoherency) ? (pCoherency[index] % 6) : 0;
+	GLC_Frustum::Localisation subject= GLC_Frustum::InFrustum;
+	for (int k= 0; k < 6; ++k)
+	{
+		const int p= (startPlane + k) % 6;
+		const float* const* ppPlaneFar= ppFar + 3 * p;
+		const float farDistance= m_Planes[p][0] * ppPlaneFar[0][index] + m_Planes[p][1] * ppPlaneFar[1][index]
+				+ m_Planes[p][2] * ppPlaneFar[2][index] + m_Planes[p][3];
+		if (farDistance < 0.0f)
+		{
+			if (NULL != pCoherency) pCoherency[index]= static_cast<quint8>(p);
+			return GLC_Frustum::OutFrustum;
+		}
+
+		const float* const* ppPlaneNear= ppNear + 3 * p;
+		const float nearDistance= m_Planes[p][0] * ppPlaneNear[0][index] + m_Planes[p][1] * ppPlaneNear[1][index]
+				+ m_Planes[p][2] * ppPlaneNear[2][index] + m_Planes[p][3];
+		if (nearDistance < 0.0f) subject= GLC_Frustum::IntersectFrustum;
+	}
+
+	return subject;
+}
@@ -0,0 +1,133 @@
+/****************************************************************************
+
+ This file is part of the GLC-lib library.
+ Copyright (C) 2005-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ http://glc-lib.sourceforge.net
+
+ GLC-lib is free software; you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation; either version 3 of the License, or
+ (at your option) any later version.
+
+ GLC-lib is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with GLC-lib; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+
+//! \file glc_frustumculler.h interface for the GLC_FrustumCuller class.
+
+#ifndef GLC_FRUSTUMCULLER_H_
+#define GLC_FRUSTUMCULLER_H_
+
+#include <QVector>
+
+#include "glc_frustum.h"
+#include "../glc_boundingbox.h"
+#include "../glc_config.h"
+
+//////////////////////////////////////////////////////////////////////
+//! \class GLC_FrustumCuller
+/*! \brief GLC_FrustumCuller : Batched localisation of bounding boxes in a frustum */
+
+/*! Bounding boxes are tested exactly against the 6 planes of the frustum with their
+ *  nearest and farthest corners, without reduction to a bounding sphere.
+ *  Packed boxes are tested by 8 with AVX, by 4 with SSE2 or one by one otherwise,
+ *  the instruction set is chosen at compile time.
+ *
+ *  An optional coherency array keeps, for each box, the index of the plane which has
+ *  rejected it on the previous call. This plane is tested first on the next call.*/
+//////////////////////////////////////////////////////////////////////
+class GLC_LIB_EXPORT GLC_FrustumCuller
+{
+//////////////////////////////////////////////////////////////////////
+/*! @name Constructor / Destructor */
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Construct a culler of the given frustum
+	explicit GLC_FrustumCuller(const GLC_Frustum& frustum);
+//@}
+
+//////////////////////////////////////////////////////////////////////
+/*! \name Get Functions*/
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Return the frustum of this culler
+	inline const GLC_Frustum& frustum() const
+	{return m_Frustum;}
+
+	//! Return the number of boxes tested by instruction
+	static int batchSize();
+
+	//! Return the number of appended bounding boxes
+	inline int boundingBoxCount() const
+	{return m_MinX.size();}
+
+	//! Localize the given bounding box
+	GLC_Frustum::Localisation localizeBoundingBox(const GLC_BoundingBox& box) const;
+
+	//! Localize the given packed bounding boxes
+	/*! The count boxes are given by their lower and upper corners coordinates arrays.
+	 *  The GLC_Frustum::Localisation of each box is written in pLocalisation.
+	 *  If not NULL, pCoherency contains the index of the plane which has rejected each box
+	 *  on the previous call and is updated.*/
+	void localizeBoundingBoxes(const float* pMinX, const float* pMinY, const float* pMinZ
+			, const float* pMaxX, const float* pMaxY, const float* pMaxZ
+			, int count, quint8* pLocalisation, quint8* pCoherency= NULL) const;
+
+	//! Localize the appended bounding boxes
+	inline void localizeBoundingBoxes(quint8* pLocalisation, quint8* pCoherency= NULL) const
+	{
+		localizeBoundingBoxes(m_MinX.constData(), m_MinY.constData(), m_MinZ.constData()
+				, m_MaxX.constData(), m_MaxY.constData(), m_MaxZ.constData()
+				, m_MinX.size(), pLocalisation, pCoherency);
+	}
+//@}
+
+//////////////////////////////////////////////////////////////////////
+/*! \name Set Functions*/
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Append the given bounding box to the packed bounding boxes
+	/*! The box is rounded outward to float precision*/
+	void appendBoundingBox(const GLC_BoundingBox& box);
+
+	//! Remove all appended bounding boxes
+	void clearBoundingBoxes();
+//@}
+
+//////////////////////////////////////////////////////////////////////
+// Private services function
+//////////////////////////////////////////////////////////////////////
+private:
+	//! Localize the packed bounding box at the given index
+	GLC_Frustum::Localisation localizePackedBoundingBox(const float* const* ppNear, const float* const* ppFar, int index, quint8* pCoherency) const;
+
+//////////////////////////////////////////////////////////////////////
+// Private members
+//////////////////////////////////////////////////////////////////////
+private:
+	//! The frustum
+	GLC_Frustum m_Frustum;
+
+	//! The plane equations in simple precision
+	float m_Planes[6][4];
+
+	//! Packed bounding boxes coordinates
+	QVector<float> m_MinX;
+	QVector<float> m_MinY;
+	QVector<float> m_MinZ;
+	QVector<float> m_MaxX;
+	QVector<float> m_MaxY;
+	QVector<float> m_MaxZ;
+};
+
+#endif /* GLC_FRUSTUMCULLER_H_ */
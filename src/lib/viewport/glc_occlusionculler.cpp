@@ -0,0 +1,653 @@
+/****************************************************************************
+
+ This file is part of the GLC-lib library.
+ Copyright (C) 2005-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ http://glc-lib.sourceforge.net
+
+ GLC-lib is free software; you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation; either version 3 of the License, or
+ (at your option) any later version.
+
+ GLC-lib is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with GLC-lib; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+
+//! \file glc_occlusionculler.cpp implementation for the GLC_OcclusionCuller class.
+
+#include "glc_occlusionculler.h"
+#include "../sceneGraph/glc_3dviewcollection.h"
+#include "../sceneGraph/glc_3dviewinstance.h"
+#include "../geometry/glc_mesh.h"
+
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define GLC_OCCLUSIONCULLER_SSE
+#endif
+
+// Number of depth buffer rows rasterized by a thread
+static const int occlusionCullerBandHeight= 16;
+
+// Number of bounding boxes tested by a thread
+static const int occlusionCullerTestChunkSize= 512;
+
+// The triangles of the last LOD of a mesh, 9 floats per triangle
+class OcclusionMesh
+{
+public:
+	// The number of positions of the mesh when the triangles have been extracted
+	int m_PositionSize;
+	QVector<float> m_Positions;
+};
+
+// A triangle in screen space, with normalized device z
+class OcclusionTriangle
+{
+public:
+	float m_X[3];
+	float m_Y[3];
+	float m_Z[3];
+};
+
+// Transform triangles to screen space
+class OcclusionSetupJob
+{
+public:
+	const float* m_pPositions;
+	int m_TriangleCount;
+	float m_Matrix[16];
+	float m_Width;
+	float m_Height;
+	QVector<OcclusionTriangle> m_Triangles;
+};
+
+// Rasterize the screen space triangles in a band of rows
+class OcclusionRasterJob
+{
+public:
+	const QVector<OcclusionSetupJob>* m_pSetupJobs;
+	float* m_pDepth;
+	int m_Width;
+	int m_Stride;
+	int m_FirstRow;
+	int m_EndRow;
+};
+
+// Test a range of bounding boxes
+class OcclusionTestJob
+{
+public:
+	const GLC_OcclusionCuller* m_pCuller;
+	const GLC_BoundingBox* m_pBoxes;
+	const quint8* m_pIsOccluder;
+	quint8* m_pIsOccluded;
+	int m_First;
+	int m_Count;
+};
+
+static inline float occlusionCullerMin(float a, float b, float c)
+{
+	return qMin(a, qMin(b, c));
+}
+
+static inline float occlusionCullerMax(float a, float b, float c)
+{
+	return qMax(a, qMax(b, c));
+}
+
+// Project the given box and return false if it crosses the near plane
+/* The screen rectangle (xMin, yMin, xMax, yMax) is stored in pRect and the nearest normalized device z in pDepth*/
+static bool occlusionCullerProjectBox(const double* m, const GLC_BoundingBox& box, double width, double height, double* pRect, double* pDepth)
+{
+	const GLC_Point3d lower(box.lowerCorner());
+	const GLC_Point3d upper(box.upperCorner());
+	pRect[0]= pRect[1]= std::numeric_limits<double>::max();
+	pRect[2]= pRect[3]= -std::numeric_limits<double>::max();
+	*pDepth= std::numeric_limits<double>::max();
+	for (int i= 0; i < 8; ++i)
+	{
+		const double px= (i & 1) ? upper.x() : lower.x();
+		const double py= (i & 2) ? upper.y() : lower.y();
+		const double pz= (i & 4) ? upper.z() : lower.z();
+		const double x= m[0] * px + m[4] * py + m[8] * pz + m[12];
+		const double y= m[1] * px + m[5] * py + m[9] * pz + m[13];
+		const double z= m[2] * px + m[6] * py + m[10] * pz + m[14];
+		const double w= m[3] * px + m[7] * py + m[11] * pz + m[15];
+		if ((w <= 0.0) || (z < -w)) return false;
+
+		const double sx= (x / w * 0.5 + 0.5) * width;
+		const double sy= (y / w * 0.5 + 0.5) * height;
+		pRect[0]= qMin(pRect[0], sx);
+		pRect[1]= qMin(pRect[1], sy);
+		pRect[2]= qMax(pRect[2], sx);
+		pRect[3]= qMax(pRect[3], sy);
+		*pDepth= qMin(*pDepth, z / w);
+	}
+	return true;
+}
+
+// Transform the triangles of the given job to screen space
+/* Triangles crossing the near plane are dropped, which keeps occlusion conservative*/
+static void occlusionCullerSetup(OcclusionSetupJob& job)
+{
+	job.m_Triangles.clear();
+	job.m_Triangles.reserve(job.m_TriangleCount);
+	const float* m= job.m_Matrix;
+	for (int t= 0; t < job.m_TriangleCount; ++t)
+	{
+		OcclusionTriangle triangle;
+		bool isValid= true;
+		for (int v= 0; isValid && (v < 3); ++v)
+		{
+			const float* p= job.m_pPositions + 9 * t + 3 * v;
+			const float x= m[0] * p[0] + m[4] * p[1] + m[8] * p[2] + m[12];
+			const float y= m[1] * p[0] + m[5] * p[1] + m[9] * p[2] + m[13];
+			const float z= m[2] * p[0] + m[6] * p[1] + m[10] * p[2] + m[14];
+			const float w= m[3] * p[0] + m[7] * p[1] + m[11] * p[2] + m[15];
+			isValid= (w > 0.0f) && (z >= -w);
+			if (isValid)
+			{
+				const float inverseW= 1.0f / w;
+				triangle.m_X[v]= (x * inverseW * 0.5f + 0.5f) * job.m_Width;
+				triangle.m_Y[v]= (y * inverseW * 0.5f + 0.5f) * job.m_Height;
+				triangle.m_Z[v]= z * inverseW;
+			}
+		}
+		if (isValid) job.m_Triangles.append(triangle);
+	}
+}
+
+// Rasterize the given triangle in the rows of the given job
+/* Pixels are covered when their center is in the triangle, their depth is the farthest depth
+ * of the triangle plane in the pixel*/
+static void occlusionCullerRasterizeTriangle(const OcclusionTriangle& triangle, const OcclusionRasterJob& job)
+{
+	float x0= triangle.m_X[0], y0= triangle.m_Y[0], z0= triangle.m_Z[0];
+	float x1= triangle.m_X[1], y1= triangle.m_Y[1], z1= triangle.m_Z[1];
+	float x2= triangle.m_X[2], y2= triangle.m_Y[2], z2= triangle.m_Z[2];
+
+	// Counter clockwise orientation
+	float area= (x1 - x0) * (y2 - y0) - (x2 - x0) * (y1 - y0);
+	if (area < 0.0f)
+	{
+		qSwap(x1, x2);
+		qSwap(y1, y2);
+		qSwap(z1, z2);
+		area= -area;
+	}
+	if (!(area > 0.0f)) return;
+
+	// Pixel rectangle of the triangle in the band
+	const float left= occlusionCullerMin(x0, x1, x2);
+	const float right= occlusionCullerMax(x0, x1, x2);
+	const float bottom= occlusionCullerMin(y0, y1, y2);
+	const float top= occlusionCullerMax(y0, y1, y2);
+	if ((right < 0.0f) || (left >= float(job.m_Width)) || (top < float(job.m_FirstRow)) || (bottom >= float(job.m_EndRow))) return;
+	const int minX= static_cast<int>(qMax(left, 0.0f));
+	const int maxX= static_cast<int>(qMin(right, float(job.m_Width - 1)));
+	const int minY= static_cast<int>(qMax(bottom, float(job.m_FirstRow)));
+	const int maxY= static_cast<int>(qMin(top, float(job.m_EndRow - 1)));
+
+	// Edge functions, positive inside
+	const float a0= y1 - y2, b0= x2 - x1, c0= x1 * y2 - y1 * x2;
+	const float a1= y2 - y0, b1= x0 - x2, c1= x2 * y0 - y2 * x0;
+	const float a2= y0 - y1, b2= x1 - x0, c2= x0 * y1 - y0 * x1;
+
+	// Depth plane biased to the farthest depth of a pixel
+	const float dzdx= ((z1 - z0) * (y2 - y0) - (z2 - z0) * (y1 - y0)) / area;
+	const float dzdy= ((z2 - z0) * (x1 - x0) - (z1 - z0) * (x2 - x0)) / area;
+	const float dz= z0 - dzdx * x0 - dzdy * y0 + 0.5f * (qAbs(dzdx) + qAbs(dzdy));
+	const float maxZ= occlusionCullerMax(z0, z1, z2);
+
+	// Start on a multiple of 4, the row stride is a multiple of 4
+	const int firstX= minX & ~3;
+	for (int py= minY; py <= maxY; ++py)
+	{
+		const float cy= float(py) + 0.5f;
+		float* pRow= job.m_pDepth + py * job.m_Stride;
+#if defined(GLC_OCCLUSIONCULLER_SSE)
+		const __m128 zero= _mm_setzero_ps();
+		const __m128 offset= _mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f);
+		const __m128 e0Row= _mm_set1_ps(b0 * cy + c0);
+		const __m128 e1Row= _mm_set1_ps(b1 * cy + c1);
+		const __m128 e2Row= _mm_set1_ps(b2 * cy + c2);
+		const __m128 zRow= _mm_set1_ps(dzdy * cy + dz);
+		const __m128 maxZ4= _mm_set1_ps(maxZ);
+		for (int px= firstX; px <= maxX; px+= 4)
+		{
+			const __m128 cx= _mm_add_ps(_mm_set1_ps(float(px)), offset);
+			const __m128 e0= _mm_add_ps(_mm_mul_ps(_mm_set1_ps(a0), cx), e0Row);
+			const __m128 e1= _mm_add_ps(_mm_mul_ps(_mm_set1_ps(a1), cx), e1Row);
+			const __m128 e2= _mm_add_ps(_mm_mul_ps(_mm_set1_ps(a2), cx), e2Row);
+			const __m128 inside= _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(e0, zero), _mm_cmpge_ps(e1, zero)), _mm_cmpge_ps(e2, zero));
+			if (0 == _mm_movemask_ps(inside)) continue;
+
+			const __m128 z= _mm_min_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(dzdx), cx), zRow), maxZ4);
+			const __m128 previous= _mm_loadu_ps(pRow + px);
+			const __m128 nearest= _mm_min_ps(previous, z);
+			_mm_storeu_ps(pRow + px, _mm_or_ps(_mm_and_ps(inside, nearest), _mm_andnot_ps(inside, previous)));
+		}
+#else
+		for (int px= firstX; px <= maxX; ++px)
+		{
+			const float cx= float(px) + 0.5f;
+			if (((a0 * cx + b0 * cy + c0) >= 0.0f) && ((a1 * cx + b1 * cy + c1) >= 0.0f) && ((a2 * cx + b2 * cy + c2) >= 0.0f))
+			{
+				const float z= qMin(dzdx * cx + dzdy * cy + dz, maxZ);
+				pRow[px]= qMin(pRow[px], z);
+			}
+		}
+#endif
+	}
+}
+
+// Rasterize the triangles of all setup jobs in the rows of the given job
+static void occlusionCullerRasterize(OcclusionRasterJob& job)
+{
+	const int setupJobCount= job.m_pSetupJobs->size();
+	for (int i= 0; i < setupJobCount; ++i)
+	{
+		const QVector<OcclusionTriangle>& triangles= job.m_pSetupJobs->at(i).m_Triangles;
+		const int triangleCount= triangles.size();
+		for (int t= 0; t < triangleCount; ++t)
+		{
+			occlusionCullerRasterizeTriangle(triangles.at(t), job);
+		}
+	}
+}
+
+// Test the bounding boxes of the given job
+static void occlusionCullerTest(OcclusionTestJob& job)
+{
+	const int end= job.m_First + job.m_Count;
+	for (int i= job.m_First; i < end; ++i)
+	{
+		if (0 == job.m_pIsOccluder[i])
+		{
+			job.m_pIsOccluded[i]= job.m_pCuller->isOccluded(job.m_pBoxes[i]) ? 1 : 0;
+		}
+	}
+}
+
+// Initialize a setup job of the given triangles placed with the given matrix
+static OcclusionSetupJob occlusionCullerSetupJob(const float* pPositions, int triangleCount, const GLC_Matrix4x4& matrix, int width, int height)
+{
+	OcclusionSetupJob job;
+	job.m_pPositions= pPositions;
+	job.m_TriangleCount= triangleCount;
+	const double* pData= matrix.getData();
+	for (int i= 0; i < 16; ++i)
+	{
+		job.m_Matrix[i]= static_cast<float>(pData[i]);
+	}
+	job.m_Width= static_cast<float>(width);
+	job.m_Height= static_cast<float>(height);
+	return job;
+}
+
+// Rasterize the given setup jobs by bands of rows
+static void occlusionCullerRasterizeJobs(const QVector<OcclusionSetupJob>& setupJobs, float* pDepth, int width, int height, int stride)
+{
+	QVector<OcclusionRasterJob> rasterJobs;
+	for (int row= 0; row < height; row+= occlusionCullerBandHeight)
+	{
+		OcclusionRasterJob job;
+		job.m_pSetupJobs= &setupJobs;
+		job.m_pDepth= pDepth;
+		job.m_Width= width;
+		job.m_Stride= stride;
+		job.m_FirstRow= row;
+		job.m_EndRow= qMin(row + occlusionCullerBandHeight, height);
+		rasterJobs.append(job);
+	}
+	QtConcurrent::blockingMap(rasterJobs, occlusionCullerRasterize);
+}
+
+GLC_OcclusionCuller::GLC_OcclusionCuller(int width, int height)
+: m_Width(0)
+, m_Height(0)
+, m_Stride(0)
+, m_DepthBuffer()
+, m_Levels()
+, m_LevelSizes()
+, m_ViewProjectionMatrix()
+, m_OccluderTriangleBudget(20000)
+, m_MinimumOccluderSize(0.01)
+, m_OccluderCount(0)
+, m_OccludedInstanceIds()
+, m_OccluderMeshCache()
+{
+	setResolution(width, height);
+}
+
+GLC_OcclusionCuller::~GLC_OcclusionCuller()
+{
+	clearCache();
+}
+
+//////////////////////////////////////////////////////////////////////
+// Get Functions
+//////////////////////////////////////////////////////////////////////
+
+bool GLC_OcclusionCuller::isOccluded(const GLC_BoundingBox& box) const
+{
+	if (box.isEmpty() || m_Levels.isEmpty()) return false;
+
+	double rect[4];
+	double nearestDepth;
+	if (!occlusionCullerProjectBox(m_ViewProjectionMatrix.getData(), box, m_Width, m_Height, rect, &nearestDepth)) return false;
+	if ((rect[2] < 0.0) || (rect[0] >= m_Width) || (rect[3] < 0.0) || (rect[1] >= m_Height)) return false;
+
+	// Covered texels dilated by one texel
+	const int x0= static_cast<int>(qMax(0.0, std::floor(rect[0]) - 1.0));
+	const int y0= static_cast<int>(qMax(0.0, std::floor(rect[1]) - 1.0));
+	const int x1= static_cast<int>(qMin(double(m_Width - 1), std::floor(rect[2]) + 1.0));
+	const int y1= static_cast<int>(qMin(double(m_Height - 1), std::floor(rect[3]) + 1.0));
+
+	// The first level where the rectangle covers at most 4x4 texels
+	int level= 0;
+	while ((((x1 >> level) - (x0 >> level)) > 3) || (((y1 >> level) - (y0 >> level)) > 3))
+	{
+		++level;
+	}
+	Q_ASSERT(level < m_Levels.size());
+
+	const float* pLevel= m_Levels.at(level).constData();
+	const int levelWidth= m_LevelSizes.at(level).width();
+	float farthestDepth= -std::numeric_limits<float>::max();
+	for (int y= (y0 >> level); y <= (y1 >> level); ++y)
+	{
+		for (int x= (x0 >> level); x <= (x1 >> level); ++x)
+		{
+			farthestDepth= qMax(farthestDepth, pLevel[y * levelWidth + x]);
+		}
+	}
+
+	return nearestDepth > farthestDepth;
+}
+
+//////////////////////////////////////////////////////////////////////
+// Set Functions
+//////////////////////////////////////////////////////////////////////
+
+void GLC_OcclusionCuller::setResolution(int width, int height)
+{
+	m_Width= qMax(1, width);
+	m_Height= qMax(1, height);
+	m_Stride= (m_Width + 3) & ~3;
+	clearDepth();
+}
+
+void GLC_OcclusionCuller::setOccluderTriangleBudget(int budget)
+{
+	m_OccluderTriangleBudget= qMax(0, budget);
+}
+
+void GLC_OcclusionCuller::setMinimumOccluderSize(double ratio)
+{
+	m_MinimumOccluderSize= qBound(0.0, ratio, 1.0);
+}
+
+void GLC_OcclusionCuller::setViewProjectionMatrix(const GLC_Matrix4x4& matrix)
+{
+	m_ViewProjectionMatrix= matrix;
+	clearDepth();
+}
+
+void GLC_OcclusionCuller::clearDepth()
+{
+	m_DepthBuffer.fill(std::numeric_limits<float>::max(), m_Stride * m_Height);
+	m_Levels.clear();
+	m_LevelSizes.clear();
+}
+
+void GLC_OcclusionCuller::rasterizeTriangles(const float* pPositions, int triangleCount, const GLC_Matrix4x4& matrix)
+{
+	QVector<OcclusionSetupJob> setupJobs;
+	setupJobs.append(occlusionCullerSetupJob(pPositions, triangleCount, m_ViewProjectionMatrix * matrix, m_Width, m_Height));
+	occlusionCullerSetup(setupJobs[0]);
+	occlusionCullerRasterizeJobs(setupJobs, m_DepthBuffer.data(), m_Width, m_Height, m_Stride);
+}
+
+void GLC_OcclusionCuller::buildDepthPyramid()
+{
+	m_Levels.clear();
+	m_LevelSizes.clear();
+
+	// Full resolution level without the row padding
+	QVector<float> level(m_Width * m_Height);
+	for (int y= 0; y < m_Height; ++y)
+	{
+		std::copy(m_DepthBuffer.constBegin() + y * m_Stride, m_DepthBuffer.constBegin() + y * m_Stride + m_Width, level.begin() + y * m_Width);
+	}
+	m_Levels.append(level);
+	m_LevelSizes.append(QSize(m_Width, m_Height));
+
+	// Each texel keeps the farthest depth of the 2x2 texels of the previous level
+	while ((m_LevelSizes.last().width() > 1) || (m_LevelSizes.last().height() > 1))
+	{
+		const QVector<float>& previous= m_Levels.last();
+		const int previousWidth= m_LevelSizes.last().width();
+		const int previousHeight= m_LevelSizes.last().height();
+		const int width= (previousWidth + 1) / 2;
+		const int height= (previousHeight + 1) / 2;
+		QVector<float> current(width * height);
+		for (int y= 0; y < height; ++y)
+		{
+			const int y0= 2 * y;
+			const int y1= qMin(y0 + 1, previousHeight - 1);
+			for (int x= 0; x < width; ++x)
+			{
+				const int x0= 2 * x;
+				const int x1= qMin(x0 + 1, previousWidth - 1);
+				current[y * width + x]= qMax(qMax(previous.at(y0 * previousWidth + x0), previous.at(y0 * previousWidth + x1))
+						, qMax(previous.at(y1 * previousWidth + x0), previous.at(y1 * previousWidth + x1)));
+			}
+		}
+		m_Levels.append(current);
+		m_LevelSizes.append(QSize(width, height));
+	}
+}
+
+int GLC_OcclusionCuller::cull(const QList<GLC_3DViewInstance*>& instances, const GLC_Matrix4x4& viewProjectionMatrix)
+{
+	setViewProjectionMatrix(viewProjectionMatrix);
+	m_OccluderCount= 0;
+	m_OccludedInstanceIds.clear();
+
+	// Viewable instances and occluder candidates
+	QVector<GLC_3DViewInstance*> candidates;
+	QVector<GLC_BoundingBox> boxes;
+	QVector<QPair<double, int> > occluderCandidates;
+	const int instanceCount= instances.count();
+	candidates.reserve(instanceCount);
+	boxes.reserve(instanceCount);
+	for (int i= 0; i < instanceCount; ++i)
+	{
+		GLC_3DViewInstance* pInstance= instances.at(i);
+		if (pInstance->viewableFlag() == GLC_3DViewInstance::NoViewable) continue;
+		const GLC_BoundingBox box(pInstance->boundingBox());
+		if (box.isEmpty()) continue;
+
+		// Transparent, wireframe and point instances don't hide what is behind them
+		const bool isOpaqueAndFilled= !pInstance->hasTransparentMaterials() && (pInstance->polygonMode() == GL_FILL);
+		double depth;
+		if (isOpaqueAndFilled && (screenRatio(box, &depth) >= m_MinimumOccluderSize))
+		{
+			occluderCandidates.append(qMakePair(depth, candidates.size()));
+		}
+		candidates.append(pInstance);
+		boxes.append(box);
+	}
+	const int candidateCount= candidates.size();
+
+	// The nearest occluders up to the triangle budget
+	std::sort(occluderCandidates.begin(), occluderCandidates.end());
+	QVector<quint8> isOccluder(candidateCount, 0);
+	QVector<OcclusionSetupJob> setupJobs;
+	int triangleCount= 0;
+	const int occluderCandidateCount= occluderCandidates.size();
+	for (int i= 0; (i < occluderCandidateCount) && (triangleCount < m_OccluderTriangleBudget); ++i)
+	{
+		const int index= occluderCandidates.at(i).second;
+		GLC_3DViewInstance* pInstance= candidates.at(index);
+		const GLC_Matrix4x4 matrix(m_ViewProjectionMatrix * pInstance->matrix());
+		const int bodyCount= pInstance->numberOfBody();
+		for (int body= 0; body < bodyCount; ++body)
+		{
+			GLC_Mesh* pMesh= dynamic_cast<GLC_Mesh*>(pInstance->geomAt(body));
+			OcclusionMesh* pOccluderMesh= (NULL != pMesh) ? occluderMesh(pMesh) : NULL;
+			if ((NULL != pOccluderMesh) && !pOccluderMesh->m_Positions.isEmpty() && (triangleCount < m_OccluderTriangleBudget))
+			{
+				// A large occluder is cut at the budget, fewer occluders keep the test conservative
+				const int meshTriangleCount= qMin(pOccluderMesh->m_Positions.size() / 9, m_OccluderTriangleBudget - triangleCount);
+				setupJobs.append(occlusionCullerSetupJob(pOccluderMesh->m_Positions.constData(), meshTriangleCount, matrix, m_Width, m_Height));
+				triangleCount+= meshTriangleCount;
+				isOccluder[index]= 1;
+			}
+		}
+		m_OccluderCount+= isOccluder.at(index);
+	}
+
+	// Rasterize the occluders
+	QtConcurrent::blockingMap(setupJobs, occlusionCullerSetup);
+	occlusionCullerRasterizeJobs(setupJobs, m_DepthBuffer.data(), m_Width, m_Height, m_Stride);
+	buildDepthPyramid();
+
+	// Test the other instances
+	QVector<quint8> isOccluded(candidateCount, 0);
+	QVector<OcclusionTestJob> testJobs;
+	for (int first= 0; first < candidateCount; first+= occlusionCullerTestChunkSize)
+	{
+		OcclusionTestJob job;
+		job.m_pCuller= this;
+		job.m_pBoxes= boxes.constData();
+		job.m_pIsOccluder= isOccluder.constData();
+		job.m_pIsOccluded= isOccluded.data();
+		job.m_First= first;
+		job.m_Count= qMin(occlusionCullerTestChunkSize, candidateCount - first);
+		testJobs.append(job);
+	}
+	QtConcurrent::blockingMap(testJobs, occlusionCullerTest);
+
+	for (int i= 0; i < candidateCount; ++i)
+	{
+		if (0 != isOccluded.at(i))
+		{
+			candidates.at(i)->setViewable(GLC_3DViewInstance::NoViewable);
+			m_OccludedInstanceIds.append(candidates.at(i)->id());
+		}
+	}
+
+	return m_OccludedInstanceIds.size();
+}
+
+int GLC_OcclusionCuller::cull(GLC_3DViewCollection* pCollection, const GLC_Matrix4x4& viewProjectionMatrix)
+{
+	Q_ASSERT(NULL != pCollection);
+	return cull(pCollection->viewableInstancesHandle(), viewProjectionMatrix);
+}
+
+void GLC_OcclusionCuller::restoreOccludedInstances(GLC_3DViewCollection* pCollection)
+{
+	Q_ASSERT(NULL != pCollection);
+	const int count= m_OccludedInstanceIds.size();
+	for (int i= 0; i < count; ++i)
+	{
+		const GLC_uint id= m_OccludedInstanceIds.at(i);
+		if (pCollection->contains(id))
+		{
+			GLC_3DViewInstance* pInstance= pCollection->instanceHandle(id);
+			if (pInstance->viewableFlag() == GLC_3DViewInstance::NoViewable)
+			{
+				pInstance->setViewable(GLC_3DViewInstance::FullViewable);
+			}
+		}
+	}
+	m_OccludedInstanceIds.clear();
+}
+
+void GLC_OcclusionCuller::removeFromCache(GLC_uint geometryId)
+{
+	delete m_OccluderMeshCache.take(geometryId);
+}
+
+void GLC_OcclusionCuller::clearCache()
+{
+	qDeleteAll(m_OccluderMeshCache);
+	m_OccluderMeshCache.clear();
+}
+
+//////////////////////////////////////////////////////////////////////
+// Private services Functions
+//////////////////////////////////////////////////////////////////////
+
+OcclusionMesh* GLC_OcclusionCuller::occluderMesh(GLC_Mesh* pMesh)
+{
+	const int lodCount= pMesh->lodCount();
+	if (0 == lodCount) return NULL;
+
+	const GLfloatVector& positions= pMesh->positionVector();
+	OcclusionMesh* pSubject= m_OccluderMeshCache.value(pMesh->id(), NULL);
+	if ((NULL != pSubject) && (pSubject->m_PositionSize != positions.size()))
+	{
+		// The mesh has been modified
+		delete pSubject;
+		pSubject= NULL;
+	}
+
+	if (NULL == pSubject)
+	{
+		// The last LOD is the coarsest
+		const int lod= lodCount - 1;
+		pSubject= new OcclusionMesh;
+		pSubject->m_PositionSize= positions.size();
+		const GLuint positionCount= static_cast<GLuint>(positions.size() / 3);
+		const QList<GLC_uint> materialIds(pMesh->materialIds());
+		const int materialCount= materialIds.count();
+		for (int i= 0; i < materialCount; ++i)
+		{
+			const GLC_uint materialId= materialIds.at(i);
+			if (!pMesh->lodContainsMaterial(lod, materialId)) continue;
+
+			const IndexList index(pMesh->getEquivalentTrianglesStripsFansIndex(lod, materialId));
+			const int triangleCount= index.size() / 3;
+			for (int t= 0; t < triangleCount; ++t)
+			{
+				const GLuint i0= index.at(3 * t);
+				const GLuint i1= index.at(3 * t + 1);
+				const GLuint i2= index.at(3 * t + 2);
+				if ((i0 >= positionCount) || (i1 >= positionCount) || (i2 >= positionCount)) continue;
+				for (int j= 0; j < 3; ++j) pSubject->m_Positions.append(positions.at(3 * i0 + j));
+				for (int j= 0; j < 3; ++j) pSubject->m_Positions.append(positions.at(3 * i1 + j));
+				for (int j= 0; j < 3; ++j) pSubject->m_Positions.append(positions.at(3 * i2 + j));
+			}
+		}
+		m_OccluderMeshCache.insert(pMesh->id(), pSubject);
+	}
+
+	return pSubject;
+}
+
+double GLC_OcclusionCuller::screenRatio(const GLC_BoundingBox& box, double* pDepth) const
+{
+	double rect[4];
+	if (!occlusionCullerProjectBox(m_ViewProjectionMatrix.getData(), box, m_Width, m_Height, rect, pDepth)) return -1.0;
+
+	const double width= qBound(0.0, rect[2], double(m_Width)) - qBound(0.0, rect[0], double(m_Width));
+	const double height= qBound(0.0, rect[3], double(m_Height)) - qBound(0.0, rect[1], double(m_Height));
+	return (width * height) / (double(m_Width) * double(m_Height));
+}
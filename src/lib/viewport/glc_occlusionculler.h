@@ -0,0 +1,236 @@
+/****************************************************************************
+
+ This file is part of the GLC-lib library.
+ Copyright (C) 2005-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ http://glc-lib.sourceforge.net
+
+ GLC-lib is free software; you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation; either version 3 of the License, or
+ (at your option) any later version.
+
+ GLC-lib is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with GLC-lib; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+
+//! \file glc_occlusionculler.h interface for the GLC_OcclusionCuller class.
+
+#ifndef GLC_OCCLUSIONCULLER_H_
+#define GLC_OCCLUSIONCULLER_H_
+
+#include <QHash>
+#include <QList>
+#include <QSize>
+#include <QVector>
+
+#include "../maths/glc_matrix4x4.h"
+#include "../glc_boundingbox.h"
+#include "../glc_global.h"
+#include "../glc_config.h"
+
+class GLC_3DViewCollection;
+class GLC_3DViewInstance;
+class GLC_Mesh;
+class OcclusionMesh;
+
+//////////////////////////////////////////////////////////////////////
+//! \class GLC_OcclusionCuller
+/*! \brief GLC_OcclusionCuller : Software hierarchical depth occlusion culling */
+
+/*! The nearest large instances of a collection are rasterized on the CPU into
+ *  a low resolution depth buffer, with their last (coarsest) mesh LOD and up to
+ *  a triangle budget. A hierarchical depth pyramid, which keeps the farthest depth
+ *  of each texel block, is built from this buffer. The bounding box of each other
+ *  viewable instance is then tested against the pyramid, and occluded instances
+ *  are set not viewable so they don't reach the render queue.
+ *
+ *  - Rasterization is made by bands of rows and box tests by chunks of instances
+ *    on the global thread pool. Rows are rasterized by 4 pixels with SSE2 if available.
+ *  - Triangles crossing the near plane, transparent instances and instances not drawn
+ *    with GL_FILL polygon mode are not used as occluders.
+ *  - Clip planes are ignored, the collection doesn't cull when its viewport uses some.
+ *  - The triangles of the last occluder are cut at the triangle budget.
+ *  - Occluders depth is biased to the farthest depth of each pixel and tested boxes are
+ *    dilated by a texel, so the test is conservative at the buffer resolution.
+ *
+ *  The depth buffer can be filled with rasterizeTriangles() and queried with isOccluded()
+ *  without collection nor OpenGL context. Meshes data must be on client side and the
+ *  occluder cache is keyed by geometry id.*/
+//////////////////////////////////////////////////////////////////////
+class GLC_LIB_EXPORT GLC_OcclusionCuller
+{
+//////////////////////////////////////////////////////////////////////
+/*! @name Constructor / Destructor */
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Construct an occlusion culler with a depth buffer of the given size
+	explicit GLC_OcclusionCuller(int width= 256, int height= 128);
+
+	//! Destructor
+	~GLC_OcclusionCuller();
+//@}
+
+//////////////////////////////////////////////////////////////////////
+/*! \name Get Functions*/
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Return the width of the depth buffer
+	inline int width() const
+	{return m_Width;}
+
+	//! Return the height of the depth buffer
+	inline int height() const
+	{return m_Height;}
+
+	//! Return the view projection matrix used to rasterize and test
+	inline const GLC_Matrix4x4& viewProjectionMatrix() const
+	{return m_ViewProjectionMatrix;}
+
+	//! Return the maximum number of occluder triangles rasterized by cull()
+	inline int occluderTriangleBudget() const
+	{return m_OccluderTriangleBudget;}
+
+	//! Return the minimum ratio of the screen covered by the box of an occluder
+	inline double minimumOccluderSize() const
+	{return m_MinimumOccluderSize;}
+
+	//! Return the number of occluders rasterized by the last cull()
+	inline int occluderCount() const
+	{return m_OccluderCount;}
+
+	//! Return the ids of the instances occluded by the last cull()
+	inline const QVector<GLC_uint>& occludedInstanceIds() const
+	{return m_OccludedInstanceIds;}
+
+	//! Return the number of levels of the depth pyramid
+	/*! The pyramid is empty until buildDepthPyramid() is called*/
+	inline int levelCount() const
+	{return m_Levels.size();}
+
+	//! Return the size of the given level of the depth pyramid
+	inline QSize levelSize(int level) const
+	{return m_LevelSizes.at(level);}
+
+	//! Return the depth of the given texel of the given level of the depth pyramid
+	/*! The depth is the normalized device z, an empty texel has the maximum float value*/
+	inline float depth(int level, int x, int y) const
+	{return m_Levels.at(level).at(y * m_LevelSizes.at(level).width() + x);}
+
+	//! Return true if the given box is hidden by the depth pyramid
+	/*! Boxes crossing the near plane or out of the screen are never occluded*/
+	bool isOccluded(const GLC_BoundingBox& box) const;
+
+	//! Return the number of cached occluder meshes
+	inline int cachedMeshCount() const
+	{return m_OccluderMeshCache.count();}
+//@}
+
+//////////////////////////////////////////////////////////////////////
+/*! \name Set Functions*/
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Set the size of the depth buffer and clear it
+	void setResolution(int width, int height);
+
+	//! Set the maximum number of occluder triangles rasterized by cull()
+	void setOccluderTriangleBudget(int budget);
+
+	//! Set the minimum ratio of the screen covered by the box of an occluder
+	void setMinimumOccluderSize(double ratio);
+
+	//! Set the view projection matrix and clear the depth buffer
+	void setViewProjectionMatrix(const GLC_Matrix4x4& matrix);
+
+	//! Clear the depth buffer and the depth pyramid
+	void clearDepth();
+
+	//! Rasterize the given triangles placed with the given matrix in the depth buffer
+	/*! Positions are given by 9 floats per triangle*/
+	void rasterizeTriangles(const float* pPositions, int triangleCount, const GLC_Matrix4x4& matrix= GLC_Matrix4x4());
+
+	//! Build the depth pyramid from the depth buffer
+	void buildDepthPyramid();
+
+	//! Cull the given instances with the given view projection matrix and return the number of occluded instances
+	/*! Occluders are chosen among the given instances which are viewable, the others viewable
+	 *  instances are tested and set not viewable if occluded.*/
+	int cull(const QList<GLC_3DViewInstance*>& instances, const GLC_Matrix4x4& viewProjectionMatrix);
+
+	//! Cull the instances of the given collection in its current show state
+	int cull(GLC_3DViewCollection* pCollection, const GLC_Matrix4x4& viewProjectionMatrix);
+
+	//! Set viewable the instances of the given collection occluded by the last cull()
+	void restoreOccludedInstances(GLC_3DViewCollection* pCollection);
+
+	//! Remove the occluder mesh of the geometry of the given id from the cache
+	void removeFromCache(GLC_uint geometryId);
+
+	//! Clear the cache of occluder meshes
+	void clearCache();
+//@}
+
+//////////////////////////////////////////////////////////////////////
+/*! \name Private services Functions*/
+//@{
+//////////////////////////////////////////////////////////////////////
+private:
+	//! Return the occluder mesh of the given mesh, build it if needed
+	OcclusionMesh* occluderMesh(GLC_Mesh* pMesh);
+
+	//! Return the screen area ratio of the given box, -1 if the box crosses the near plane
+	/*! The nearest normalized device z of the box is stored in pDepth*/
+	double screenRatio(const GLC_BoundingBox& box, double* pDepth) const;
+//@}
+
+//////////////////////////////////////////////////////////////////////
+// Private members
+//////////////////////////////////////////////////////////////////////
+private:
+	//! The depth buffer size
+	int m_Width;
+	int m_Height;
+
+	//! The depth buffer row size, a multiple of 4
+	int m_Stride;
+
+	//! The depth buffer
+	QVector<float> m_DepthBuffer;
+
+	//! The depth pyramid levels, from the full resolution level
+	QVector<QVector<float> > m_Levels;
+
+	//! The size of each level of the depth pyramid
+	QVector<QSize> m_LevelSizes;
+
+	//! The view projection matrix
+	GLC_Matrix4x4 m_ViewProjectionMatrix;
+
+	//! The maximum number of occluder triangles
+	int m_OccluderTriangleBudget;
+
+	//! The minimum screen ratio of an occluder
+	double m_MinimumOccluderSize;
+
+	//! The number of occluders of the last cull
+	int m_OccluderCount;
+
+	//! The instances occluded by the last cull
+	QVector<GLC_uint> m_OccludedInstanceIds;
+
+	//! The occluder triangles of meshes
+	QHash<GLC_uint, OcclusionMesh*> m_OccluderMeshCache;
+
+	Q_DISABLE_COPY(GLC_OcclusionCuller)
+};
+
+#endif /* GLC_OCCLUSIONCULLER_H_ */
@@ -0,0 +1,1054 @@
+/****************************************************************************
+
+ This file is part of the GLC-lib library.
+ Copyright (C) 2005-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ http://glc-lib.sourceforge.net
+
+ GLC-lib is free software; you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation; either version 3 of the License, or
+ (at your option) any later version.
+
+ GLC-lib is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with GLC-lib; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+
+//! \file glc_raycaster.cpp implementation for the GLC_RayCaster class.
+
+#include "glc_raycaster.h"
+#include "glc_viewport.h"
+#include "../sceneGraph/glc_3dviewcollection.h"
+#include "../sceneGraph/glc_3dviewinstance.h"
+#include "../sceneGraph/glc_spacepartitioning.h"
+#include "../sceneGraph/glc_world.h"
+#include "../geometry/glc_mesh.h"
+#include "glc_frustumculler.h"
+#include "../maths/glc_utils_maths.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// Maximum number of triangles of a mesh BVH leaf
+static const int rayCasterLeafSize= 4;
+
+// Localisation flags in a selection region
+/* A part inside the region sets the touch flag, a part outside the region sets the leave flag*/
+static const int rayCasterRegionTouch= 1;
+static const int rayCasterRegionLeave= 2;
+static const int rayCasterRegionInside= rayCasterRegionTouch;
+static const int rayCasterRegionCrossing= rayCasterRegionTouch | rayCasterRegionLeave;
+static const int rayCasterRegionOut= rayCasterRegionLeave;
+
+// A triangle of a mesh in the mesh coordinate system
+class RayCasterTriangle
+{
+public:
+	float m_Vertex[3][3];
+	GLC_uint m_PrimitiveId;
+};
+
+// A node of a mesh BVH
+/* If m_Count is greater than 0 the node is a leaf and m_First is the index of its first triangle,
+ * else the node children are at m_First and m_First + 1*/
+class RayCasterNode
+{
+public:
+	float m_Min[3];
+	float m_Max[3];
+	qint32 m_First;
+	qint32 m_Count;
+};
+
+// The BVH of the triangles of a mesh LOD
+class RayCasterMeshBvh
+{
+public:
+	RayCasterMeshBvh(const GLC_Mesh* pMesh, int lod);
+
+	// Return true if the given ray hit a triangle nearer than the given distance
+	/* The distance and the triangle index are updated with the nearest hit*/
+	bool intersect(const double* pOrigin, const double* pDirection, double* pDistance, int* pTriangle) const;
+
+	// Return the localisation flags of the triangles in the given region, with the given composition matrix
+	/* The traversal stops when one of the given stop flags is set.
+	 * If not NULL, the localisation flags of each primitive are accumulated in pPrimitives*/
+	int localize(const double* pMatrix, const RayCasterRegion& region, int stopFlags, QHash<GLC_uint, int>* pPrimitives) const;
+
+	// The number of positions of the mesh when the BVH has been built
+	int m_PositionSize;
+	QVector<RayCasterTriangle> m_Triangles;
+	QVector<RayCasterNode> m_Nodes;
+
+private:
+	void addTriangle(const GLfloatVector& positions, GLuint i0, GLuint i1, GLuint i2, GLC_uint primitiveId);
+	void build();
+	void triangleRange(int nodeIndex, int* pFirst, int* pEnd) const;
+};
+
+// A selection region, a polygon in normalized device coordinates
+/* Points inside the region follow the odd even rule*/
+class RayCasterRegion
+{
+public:
+	explicit RayCasterRegion(const QPolygonF& polygon);
+
+	// Return the localisation of the given convex polygon
+	int localizeConvex(const double* pX, const double* pY, int count) const;
+
+	// Return the localisation of the given box transformed by the given composition matrix
+	/* The localisation is conservative, a box whose localisation is not sure is crossing*/
+	int localizeBox(const double* pMatrix, const double* pMin, const double* pMax) const;
+
+	// Return the localisation of the given triangle transformed by the given composition matrix
+	/* The triangle is clipped by the near plane, its part behind the near plane is outside*/
+	int localizeTriangle(const double* pMatrix, const float pVertex[3][3]) const;
+
+	QPolygonF m_Polygon;
+	QRectF m_Bounds;
+
+private:
+	bool crossEdges(const double* pX, const double* pY, int count) const;
+};
+
+// Compare triangle centroids along an axis
+class RayCasterCentroidLessThan
+{
+public:
+	explicit RayCasterCentroidLessThan(int axis)
+	: m_Axis(axis)
+	{}
+
+	bool operator()(const RayCasterTriangle& triangle1, const RayCasterTriangle& triangle2) const
+	{
+		const float center1= triangle1.m_Vertex[0][m_Axis] + triangle1.m_Vertex[1][m_Axis] + triangle1.m_Vertex[2][m_Axis];
+		const float center2= triangle2.m_Vertex[0][m_Axis] + triangle2.m_Vertex[1][m_Axis] + triangle2.m_Vertex[2][m_Axis];
+		return center1 < center2;
+	}
+
+private:
+	int m_Axis;
+};
+
+// Return the entry distance of the given ray in the given node, -1 if the node is missed
+static inline double rayCasterNodeDistance(const RayCasterNode& node, const double* pOrigin, const double* pInverse, double maxDistance)
+{
+	double nearDistance= 0.0;
+	double farDistance= maxDistance;
+	for (int j= 0; j < 3; ++j)
+	{
+		if (0.0 == pInverse[j])
+		{
+			if ((pOrigin[j] < node.m_Min[j]) || (pOrigin[j] > node.m_Max[j])) return -1.0;
+		}
+		else
+		{
+			double t1= (node.m_Min[j] - pOrigin[j]) * pInverse[j];
+			double t2= (node.m_Max[j] - pOrigin[j]) * pInverse[j];
+			if (t1 > t2) qSwap(t1, t2);
+			nearDistance= qMax(nearDistance, t1);
+			farDistance= qMin(farDistance, t2);
+			if (nearDistance > farDistance) return -1.0;
+		}
+	}
+	return nearDistance;
+}
+
+// Return the distance of the given ray to the given triangle, -1 if the triangle is missed
+/* Moller-Trumbore intersection, triangles are two sided*/
+static inline double rayCasterTriangleDistance(const RayCasterTriangle& triangle, const double* pOrigin, const double* pDirection)
+{
+	const float* v0= triangle.m_Vertex[0];
+	const float* v1= triangle.m_Vertex[1];
+	const float* v2= triangle.m_Vertex[2];
+	const double e1[3]= {double(v1[0]) - v0[0], double(v1[1]) - v0[1], double(v1[2]) - v0[2]};
+	const double e2[3]= {double(v2[0]) - v0[0], double(v2[1]) - v0[1], double(v2[2]) - v0[2]};
+
+	const double p[3]= {pDirection[1] * e2[2] - pDirection[2] * e2[1]
+					   , pDirection[2] * e2[0] - pDirection[0] * e2[2]
+					   , pDirection[0] * e2[1] - pDirection[1] * e2[0]};
+	const double determinant= e1[0] * p[0] + e1[1] * p[1] + e1[2] * p[2];
+	if (qAbs(determinant) < std::numeric_limits<double>::min()) return -1.0;
+	const double inverse= 1.0 / determinant;
+
+	const double s[3]= {pOrigin[0] - v0[0], pOrigin[1] - v0[1], pOrigin[2] - v0[2]};
+	const double u= (s[0] * p[0] + s[1] * p[1] + s[2] * p[2]) * inverse;
+	if ((u < 0.0) || (u > 1.0)) return -1.0;
+
+	const double q[3]= {s[1] * e1[2] - s[2] * e1[1]
+					   , s[2] * e1[0] - s[0] * e1[2]
+					   , s[0] * e1[1] - s[1] * e1[0]};
+	const double v= (pDirection[0] * q[0] + pDirection[1] * q[1] + pDirection[2] * q[2]) * inverse;
+	if ((v < 0.0) || ((u + v) > 1.0)) return -1.0;
+
+	return (e2[0] * q[0] + e2[1] * q[1] + e2[2] * q[2]) * inverse;
+}
+
+// Return the orientation of the point c from the line going through a and b
+static inline double rayCasterOrientation(double ax, double ay, double bx, double by, double cx, double cy)
+{
+	return (bx - ax) * (cy - ay) - (by - ay) * (cx - ax);
+}
+
+// Return true if the given segments intersect, touching segments intersect
+static bool rayCasterSegmentsIntersect(double ax, double ay, double bx, double by, double cx, double cy, double dx, double dy)
+{
+	if ((qMax(ax, bx) < qMin(cx, dx)) || (qMax(cx, dx) < qMin(ax, bx))) return false;
+	if ((qMax(ay, by) < qMin(cy, dy)) || (qMax(cy, dy) < qMin(ay, by))) return false;
+
+	const double o1= rayCasterOrientation(ax, ay, bx, by, cx, cy);
+	const double o2= rayCasterOrientation(ax, ay, bx, by, dx, dy);
+	const double o3= rayCasterOrientation(cx, cy, dx, dy, ax, ay);
+	const double o4= rayCasterOrientation(cx, cy, dx, dy, bx, by);
+
+	// The bounds overlap, so collinear segments intersect
+	return ((o1 * o2) <= 0.0) && ((o3 * o4) <= 0.0);
+}
+
+// Return true if the given point is inside the given convex polygon
+static bool rayCasterConvexContains(const double* pX, const double* pY, int count, double x, double y)
+{
+	bool positive= false;
+	bool negative= false;
+	for (int i= 0; i < count; ++i)
+	{
+		const int next= (i + 1) % count;
+		const double orientation= rayCasterOrientation(pX[i], pY[i], pX[next], pY[next], x, y);
+		if (orientation > 0.0) positive= true;
+		else if (orientation < 0.0) negative= true;
+	}
+	return !(positive && negative);
+}
+
+// Return true if the given localisation flags are selected with the given mode
+static inline bool rayCasterRegionSelects(int flags, GLC_RayCaster::RegionMode mode)
+{
+	if (mode == GLC_RayCaster::CrossingRegion) return 0 != (flags & rayCasterRegionTouch);
+	else return flags == rayCasterRegionInside;
+}
+
+// Return the normalized plane of the clip space inequality rowFactor * row + wFactor * w >= 0
+static GLC_Plane rayCasterClipPlane(const double* pMatrix, int row, double rowFactor, double wFactor)
+{
+	const double* m= pMatrix;
+	GLC_Plane subject(rowFactor * m[row] + wFactor * m[3]
+					, rowFactor * m[4 + row] + wFactor * m[7]
+					, rowFactor * m[8 + row] + wFactor * m[11]
+					, rowFactor * m[12 + row] + wFactor * m[15]);
+	subject.normalize();
+	return subject;
+}
+
+// Sort instances by entry distance
+static bool rayCasterEntryLessThan(const QPair<double, GLC_3DViewInstance*>& entry1, const QPair<double, GLC_3DViewInstance*>& entry2)
+{
+	return entry1.first < entry2.first;
+}
+
+RayCasterMeshBvh::RayCasterMeshBvh(const GLC_Mesh* pMesh, int lod)
+: m_PositionSize(pMesh->positionVector().size())
+, m_Triangles()
+, m_Nodes()
+{
+	const GLfloatVector& positions= pMesh->positionVector();
+	const QList<GLC_uint> materialIds(pMesh->materialIds());
+	const int materialCount= materialIds.count();
+	for (int m= 0; m < materialCount; ++m)
+	{
+		const GLC_uint materialId= materialIds.at(m);
+		if (!pMesh->lodContainsMaterial(lod, materialId)) continue;
+
+		if (pMesh->containsTriangles(lod, materialId))
+		{
+			const QVector<GLuint> index(pMesh->getTrianglesIndex(lod, materialId));
+			const QVector<GLC_uint> ids(pMesh->getTrianglesPrimitiveId(lod, materialId));
+			const int count= index.size() / 3;
+			for (int i= 0; i < count; ++i)
+			{
+				addTriangle(positions, index.at(3 * i), index.at(3 * i + 1), index.at(3 * i + 2), ids.value(i));
+			}
+		}
+		if (pMesh->containsStrips(lod, materialId))
+		{
+			const QList<QVector<GLuint> > strips(pMesh->getStripsIndex(lod, materialId));
+			const QVector<GLC_uint> ids(pMesh->getStripsPrimitiveId(lod, materialId));
+			const int stripCount= strips.count();
+			for (int i= 0; i < stripCount; ++i)
+			{
+				const QVector<GLuint>& strip= strips.at(i);
+				for (int j= 2; j < strip.size(); ++j)
+				{
+					addTriangle(positions, strip.at(j - 2), strip.at(j - 1), strip.at(j), ids.value(i));
+				}
+			}
+		}
+		if (pMesh->containsFans(lod, materialId))
+		{
+			const QList<QVector<GLuint> > fans(pMesh->getFansIndex(lod, materialId));
+			const QVector<GLC_uint> ids(pMesh->getFansPrimitiveId(lod, materialId));
+			const int fanCount= fans.count();
+			for (int i= 0; i < fanCount; ++i)
+			{
+				const QVector<GLuint>& fan= fans.at(i);
+				for (int j= 2; j < fan.size(); ++j)
+				{
+					addTriangle(positions, fan.at(0), fan.at(j - 1), fan.at(j), ids.value(i));
+				}
+			}
+		}
+	}
+
+	build();
+}
+
+void RayCasterMeshBvh::addTriangle(const GLfloatVector& positions, GLuint i0, GLuint i1, GLuint i2, GLC_uint primitiveId)
+{
+	const int positionSize= positions.size();
+	if (((3 * i0 + 2) >= GLuint(positionSize)) || ((3 * i1 + 2) >= GLuint(positionSize)) || ((3 * i2 + 2) >= GLuint(positionSize))) return;
+
+	RayCasterTriangle triangle;
+	const GLuint index[3]= {i0, i1, i2};
+	for (int v= 0; v < 3; ++v)
+	{
+		for (int j= 0; j < 3; ++j)
+		{
+			triangle.m_Vertex[v][j]= positions.at(3 * index[v] + j);
+		}
+	}
+	triangle.m_PrimitiveId= primitiveId;
+	m_Triangles.append(triangle);
+}
+
+void RayCasterMeshBvh::build()
+{
+	m_Nodes.clear();
+	if (m_Triangles.isEmpty()) return;
+
+	// Median split, a node and its sibling are contiguous
+	m_Nodes.reserve(2 * (m_Triangles.size() / rayCasterLeafSize) + 1);
+	RayCasterNode rootNode;
+	rootNode.m_First= 0;
+	rootNode.m_Count= m_Triangles.size();
+	m_Nodes.append(rootNode);
+
+	QVector<int> nodeStack;
+	nodeStack.append(0);
+	while (!nodeStack.isEmpty())
+	{
+		const int nodeIndex= nodeStack.takeLast();
+		const int first= m_Nodes.at(nodeIndex).m_First;
+		const int count= m_Nodes.at(nodeIndex).m_Count;
+
+		float boxMin[3];
+		float boxMax[3];
+		float centerMin[3];
+		float centerMax[3];
+		for (int j= 0; j < 3; ++j)
+		{
+			boxMin[j]= centerMin[j]= std::numeric_limits<float>::max();
+			boxMax[j]= centerMax[j]= -std::numeric_limits<float>::max();
+		}
+		for (int i= first; i < (first + count); ++i)
+		{
+			const RayCasterTriangle& triangle= m_Triangles.at(i);
+			for (int j= 0; j < 3; ++j)
+			{
+				const float center= triangle.m_Vertex[0][j] + triangle.m_Vertex[1][j] + triangle.m_Vertex[2][j];
+				centerMin[j]= qMin(centerMin[j], center);
+				centerMax[j]= qMax(centerMax[j], center);
+				for (int v= 0; v < 3; ++v)
+				{
+					boxMin[j]= qMin(boxMin[j], triangle.m_Vertex[v][j]);
+					boxMax[j]= qMax(boxMax[j], triangle.m_Vertex[v][j]);
+				}
+			}
+		}
+		RayCasterNode& node= m_Nodes[nodeIndex];
+		for (int j= 0; j < 3; ++j)
+		{
+			node.m_Min[j]= boxMin[j];
+			node.m_Max[j]= boxMax[j];
+		}
+
+		if (count <= rayCasterLeafSize) continue;
+
+		int axis= 0;
+		for (int j= 1; j < 3; ++j)
+		{
+			if ((centerMax[j] - centerMin[j]) > (centerMax[axis] - centerMin[axis])) axis= j;
+		}
+		const int middle= first + count / 2;
+		RayCasterTriangle* pTriangles= m_Triangles.data();
+		std::nth_element(pTriangles + first, pTriangles + middle, pTriangles + first + count, RayCasterCentroidLessThan(axis));
+
+		const int childIndex= m_Nodes.size();
+		node.m_First= childIndex;
+		node.m_Count= 0;
+
+		RayCasterNode leftNode;
+		leftNode.m_First= first;
+		leftNode.m_Count= middle - first;
+		RayCasterNode rightNode;
+		rightNode.m_First= middle;
+		rightNode.m_Count= first + count - middle;
+		m_Nodes.append(leftNode);
+		m_Nodes.append(rightNode);
+
+		nodeStack.append(childIndex + 1);
+		nodeStack.append(childIndex);
+	}
+}
+
+bool RayCasterMeshBvh::intersect(const double* pOrigin, const double* pDirection, double* pDistance, int* pTriangle) const
+{
+	if (m_Nodes.isEmpty()) return false;
+
+	double inverse[3];
+	for (int j= 0; j < 3; ++j)
+	{
+		inverse[j]= (pDirection[j] != 0.0) ? (1.0 / pDirection[j]) : 0.0;
+	}
+
+	bool subject= false;
+	const RayCasterNode* pNodes= m_Nodes.constData();
+	if (rayCasterNodeDistance(pNodes[0], pOrigin, inverse, *pDistance) < 0.0) return false;
+
+	QVector<int> nodeStack;
+	nodeStack.append(0);
+	while (!nodeStack.isEmpty())
+	{
+		const RayCasterNode& node= pNodes[nodeStack.takeLast()];
+		if (node.m_Count > 0)
+		{
+			const int end= node.m_First + node.m_Count;
+			for (int i= node.m_First; i < end; ++i)
+			{
+				const double distance= rayCasterTriangleDistance(m_Triangles.at(i), pOrigin, pDirection);
+				if ((distance >= 0.0) && (distance < *pDistance))
+				{
+					*pDistance= distance;
+					*pTriangle= i;
+					subject= true;
+				}
+			}
+		}
+		else
+		{
+			// Visit the nearest child first
+			const double leftDistance= rayCasterNodeDistance(pNodes[node.m_First], pOrigin, inverse, *pDistance);
+			const double rightDistance= rayCasterNodeDistance(pNodes[node.m_First + 1], pOrigin, inverse, *pDistance);
+			if (leftDistance <= rightDistance)
+			{
+				if (rightDistance >= 0.0) nodeStack.append(node.m_First + 1);
+				if (leftDistance >= 0.0) nodeStack.append(node.m_First);
+			}
+			else
+			{
+				if (leftDistance >= 0.0) nodeStack.append(node.m_First);
+				if (rightDistance >= 0.0) nodeStack.append(node.m_First + 1);
+			}
+		}
+	}
+
+	return subject;
+}
+
+int RayCasterMeshBvh::localize(const double* pMatrix, const RayCasterRegion& region, int stopFlags, QHash<GLC_uint, int>* pPrimitives) const
+{
+	int subject= 0;
+	if (m_Nodes.isEmpty()) return subject;
+
+	const RayCasterNode* pNodes= m_Nodes.constData();
+	QVector<int> nodeStack;
+	nodeStack.append(0);
+	while (!nodeStack.isEmpty() && (0 == (subject & stopFlags)))
+	{
+		const int nodeIndex= nodeStack.takeLast();
+		const RayCasterNode& node= pNodes[nodeIndex];
+		const double lower[3]= {node.m_Min[0], node.m_Min[1], node.m_Min[2]};
+		const double upper[3]= {node.m_Max[0], node.m_Max[1], node.m_Max[2]};
+		const int nodeLocalisation= region.localizeBox(pMatrix, lower, upper);
+		if (nodeLocalisation != rayCasterRegionCrossing)
+		{
+			// All the triangles of the node have the same localisation
+			subject|= nodeLocalisation;
+			if (NULL != pPrimitives)
+			{
+				int first, end;
+				triangleRange(nodeIndex, &first, &end);
+				for (int i= first; i < end; ++i)
+				{
+					(*pPrimitives)[m_Triangles.at(i).m_PrimitiveId]|= nodeLocalisation;
+				}
+			}
+		}
+		else if (node.m_Count > 0)
+		{
+			const int end= node.m_First + node.m_Count;
+			for (int i= node.m_First; i < end; ++i)
+			{
+				const RayCasterTriangle& triangle= m_Triangles.at(i);
+				const int triangleLocalisation= region.localizeTriangle(pMatrix, triangle.m_Vertex);
+				subject|= triangleLocalisation;
+				if (NULL != pPrimitives)
+				{
+					(*pPrimitives)[triangle.m_PrimitiveId]|= triangleLocalisation;
+				}
+			}
+		}
+		else
+		{
+			nodeStack.append(node.m_First + 1);
+			nodeStack.append(node.m_First);
+		}
+	}
+
+	return subject;
+}
+
+void RayCasterMeshBvh::triangleRange(int nodeIndex, int* pFirst, int* pEnd) const
+{
+	// The triangles of a sub tree are contiguous, from its leftmost leaf to its rightmost leaf
+	int leftIndex= nodeIndex;
+	while (0 == m_Nodes.at(leftIndex).m_Count)
+	{
+		leftIndex= m_Nodes.at(leftIndex).m_First;
+	}
+	int rightIndex= nodeIndex;
+	while (0 == m_Nodes.at(rightIndex).m_Count)
+	{
+		rightIndex= m_Nodes.at(rightIndex).m_First + 1;
+	}
+	*pFirst= m_Nodes.at(leftIndex).m_First;
+	*pEnd= m_Nodes.at(rightIndex).m_First + m_Nodes.at(rightIndex).m_Count;
+}
+
+RayCasterRegion::RayCasterRegion(const QPolygonF& polygon)
+: m_Polygon(polygon)
+, m_Bounds()
+{
+	if (m_Polygon.isClosed() && (m_Polygon.size() > 1))
+	{
+		m_Polygon.removeLast();
+	}
+	m_Bounds= m_Polygon.boundingRect();
+}
+
+int RayCasterRegion::localizeConvex(const double* pX, const double* pY, int count) const
+{
+	double minX= pX[0];
+	double maxX= pX[0];
+	double minY= pY[0];
+	double maxY= pY[0];
+	for (int i= 1; i < count; ++i)
+	{
+		minX= qMin(minX, pX[i]);
+		maxX= qMax(maxX, pX[i]);
+		minY= qMin(minY, pY[i]);
+		maxY= qMax(maxY, pY[i]);
+	}
+	if ((maxX < m_Bounds.left()) || (minX > m_Bounds.right()) || (maxY < m_Bounds.top()) || (minY > m_Bounds.bottom()))
+	{
+		return rayCasterRegionOut;
+	}
+
+	int insideCount= 0;
+	for (int i= 0; i < count; ++i)
+	{
+		if (m_Polygon.containsPoint(QPointF(pX[i], pY[i]), Qt::OddEvenFill)) ++insideCount;
+	}
+	if ((insideCount > 0) && (insideCount < count)) return rayCasterRegionCrossing;
+	if (crossEdges(pX, pY, count)) return rayCasterRegionCrossing;
+	if (insideCount == count) return rayCasterRegionInside;
+
+	// The polygon is outside the region or the region is inside the polygon
+	const QPointF& point= m_Polygon.first();
+	if ((point.x() >= minX) && (point.x() <= maxX) && (point.y() >= minY) && (point.y() <= maxY)
+			&& rayCasterConvexContains(pX, pY, count, point.x(), point.y()))
+	{
+		return rayCasterRegionCrossing;
+	}
+
+	return rayCasterRegionOut;
+}
+
+int RayCasterRegion::localizeBox(const double* pMatrix, const double* pMin, const double* pMax) const
+{
+	const double* m= pMatrix;
+	double minX= std::numeric_limits<double>::max();
+	double maxX= -std::numeric_limits<double>::max();
+	double minY= std::numeric_limits<double>::max();
+	double maxY= -std::numeric_limits<double>::max();
+	int behindCount= 0;
+	for (int i= 0; i < 8; ++i)
+	{
+		const double x= (i & 1) ? pMax[0] : pMin[0];
+		const double y= (i & 2) ? pMax[1] : pMin[1];
+		const double z= (i & 4) ? pMax[2] : pMin[2];
+		const double clipZ= m[2] * x + m[6] * y + m[10] * z + m[14];
+		const double clipW= m[3] * x + m[7] * y + m[11] * z + m[15];
+		if ((clipZ + clipW) < 0.0)
+		{
+			++behindCount;
+		}
+		else
+		{
+			const double inverseW= 1.0 / clipW;
+			const double screenX= (m[0] * x + m[4] * y + m[8] * z + m[12]) * inverseW;
+			const double screenY= (m[1] * x + m[5] * y + m[9] * z + m[13]) * inverseW;
+			minX= qMin(minX, screenX);
+			maxX= qMax(maxX, screenX);
+			minY= qMin(minY, screenY);
+			maxY= qMax(maxY, screenY);
+		}
+	}
+	if (8 == behindCount) return rayCasterRegionOut;
+	if (behindCount > 0) return rayCasterRegionCrossing;
+
+	// The projected box is inside its screen rectangle
+	const double rectX[4]= {minX, maxX, maxX, minX};
+	const double rectY[4]= {minY, minY, maxY, maxY};
+	return localizeConvex(rectX, rectY, 4);
+}
+
+int RayCasterRegion::localizeTriangle(const double* pMatrix, const float pVertex[3][3]) const
+{
+	const double* m= pMatrix;
+	double clip[3][4];
+	for (int v= 0; v < 3; ++v)
+	{
+		const double x= pVertex[v][0];
+		const double y= pVertex[v][1];
+		const double z= pVertex[v][2];
+		for (int j= 0; j < 4; ++j)
+		{
+			clip[v][j]= m[j] * x + m[4 + j] * y + m[8 + j] * z + m[12 + j];
+		}
+	}
+
+	// Clip the triangle by the near plane z + w >= 0
+	double screenX[4];
+	double screenY[4];
+	int count= 0;
+	bool clipped= false;
+	for (int v= 0; v < 3; ++v)
+	{
+		const double* pCurrent= clip[v];
+		const double* pNext= clip[(v + 1) % 3];
+		const double currentDistance= pCurrent[2] + pCurrent[3];
+		const double nextDistance= pNext[2] + pNext[3];
+		if (currentDistance >= 0.0)
+		{
+			screenX[count]= pCurrent[0] / pCurrent[3];
+			screenY[count]= pCurrent[1] / pCurrent[3];
+			++count;
+		}
+		else
+		{
+			clipped= true;
+		}
+		if ((currentDistance >= 0.0) != (nextDistance >= 0.0))
+		{
+			const double t= currentDistance / (currentDistance - nextDistance);
+			const double w= pCurrent[3] + t * (pNext[3] - pCurrent[3]);
+			screenX[count]= (pCurrent[0] + t * (pNext[0] - pCurrent[0])) / w;
+			screenY[count]= (pCurrent[1] + t * (pNext[1] - pCurrent[1])) / w;
+			++count;
+		}
+	}
+	if (0 == count) return rayCasterRegionOut;
+
+	int subject= localizeConvex(screenX, screenY, count);
+	if (clipped) subject|= rayCasterRegionLeave;
+	return subject;
+}
+
+bool RayCasterRegion::crossEdges(const double* pX, const double* pY, int count) const
+{
+	const int regionCount= m_Polygon.size();
+	for (int i= 0; i < count; ++i)
+	{
+		const int next= (i + 1) % count;
+		for (int j= 0; j < regionCount; ++j)
+		{
+			const QPointF& point1= m_Polygon.at(j);
+			const QPointF& point2= m_Polygon.at((j + 1) % regionCount);
+			if (rayCasterSegmentsIntersect(pX[i], pY[i], pX[next], pY[next], point1.x(), point1.y(), point2.x(), point2.y()))
+			{
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+GLC_RayHit::GLC_RayHit()
+: m_OccurrenceId(0)
+, m_BodyIndex(-1)
+, m_BodyId(0)
+, m_PrimitiveId(0)
+, m_Point()
+, m_Normal()
+, m_Distance(std::numeric_limits<double>::max())
+{
+
+}
+
+GLC_RayCaster::GLC_RayCaster(GLC_3DViewCollection* pCollection)
+: m_pCollection(pCollection)
+, m_Lod(0)
+, m_MeshBvhCache()
+{
+	Q_ASSERT(NULL != pCollection);
+}
+
+GLC_RayCaster::~GLC_RayCaster()
+{
+	clearCache();
+}
+
+GLC_Line3d GLC_RayCaster::rayFromViewport(const GLC_Viewport& viewport, int x, int y)
+{
+	const GLC_Camera* pCamera= viewport.cameraHandle();
+	const GLC_Point2d position= viewport.mapToOpenGLScreen(x, y);
+	const GLC_Vector3d forward(pCamera->forward().normalize());
+	const GLC_Vector3d side(pCamera->sideVector());
+	const GLC_Vector3d up((side ^ forward).normalize());
+
+	GLC_Line3d subject;
+	if (viewport.useOrtho())
+	{
+		// Same extent than the viewport projection matrix
+		const double height= pCamera->distEyeTarget() * viewport.viewTangent();
+		const double width= height * viewport.aspectRatio();
+		subject.setStartingPoint(pCamera->eye() + side * (position.x() * width * 0.5) + up * (position.y() * height * 0.5));
+		subject.setDirection(forward);
+	}
+	else
+	{
+		const double yMax= tan(viewport.viewAngle() * glc::PI / 360.0);
+		const double xMax= yMax * viewport.aspectRatio();
+		subject.setStartingPoint(pCamera->eye());
+		subject.setDirection((forward + side * (position.x() * xMax) + up * (position.y() * yMax)).normalize());
+	}
+
+	return subject;
+}
+
+GLC_Frustum GLC_RayCaster::regionFrustum(const GLC_Matrix4x4& compositionMatrix, const QRectF& rect)
+{
+	// Gribb and Hartmann planes of the clip space rectangle
+	const double* m= compositionMatrix.getData();
+	GLC_Frustum subject;
+	subject.setLeftClippingPlane(rayCasterClipPlane(m, 0, 1.0, -rect.left()));
+	subject.setRightClippingPlane(rayCasterClipPlane(m, 0, -1.0, rect.right()));
+	subject.setTopClippingPlane(rayCasterClipPlane(m, 1, 1.0, -rect.top()));
+	subject.setBottomClippingPlane(rayCasterClipPlane(m, 1, -1.0, rect.bottom()));
+	subject.setNearClippingPlane(rayCasterClipPlane(m, 2, 1.0, 1.0));
+	subject.setFarClippingPlane(rayCasterClipPlane(m, 2, -1.0, 1.0));
+
+	return subject;
+}
+
+GLC_RayHit GLC_RayCaster::castRay(const GLC_Line3d& ray)
+{
+	GLC_RayHit subject;
+	GLC_Vector3d direction(ray.direction());
+	if (direction.isNull()) return subject;
+
+	// Distances are measured along a normalized direction
+	const GLC_Line3d normalizedRay(ray.startingPoint(), direction.normalize());
+
+	QList<GLC_3DViewInstance*> instanceList;
+	GLC_SpacePartitioning* pSpacePartitioning= m_pCollection->spacePartitioningHandle();
+	if (m_pCollection->spacePartitioningIsUsed() && (NULL != pSpacePartitioning))
+	{
+		instanceList= pSpacePartitioning->listOfInstancesIntersectingRay(normalizedRay);
+	}
+	else
+	{
+		instanceList= m_pCollection->instancesHandle();
+	}
+
+	// Test the instances from the nearest
+	QVector<QPair<double, GLC_3DViewInstance*> > entryList;
+	entryList.reserve(instanceList.size());
+	const bool showState= m_pCollection->showState();
+	const int instanceCount= instanceList.count();
+	for (int i= 0; i < instanceCount; ++i)
+	{
+		GLC_3DViewInstance* pInstance= instanceList.at(i);
+		double entryDistance;
+		if ((pInstance->isVisible() == showState) && pInstance->boundingBox().intersectRay(normalizedRay, &entryDistance))
+		{
+			entryList.append(qMakePair(entryDistance, pInstance));
+		}
+	}
+	std::sort(entryList.begin(), entryList.end(), rayCasterEntryLessThan);
+
+	const int entryCount= entryList.count();
+	for (int i= 0; (i < entryCount) && (entryList.at(i).first <= subject.m_Distance); ++i)
+	{
+		castRayOnInstance(entryList.at(i).second, normalizedRay, &subject);
+	}
+
+	if (subject.isValid())
+	{
+		subject.m_Point= normalizedRay.startingPoint() + normalizedRay.direction() * subject.m_Distance;
+		if ((subject.m_Normal * normalizedRay.direction()) > 0.0)
+		{
+			subject.m_Normal= -subject.m_Normal;
+		}
+	}
+
+	return subject;
+}
+
+GLC_SelectionSet GLC_RayCaster::selectRegion(const GLC_Matrix4x4& compositionMatrix, const QPolygonF& region, RegionMode mode
+		, const GLC_World* pWorld, bool selectPrimitives)
+{
+	GLC_SelectionSet subject;
+	if (NULL != pWorld)
+	{
+		subject.setAttachedWorld(*pWorld);
+	}
+
+	const RayCasterRegion selectionRegion(region);
+	if (selectionRegion.m_Polygon.size() < 3) return subject;
+
+	// The instances are found with the frustum of the region bounds
+	const GLC_Frustum frustum(regionFrustum(compositionMatrix, selectionRegion.m_Bounds));
+	QList<GLC_3DViewInstance*> instanceList;
+	GLC_SpacePartitioning* pSpacePartitioning= m_pCollection->spacePartitioningHandle();
+	if (m_pCollection->spacePartitioningIsUsed() && (NULL != pSpacePartitioning))
+	{
+		instanceList= pSpacePartitioning->listOfInstancesInFrustum(frustum);
+	}
+	else
+	{
+		const GLC_FrustumCuller culler(frustum);
+		const QList<GLC_3DViewInstance*> collectionInstances(m_pCollection->instancesHandle());
+		const int collectionCount= collectionInstances.count();
+		for (int i= 0; i < collectionCount; ++i)
+		{
+			GLC_3DViewInstance* pInstance= collectionInstances.at(i);
+			if (!pInstance->boundingBox().isEmpty() && (culler.localizeBoundingBox(pInstance->boundingBox()) != GLC_Frustum::OutFrustum))
+			{
+				instanceList.append(pInstance);
+			}
+		}
+	}
+
+	const bool showState= m_pCollection->showState();
+	const int instanceCount= instanceList.count();
+	for (int i= 0; i < instanceCount; ++i)
+	{
+		GLC_3DViewInstance* pInstance= instanceList.at(i);
+		if (pInstance->isVisible() == showState)
+		{
+			selectRegionOnInstance(pInstance, compositionMatrix, selectionRegion, mode, selectPrimitives, &subject);
+		}
+	}
+
+	return subject;
+}
+
+GLC_SelectionSet GLC_RayCaster::selectInsideRectangle(const GLC_Viewport& viewport, const QRect& rect, RegionMode mode
+		, const GLC_World* pWorld, bool selectPrimitives)
+{
+	const QRect normalizedRect(rect.normalized());
+	const int left= normalizedRect.x();
+	const int top= normalizedRect.y();
+	const int right= left + normalizedRect.width();
+	const int bottom= top + normalizedRect.height();
+
+	QPolygon lasso;
+	lasso << QPoint(left, top) << QPoint(right, top) << QPoint(right, bottom) << QPoint(left, bottom);
+	return selectInsideLasso(viewport, lasso, mode, pWorld, selectPrimitives);
+}
+
+GLC_SelectionSet GLC_RayCaster::selectInsideLasso(const GLC_Viewport& viewport, const QPolygon& lasso, RegionMode mode
+		, const GLC_World* pWorld, bool selectPrimitives)
+{
+	QPolygonF region;
+	const int count= lasso.size();
+	region.reserve(count);
+	for (int i= 0; i < count; ++i)
+	{
+		const GLC_Point2d position= viewport.mapToOpenGLScreen(lasso.at(i).x(), lasso.at(i).y());
+		region.append(QPointF(position.x(), position.y()));
+	}
+
+	return selectRegion(viewport.compositionMatrix(), region, mode, pWorld, selectPrimitives);
+}
+
+void GLC_RayCaster::setLod(int lod)
+{
+	m_Lod= qMax(0, lod);
+}
+
+void GLC_RayCaster::setCollection(GLC_3DViewCollection* pCollection)
+{
+	Q_ASSERT(NULL != pCollection);
+	m_pCollection= pCollection;
+}
+
+void GLC_RayCaster::removeFromCache(GLC_uint geometryId)
+{
+	QHash<QPair<GLC_uint, int>, RayCasterMeshBvh*>::iterator iBvh= m_MeshBvhCache.begin();
+	while (iBvh != m_MeshBvhCache.end())
+	{
+		if (iBvh.key().first == geometryId)
+		{
+			delete iBvh.value();
+			iBvh= m_MeshBvhCache.erase(iBvh);
+		}
+		else
+		{
+			++iBvh;
+		}
+	}
+}
+
+void GLC_RayCaster::clearCache()
+{
+	qDeleteAll(m_MeshBvhCache);
+	m_MeshBvhCache.clear();
+}
+
+RayCasterMeshBvh* GLC_RayCaster::meshBvh(GLC_Mesh* pMesh)
+{
+	const int lodCount= pMesh->lodCount();
+	if (0 == lodCount) return NULL;
+	const int lod= qMin(m_Lod, lodCount - 1);
+
+	const QPair<GLC_uint, int> key(pMesh->id(), lod);
+	RayCasterMeshBvh* pSubject= m_MeshBvhCache.value(key, NULL);
+	if ((NULL != pSubject) && (pSubject->m_PositionSize != pMesh->positionVector().size()))
+	{
+		// The mesh has been modified
+		delete pSubject;
+		pSubject= NULL;
+	}
+	if (NULL == pSubject)
+	{
+		pSubject= new RayCasterMeshBvh(pMesh, lod);
+		m_MeshBvhCache.insert(key, pSubject);
+	}
+
+	return pSubject;
+}
+
+void GLC_RayCaster::castRayOnInstance(GLC_3DViewInstance* pInstance, const GLC_Line3d& ray, GLC_RayHit* pHit)
+{
+	// The ray in the instance coordinate system has the same parametrisation
+	const GLC_Matrix4x4& matrix= pInstance->matrix();
+	const GLC_Matrix4x4 inverseMatrix(matrix.inverted());
+	const GLC_Point3d origin(ray.startingPoint());
+	const GLC_Point3d localOrigin(inverseMatrix * origin);
+	const GLC_Vector3d localDirection((inverseMatrix * (origin + ray.direction())) - localOrigin);
+	const GLC_Line3d localRay(localOrigin, localDirection);
+
+	const int bodyCount= pInstance->numberOfBody();
+	for (int i= 0; i < bodyCount; ++i)
+	{
+		GLC_Mesh* pMesh= dynamic_cast<GLC_Mesh*>(pInstance->geomAt(i));
+		if (NULL == pMesh) continue;
+
+		double entryDistance;
+		if (!pMesh->boundingBox().intersectRay(localRay, &entryDistance) || (entryDistance > pHit->m_Distance)) continue;
+
+		RayCasterMeshBvh* pBvh= meshBvh(pMesh);
+		if (NULL == pBvh) continue;
+
+		double distance= pHit->m_Distance;
+		int triangleIndex= -1;
+		if (pBvh->intersect(localOrigin.data(), localDirection.data(), &distance, &triangleIndex))
+		{
+			const RayCasterTriangle& triangle= pBvh->m_Triangles.at(triangleIndex);
+			const GLC_Point3d v0(matrix * GLC_Point3d(triangle.m_Vertex[0][0], triangle.m_Vertex[0][1], triangle.m_Vertex[0][2]));
+			const GLC_Point3d v1(matrix * GLC_Point3d(triangle.m_Vertex[1][0], triangle.m_Vertex[1][1], triangle.m_Vertex[1][2]));
+			const GLC_Point3d v2(matrix * GLC_Point3d(triangle.m_Vertex[2][0], triangle.m_Vertex[2][1], triangle.m_Vertex[2][2]));
+
+			pHit->m_OccurrenceId= pInstance->id();
+			pHit->m_BodyIndex= i;
+			pHit->m_BodyId= pMesh->id();
+			pHit->m_PrimitiveId= triangle.m_PrimitiveId;
+			pHit->m_Normal= ((v1 - v0) ^ (v2 - v0)).normalize();
+			pHit->m_Distance= distance;
+		}
+	}
+}
+
+void GLC_RayCaster::selectRegionOnInstance(GLC_3DViewInstance* pInstance, const GLC_Matrix4x4& compositionMatrix, const RayCasterRegion& region
+		, RegionMode mode, bool selectPrimitives, GLC_SelectionSet* pSelection)
+{
+	// Quick test of the instance bounding box in world coordinates
+	const GLC_BoundingBox& instanceBox= pInstance->boundingBox();
+	const int instanceLocalisation= region.localizeBox(compositionMatrix.getData(), instanceBox.lowerCorner().data(), instanceBox.upperCorner().data());
+	if (instanceLocalisation == rayCasterRegionOut) return;
+	if (!selectPrimitives && (instanceLocalisation == rayCasterRegionInside))
+	{
+		pSelection->insert(pInstance->id());
+		return;
+	}
+
+	// Without primitives, the bodies are tested until the selection of the instance is known
+	const int stopFlags= selectPrimitives ? 0 : ((mode == CrossingRegion) ? rayCasterRegionTouch : rayCasterRegionLeave);
+	const GLC_Matrix4x4 matrix(compositionMatrix * pInstance->matrix());
+	const double* pMatrix= matrix.getData();
+
+	int instanceFlags= 0;
+	QHash<GLC_uint, int> primitiveFlags;
+	const int bodyCount= pInstance->numberOfBody();
+	for (int i= 0; (i < bodyCount) && (0 == (instanceFlags & stopFlags)); ++i)
+	{
+		GLC_Geometry* pGeom= pInstance->geomAt(i);
+		const GLC_BoundingBox& box= pGeom->boundingBox();
+		if (box.isEmpty()) continue;
+
+		int bodyFlags= region.localizeBox(pMatrix, box.lowerCorner().data(), box.upperCorner().data());
+		primitiveFlags.clear();
+		GLC_Mesh* pMesh= dynamic_cast<GLC_Mesh*>(pGeom);
+		if ((NULL != pMesh) && (bodyFlags != rayCasterRegionOut) && (selectPrimitives || (bodyFlags == rayCasterRegionCrossing)))
+		{
+			RayCasterMeshBvh* pBvh= meshBvh(pMesh);
+			if (NULL != pBvh)
+			{
+				bodyFlags= pBvh->localize(pMatrix, region, stopFlags, selectPrimitives ? &primitiveFlags : NULL);
+			}
+		}
+		instanceFlags|= bodyFlags;
+
+		if (selectPrimitives)
+		{
+			// Bodies without primitive id are selected as a whole
+			QHash<GLC_uint, int>::const_iterator iPrimitive= primitiveFlags.constBegin();
+			while (iPrimitive != primitiveFlags.constEnd())
+			{
+				if (rayCasterRegionSelects(iPrimitive.value(), mode))
+				{
+					if (0 != iPrimitive.key()) pSelection->insert(pInstance->id(), pGeom->id(), iPrimitive.key());
+					else pSelection->insert(pInstance->id(), pGeom->id());
+				}
+				++iPrimitive;
+			}
+			if (primitiveFlags.isEmpty() && rayCasterRegionSelects(bodyFlags, mode))
+			{
+				pSelection->insert(pInstance->id(), pGeom->id());
+			}
+		}
+	}
+
+	if (!selectPrimitives && rayCasterRegionSelects(instanceFlags, mode))
+	{
+		pSelection->insert(pInstance->id());
+	}
+}
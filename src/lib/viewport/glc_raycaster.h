@@ -0,0 +1,243 @@
+/****************************************************************************
+
+ This file is part of the GLC-lib library.
+ Copyright (C) 2005-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ http://glc-lib.sourceforge.net
+
+ GLC-lib is free software; you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation; either version 3 of the License, or
+ (at your option) any later version.
+
+ GLC-lib is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with GLC-lib; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+
+//! \file glc_raycaster.h interface for the GLC_RayCaster class.
+
+#ifndef GLC_RAYCASTER_H_
+#define GLC_RAYCASTER_H_
+
+#include <QHash>
+#include <QPair>
+#include <QPolygonF>
+#include <QRect>
+
+#include "../maths/glc_vector3d.h"
+#include "../maths/glc_line3d.h"
+#include "../maths/glc_matrix4x4.h"
+#include "../sceneGraph/glc_selectionset.h"
+#include "glc_frustum.h"
+#include "../glc_global.h"
+#include "../glc_config.h"
+
+class GLC_3DViewCollection;
+class GLC_3DViewInstance;
+class GLC_Viewport;
+class GLC_Mesh;
+class GLC_World;
+class RayCasterMeshBvh;
+class RayCasterRegion;
+
+//////////////////////////////////////////////////////////////////////
+//! \class GLC_RayHit
+/*! \brief GLC_RayHit : The nearest intersection of a ray with a 3D view collection */
+//////////////////////////////////////////////////////////////////////
+class GLC_LIB_EXPORT GLC_RayHit
+{
+	friend class GLC_RayCaster;
+public:
+	//! Construct an invalid hit
+	GLC_RayHit();
+
+	//! Return true if this hit is valid
+	inline bool isValid() const
+	{return 0 != m_OccurrenceId;}
+
+	//! Return the id of the hit instance, which is the id of its occurrence
+	inline GLC_uint occurrenceId() const
+	{return m_OccurrenceId;}
+
+	//! Return the index of the hit body in its instance
+	inline int bodyIndex() const
+	{return m_BodyIndex;}
+
+	//! Return the id of the hit body
+	inline GLC_uint bodyId() const
+	{return m_BodyId;}
+
+	//! Return the id of the hit primitive, 0 if the body has no primitive id
+	inline GLC_uint primitiveId() const
+	{return m_PrimitiveId;}
+
+	//! Return the hit point in world coordinate
+	inline const GLC_Point3d& point() const
+	{return m_Point;}
+
+	//! Return the normal of the hit triangle in world coordinate, facing the ray
+	inline const GLC_Vector3d& normal() const
+	{return m_Normal;}
+
+	//! Return the distance between the ray starting point and the hit point
+	inline double distance() const
+	{return m_Distance;}
+
+private:
+	GLC_uint m_OccurrenceId;
+	int m_BodyIndex;
+	GLC_uint m_BodyId;
+	GLC_uint m_PrimitiveId;
+	GLC_Point3d m_Point;
+	GLC_Vector3d m_Normal;
+	double m_Distance;
+};
+
+//////////////////////////////////////////////////////////////////////
+//! \class GLC_RayCaster
+/*! \brief GLC_RayCaster : Pick instances of a 3D view collection without OpenGL */
+
+/*! The rays are tested against the triangles of the meshes of the collection
+ *  on the CPU, so picking does not render the scene and doesn't need an OpenGL context.
+ *  - Instances are found with the space partitioning of the collection if used.
+ *  - A triangle BVH is built the first time a mesh LOD is hit and kept in cache.
+ *
+ *  Rectangle and lasso selections are done the same way : the instances are found
+ *  with the sub frustum of the region bounds and the triangles are projected and tested
+ *  against the region in normalized device coordinates. Hidden and sub pixel
+ *  triangles are selected.
+ *
+ *  Meshes data must be on client side. The cache is keyed by the geometry id, it must
+ *  be cleared if a cached mesh is modified.*/
+//////////////////////////////////////////////////////////////////////
+class GLC_LIB_EXPORT GLC_RayCaster
+{
+public:
+	//! The region selection modes
+	enum RegionMode
+	{
+		InsideRegion,		//!< Select what is fully inside the region
+		CrossingRegion		//!< Select what is inside or crosses the region
+	};
+
+//////////////////////////////////////////////////////////////////////
+/*! @name Constructor / Destructor */
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Construct a ray caster of the given collection
+	explicit GLC_RayCaster(GLC_3DViewCollection* pCollection);
+
+	//! Destructor
+	~GLC_RayCaster();
+//@}
+
+//////////////////////////////////////////////////////////////////////
+/*! \name Get Functions*/
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Return the collection of this ray caster
+	inline GLC_3DViewCollection* collectionHandle() const
+	{return m_pCollection;}
+
+	//! Return the LOD used to test meshes
+	inline int lod() const
+	{return m_Lod;}
+
+	//! Return the number of cached mesh BVH
+	inline int cachedMeshCount() const
+	{return m_MeshBvhCache.count();}
+
+	//! Return the ray going through the given pixel of the given viewport
+	/*! The ray starts at the camera eye for a perspective projection
+	 *  and on the eye plane for an orthographic projection*/
+	static GLC_Line3d rayFromViewport(const GLC_Viewport& viewport, int x, int y);
+
+	//! Return the frustum of the given rectangle in normalized device coordinates
+	/*! The frustum is the part of the frustum of the given composition matrix
+	 *  (projection * modelview) which is projected inside the rectangle*/
+	static GLC_Frustum regionFrustum(const GLC_Matrix4x4& compositionMatrix, const QRectF& rect);
+//@}
+
+//////////////////////////////////////////////////////////////////////
+/*! \name Set Functions*/
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Return the nearest hit of the given ray with the visible instances of the collection
+	GLC_RayHit castRay(const GLC_Line3d& ray);
+
+	//! Return the nearest hit under the given pixel of the given viewport
+	inline GLC_RayHit pick(const GLC_Viewport& viewport, int x, int y)
+	{return castRay(rayFromViewport(viewport, x, y));}
+
+	//! Return the selection of the visible instances in the given region
+	/*! The region is a polygon in normalized device coordinates of the given composition matrix.
+	 *  If selectPrimitives is false the selection contains occurrences, else it contains
+	 *  the bodies and primitives of the occurrences of the given world.
+	 *  Bodies which are not meshes are tested with their bounding box.*/
+	GLC_SelectionSet selectRegion(const GLC_Matrix4x4& compositionMatrix, const QPolygonF& region, RegionMode mode
+			, const GLC_World* pWorld= NULL, bool selectPrimitives= false);
+
+	//! Return the selection of the visible instances in the given rectangle of the given viewport
+	GLC_SelectionSet selectInsideRectangle(const GLC_Viewport& viewport, const QRect& rect, RegionMode mode
+			, const GLC_World* pWorld= NULL, bool selectPrimitives= false);
+
+	//! Return the selection of the visible instances in the given lasso of the given viewport
+	GLC_SelectionSet selectInsideLasso(const GLC_Viewport& viewport, const QPolygon& lasso, RegionMode mode
+			, const GLC_World* pWorld= NULL, bool selectPrimitives= false);
+
+	//! Set the LOD used to test meshes
+	/*! The last LOD of a mesh is used if it has not the given LOD*/
+	void setLod(int lod);
+
+	//! Set the collection of this ray caster
+	void setCollection(GLC_3DViewCollection* pCollection);
+
+	//! Remove the BVH of the geometry of the given id from the cache
+	void removeFromCache(GLC_uint geometryId);
+
+	//! Clear the cache of mesh BVH
+	void clearCache();
+//@}
+
+//////////////////////////////////////////////////////////////////////
+/*! \name Private services Functions*/
+//@{
+//////////////////////////////////////////////////////////////////////
+private:
+	//! Return the BVH of the given mesh, build it if needed
+	RayCasterMeshBvh* meshBvh(GLC_Mesh* pMesh);
+
+	//! Test the given ray with the given instance and update the given hit if a nearer hit is found
+	void castRayOnInstance(GLC_3DViewInstance* pInstance, const GLC_Line3d& ray, GLC_RayHit* pHit);
+
+	//! Add the given instance or its primitives in the given region to the given selection
+	void selectRegionOnInstance(GLC_3DViewInstance* pInstance, const GLC_Matrix4x4& compositionMatrix, const RayCasterRegion& region
+			, RegionMode mode, bool selectPrimitives, GLC_SelectionSet* pSelection);
+//@}
+
+//////////////////////////////////////////////////////////////////////
+// Private members
+//////////////////////////////////////////////////////////////////////
+private:
+	//! The collection to pick
+	GLC_3DViewCollection* m_pCollection;
+
+	//! The LOD used to test meshes
+	int m_Lod;
+
+	//! The BVH of meshes LOD
+	QHash<QPair<GLC_uint, int>, RayCasterMeshBvh*> m_MeshBvhCache;
+
+	Q_DISABLE_COPY(GLC_RayCaster)
+};
+
+#endif /* GLC_RAYCASTER_H_ */
@@ -166,6 +166,10 @@ public:
 	inline double minimumDynamicPixelCullingRatio() const
 	{return m_MinimumDynamicRatioSize;}
 
+	//! Return true if clip planes are used and this viewport has some
+	inline bool clipPlaneIsUsed() const
+	{return m_UseClipPlane && !m_ClipPlanesHash.isEmpty();}
+
 //@}
 
 //////////////////////////////////////////////////////////////////////